@@ -2,17 +2,37 @@
 #define KMU2_HH
 
 #include <stdlib.h>
+#include <string.h>
+#include <map>
 #include <vector>
 #include "Analyzer.hh"
 #include "MCSimple.hh"
 #include "DetectorAcceptance.hh"
+#include "CutFlow.hh"
+#include "CutScheduler.hh"
+#include "CutScan.hh"
+#include "StageTimer.hh"
+#include "SelectionMask.hh"
+#include "EfficiencyMap.hh"
+#include "TimeOffsetTable.hh"
+#include "BadBurstList.hh"
+#include "HitTimeline.hh"
+#include "AnalysisKernels.hh"
 #include "TRecoVEvent.hh"
 #include <TCanvas.h>
 
+class TH1;
 class TH1I;
 class TH2F;
 class TGraph;
 class TTree;
+class AsyncHistoWriter;
+class TimeOffsetCalibrator;
+class ChannelT0Calibrator;
+class ChannelGainCalibrator;
+class BurstQuality;
+class DigiPulseMonitor;
+class HeapCounter;
 
 
 class Kmu2 : public NA62Analysis::Analyzer
@@ -30,9 +50,101 @@ public:
     void PostProcess();
     void DrawPlot();
     TVector3 VertexCDA(TVector3 pos1, TVector3 p1, TVector3 pos2, TVector3 p2, Double_t &cda);
-    int FindClosestCluster(TRecoVEvent* Event, TVector3 Extrap_track, string detector_type, double& dtrkcl_min);
+    int FindClosestCluster(TRecoVEvent* Event, const TVector3& Extrap_track, AnalysisKernels::Detector detector, double& dtrkcl_min);
+    bool ReadVariants(TString fileName);
+    void BookVariantHisto(TH1* histo);
+    void BookVariantHisto(TH1* histo, TString directory);
+    void FillVariant(const char* name, int iVariant, double x);
+    void FillVariant(const char* name, int iVariant, double x, double y);
 protected:
+    /// Stages of the selection, in the order of Process
+    enum CutStage {
+        kSTRAWNCandidates, kTrackCharge, kSTRAWChi2, kSTRAWNChambers, kCedarNSectors, kCDA, kVertexZ,
+        kLKrMIP, kMUV3NCandidates, kCedarNCandidates,
+        kCHODAssociation, kMUV3Association, kMissingMass, kSTRAWMomentum, kSTRAWMomentumDiff,
+        kCHODDistance, kCHODAcceptance, kSTRAW4Acceptance, kCHODNeighbour, kCedarTime,
+        kMUV1Time, kMUV1Distance, kMUV1Acceptance, kMUV1Window,
+        kMUV2Acceptance, kMUV2Time, kMUV2Distance, kMUV2Window,
+        kLKrNHits, kMUV3Time, kMUV3Acceptance, kMUV3Window,
+        kLKrAcceptance, kLKrDistance, kLKrTime, kLKrDeadCell, kLKrNeighbour
+    };
+    /// Inputs of the reordered cuts, computed on demand
+    enum CutInput { kTrackVertex, kLKrCorrection, kCHODCluster, kLKrCluster, kMUV1Cluster, kMUV2Cluster, kMUV3Cluster };
+    /// Cuts of the single pass scan (CutScan parameter)
+    enum ScanCut { kScanCDA, kScanSTRAWChi2, kScanCHODDistance, kScanMUV1Window, kScanMUV2Window };
+    /// Bits of the event mask of fSelection
+    enum EventBit { kBitMUV1, kBitMUV2, kBitMUV3, kBitLKr, kBitBadBurstMUV1, kBitBadBurstMUV2 };
+    /// MUV categories and DQ selections, predicates on the event mask
+    enum MUVSelection { kMUV123, kMUV23, kMUV13, kMUV3Only, kMUV23BadBurst, kMUV13BadBurst };
+    /// Efficiency maps of fEfficiency (Efficiency parameter)
+    enum EfficiencyMapIndex { kEffMUV1Strips, kEffMUV1Position, kEffMUV2Strips, kEffMUV2Position };
+    /// Detectors of fTimeline
+    enum TimelineDetector { kTimeCHOD, kTimeCedar, kTimeLKr, kTimeMUV1Hits, kTimeMUV2Hits, kNTimeDetectors };
+    /// Timed stages of Process (StageTiming parameter)
+    enum ProcessStage { kStageRead, kStageCuts, kStageLKrCorrection, kStageAssociation, kStageTimeline, kStageVariants, kStageMUVHits, kStageRICH, kStageHistos };
 
+    /// strcmp order: the variant histograms are looked up with the string literals of the fills
+    struct NameLess {
+        bool operator()(const char* a, const char* b) const { return strcmp(a, b)<0; }
+    };
+    /// Histograms of the selection: [0] nominal configuration, [K] copy with the _vK suffix
+    typedef std::map<const char*, std::vector<TH1*>, NameLess> VariantHistoTable;
 
+    /// Time offsets with respect to the CHOD and time cuts of one configuration of the selection [ns]
+    struct TimeConfig {
+        double fLKrOffset;
+        double fCedarOffset;
+        double fMUV1Offset;
+        double fMUV2Offset;
+        double fMUV3Offset;
+        double fLKrOffsetCut;
+        double fRICHOffsetCut;
+        double fMUV1OffsetCut;
+        double fMUV2OffsetCut;
+        double fMUV3OffsetCut;
+        double fCedarOffsetCut;
+    };
+
+    CutFlow fCutFlow;
+    CutScheduler fCutScheduler;
+    int fCutWarmUp;
+    CutScan fCutScan;
+    bool fCutScanEnabled;
+    StageTimer fStageTimer;               ///< Time distribution of the stages of Process (StageTiming parameter)
+    bool fStageTimingEnabled;
+    std::vector<TimeConfig> fVariants;    ///< [0] is the nominal configuration, the others come from fVariantsFile
+    std::vector<CutFlow> fVariantCutFlows; ///< Cut flow of the variant i+1
+    VariantHistoTable fVariantHistos;     ///< Histograms duplicated with the _vK suffix for each variant
+    std::map<const char*, TString, NameLess> fVariantDirectories; ///< Output directory of the variant histograms not booked at the top level
+    TString fVariantsFile;
+    SelectionMask fSelection;
+    SelectionMask::Mask fCategories; ///< Selections of the four MUV categories, filling the common histograms
+    std::vector<EfficiencyMap> fEfficiency;
+    bool fEfficiencyEnabled;
+    TimeOffsetTable fTimeOffsets;            ///< Calibrated offsets of the nominal configuration (TimeOffsets parameter)
+    TimeOffsetCalibrator* fTimeCalibrator;   ///< Calibration prepass (TimeCalibration parameter), writes fTimeOffsetsFile
+    TString fTimeOffsetsFile;
+    bool fTimeCalibration;
+    int fCalibrationEvents;
+    int fNBurstEvents;
+    ChannelT0Calibrator* fChannelT0;         ///< Per channel T0 of MUV1/MUV2/MUV3 (ChannelT0 parameter), written to fChannelT0File
+    TString fChannelT0File;
+    ChannelGainCalibrator* fChannelGain;     ///< Per channel MUV1/MUV2 gain from the MIP peak (ChannelGain parameter), written to fChannelGainFile
+    TString fChannelGainFile;
+    BadBurstList fBadBursts;                 ///< Bad bursts of the BadBurstMUV1/2 bits (BadBursts parameter)
+    TString fBadBurstsFile;
+    BurstQuality* fBurstQuality;             ///< Bad burst and dead/hot channel detection (BurstQuality parameter), written to fBurstQualityFile
+    TString fBurstQualityFile;
+    DigiPulseMonitor* fDigiPulses;           ///< MUV1/MUV2 digi pulse summaries of the MUV13 category (DigiPulses parameter)
+    bool fDigiPulsesEnabled;
+    HeapCounter* fHeapCounter;               ///< Heap allocations per event after warm-up (HeapCount parameter)
+    bool fHeapCountEnabled;
+    AsyncHistoWriter* fBurstWriter; ///< Per burst histogram snapshots (enabled with the BurstOutput parameter)
+    TString fBurstOutput;
+    HitTimeline fTimeline;                   ///< Candidate and hit times of the event, for the coincidence windows
+    int fMemoryIndex;                        ///< Analyzer index in MemoryMonitor
+    int fPerfIndex;                          ///< Analyzer index in PerfCounters
+    int fSharedIndex;                         ///< Analyzer index in SharedEvent
+    int fBurstID;
 };
 #endif
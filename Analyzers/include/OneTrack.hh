@@ -7,12 +7,17 @@
 #include "MCSimple.hh"
 #include "TRecoVEvent.hh"
 #include "DetectorAcceptance.hh"
+#include "CutFlow.hh"
+#include "EventArena.hh"
+#include "AnalysisKernels.hh"
 #include <TCanvas.h>
 
 class TH1I;
 class TH2F;
 class TGraph;
 class TTree;
+class AsyncHistoWriter;
+class HeapCounter;
 
 
 class OneTrack : public NA62Analysis::Analyzer
@@ -30,10 +35,24 @@ public:
     void PostProcess();
     void DrawPlot();
     TVector3 VertexCDA(TVector3 pos1, TVector3 p1, TVector3 pos2, TVector3 p2, Double_t &cda);
-    int FindClosestCluster(TRecoVEvent* Event, TVector3 Extrap_track, string detector_type, double& dtrkcl_min);
+    int FindClosestCluster(TRecoVEvent* Event, const TVector3& Extrap_track, AnalysisKernels::Detector detector, double& dtrkcl_min);
 
 protected:
+    /// Stages of the selection, in the order of Process
+    enum CutStage {
+        kSTRAWNCandidates, kTrackCharge, kSTRAWChi2, kSTRAWNChambers, kCedarNCandidates, kCedarNSectors,
+        kCDA, kVertexZ, kLKrEnergy, kLKrNGammas, kCHODAssociation
+    };
 
-
+    CutFlow fCutFlow;
+    AsyncHistoWriter* fBurstWriter; ///< Per burst histogram snapshots (enabled with the BurstOutput parameter)
+    TString fBurstOutput;
+    HeapCounter* fHeapCounter;      ///< Heap allocations per event after warm-up (HeapCount parameter)
+    bool fHeapCountEnabled;
+    EventArena fArena;              ///< Per event temporaries, reset in PostProcess
+    int fMemoryIndex;               ///< Analyzer index in MemoryMonitor
+    int fPerfIndex;                 ///< Analyzer index in PerfCounters
+    int fSharedIndex;                ///< Analyzer index in SharedEvent
+    int fBurstID;
 };
 #endif
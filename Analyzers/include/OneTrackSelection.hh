@@ -7,19 +7,25 @@
 #include "MCSimple.hh"
 #include "DetectorAcceptance.hh"
 #include "TRecoVEvent.hh"
+#include "CutFlow.hh"
+#include "CutScan.hh"
+#include "EventArena.hh"
+#include "AnalysisKernels.hh"
 #include <TCanvas.h>
 
 class TH1I;
 class TH2F;
 class TGraph;
 class TTree;
+class AsyncHistoWriter;
+class HeapCounter;
 
 
 class OneTrackSelection : public NA62Analysis::Analyzer
 {
 public:
     OneTrackSelection(NA62Analysis::Core::BaseAnalysis *ba);
-    int FindClosestCluster( TRecoVEvent* Event, TVector3 Extrap_track, string detector_type, double& minimum);
+    int FindClosestCluster(TRecoVEvent* Event, const TVector3& Extrap_track, AnalysisKernels::Detector detector, double& minimum);
     void InitHist();
     void InitOutput();
     void DefineMCSimple();
@@ -31,7 +37,29 @@ public:
     void PostProcess();
     void DrawPlot();
 protected:
+    /// Stages of the selection, in the order of Process
+    enum CutStage {
+        kSTRAWNCandidates, kTrackCharge, kSTRAWChi2, kSTRAWNChambers, kCedarNCandidates, kCedarNSectors,
+        kCHODAssociation, kCHODDistance, kCHODAcceptance, kCedarTime,
+        kLKrAcceptance, kLKrDistance, kLKrDeadCell, kLKrTime,
+        kMUV1Acceptance, kMUV1Window, kMUV1Time,
+        kMUV2Acceptance, kMUV2Window, kMUV2Time,
+        kMUV3Acceptance, kMUV3Window, kMUV3Time
+    };
+    /// Cuts of the single pass scan (CutScan parameter)
+    enum ScanCut { kScanSTRAWChi2, kScanCHODDistance, kScanMUV1Window, kScanMUV2Window };
 
-
+    CutFlow fCutFlow;
+    CutScan fCutScan;
+    bool fCutScanEnabled;
+    AsyncHistoWriter* fBurstWriter; ///< Per burst histogram snapshots (enabled with the BurstOutput parameter)
+    TString fBurstOutput;
+    HeapCounter* fHeapCounter;      ///< Heap allocations per event after warm-up (HeapCount parameter)
+    bool fHeapCountEnabled;
+    EventArena fArena;              ///< Per event temporaries, reset in PostProcess
+    int fMemoryIndex;               ///< Analyzer index in MemoryMonitor
+    int fPerfIndex;                 ///< Analyzer index in PerfCounters
+    int fSharedIndex;                ///< Analyzer index in SharedEvent
+    int fBurstID;
 };
 #endif
@@ -1,12 +1,28 @@
 #include <stdlib.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <TChain.h>
+#include <TGraphAsymmErrors.h>
 #include "Kmu2.hh"
 #include "Definition.h"
+#include "Logger.hh"
+#include "AsyncHistoWriter.hh"
+#include "TimeOffsetCalibrator.hh"
+#include "ChannelT0Calibrator.hh"
+#include "ChannelGainCalibrator.hh"
+#include "BurstQuality.hh"
+#include "DigiPulseMonitor.hh"
+#include "HeapCounter.hh"
+#include "MemoryMonitor.hh"
+#include "PerfCounters.hh"
+#include "SharedEvent.hh"
+#include "MUVChannelMap.hh"
 #include "MCSimple.hh"
 #include "functions.hh"
 #include "Event.hh"
 #include "Persistency.hh"
+#include "AnalysisKernels.hh"
 #include "MUV1Geometry.hh"
 #include "FADCEvent.hh"
 #include "TDigiVEvent.hh"
@@ -16,6 +32,10 @@
 #include "TRecoVCandidate.hh"
 #include <algorithm>
 
+//Directory of the default input files, set by CMake (ANALYSIS_DATA_DIR)
+#ifndef ANALYSIS_DATA_DIR
+#define ANALYSIS_DATA_DIR "data"
+#endif
 
 using namespace std;
 using namespace NA62Analysis;
@@ -62,7 +82,7 @@ using namespace NA62Constants;
 ///
 /// \EndDetailed
 
-Kmu2::Kmu2(Core::BaseAnalysis *ba) : Analyzer(ba, "Kmu2")
+Kmu2::Kmu2(Core::BaseAnalysis *ba) : Analyzer(ba, "Kmu2"), fCutFlow("Kmu2"), fCutScheduler("Kmu2"), fCutScan("Kmu2"), fStageTimer("Kmu2"), fSelection("Kmu2"), fTimeCalibrator(0), fNBurstEvents(0), fChannelT0(0), fChannelGain(0), fBurstQuality(0), fDigiPulses(0), fHeapCounter(0), fBurstWriter(0), fTimeline(kNTimeDetectors), fBurstID(-1)
 {
     /// \MemberDescr
     /// \param ba : parent BaseAnalysis
@@ -111,8 +131,131 @@ Kmu2::Kmu2(Core::BaseAnalysis *ba) : Analyzer(ba, "Kmu2")
     RequestTree("RICH",new TRecoRICHEvent);
     RequestTree("CHOD",new TRecoCHODEvent);
     RequestTree("Cedar",new TRecoCedarEvent);
+    fMemoryIndex = MemoryMonitor::Instance().AddAnalyzer("Kmu2");
+    fPerfIndex = PerfCounters::Instance().AddAnalyzer("Kmu2");
+    fSharedIndex = SharedEvent::Instance().AddAnalyzer("Kmu2");
     //RequestL0Data();
 
+    //Nominal time offsets (ATM using only CHOD as reference) and time cuts
+    TimeConfig nominal;
+    nominal.fLKrOffset   = +115; //Old 112.3 Use GetClusterTime new 115 Gia 121.2
+    nominal.fCedarOffset =0.; //old 0 new 0 Gia 6.23
+    nominal.fMUV1Offset  =0.;//new -5 old -8.5 Gia 6.08
+    nominal.fMUV2Offset  =0.;//new -5 old -20.4 Gia 5.59
+    nominal.fMUV3Offset  =0.;//old -11.35 Gia -2.75
+    nominal.fLKrOffsetCut  = 100.;//10;
+    nominal.fRICHOffsetCut = 100.;//10;
+    nominal.fMUV3OffsetCut = 100.;//5 ;
+    nominal.fMUV1OffsetCut = 100.;//20;
+    nominal.fMUV2OffsetCut = 100.;//20;
+    nominal.fCedarOffsetCut= 100.;//2 ;
+    fVariants.push_back(nominal);
+
+    fCutFlow.AddCut(kSTRAWNCandidates , "STRAW_NCandidates");
+    fCutFlow.AddCut(kTrackCharge      , "Track_charge");
+    fCutFlow.AddCut(kSTRAWChi2        , "STRAW_chi2");
+    fCutFlow.AddCut(kSTRAWNChambers   , "STRAW_NChambers");
+    fCutFlow.AddCut(kCedarNSectors    , "Cedar_NSectors");
+    fCutFlow.AddCut(kCDA              , "cda");
+    fCutFlow.AddCut(kVertexZ          , "Vertex_Z");
+    fCutFlow.AddCut(kLKrMIP           , "LKr_MIP");
+    fCutFlow.AddCut(kMUV3NCandidates  , "MUV3_NCandidates");
+    fCutFlow.AddCut(kCedarNCandidates , "Cedar_NCandidates");
+    fCutFlow.AddCut(kCHODAssociation  , "CHOD_association");
+    fCutFlow.AddCut(kMUV3Association  , "MUV3_association");
+    fCutFlow.AddCut(kMissingMass      , "Missing_mass");
+    fCutFlow.AddCut(kSTRAWMomentum    , "STRAW_P");
+    fCutFlow.AddCut(kSTRAWMomentumDiff, "STRAW_P_minus_Pbf");
+    fCutFlow.AddCut(kCHODDistance     , "CHOD_dtrkcl");
+    fCutFlow.AddCut(kCHODAcceptance   , "CHOD_acceptance");
+    fCutFlow.AddCut(kSTRAW4Acceptance , "STRAW4_acceptance");
+    fCutFlow.AddCut(kCHODNeighbour    , "CHOD_neighbour");
+    fCutFlow.AddCut(kCedarTime        , "Cedar_time");
+    fCutFlow.AddCut(kMUV1Time         , "MUV1_time");
+    fCutFlow.AddCut(kMUV1Distance     , "MUV1_dtrkcl");
+    fCutFlow.AddCut(kMUV1Acceptance   , "MUV1_acceptance");
+    fCutFlow.AddCut(kMUV1Window       , "MUV1_window");
+    fCutFlow.AddCut(kMUV2Acceptance   , "MUV2_acceptance");
+    fCutFlow.AddCut(kMUV2Time         , "MUV2_time");
+    fCutFlow.AddCut(kMUV2Distance     , "MUV2_dtrkcl");
+    fCutFlow.AddCut(kMUV2Window       , "MUV2_window");
+    fCutFlow.AddCut(kLKrNHits         , "LKr_NHits");
+    fCutFlow.AddCut(kMUV3Time         , "MUV3_time");
+    fCutFlow.AddCut(kMUV3Acceptance   , "MUV3_acceptance");
+    fCutFlow.AddCut(kMUV3Window       , "MUV3_window");
+    fCutFlow.AddCut(kLKrAcceptance    , "LKr_acceptance");
+    fCutFlow.AddCut(kLKrDistance      , "LKr_dtrkcl");
+    fCutFlow.AddCut(kLKrTime          , "LKr_time");
+    fCutFlow.AddCut(kLKrDeadCell      , "LKr_DDeadCell");
+    fCutFlow.AddCut(kLKrNeighbour     , "LKr_neighbour");
+
+    //Cuts before the CHOD neighbour veto: independent, reordered at run time (see CutScheduler)
+    fCutScheduler.AddProducer(kTrackVertex  , "VertexCDA");
+    fCutScheduler.AddProducer(kLKrCorrection, "LKr_correction");
+    fCutScheduler.AddProducer(kCHODCluster  , "CHOD_closest");
+    fCutScheduler.AddProducer(kLKrCluster   , "LKr_closest");
+    fCutScheduler.AddProducer(kMUV1Cluster  , "MUV1_closest");
+    fCutScheduler.AddProducer(kMUV2Cluster  , "MUV2_closest");
+    fCutScheduler.AddProducer(kMUV3Cluster  , "MUV3_closest");
+    fCutScheduler.AddCut(kSTRAWChi2        , "STRAW_chi2"       , {});
+    fCutScheduler.AddCut(kSTRAWNChambers   , "STRAW_NChambers"  , {});
+    fCutScheduler.AddCut(kCedarNSectors    , "Cedar_NSectors"   , {});
+    fCutScheduler.AddCut(kCDA              , "cda"              , {kTrackVertex});
+    fCutScheduler.AddCut(kVertexZ          , "Vertex_Z"         , {kTrackVertex});
+    fCutScheduler.AddCut(kLKrMIP           , "LKr_MIP"          , {kLKrCorrection});
+    fCutScheduler.AddCut(kMUV3NCandidates  , "MUV3_NCandidates" , {});
+    fCutScheduler.AddCut(kCedarNCandidates , "Cedar_NCandidates", {});
+    fCutScheduler.AddCut(kCHODAssociation  , "CHOD_association" , {kCHODCluster});
+    fCutScheduler.AddCut(kMUV3Association  , "MUV3_association" , {kMUV3Cluster});
+    fCutScheduler.AddCut(kMissingMass      , "Missing_mass"     , {});
+    fCutScheduler.AddCut(kSTRAWMomentum    , "STRAW_P"          , {});
+    fCutScheduler.AddCut(kSTRAWMomentumDiff, "STRAW_P_minus_Pbf", {});
+    fCutScheduler.AddCut(kCHODDistance     , "CHOD_dtrkcl"      , {kCHODCluster}, {kCHODAssociation}); //dtrkcl undefined without candidate
+    fCutScheduler.AddCut(kCHODAcceptance   , "CHOD_acceptance"  , {});
+    fCutScheduler.AddCut(kSTRAW4Acceptance , "STRAW4_acceptance", {});
+
+    //Scanned variables, binned finely enough to place the cut anywhere in the range
+    fCutScan.AddCut(kScanCDA         , "cda"        , 2000, 0., 200.);
+    fCutScan.AddCut(kScanSTRAWChi2   , "STRAW_chi2" , 1000, 0., 100.);
+    fCutScan.AddCut(kScanCHODDistance, "CHOD_dtrkcl", 800 , 0., 400.);
+    fCutScan.AddCut(kScanMUV1Window  , "MUV1_window", 1200, 0., 600.);
+    fCutScan.AddCut(kScanMUV2Window  , "MUV2_window", 1200, 0., 600.);
+
+    //Timed stages of Process, the nested ones are included in their parent
+    fStageTimer.AddStage(kStageRead         , "Read");
+    fStageTimer.AddStage(kStageCuts         , "Cuts");
+    fStageTimer.AddStage(kStageLKrCorrection, "LKr_correction", kStageCuts);
+    fStageTimer.AddStage(kStageAssociation  , "Association", kStageCuts);
+    fStageTimer.AddStage(kStageTimeline     , "Timeline");
+    fStageTimer.AddStage(kStageVariants     , "Variants");
+    fStageTimer.AddStage(kStageMUVHits      , "MUV_hits", kStageVariants);
+    fStageTimer.AddStage(kStageRICH         , "RICH", kStageVariants);
+    fStageTimer.AddStage(kStageHistos       , "Histograms", kStageVariants);
+
+    //Event bits and MUV categories (the names are the suffixes of the category histograms)
+    fSelection.AddBit(kBitMUV1        , "MUV1");
+    fSelection.AddBit(kBitMUV2        , "MUV2");
+    fSelection.AddBit(kBitMUV3        , "MUV3");
+    fSelection.AddBit(kBitLKr         , "LKr");
+    fSelection.AddBit(kBitBadBurstMUV1, "BadBurstMUV1");
+    fSelection.AddBit(kBitBadBurstMUV2, "BadBurstMUV2");
+    SelectionMask::Mask MUV1 = SelectionMask::Bit(kBitMUV1);
+    SelectionMask::Mask MUV2 = SelectionMask::Bit(kBitMUV2);
+    SelectionMask::Mask MUV3 = SelectionMask::Bit(kBitMUV3);
+    fSelection.AddSelection(kMUV123       , "MUV123"  , MUV1 | MUV2 | MUV3);
+    fSelection.AddSelection(kMUV23        , "MUV23"   , MUV2 | MUV3, MUV1);
+    fSelection.AddSelection(kMUV13        , "MUV13"   , MUV1 | MUV3, MUV2);
+    fSelection.AddSelection(kMUV3Only     , "MUV3"    , MUV3, MUV1 | MUV2);
+    fSelection.AddSelection(kMUV23BadBurst, "MUV23_BB", MUV2 | MUV3 | SelectionMask::Bit(kBitBadBurstMUV1), MUV1);
+    fSelection.AddSelection(kMUV13BadBurst, "MUV13_BB", MUV1 | MUV3 | SelectionMask::Bit(kBitBadBurstMUV2), MUV2);
+    fCategories = SelectionMask::Bit(kMUV123) | SelectionMask::Bit(kMUV23) | SelectionMask::Bit(kMUV13) | SelectionMask::Bit(kMUV3Only);
+
+    //MUV1 (MUV2) efficiency for the muons associated to MUV2 (MUV1) and MUV3, vs the strips crossed and the position
+    fEfficiency.push_back(EfficiencyMap("Kmu2_EffMUV1_Strips"  , "MUV1 efficiency;Vertical strip;Horizontal strip", 45, 0, 45, 45, 0, 45));
+    fEfficiency.push_back(EfficiencyMap("Kmu2_EffMUV1_Position", "MUV1 efficiency;X [mm];Y [mm]", 52, -1300, 1300, 52, -1300, 1300));
+    fEfficiency.push_back(EfficiencyMap("Kmu2_EffMUV2_Strips"  , "MUV2 efficiency;Vertical strip;Horizontal strip", 23, 0, 23, 23, 0, 23));
+    fEfficiency.push_back(EfficiencyMap("Kmu2_EffMUV2_Position", "MUV2 efficiency;X [mm];Y [mm]", 52, -1300, 1300, 52, -1300, 1300));
+
 }
 
 void Kmu2::InitOutput(){
@@ -157,6 +300,36 @@ void Kmu2::InitOutput(){
     ///     CreateStandardTree("TTreeName", "TTreeTitle");
     /// \endcode
     /// \EndMemberDescr
+    //Path of the file receiving the per burst histogram snapshots (empty: disabled)
+    AddParam("BurstOutput", &fBurstOutput, "");
+    //Number of events processed with the declared cut order before reordering (<=0: never reorder)
+    AddParam("CutWarmUp", &fCutWarmUp, 1000);
+    //N-1 distributions and efficiency curves of the scanned cuts in a single pass
+    AddParam("CutScan", &fCutScanEnabled, false);
+    //File declaring configuration variants of the time offsets and cuts, one per line (empty: nominal only)
+    AddParam("Variants", &fVariantsFile, "");
+    //Per burst time offset table: written by the calibration prepass, read by the main pass (empty: hard-coded offsets)
+    AddParam("TimeOffsets", &fTimeOffsetsFile, "");
+    //Calibration prepass: fit the time offsets of each burst and write them to TimeOffsets
+    AddParam("TimeCalibration", &fTimeCalibration, false);
+    //Number of events of each burst used by the calibration prepass (<=0: all)
+    AddParam("CalibrationEvents", &fCalibrationEvents, 20000);
+    //Text file receiving the per channel T0 of the MUV1/MUV2 strips and MUV3 tiles (empty: disabled)
+    AddParam("ChannelT0", &fChannelT0File, "");
+    //Text file receiving the per channel MUV1/MUV2 gain constants (empty: disabled)
+    AddParam("ChannelGain", &fChannelGainFile, "");
+    //MUV1/MUV2 efficiency maps and per burst efficiency
+    AddParam("Efficiency", &fEfficiencyEnabled, false);
+    //Bad burst list setting the BadBurstMUV1/2 bits, as written by BurstQuality (empty: no bad burst)
+    AddParam("BadBursts", &fBadBurstsFile, ANALYSIS_DATA_DIR "/Kmu2BadBursts.txt");
+    //Text file receiving the bad bursts and dead/hot MUV1/MUV2 channels found in this run (empty: disabled)
+    AddParam("BurstQuality", &fBurstQualityFile, "");
+    //Pulse analysis of the MUV1/MUV2 digis of the MUV13 category
+    AddParam("DigiPulses", &fDigiPulsesEnabled, false);
+    //Heap allocations per event of the analyzers, after the first 100 events (build with -DHEAP_COUNTER=ON)
+    AddParam("HeapCount", &fHeapCountEnabled, false);
+    //Time distribution (p50, p99, share) of the stages of Process: reading, cuts, associations, variants, histogram filling
+    AddParam("StageTiming", &fStageTimingEnabled, false);
 }
 
 void Kmu2::InitHist(){
@@ -229,266 +402,274 @@ void Kmu2::InitHist(){
     /// of the histogram is replaced each time a new file is opened.
     /// \EndMemberDescr
 
+    //MUV1 digis are only read for the pulse shapes: the parameters are not set yet in the constructor
+    if(fDigiPulsesEnabled) RequestTree("MUV1",new FADCEvent,"Digis");
+
     //Run/burst related histograms
     //testing MUV candidates
 
-    BookHisto(new TH1I("MUV123", "Track having MUV1,2,3 associated clusters; MUV1+2+3", 5, 0, 5));
-    BookHisto(new TH1I("MUV13", "Track having MUV1,3 associated clusters; MUV1+3", 5, 0, 5));
-    BookHisto(new TH1I("MUV23", "Track having MUV2,3 associated clusters; MUV2+3", 5, 0, 5));
-    BookHisto(new TH1I("MUV3Only", "Track having MUV3 associated cluster; MUV3", 5, 0, 5));
+    BookVariantHisto(new TH1I("MUV123", "Track having MUV1,2,3 associated clusters; MUV1+2+3", 5, 0, 5));
+    BookVariantHisto(new TH1I("MUV13", "Track having MUV1,3 associated clusters; MUV1+3", 5, 0, 5));
+    BookVariantHisto(new TH1I("MUV23", "Track having MUV2,3 associated clusters; MUV2+3", 5, 0, 5));
+    BookVariantHisto(new TH1I("MUV3Only", "Track having MUV3 associated cluster; MUV3", 5, 0, 5));
 
-    BookHisto(new TH1I("BurstID","Burst  ID;BurstID",4000,0,4000), "BurstInfo");
-    BookHisto(new TH2I("BurstID_vs_MUV123","Burst  ID for MUV1&MUV2&MUV3 events;BurstID"  ,4000,0,4000, 5, 0 , 5));
-    BookHisto(new TH2I("BurstID_vs_MUV23","Burst  ID for MUV3&MUV2 !& MUV1 events;BurstID",4000,0,4000, 5, 0 , 5));
-    BookHisto(new TH2I("BurstID_vs_MUV13","Burst  ID for MUV3&MUV1 !& MUV2 events;BurstID",4000,0,4000, 5, 0 , 5));
-    BookHisto(new TH2I("BurstID_vs_MUV3","Burst  ID for MUV3 only events;BurstID",4000,0,4000, 5,0,5));
+    BookVariantHisto(new TH1I("BurstID","Burst  ID;BurstID",4000,0,4000), "BurstInfo");
+    BookVariantHisto(new TH2I("BurstID_vs_MUV123","Burst  ID for MUV1&MUV2&MUV3 events;BurstID"  ,4000,0,4000, 5, 0 , 5));
+    BookVariantHisto(new TH2I("BurstID_vs_MUV23","Burst  ID for MUV3&MUV2 !& MUV1 events;BurstID",4000,0,4000, 5, 0 , 5));
+    BookVariantHisto(new TH2I("BurstID_vs_MUV13","Burst  ID for MUV3&MUV1 !& MUV2 events;BurstID",4000,0,4000, 5, 0 , 5));
+    BookVariantHisto(new TH2I("BurstID_vs_MUV3","Burst  ID for MUV3 only events;BurstID",4000,0,4000, 5,0,5));
 
     //MUV3 hit plots for the inefficient events
-    BookHisto(new TH1I("MUV3Hit_NoMUV1", "MUV3 Hitmap for the MUV1 inefficient events", 200, 0, 200));
-    BookHisto(new TH1I("MUV3Hit_NoMUV2", "MUV3 Hitmap for the MUV2 inefficient events", 200, 0, 200));
+    BookVariantHisto(new TH1I("MUV3Hit_NoMUV1", "MUV3 Hitmap for the MUV1 inefficient events", 200, 0, 200));
+    BookVariantHisto(new TH1I("MUV3Hit_NoMUV2", "MUV3 Hitmap for the MUV2 inefficient events", 200, 0, 200));
     BookHisto(new TH1I("MUV3Hit_NoMUV12", "MUV3 Hitmap for the MUV2 and MUV1 inefficient events", 200, 0, 200));
-    BookHisto(new TH1I("MUV3Hit_GoodEvent", "MUV3 Hitmap for the fully efficient events", 200, 0, 200));
+    BookVariantHisto(new TH1I("MUV3Hit_GoodEvent", "MUV3 Hitmap for the fully efficient events", 200, 0, 200));
 
     //General Kinematic histograms
-    BookHisto(new TH1F("TrackP", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.));
-    BookHisto(new TH1F("TrackPfit_TrackP", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.));
-    BookHisto(new TH1F("BeamP", "Beam Momentum ; Beam_P[MeV]", 100, 0., 100000.));
-    BookHisto(new TH1F("MM2", "Missing mass squared; (P_{K} - P_{#pi} )^2 [GeV^2]",200, -0.2,0.2));
-    BookHisto(new TH2F("Track_P_vs_MM2", "Track Momentum vs Missing mass squared;P_{track} [GeV/c]; M_{miss}^2 [GeV^2/c^2]",100, 0., 100., 200, -0.2,0.2));
-    BookHisto(new TH2F("Track_P_vs_Theta", " Missing mass squared vs Angle between kaon and #pi; P_{track} [GeV/c];#theta_{K#pi} [rad]",100, 0., 100., 200, 0.,0.02));
+    BookVariantHisto(new TH1F("TrackP", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.));
+    BookVariantHisto(new TH1F("TrackPfit_TrackP", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.));
+    BookVariantHisto(new TH1F("BeamP", "Beam Momentum ; Beam_P[MeV]", 100, 0., 100000.));
+    BookVariantHisto(new TH1F("MM2", "Missing mass squared; (P_{K} - P_{#pi} )^2 [GeV^2]",200, -0.2,0.2));
+    BookVariantHisto(new TH2F("Track_P_vs_MM2", "Track Momentum vs Missing mass squared;P_{track} [GeV/c]; M_{miss}^2 [GeV^2/c^2]",100, 0., 100., 200, -0.2,0.2));
+    BookVariantHisto(new TH2F("Track_P_vs_Theta", " Missing mass squared vs Angle between kaon and #pi; P_{track} [GeV/c];#theta_{K#pi} [rad]",100, 0., 100., 200, 0.,0.02));
 
     //STRAW
-    BookHisto(new TH1I("STRAW_Nchambers", "STRAW number of chambers per candidate; Nchambers", 20, 0, 20));
-    BookHisto(new TH1F("TrackChi2", "STRAW Chi2", 200, 0., 200.));
+    BookVariantHisto(new TH1I("STRAW_Nchambers", "STRAW number of chambers per candidate; Nchambers", 20, 0, 20));
+    BookVariantHisto(new TH1F("TrackChi2", "STRAW Chi2", 200, 0., 200.));
 
 
     //MUV1
-    BookHisto(new TH1I("MUV1_Ncandidates", "MUV1 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV1_Nhits", "MUV1 number of hits for the associated track cluster", 50, 0, 50));
-    BookHisto(new TH2F("MUV1xvsy", "x vs y position in MUV1", 44, -1320., 1320.,44, -1320., 1320.));
+    BookVariantHisto(new TH1I("MUV1_Ncandidates", "MUV1 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV1_Nhits", "MUV1 number of hits for the associated track cluster", 50, 0, 50));
+    BookVariantHisto(new TH2F("MUV1xvsy", "x vs y position in MUV1", 44, -1320., 1320.,44, -1320., 1320.));
     BookHisto(new TH1F("MUV1_RICH_timediff", "Time difference between MUV1 and RICH", 100, -50, 50.));
-    BookHisto(new TH1F("MUV1_SeedEnergy", " MUV1 Energy of the two most energetic Horizontal+Vertical channels", 1000, 0, 10000.));
-    BookHisto(new TH1F("MUV1_ClusterEnergy", " MUV1 cluster energy", 1000, 0, 10000.));
-    BookHisto(new TH1F("MUV1_Eseed_over_Ecl", "MUV1 E_{seed}/E_{cluster}; E_{seed}/E_{cluster}", 120, 0.,1.2));
-    BookHisto(new TH2F("MUV1_SeedEnergy_xvsy", " MUV1 SeedEnergy Horizontal + Vertical channels", 1000, 0, 10000., 1000, 0, 1000.));
-    BookHisto(new TH2F("MUV1_SeedEnergy_vs_ClusterEnergy", " MUV1 SeedEnergy vs ClusterEnergy", 1000, 0, 10000., 1000, 0, 10000.));
-    BookHisto(new TH2F("MUV1_cda_x_vs_y", "Difference between extraplated track and position given by MUV1;#Delta_x [mm];#Delta_y [mm]", 300, -300., 300., 300, -300., 300.));
-    BookHisto(new TH1F("MUV1_trk_dist", "Distance beteen extrapolated track and position in the MUV1;MUV1_trkd [mm] ", 1500, 0., 3000.));
+    BookVariantHisto(new TH1F("MUV1_SeedEnergy", " MUV1 Energy of the two most energetic Horizontal+Vertical channels", 1000, 0, 10000.));
+    BookVariantHisto(new TH1F("MUV1_ClusterEnergy", " MUV1 cluster energy", 1000, 0, 10000.));
+    BookVariantHisto(new TH1F("MUV1_Eseed_over_Ecl", "MUV1 E_{seed}/E_{cluster}; E_{seed}/E_{cluster}", 120, 0.,1.2));
+    BookVariantHisto(new TH2F("MUV1_SeedEnergy_xvsy", " MUV1 SeedEnergy Horizontal + Vertical channels", 1000, 0, 10000., 1000, 0, 1000.));
+    BookVariantHisto(new TH2F("MUV1_SeedEnergy_vs_ClusterEnergy", " MUV1 SeedEnergy vs ClusterEnergy", 1000, 0, 10000., 1000, 0, 10000.));
+    BookVariantHisto(new TH2F("MUV1_cda_x_vs_y", "Difference between extraplated track and position given by MUV1;#Delta_x [mm];#Delta_y [mm]", 300, -300., 300., 300, -300., 300.));
+    BookVariantHisto(new TH1F("MUV1_trk_dist", "Distance beteen extrapolated track and position in the MUV1;MUV1_trkd [mm] ", 1500, 0., 3000.));
 
 
     //MUV2
-    BookHisto(new TH1I("MUV2_Ncandidates", "MUV2 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV2_Nhits", "MUV2 number of hits for the associated track cluster", 50, 0, 50));
-    BookHisto(new TH2F("MUV2xvsy", "x vs y position in MUV2", 22, -1320., 1320.,22, -1320., 1320.));
+    BookVariantHisto(new TH1I("MUV2_Ncandidates", "MUV2 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV2_Nhits", "MUV2 number of hits for the associated track cluster", 50, 0, 50));
+    BookVariantHisto(new TH2F("MUV2xvsy", "x vs y position in MUV2", 22, -1320., 1320.,22, -1320., 1320.));
 
 
-    BookHisto(new TH2F("MUV2_cda_x_vs_y", "Difference between extraplated track and position given by MUV2;#Delta_x [mm];#Delta_y [mm]", 300, -300., 300., 300, -300., 300.));
-    BookHisto(new TH1F("MUV2_trk_dist", "Distance beteen extrapolated track and position in the MUV2;MUV2_trkd [mm] ", 1500, 0., 3000.));
-    BookHisto(new TH1F("MUV2_ClusterEnergy", " MUV2 cluster energy", 1000, 0, 10000.));
-    BookHisto(new TH1F("MUV2_SeedEnergy", " MUV2 Energy of the two most energetic Horizontal and Vertical channels", 1000, 0, 10000.));
-    BookHisto(new TH1F("MUV2_Eseed_over_Ecl", "MUV2 E_{seed}/E_{cluster}; E_{seed}/E_{cluster}", 120, 0.,1.2));
-    BookHisto(new TH2F("MUV2_SeedEnergy_xvsy", " MUV2 SeedEnergy Horizontal vs Vertical", 1000, 0, 10000., 1000, 0., 10000.));
-    BookHisto(new TH2F("MUV2_SeedEnergy_vs_ClusterEnergy", " MUV2 SeedEnergy vs ClusterEnergy", 1000, 0, 10000., 1000, 0, 10000.));
+    BookVariantHisto(new TH2F("MUV2_cda_x_vs_y", "Difference between extraplated track and position given by MUV2;#Delta_x [mm];#Delta_y [mm]", 300, -300., 300., 300, -300., 300.));
+    BookVariantHisto(new TH1F("MUV2_trk_dist", "Distance beteen extrapolated track and position in the MUV2;MUV2_trkd [mm] ", 1500, 0., 3000.));
+    BookVariantHisto(new TH1F("MUV2_ClusterEnergy", " MUV2 cluster energy", 1000, 0, 10000.));
+    BookVariantHisto(new TH1F("MUV2_SeedEnergy", " MUV2 Energy of the two most energetic Horizontal and Vertical channels", 1000, 0, 10000.));
+    BookVariantHisto(new TH1F("MUV2_Eseed_over_Ecl", "MUV2 E_{seed}/E_{cluster}; E_{seed}/E_{cluster}", 120, 0.,1.2));
+    BookVariantHisto(new TH2F("MUV2_SeedEnergy_xvsy", " MUV2 SeedEnergy Horizontal vs Vertical", 1000, 0, 10000., 1000, 0., 10000.));
+    BookVariantHisto(new TH2F("MUV2_SeedEnergy_vs_ClusterEnergy", " MUV2 SeedEnergy vs ClusterEnergy", 1000, 0, 10000., 1000, 0, 10000.));
 
     //MUV3
-    BookHisto(new TH1I("MUV3_Ncandidates", "MUV3 number of candidates", 50, 0, 50));
-    BookHisto(new TH2F("MUV3_cda_x_vs_y", "Difference between extraplated track and position given by MUV3;#Delta_x [mm];#Delta_y [mm]", 1000, -1000., 1000., 1000, -1000., 1000.));
+    BookVariantHisto(new TH1I("MUV3_Ncandidates", "MUV3 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH2F("MUV3_cda_x_vs_y", "Difference between extraplated track and position given by MUV3;#Delta_x [mm];#Delta_y [mm]", 1000, -1000., 1000., 1000, -1000., 1000.));
     //BookHisto(new TH1F("MUV3_time", "MUV3 cluster Time", 100, -50, 50.));
 
     //CHOD
-    BookHisto(new TH1I("CHOD_Ncandidates", "CHOD number of candidates", 20, 0, 20));
-    BookHisto(new TH2F("CHOD_x_vs_y", "CHOD hitposition x vs y ; x[mm];y[mm]", 26, -1300., 1300., 26, -1300., 1300.));
-    BookHisto(new TH1F("CHOD_trk_dist", "Distance beteen extrapolated track and position in the CHOD;CHOD_trkd [mm] ", 1500, 0., 3000.));
-    BookHisto(new TH1F("CHOD_nt_timediff" , " Time difference between the associated hit and the others ; CHOD_{associated cl} - CHOD_{secondary cl} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("CHOD_nt_dtrk", "Distance beteen extrapolated track and position in the CHOD for the closest track;CHOD_trkd [mm] ", 150, 0., 300.));
-    BookHisto(new TH2F("CHOD_cda_x_vs_y", "Distance beteen extrapolated track and position in the CHOD  x vs y;x[mm];y[mm]", 300, -300, 300., 300, -300., 300.));
+    BookVariantHisto(new TH1I("CHOD_Ncandidates", "CHOD number of candidates", 20, 0, 20));
+    BookVariantHisto(new TH2F("CHOD_x_vs_y", "CHOD hitposition x vs y ; x[mm];y[mm]", 26, -1300., 1300., 26, -1300., 1300.));
+    BookVariantHisto(new TH1F("CHOD_trk_dist", "Distance beteen extrapolated track and position in the CHOD;CHOD_trkd [mm] ", 1500, 0., 3000.));
+    BookVariantHisto(new TH1F("CHOD_nt_timediff" , " Time difference between the associated hit and the others ; CHOD_{associated cl} - CHOD_{secondary cl} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("CHOD_nt_dtrk", "Distance beteen extrapolated track and position in the CHOD for the closest track;CHOD_trkd [mm] ", 150, 0., 300.));
+    BookVariantHisto(new TH2F("CHOD_cda_x_vs_y", "Distance beteen extrapolated track and position in the CHOD  x vs y;x[mm];y[mm]", 300, -300, 300., 300, -300., 300.));
 
 
     //RICH
-    BookHisto(new TH1I("RICH_Ncandidates", "RICH number of candidates", 50, 0, 50));
-    BookHisto(new TH1F("RICHRadius", "RICH radius", 500, 0., 500.));
-    BookHisto(new TH1F("RICHMass", "Mass computed with RICH", 1000, 0., 1.));
-    BookHisto(new TH2F("RICHMvsP", "Momentum vs RICH mass", 100, 0., 100., 1000, 0., 1.));
-    BookHisto(new TH1F("RICHAngle", "RICH angle", 200, 0., 1.));
-    BookHisto(new TH2F("RICHRvsP", "Energy as a function of particle", 100, 0., 100000., 500, 0., 500.));
-    BookHisto(new TH1F("RICH_STRAW_dxdzdiff", "Slope difference between x slopes of RICH and STRAW", 200, -0.5, 0.5));
-    BookHisto(new TH1F("RICH_STRAW_dydzdiff", "Slope difference between y slopes of RICH and STRAW", 200, -0.5, 0.5));
-    BookHisto(new TH2F("RICH_dxdz_vs_dydz", "Slopes taken from the RICH ;dxdz[rad];dydz[rad]", 400, -0.1, 0.1, 400, -0.1, 0.1));
-    BookHisto(new TH2F("RICH_x_vs_y", "Position of extrapolated track to the RICH front mirror;x[mm];y[mm]", 220, -1100, 1100., 220, -1100., 1100.));
-    BookHisto(new TH2F("RICH_cda_x_vs_y", "Distance beteen extrapolated track and position in the RICH  x vs y", 220, -1100, 1100., 220, -1100., 1100.));
+    BookVariantHisto(new TH1I("RICH_Ncandidates", "RICH number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1F("RICHRadius", "RICH radius", 500, 0., 500.));
+    BookVariantHisto(new TH1F("RICHMass", "Mass computed with RICH", 1000, 0., 1.));
+    BookVariantHisto(new TH2F("RICHMvsP", "Momentum vs RICH mass", 100, 0., 100., 1000, 0., 1.));
+    BookVariantHisto(new TH1F("RICHAngle", "RICH angle", 200, 0., 1.));
+    BookVariantHisto(new TH2F("RICHRvsP", "Energy as a function of particle", 100, 0., 100000., 500, 0., 500.));
+    BookVariantHisto(new TH1F("RICH_STRAW_dxdzdiff", "Slope difference between x slopes of RICH and STRAW", 200, -0.5, 0.5));
+    BookVariantHisto(new TH1F("RICH_STRAW_dydzdiff", "Slope difference between y slopes of RICH and STRAW", 200, -0.5, 0.5));
+    BookVariantHisto(new TH2F("RICH_dxdz_vs_dydz", "Slopes taken from the RICH ;dxdz[rad];dydz[rad]", 400, -0.1, 0.1, 400, -0.1, 0.1));
+    BookVariantHisto(new TH2F("RICH_x_vs_y", "Position of extrapolated track to the RICH front mirror;x[mm];y[mm]", 220, -1100, 1100., 220, -1100., 1100.));
+    BookVariantHisto(new TH2F("RICH_cda_x_vs_y", "Distance beteen extrapolated track and position in the RICH  x vs y", 220, -1100, 1100., 220, -1100., 1100.));
 
     //LKr
-    BookHisto(new TH1I("LKr_Ncandidates", "LKr number of candidates;Ncandidates", 20, 0., 20.));
-    BookHisto(new TH2F("LKr_x_vs_y", "LKr hitposition x vs y ;x[mm];y[mm]", 130 , -1300., 1300., 130, -1300., 1300.));
-    BookHisto(new TH2F("LKr_cda_x_vs_y", "Distance beteen extrapolated track and position in the LKr  x vs y;x[mm];y[mm]", 300, -300, 300., 300, -300., 300.));
-    BookHisto(new TH2F("LKr_Ecl_vs_NCell", "LKr cluster energy vs number of cells ; E_{cluster} [MeV]; Number of Cells", 1000, 0., 10000., 150, 0., 150.));
-    BookHisto(new TH1F("LKr_EoP", "LKr E/p", 120, 0., 1.2));
-    BookHisto(new TH1F("LKr_Ecl", "LKr cluster energy", 1000, 0., 10000.));
-    BookHisto(new TH1F("LKr_Eseed_over_Ecl", "LKr E_{seed}/E_{cluster}; E_{seed}/E_{cluster}", 120, 0.,1.2));
-    BookHisto(new TH2F("LKr_Es_Ecl_vs_E77_Ecl", "LKr clusters ; E_{seed}/E_{cluster}; 1 - E_{77}/E_{cluster}", 100, 0.,1., 100, 0.,1.));
-    BookHisto(new TH1F("LKr_nearest_track_DDeadCell", "Distance to nearest dead cell in the LKr for the closest track;LKr_DDeadcell [cm] ", 500, 0., 250.));
-    BookHisto(new TH1F("LKr_nt_timediff" , " Time difference between the associated LKr cluster and the others ; LKr_{associated cl} - LKr_{secondary cl} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("LKr_nt_dtrk", "Distance beteen the associated cluster in the LKr and the secondary clusters ;ClusterDistance [mm] ", 250, 0., 500.));
+    BookVariantHisto(new TH1I("LKr_Ncandidates", "LKr number of candidates;Ncandidates", 20, 0., 20.));
+    BookVariantHisto(new TH2F("LKr_x_vs_y", "LKr hitposition x vs y ;x[mm];y[mm]", 130 , -1300., 1300., 130, -1300., 1300.));
+    BookVariantHisto(new TH2F("LKr_cda_x_vs_y", "Distance beteen extrapolated track and position in the LKr  x vs y;x[mm];y[mm]", 300, -300, 300., 300, -300., 300.));
+    BookVariantHisto(new TH2F("LKr_Ecl_vs_NCell", "LKr cluster energy vs number of cells ; E_{cluster} [MeV]; Number of Cells", 1000, 0., 10000., 150, 0., 150.));
+    BookVariantHisto(new TH1F("LKr_EoP", "LKr E/p", 120, 0., 1.2));
+    BookVariantHisto(new TH1F("LKr_Ecl", "LKr cluster energy", 1000, 0., 10000.));
+    BookVariantHisto(new TH1F("LKr_Eseed_over_Ecl", "LKr E_{seed}/E_{cluster}; E_{seed}/E_{cluster}", 120, 0.,1.2));
+    BookVariantHisto(new TH2F("LKr_Es_Ecl_vs_E77_Ecl", "LKr clusters ; E_{seed}/E_{cluster}; 1 - E_{77}/E_{cluster}", 100, 0.,1., 100, 0.,1.));
+    BookVariantHisto(new TH1F("LKr_nearest_track_DDeadCell", "Distance to nearest dead cell in the LKr for the closest track;LKr_DDeadcell [cm] ", 500, 0., 250.));
+    BookVariantHisto(new TH1F("LKr_nt_timediff" , " Time difference between the associated LKr cluster and the others ; LKr_{associated cl} - LKr_{secondary cl} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("LKr_nt_dtrk", "Distance beteen the associated cluster in the LKr and the secondary clusters ;ClusterDistance [mm] ", 250, 0., 500.));
     //CEDAR
-    BookHisto(new TH1I("CEDAR_Ncandidates", "CEDAR number of candidates; Ncandidates", 20, 0, 20));
+    BookVariantHisto(new TH1I("CEDAR_Ncandidates", "CEDAR number of candidates; Ncandidates", 20, 0, 20));
 
     //Other
-    BookHisto(new TH1F("Vertex_Z", " Z vertex ; Zvtx [mm]", 500, 0, 500000));
-    BookHisto(new TH1F("Vertex_Y", " Y vertex ; Yvtx [mm]", 1000, -500., 500));
-    BookHisto(new TH1F("Vertex_X", " X vertex ; Xvtx [mm]", 1000, -500., 500));
-    BookHisto(new TH1F("Vertex_cda", " Closest distance approached between the kaon and the track ; cda [mm]", 300, 0, 300));
+    BookVariantHisto(new TH1F("Vertex_Z", " Z vertex ; Zvtx [mm]", 500, 0, 500000));
+    BookVariantHisto(new TH1F("Vertex_Y", " Y vertex ; Yvtx [mm]", 1000, -500., 500));
+    BookVariantHisto(new TH1F("Vertex_X", " X vertex ; Xvtx [mm]", 1000, -500., 500));
+    BookVariantHisto(new TH1F("Vertex_cda", " Closest distance approached between the kaon and the track ; cda [mm]", 300, 0, 300));
 
-    BookHisto(new TH2F("STRAW1_x_vs_y", "STRAW hitposition @ Chamber 1 x vs y ; x[mm];y[mm]", 110, -1100., 1100., 110, -1100., 1100.));
-    BookHisto(new TH2F("STRAW4_x_vs_y", "STRAW hitposition @ Chamber 4 x vs y ; x[mm];y[mm]", 110, -1100., 1100., 110, -1100., 1100.));
+    BookVariantHisto(new TH2F("STRAW1_x_vs_y", "STRAW hitposition @ Chamber 1 x vs y ; x[mm];y[mm]", 110, -1100., 1100., 110, -1100., 1100.));
+    BookVariantHisto(new TH2F("STRAW4_x_vs_y", "STRAW hitposition @ Chamber 4 x vs y ; x[mm];y[mm]", 110, -1100., 1100., 110, -1100., 1100.));
 
     //Information  about the nearest cluster for all detectors
-    BookHisto(new TH1F("CHOD_nearest_track_dtrkcl", "Distance beteen extrapolated track and position in the CHOD for the closest track;CHOD_trkd [mm] ", 150, 0., 300.));
-    BookHisto(new TH2F("CHOD_nearest_track_x_vs_y", "CHOD candidate x vs y ; x[mm];y[mm]", 520, -1300., 1300., 520, -1300., 1300.));
-    BookHisto(new TH2F("CHOD_extrap_x_vs_y", "CHOD extrapolated track x vs y ; x[mm];y[mm]", 260, -1300., 1300., 260, -1300., 1300.));
-    BookHisto(new TH1F("LKr_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the LKr for the closest track;LKr_trkd [mm] ", 150, 0., 300.));
-    BookHisto(new TH2F("LKr_nearest_track_x_vs_y", "LKr candidate x vs y  ;x[mm];y[mm]", 520 , -1300., 1300., 520, -1300., 1300.));
-    BookHisto(new TH2F("LKr_extrap_x_vs_y", "LKr extrapolated track x vs y ;x[mm];y[mm]", 260 , -1300., 1300., 260, -1300., 1300.));
-    BookHisto(new TH1F("MUV1_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the MUV1 for the closest track;MUV1_trkd [mm] ", 150, 0., 300.));
-    BookHisto(new TH2F("MUV1_extrap_x_vs_y", "Extrapolated x vs y position for the associated track in MUV1;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
-    BookHisto(new TH2F("MUV1_nearest_track_x_vs_y", "MUV1  x vs y candidate position of the associated track;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
-    BookHisto(new TH2I("MUV1_nearest_track_VvsH", "Associated track cluster Vertical channel ID (x)  vs cluster Horizontal channel ID (y) in MUV1", 44, 0, 44.,44, 0., 44.));
-    BookHisto(new TH1F("MUV1_nearest_track_cluster_charge", "Charge of the cluster associated with the track at MUV1;MUV1_Q[fC]  ", 1000, 0., 10000.));
-    BookHisto(new TH2F("MUV1_near_charge_vs_dtrkcl", " Cluster charge vs distance for the associated track at MUV1;MUV1_Q[fC];MUV1_dtrkcl  ", 1000, 0., 10000., 100., 0., 100.));
-    BookHisto(new TH1F("MUV2_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the MUV2 for the closest track;MUV2_trkd [mm] ", 150, 0., 300.));
-    BookHisto(new TH2F("MUV2_extrap_x_vs_y", "Extrapolated x vs y position in MUV2;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
-    BookHisto(new TH2F("MUV2_nearest_track_x_vs_y", "Associated track cluster x vs cluster y position in MUV2", 440 , -1320., 1320., 440, -1320., 1320.));
-    BookHisto(new TH2I("MUV2_nearest_track_VvsH", "Associated track cluster Vertical channel ID (x)  vs cluster Horizontal channel ID (y) in MUV2", 22, 0, 22.,22, 0., 22.));
-    BookHisto(new TH1F("MUV2_nearest_track_cluster_charge", "Charge of the cluster associated with the track at MUV2;MUV2_Q[fC]  ", 1000, 0., 10000.));
-    BookHisto(new TH2F("MUV2_near_charge_vs_dtrkcl", " Cluster charge vs distance for the associated track at MUV2;MUV2_Q[fC];MUV2_dtrkcl  ", 1000, 0., 10000., 200., 0., 200.));
-    BookHisto(new TH1F("MUV3_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.));
-    BookHisto(new TH2F("MUV3_extrap_x_vs_y", " MUV3 extrapolated x vs y position of the associated track ;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
-    BookHisto(new TH2F("MUV3_nearest_track_x_vs_y", " MUV3 x vs y candidate position of the associated track ;x[mm];y[mm]", 440, -1320., 1320., 440, -1320., 1320.));
+    BookVariantHisto(new TH1F("CHOD_nearest_track_dtrkcl", "Distance beteen extrapolated track and position in the CHOD for the closest track;CHOD_trkd [mm] ", 150, 0., 300.));
+    BookVariantHisto(new TH2F("CHOD_nearest_track_x_vs_y", "CHOD candidate x vs y ; x[mm];y[mm]", 520, -1300., 1300., 520, -1300., 1300.));
+    BookVariantHisto(new TH2F("CHOD_extrap_x_vs_y", "CHOD extrapolated track x vs y ; x[mm];y[mm]", 260, -1300., 1300., 260, -1300., 1300.));
+    BookVariantHisto(new TH1F("LKr_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the LKr for the closest track;LKr_trkd [mm] ", 150, 0., 300.));
+    BookVariantHisto(new TH2F("LKr_nearest_track_x_vs_y", "LKr candidate x vs y  ;x[mm];y[mm]", 520 , -1300., 1300., 520, -1300., 1300.));
+    BookVariantHisto(new TH2F("LKr_extrap_x_vs_y", "LKr extrapolated track x vs y ;x[mm];y[mm]", 260 , -1300., 1300., 260, -1300., 1300.));
+    BookVariantHisto(new TH1F("MUV1_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the MUV1 for the closest track;MUV1_trkd [mm] ", 150, 0., 300.));
+    BookVariantHisto(new TH2F("MUV1_extrap_x_vs_y", "Extrapolated x vs y position for the associated track in MUV1;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
+    BookVariantHisto(new TH2F("MUV1_nearest_track_x_vs_y", "MUV1  x vs y candidate position of the associated track;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
+    BookVariantHisto(new TH2I("MUV1_nearest_track_VvsH", "Associated track cluster Vertical channel ID (x)  vs cluster Horizontal channel ID (y) in MUV1", 44, 0, 44.,44, 0., 44.));
+    BookVariantHisto(new TH1F("MUV1_nearest_track_cluster_charge", "Charge of the cluster associated with the track at MUV1;MUV1_Q[fC]  ", 1000, 0., 10000.));
+    BookVariantHisto(new TH2F("MUV1_near_charge_vs_dtrkcl", " Cluster charge vs distance for the associated track at MUV1;MUV1_Q[fC];MUV1_dtrkcl  ", 1000, 0., 10000., 100., 0., 100.));
+    BookVariantHisto(new TH1F("MUV2_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the MUV2 for the closest track;MUV2_trkd [mm] ", 150, 0., 300.));
+    BookVariantHisto(new TH2F("MUV2_extrap_x_vs_y", "Extrapolated x vs y position in MUV2;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
+    BookVariantHisto(new TH2F("MUV2_nearest_track_x_vs_y", "Associated track cluster x vs cluster y position in MUV2", 440 , -1320., 1320., 440, -1320., 1320.));
+    BookVariantHisto(new TH2I("MUV2_nearest_track_VvsH", "Associated track cluster Vertical channel ID (x)  vs cluster Horizontal channel ID (y) in MUV2", 22, 0, 22.,22, 0., 22.));
+    BookVariantHisto(new TH1F("MUV2_nearest_track_cluster_charge", "Charge of the cluster associated with the track at MUV2;MUV2_Q[fC]  ", 1000, 0., 10000.));
+    BookVariantHisto(new TH2F("MUV2_near_charge_vs_dtrkcl", " Cluster charge vs distance for the associated track at MUV2;MUV2_Q[fC];MUV2_dtrkcl  ", 1000, 0., 10000., 200., 0., 200.));
+    BookVariantHisto(new TH1F("MUV3_nearest_track_dtrkcl", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.));
+    BookVariantHisto(new TH2F("MUV3_extrap_x_vs_y", " MUV3 extrapolated x vs y position of the associated track ;x[mm];y[mm]", 260, -1320., 1320., 260, -1320., 1320.));
+    BookVariantHisto(new TH2F("MUV3_nearest_track_x_vs_y", " MUV3 x vs y candidate position of the associated track ;x[mm];y[mm]", 440, -1320., 1320., 440, -1320., 1320.));
 
     //Time differences using CHOD as the reference detector
-    BookHisto(new TH1F("RICH_timediff" , " RICH_{time} - CHOD_{time} ; RICH_{time} - CHOD_{time} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("LKr_timediff"  , " LKr_{time} - CHOD_{time}  ; LKr_{time}  - CHOD_{time} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("MUV1_timediff" , " MUV1_{time} - CHOD_{time} ; MUV1_{time} - CHOD_{time} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("MUV2_timediff" , " MUV2_{time} - CHOD_{time} ; MUV2_{time} - CHOD_{time} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("MUV3_timediff" , " MUV3_{time} - CHOD_{time} ; MUV3_{time} - CHOD_{time} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("CEDAR_timediff"," CEDAR_{time} - CHOD_{time} ; CEDAR_{time}- CHOD_{time} [ns]", 400, -100, 100.));
+    BookVariantHisto(new TH1F("RICH_timediff" , " RICH_{time} - CHOD_{time} ; RICH_{time} - CHOD_{time} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("LKr_timediff"  , " LKr_{time} - CHOD_{time}  ; LKr_{time}  - CHOD_{time} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("MUV1_timediff" , " MUV1_{time} - CHOD_{time} ; MUV1_{time} - CHOD_{time} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("MUV2_timediff" , " MUV2_{time} - CHOD_{time} ; MUV2_{time} - CHOD_{time} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("MUV3_timediff" , " MUV3_{time} - CHOD_{time} ; MUV3_{time} - CHOD_{time} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("CEDAR_timediff"," CEDAR_{time} - CHOD_{time} ; CEDAR_{time}- CHOD_{time} [ns]", 400, -100, 100.));
 
     //Timedifferences between detectors using MUV3 as reference detector
     BookHisto(new TH1F("MUV3_MUV2timediff" , " MUV3_{time} - MUV2_{time} ; MUV3_{time} - MUV2_{time} [ns]", 100, -50, 50.));
     BookHisto(new TH1F("MUV3_MUV1timediff" , " MUV3_{time} - MUV1_{time} ; MUV3_{time} - MUV1_{time} [ns]", 100, -50, 50.));
 
-    BookHisto(new TH1I("MUV1_Ncandidates_MUV13", "MUV1 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV2_Ncandidates_MUV13", "MUV2 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV3_Ncandidates_MUV13", "MUV3 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV1_Ncandidates_MUV23", "MUV1 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV2_Ncandidates_MUV23", "MUV2 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV3_Ncandidates_MUV23", "MUV3 number of candidates", 50, 0, 50));
-    BookHisto(new TH1I("MUV1_Ncandidates_MUV3", "MUV1 number of candidates", 50, 0, 50) );
-    BookHisto(new TH1I("MUV2_Ncandidates_MUV3", "MUV2 number of candidates", 50, 0, 50) );
-    BookHisto(new TH1I("MUV3_Ncandidates_MUV3", "MUV3 number of candidates", 50, 0, 50) );
-    BookHisto(new TH2I("BadMUV2_HitMap_MUV13", " Hitmap for the MUV1&MUV3 !&MUV2 events", 23, 0, 22, 23, 0, 22 ));
-    BookHisto(new TH2I("BadMUV1_HitMap_MUV13", " Hitmap for the MUV1&MUV3 !&MUV2 events", 45, 0, 44, 45, 0, 44) );
-    BookHisto(new TH2I("BadMUV2_HitMap_MUV23", " Hitmap for the MUV2&MUV3 !&MUV1 events", 23, 0, 22, 23, 0, 22 ));
-    BookHisto(new TH2I("BadMUV1_HitMap_MUV23", " Hitmap for the MUV2&MUV3 !&MUV1 events", 45, 0, 44, 45, 0, 44 ));
-    BookHisto(new TH2I("BadMUV2_HitMap_MUV123", " Hitmap for the MUV2&MUV3&MUV1 events", 23, 0, 22, 23, 0, 22 ) );
-    BookHisto(new TH2I("BadMUV1_HitMap_MUV123", " Hitmap for the MUV2&MUV3&MUV1 events", 45, 0, 44, 45, 0, 44)  );
-    BookHisto(new TH2I("BadMUV1_HitMap_MUV3", " Hitmap for the MUV3 only events", 45, 0, 44, 45, 0, 44));
-    BookHisto(new TH2I("BadMUV2_HitMap_MUV3", " Hitmap for the MUV3 only events", 23, 0, 22, 23, 0, 22));
-    BookHisto(new TH1F("TrackPfit_TrackP_MUV13", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.));
-    BookHisto(new TH1F("TrackPfit_TrackP_MUV23", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.));
-    BookHisto(new TH1F("TrackPfit_TrackP_MUV3", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.) );
-    BookHisto(new TH1F("TrackP_MUV13", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.));
-    BookHisto(new TH1F("TrackP_MUV23", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.));
-    BookHisto(new TH1F("TrackP_MUV3", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.) );
-
-    BookHisto(new TH1F("MUV3_LKr_tdiff_MUV3" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.)  );
-    BookHisto(new TH1F("MUV3_LKr_tdiff_MUV13" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.) );
-    BookHisto(new TH1F("MUV3_LKr_tdiff_MUV123" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.));
-    BookHisto(new TH1F("MUV3_LKr_tdiff_MUV23" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.) );
-
-    BookHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV123", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.));
-    BookHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV13", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.) );
-    BookHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV23", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.) );
-    BookHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV3", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.)  );
-    BookHisto(new TH1F("MUV1_nt_SW", " Shower width for the associated cluster in MUV1;MUV1_SW [mm] ", 500, 0., 500.));
-    BookHisto(new TH2F("MUV1_TrP_SW"," Shower width vs Track P; Track_P[MeV];MUV1_SW[mm]", 100, 0, 100000., 500, 0., 500. ));
-    BookHisto(new TH1F("MUV1_nt_timediff" , " Time difference between the associated cluster and the others ; MUV1_{associated cl} - MUV1_{secondary cl} [ns]", 100, -50, 50.));
-    BookHisto(new TH2I("MUV1_sc_HitMap", " Hitmap for the secondary clusters in time with the associated cluster in MUV1", 45, 0, 44, 45, 0, 44 ));
-    BookHisto(new TH1I("MUV1_hz_nt_chdiff", " Difference in horizontal channels between the cluster and the secondary clusters in MUV1", 44, -22, 22));
-    BookHisto(new TH1I("MUV1_vt_nt_chdiff", " Difference in vertical channels between the cluster and the secondary clusters in MUV1", 44, -22, 22));
-    BookHisto(new TH2I("MUV1_hz_vt_chdiff", " Channel difference between the secondary clusters and the associated cluster in MUV1;Horizontal Channel;Vertical Channel", 44, -22, 22, 44, -22, 22 ));
+    BookVariantHisto(new TH1I("MUV1_Ncandidates_MUV13", "MUV1 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV2_Ncandidates_MUV13", "MUV2 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV3_Ncandidates_MUV13", "MUV3 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV1_Ncandidates_MUV23", "MUV1 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV2_Ncandidates_MUV23", "MUV2 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV3_Ncandidates_MUV23", "MUV3 number of candidates", 50, 0, 50));
+    BookVariantHisto(new TH1I("MUV1_Ncandidates_MUV3", "MUV1 number of candidates", 50, 0, 50) );
+    BookVariantHisto(new TH1I("MUV2_Ncandidates_MUV3", "MUV2 number of candidates", 50, 0, 50) );
+    BookVariantHisto(new TH1I("MUV3_Ncandidates_MUV3", "MUV3 number of candidates", 50, 0, 50) );
+    BookVariantHisto(new TH2I("BadMUV2_HitMap_MUV13", " Hitmap for the MUV1&MUV3 !&MUV2 events", 23, 0, 22, 23, 0, 22 ));
+    BookVariantHisto(new TH2I("BadMUV1_HitMap_MUV13", " Hitmap for the MUV1&MUV3 !&MUV2 events", 45, 0, 44, 45, 0, 44) );
+    BookVariantHisto(new TH2I("BadMUV2_HitMap_MUV23", " Hitmap for the MUV2&MUV3 !&MUV1 events", 23, 0, 22, 23, 0, 22 ));
+    BookVariantHisto(new TH2I("BadMUV1_HitMap_MUV23", " Hitmap for the MUV2&MUV3 !&MUV1 events", 45, 0, 44, 45, 0, 44 ));
+    BookVariantHisto(new TH2I("BadMUV2_HitMap_MUV123", " Hitmap for the MUV2&MUV3&MUV1 events", 23, 0, 22, 23, 0, 22 ) );
+    BookVariantHisto(new TH2I("BadMUV1_HitMap_MUV123", " Hitmap for the MUV2&MUV3&MUV1 events", 45, 0, 44, 45, 0, 44)  );
+    BookVariantHisto(new TH2I("BadMUV1_HitMap_MUV3", " Hitmap for the MUV3 only events", 45, 0, 44, 45, 0, 44));
+    BookVariantHisto(new TH2I("BadMUV2_HitMap_MUV3", " Hitmap for the MUV3 only events", 23, 0, 22, 23, 0, 22));
+    BookVariantHisto(new TH1F("TrackPfit_TrackP_MUV13", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.));
+    BookVariantHisto(new TH1F("TrackPfit_TrackP_MUV23", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.));
+    BookVariantHisto(new TH1F("TrackPfit_TrackP_MUV3", "GetMomentum() - GetMomentumBeforeFit() ; Track_P[MeV] - Track_Ppat[MeV]", 100, -50000., 50000.) );
+    BookVariantHisto(new TH1F("TrackP_MUV13", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.));
+    BookVariantHisto(new TH1F("TrackP_MUV23", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.));
+    BookVariantHisto(new TH1F("TrackP_MUV3", "STRAW Momentum ; Track_P[MeV]", 100, 0., 100000.) );
+
+    BookVariantHisto(new TH1F("MUV3_LKr_tdiff_MUV3" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.)  );
+    BookVariantHisto(new TH1F("MUV3_LKr_tdiff_MUV13" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.) );
+    BookVariantHisto(new TH1F("MUV3_LKr_tdiff_MUV123" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("MUV3_LKr_tdiff_MUV23" , " MUV3_{time} - LKr_{time} for MUV3 only events ; MUV3_{time} - LKr_{time} [ns]", 100, -50, 50.) );
+
+    BookVariantHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV123", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.));
+    BookVariantHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV13", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.) );
+    BookVariantHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV23", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.) );
+    BookVariantHisto(new TH1F("MUV3_nearest_track_dtrkcl_MUV3", "Distance beteen extrapolated track and cluster position in the MUV3 for the closest track;MUV3_trkd [mm] ", 60, 0., 4000.)  );
+    BookVariantHisto(new TH1F("MUV1_nt_SW", " Shower width for the associated cluster in MUV1;MUV1_SW [mm] ", 500, 0., 500.));
+    BookVariantHisto(new TH2F("MUV1_TrP_SW"," Shower width vs Track P; Track_P[MeV];MUV1_SW[mm]", 100, 0, 100000., 500, 0., 500. ));
+    BookVariantHisto(new TH1F("MUV1_nt_timediff" , " Time difference between the associated cluster and the others ; MUV1_{associated cl} - MUV1_{secondary cl} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH2I("MUV1_sc_HitMap", " Hitmap for the secondary clusters in time with the associated cluster in MUV1", 45, 0, 44, 45, 0, 44 ));
+    BookVariantHisto(new TH1I("MUV1_hz_nt_chdiff", " Difference in horizontal channels between the cluster and the secondary clusters in MUV1", 44, -22, 22));
+    BookVariantHisto(new TH1I("MUV1_vt_nt_chdiff", " Difference in vertical channels between the cluster and the secondary clusters in MUV1", 44, -22, 22));
+    BookVariantHisto(new TH2I("MUV1_hz_vt_chdiff", " Channel difference between the secondary clusters and the associated cluster in MUV1;Horizontal Channel;Vertical Channel", 44, -22, 22, 44, -22, 22 ));
     BookHisto(new TH2F("MUV1_charge_vs_SW", " Cluster charge vs SW at MUV1;MUV1_Q[fC];MUV1_SW[mm]  ", 1000, 0., 10000., 500., 0., 500.));
 
-    BookHisto(new TH2F("MUV1_PvsQ", " Charge vs Momentum of the cluster associated with a track at MUV1; TrackP[MeV];MUV1_Q[pC]  ", 100, 0., 100000., 1000., 0., 10000.));
-    BookHisto(new TH2F("MUV2_PvsQ", " Charge vs Momentum of the cluster associated with a track at MUV2; TrackP[MeV];MUV2_Q[pC]  ", 100, 0., 100000., 1000., 0., 10000.));
+    BookVariantHisto(new TH2F("MUV1_PvsQ", " Charge vs Momentum of the cluster associated with a track at MUV1; TrackP[MeV];MUV1_Q[pC]  ", 100, 0., 100000., 1000., 0., 10000.));
+    BookVariantHisto(new TH2F("MUV2_PvsQ", " Charge vs Momentum of the cluster associated with a track at MUV2; TrackP[MeV];MUV2_Q[pC]  ", 100, 0., 100000., 1000., 0., 10000.));
 
-    BookHisto(new TH1F("MUV1_zero_distance_timediff" , " Time difference between the associated and sc, which are very close to eachother  ; MUV1_{associated cl} - MUV1_{secondary cl} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("MUV1_zero_distance_timediff" , " Time difference between the associated and sc, which are very close to eachother  ; MUV1_{associated cl} - MUV1_{secondary cl} [ns]", 100, -50, 50.));
 
 
-    BookHisto(new TH1F("MUV2_nt_SW", " Shower width for the associated cluster in MUV2;MUV2_SW [mm] ", 500, 0., 500.));
-    BookHisto(new TH2F("MUV2_TrP_SW"," Shower width vs Track P; Track_P[MeV];MUV2_SW[mm]", 100, 0, 100000., 500, 0., 500. ));
-    BookHisto(new TH1F("MUV2_nt_timediff" , " Time difference between the associated cluster and the others ; MUV2_{associated cl} - MUV2_{secondary cl} [ns]", 100, -50, 50.));
-    BookHisto(new TH2I("MUV2_sc_HitMap", " Hitmap for the secondary clusters in time with the associated cluster", 23, 0, 22, 23, 0, 22 ));
-    BookHisto(new TH1I("MUV2_hz_nt_chdiff", " Difference in horizontal channels between the cluster and the secondary clusters in MUV2", 22, -11, 11));
-    BookHisto(new TH1I("MUV2_vt_nt_chdiff", " Difference in vertical channels between the cluster and the secondary clusters in MUV2", 22, -11, 11));
-    BookHisto(new TH2I("MUV2_hz_vt_chdiff", " Channel difference between the secondary clusters and the associated cluster in MUV2;Horizontal Channel;Vertical Channel", 22, -11, 11, 22, -11, 11 ));
+    BookVariantHisto(new TH1F("MUV2_nt_SW", " Shower width for the associated cluster in MUV2;MUV2_SW [mm] ", 500, 0., 500.));
+    BookVariantHisto(new TH2F("MUV2_TrP_SW"," Shower width vs Track P; Track_P[MeV];MUV2_SW[mm]", 100, 0, 100000., 500, 0., 500. ));
+    BookVariantHisto(new TH1F("MUV2_nt_timediff" , " Time difference between the associated cluster and the others ; MUV2_{associated cl} - MUV2_{secondary cl} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH2I("MUV2_sc_HitMap", " Hitmap for the secondary clusters in time with the associated cluster", 23, 0, 22, 23, 0, 22 ));
+    BookVariantHisto(new TH1I("MUV2_hz_nt_chdiff", " Difference in horizontal channels between the cluster and the secondary clusters in MUV2", 22, -11, 11));
+    BookVariantHisto(new TH1I("MUV2_vt_nt_chdiff", " Difference in vertical channels between the cluster and the secondary clusters in MUV2", 22, -11, 11));
+    BookVariantHisto(new TH2I("MUV2_hz_vt_chdiff", " Channel difference between the secondary clusters and the associated cluster in MUV2;Horizontal Channel;Vertical Channel", 22, -11, 11, 22, -11, 11 ));
     BookHisto(new TH2F("MUV2_charge_vs_SW", " Cluster charge vs SW at MUV2;MUV2_Q[fC];MUV2_SW[mm]  ", 1000, 0., 10000., 500., 0., 500.));
-    BookHisto(new TH1F("MUV2_zero_distance_timediff" , " Time difference between the associated and sc, which are very close to eachother  ; MUV2_{associated cl} - MUV2_{secondary cl} [ns]", 100, -50, 50.));
+    BookVariantHisto(new TH1F("MUV2_zero_distance_timediff" , " Time difference between the associated and sc, which are very close to eachother  ; MUV2_{associated cl} - MUV2_{secondary cl} [ns]", 100, -50, 50.));
 
     //Hits histograms for checking for readout failure
 
-    BookHisto(new TH1I("Nhits123_MUV2", "MUV2 number of hits for  MUV1+2+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits123_MUV1", "MUV1 number of hits for  MUV1+2+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits123_LKr",  "LKr  number of hits for  MUV1+2+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C13_MUV2", "MUV2 number of hits for events without reconstructed cluster for MUV1+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C13_MUV1", "MUV1 number of hits for events without reconstructed cluster for MUV1+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C13_LKr",  "LKr  number of hits for events without reconstructed cluster for MUV1+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C23_MUV2", "MUV2 number of hits for events without reconstructed cluster for MUV2+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C23_MUV1", "MUV1 number of hits for events without reconstructed cluster for MUV2+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C23_LKr",  "LKr  number of hits for events without reconstructed cluster for MUV2+3 events", 50, 0, 50));
-
-    BookHisto(new TH1I("Nhits0C23_MUV1_BB", "MUV1  number of hits for events without reconstructed cluster for the inefficient bursts MUV2+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C13_MUV2_BB", "MUV2  number of hits for events without reconstructed cluster for the inefficient bursts MUV1+3 events", 50, 0, 50));
-    BookHisto(new TH1I("Nhits0C3_MUV2_BB",  "MUV2  number of hits for events without reconstructed cluster for the inefficient bursts MUV3 events", 50, 0, 50)  );
-    BookHisto(new TH1I("Nhits0C3_MUV1_BB",  "MUV1  number of hits for events without reconstructed cluster for the inefficient bursts MUV3 events", 50, 0, 50)  );
-
-    BookHisto(new TH1I("0C_ChID_MUV2",  "Channel ID of the hits from the inefficient MUV2 events (MUV1+3)", 200, 100, 300) );
-    BookHisto(new TH1I("0C_VChID_MUV2",  "Vertical Channel ID of the hits from the inefficient MUV2 events (MUV1+3)", 22, 1, 23) );
-    BookHisto(new TH1I("0C_HChID_MUV2",  "Horizontal Channel ID of the hits from the inefficient MUV2 events (MUV1+3)", 22, 1, 23) );
-    BookHisto(new TH1I("0C_ChID_MUV1",  "Channel ID of the hits from the inefficient MUV1 events (MUV2+3)", 200, 100, 300) );
-    BookHisto(new TH1I("0C_HChID_MUV1",  "Horizontal Channel ID of the hits from the inefficient MUV1 events (MUV2+3)", 44, 1, 45) );
-    BookHisto(new TH1I("0C_VChID_MUV1",  "Vertical Channel ID of the hits from the inefficient MUV1 events (MUV2+3)", 44, 1, 45) );
-    BookHisto(new TH1I("0C_VM1_CHOD_t",  "Vertical Channel Time - CHOD time of the hits from the inefficient MUV1 events (MUV2+3)",  800, -400, 400) );
-    BookHisto(new TH1I("0C_HM1_CHOD_t",  "Horizontal Channel Time - CHOD time of the hits from the inefficient MUV1 events (MUV2+3)",800, -400, 400));
-    BookHisto(new TH1I("0C_VM2_CHOD_t",  "Vertical Channel Time - CHOD time of the hits from the inefficient MUV2 events (MUV1+3)",  800, -400, 400));
-    BookHisto(new TH1I("0C_HM2_CHOD_t",  "Horizontal Channel Time - CHOD time of the hits from the inefficient MUV2 events (MUV1+3)",800, -400, 400));
-
-    BookHisto(new TH1I("0C_HChID_diff_M1",  " Horizontal ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV1 events (MUV2+3)", 80, -40, 40) );
-    BookHisto(new TH1I("0C_VChID_diff_M1",  " Vertical ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV1 events (MUV2+3)", 80, -40, 40)   );
-    BookHisto(new TH1I("0C_HChID_diff_M2",  " Horizontal ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV2 events (MUV1+3)", 40, -20, 20) );
-    BookHisto(new TH1I("0C_VChID_diff_M2",  " Vertical ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV2 events (MUV1+3)", 40, -20, 20)   );
+    BookVariantHisto(new TH1I("Nhits123_MUV2", "MUV2 number of hits for  MUV1+2+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits123_MUV1", "MUV1 number of hits for  MUV1+2+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits123_LKr",  "LKr  number of hits for  MUV1+2+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C13_MUV2", "MUV2 number of hits for events without reconstructed cluster for MUV1+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C13_MUV1", "MUV1 number of hits for events without reconstructed cluster for MUV1+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C13_LKr",  "LKr  number of hits for events without reconstructed cluster for MUV1+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C23_MUV2", "MUV2 number of hits for events without reconstructed cluster for MUV2+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C23_MUV1", "MUV1 number of hits for events without reconstructed cluster for MUV2+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C23_LKr",  "LKr  number of hits for events without reconstructed cluster for MUV2+3 events", 50, 0, 50));
+
+    BookVariantHisto(new TH1I("Nhits0C23_MUV1_BB", "MUV1  number of hits for events without reconstructed cluster for the inefficient bursts MUV2+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C13_MUV2_BB", "MUV2  number of hits for events without reconstructed cluster for the inefficient bursts MUV1+3 events", 50, 0, 50));
+    BookVariantHisto(new TH1I("Nhits0C3_MUV2_BB",  "MUV2  number of hits for events without reconstructed cluster for the inefficient bursts MUV3 events", 50, 0, 50)  );
+    BookVariantHisto(new TH1I("Nhits0C3_MUV1_BB",  "MUV1  number of hits for events without reconstructed cluster for the inefficient bursts MUV3 events", 50, 0, 50)  );
+
+    BookVariantHisto(new TH1I("0C_ChID_MUV2",  "Channel ID of the hits from the inefficient MUV2 events (MUV1+3)", 200, 100, 300) );
+    BookVariantHisto(new TH1I("0C_VChID_MUV2",  "Vertical Channel ID of the hits from the inefficient MUV2 events (MUV1+3)", 22, 1, 23) );
+    BookVariantHisto(new TH1I("0C_HChID_MUV2",  "Horizontal Channel ID of the hits from the inefficient MUV2 events (MUV1+3)", 22, 1, 23) );
+    BookVariantHisto(new TH1I("0C_ChID_MUV1",  "Channel ID of the hits from the inefficient MUV1 events (MUV2+3)", 200, 100, 300) );
+    BookVariantHisto(new TH1I("0C_HChID_MUV1",  "Horizontal Channel ID of the hits from the inefficient MUV1 events (MUV2+3)", 44, 1, 45) );
+    BookVariantHisto(new TH1I("0C_VChID_MUV1",  "Vertical Channel ID of the hits from the inefficient MUV1 events (MUV2+3)", 44, 1, 45) );
+    BookVariantHisto(new TH1I("0C_VM1_CHOD_t",  "Vertical Channel Time - CHOD time of the hits from the inefficient MUV1 events (MUV2+3)",  800, -400, 400) );
+    BookVariantHisto(new TH1I("0C_HM1_CHOD_t",  "Horizontal Channel Time - CHOD time of the hits from the inefficient MUV1 events (MUV2+3)",800, -400, 400));
+    BookVariantHisto(new TH1I("0C_VM2_CHOD_t",  "Vertical Channel Time - CHOD time of the hits from the inefficient MUV2 events (MUV1+3)",  800, -400, 400));
+    BookVariantHisto(new TH1I("0C_HM2_CHOD_t",  "Horizontal Channel Time - CHOD time of the hits from the inefficient MUV2 events (MUV1+3)",800, -400, 400));
+
+    BookVariantHisto(new TH1I("0C_HChID_diff_M1",  " Horizontal ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV1 events (MUV2+3)", 80, -40, 40) );
+    BookVariantHisto(new TH1I("0C_VChID_diff_M1",  " Vertical ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV1 events (MUV2+3)", 80, -40, 40)   );
+    BookVariantHisto(new TH1I("0C_HChID_diff_M2",  " Horizontal ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV2 events (MUV1+3)", 40, -20, 20) );
+    BookVariantHisto(new TH1I("0C_VChID_diff_M2",  " Vertical ChannelID_{Hits} - ChannelID_{extrap} for inefficient MUV2 events (MUV1+3)", 40, -20, 20)   );
 
     //Quality checks for Gia`s reconstruction
-    BookHisto(new TH1I("Quality",  " MUV1 fQuality variable: 0 - true cluster 1 - time-charge information ambiguous 2 - wrongly reconstructed", 5, 0, 5));
-    BookHisto(new TH2F("Q0_nearest_track_x_vs_y", "X vs Y position from MUV1 for fQuality = 0;x[mm];y[mm]", 436, -1308., 1308., 436, -1308., 1308.));
-    BookHisto(new TH2F("Q1_nearest_track_x_vs_y", "X vs Y position from MUV1 for fQuality = 1;x[mm];y[mm]", 436, -1308., 1308., 436, -1308., 1308.));
-    BookHisto(new TH2F("Q2_nearest_track_x_vs_y", "X vs Y position from MUV1 for fQuality = 2;x[mm];y[mm]", 436, -1308., 1308., 436, -1308., 1308.));
+    BookVariantHisto(new TH1I("Quality",  " MUV1 fQuality variable: 0 - true cluster 1 - time-charge information ambiguous 2 - wrongly reconstructed", 5, 0, 5));
+    BookVariantHisto(new TH2F("Q0_nearest_track_x_vs_y", "X vs Y position from MUV1 for fQuality = 0;x[mm];y[mm]", 436, -1308., 1308., 436, -1308., 1308.));
+    BookVariantHisto(new TH2F("Q1_nearest_track_x_vs_y", "X vs Y position from MUV1 for fQuality = 1;x[mm];y[mm]", 436, -1308., 1308., 436, -1308., 1308.));
+    BookVariantHisto(new TH2F("Q2_nearest_track_x_vs_y", "X vs Y position from MUV1 for fQuality = 2;x[mm];y[mm]", 436, -1308., 1308., 436, -1308., 1308.));
 
     //25ns difference hits
-    BookHisto(new TH1I("ChannelID_25ns_away_M1",  "ChannelID for the hits that are 25 ns away (MUV2+3)", 200, 100, 300));
-    BookHisto(new TH1I("ChannelID_25ns_away_M2",  "ChannelID for the hits that are 25 ns away (MUV1+3)", 200, 100, 300));
+    BookVariantHisto(new TH1I("ChannelID_25ns_away_M1",  "ChannelID for the hits that are 25 ns away (MUV2+3)", 200, 100, 300));
+    BookVariantHisto(new TH1I("ChannelID_25ns_away_M2",  "ChannelID for the hits that are 25 ns away (MUV1+3)", 200, 100, 300));
 
 
     //Saving hits
-    BookHisto(new TH1I("MUV13_Vsaved_M2" , "No reco cluster in MUV2, hit at the extrapolated vertical strip (MUV1+3 events)", 22, 1, 23) );
-    BookHisto(new TH1I("MUV13_Hsaved_M2" , "No reco cluster in MUV2, hit at the extrapolated horizontal strip (MUV1+3 events)", 22, 1, 23) );
-    BookHisto(new TH1I("RecVHits_M2" , "Number of hits in the Vertical MUV2 channels that are found in the extrapolated strips (MUV1+3 events)", 20, 0, 20));
-    BookHisto(new TH1I("RecHHits_M2" , "Number of hits in the Horizontal MUV2 channels that are found in the extrapolated strips (MUV1+3 events)", 20, 0, 20) );
-    BookHisto(new TH1I("RecHits_M2" , " Events that have at least one hit in the Vertical and Horizontal channel (0 reconstructed clusters) in MUV2 (MUV1+3 events)", 20, 0, 20) );
-    BookHisto(new TH1I("MUV23_Vsaved_M1" , "No reco cluster in MUV1, hit at the extrapolated vertical strip (MUV2+3 events)", 44, 1, 45) );
-    BookHisto(new TH1I("MUV23_Hsaved_M1" , "No reco cluster in MUV1, hit at the extrapolated horizontal strip (MUV2+3 events)", 44, 1, 45) );
-    BookHisto(new TH1I("RecVHits_M1" , "Number of hits in the Vertical MUV1 channels that are found in the extrapolated strips (MUV2+3 events)", 20, 0, 20) );
-    BookHisto(new TH1I("RecHHits_M1" , "Number of hits in the Horizontal MUV1 channels that are found in the extrapolated strips (MUV2+3 events)", 20, 0, 20) );
-    BookHisto(new TH1I("RecHits_M1" , "Events that have at least one hit in the Vertical and Horizontal channel (0 reconstructed clusters) MUV1 (MUV2+3 events)", 20, 0, 20) );
+    BookVariantHisto(new TH1I("MUV13_Vsaved_M2" , "No reco cluster in MUV2, hit at the extrapolated vertical strip (MUV1+3 events)", 22, 1, 23) );
+    BookVariantHisto(new TH1I("MUV13_Hsaved_M2" , "No reco cluster in MUV2, hit at the extrapolated horizontal strip (MUV1+3 events)", 22, 1, 23) );
+    BookVariantHisto(new TH1I("RecVHits_M2" , "Number of hits in the Vertical MUV2 channels that are found in the extrapolated strips (MUV1+3 events)", 20, 0, 20));
+    BookVariantHisto(new TH1I("RecHHits_M2" , "Number of hits in the Horizontal MUV2 channels that are found in the extrapolated strips (MUV1+3 events)", 20, 0, 20) );
+    BookVariantHisto(new TH1I("RecHits_M2" , " Events that have at least one hit in the Vertical and Horizontal channel (0 reconstructed clusters) in MUV2 (MUV1+3 events)", 20, 0, 20) );
+    BookVariantHisto(new TH1I("MUV23_Vsaved_M1" , "No reco cluster in MUV1, hit at the extrapolated vertical strip (MUV2+3 events)", 44, 1, 45) );
+    BookVariantHisto(new TH1I("MUV23_Hsaved_M1" , "No reco cluster in MUV1, hit at the extrapolated horizontal strip (MUV2+3 events)", 44, 1, 45) );
+    BookVariantHisto(new TH1I("RecVHits_M1" , "Number of hits in the Vertical MUV1 channels that are found in the extrapolated strips (MUV2+3 events)", 20, 0, 20) );
+    BookVariantHisto(new TH1I("RecHHits_M1" , "Number of hits in the Horizontal MUV1 channels that are found in the extrapolated strips (MUV2+3 events)", 20, 0, 20) );
+    BookVariantHisto(new TH1I("RecHits_M1" , "Events that have at least one hit in the Vertical and Horizontal channel (0 reconstructed clusters) MUV1 (MUV2+3 events)", 20, 0, 20) );
+
+    //Cut flow
+    vector<TH1D*> cutFlowHistos;
+    fCutFlow.BookHistos(cutFlowHistos);
+    for(size_t iHisto=0; iHisto<cutFlowHistos.size(); iHisto++) BookHisto(cutFlowHistos[iHisto]);
 
 
 }
@@ -520,6 +701,108 @@ void Kmu2::StartOfRunUser(){
     /// This method is called at the beginning of the processing (corresponding to a start of run in the normal NA62 data taking)\n
     /// Do here your start of run processing if any
     /// \EndMemberDescr
+    if(fBurstOutput.Length()>0) fBurstWriter = new AsyncHistoWriter(fBurstOutput);
+    fCutScheduler.SetWarmUp(fCutWarmUp);
+
+    if(fVariantsFile.Length()>0 && ReadVariants(fVariantsFile) && fCutScanEnabled){
+        //The scan keeps the events failing the scanned cuts, which the variants would select
+        cout << "Kmu2: CutScan studies the nominal configuration, variants from " << fVariantsFile << " ignored" << endl;
+        fVariants.resize(1);
+    }
+    if(fTimeCalibration){
+        //Prepass: raw time differences, without offsets nor time cuts, for the nominal configuration only
+        if(fTimeOffsetsFile.Length()==0) fTimeOffsetsFile = "TimeOffsets.bin";
+        fTimeCalibrator = new TimeOffsetCalibrator();
+        fVariants.resize(1);
+        TimeConfig& calibration = fVariants[0];
+        calibration.fLKrOffset = calibration.fCedarOffset = 0.;
+        calibration.fMUV1Offset = calibration.fMUV2Offset = calibration.fMUV3Offset = 0.;
+        calibration.fLKrOffsetCut = calibration.fRICHOffsetCut = calibration.fCedarOffsetCut = 1e9;
+        calibration.fMUV1OffsetCut = calibration.fMUV2OffsetCut = calibration.fMUV3OffsetCut = 1e9;
+        cout << "Kmu2: time offset calibration of the first " << fCalibrationEvents << " events of each burst, written to " << fTimeOffsetsFile << endl;
+    }
+    else if(fTimeOffsetsFile.Length()>0){
+        if(fTimeOffsets.Open(fTimeOffsetsFile)) cout << "Kmu2: time offsets of " << fTimeOffsets.GetNBursts() << " bursts from " << fTimeOffsetsFile << endl;
+        else cout << "Kmu2: hard-coded time offsets used" << endl;
+    }
+    for(size_t iVariant=1; iVariant<fVariants.size(); iVariant++){
+        TString suffix = TString::Format("_v%d", (int)iVariant);
+        fVariantCutFlows.push_back(CutFlow("Kmu2" + suffix, fCutFlow));
+
+        //Only the histograms filled by the selection of the variants (BookVariantHisto)
+        for(VariantHistoTable::iterator it=fVariantHistos.begin(); it!=fVariantHistos.end(); ++it){
+            TH1* histo = (TH1*)it->second[0]->Clone(it->first + suffix);
+            histo->Reset();
+            map<const char*, TString, NameLess>::const_iterator directory = fVariantDirectories.find(it->first);
+            if(directory!=fVariantDirectories.end()) BookHisto(histo, directory->second);
+            else BookHisto(histo);
+            it->second.push_back(histo);
+        }
+    }
+    for(size_t iVariant=0; iVariant<fVariantCutFlows.size(); iVariant++){
+        vector<TH1D*> cutFlowHistos;
+        fVariantCutFlows[iVariant].BookHistos(cutFlowHistos);
+        for(size_t iHisto=0; iHisto<cutFlowHistos.size(); iHisto++) BookHisto(cutFlowHistos[iHisto]);
+    }
+
+    if(fChannelT0File.Length()>0){
+        fChannelT0 = new ChannelT0Calibrator("Kmu2");
+        vector<TH1D*> channelT0Histos;
+        fChannelT0->BookHistos(channelT0Histos);
+        for(size_t iHisto=0; iHisto<channelT0Histos.size(); iHisto++) BookHisto(channelT0Histos[iHisto]);
+    }
+    if(fChannelGainFile.Length()>0){
+        fChannelGain = new ChannelGainCalibrator("Kmu2");
+        vector<TH1D*> channelGainHistos;
+        fChannelGain->BookHistos(channelGainHistos);
+        for(size_t iHisto=0; iHisto<channelGainHistos.size(); iHisto++) BookHisto(channelGainHistos[iHisto]);
+    }
+
+    if(fBadBurstsFile.Length()>0 && fBadBursts.Read(fBadBurstsFile)) cout << "Kmu2: " << fBadBursts.GetNBadBursts() << " bad bursts from " << fBadBurstsFile << endl;
+    if(fBurstQualityFile.Length()>0){
+        fBurstQuality = new BurstQuality("Kmu2");
+        vector<TH1D*> burstQualityHistos;
+        fBurstQuality->BookHistos(burstQualityHistos);
+        for(size_t iHisto=0; iHisto<burstQualityHistos.size(); iHisto++) BookHisto(burstQualityHistos[iHisto]);
+    }
+
+    if(fDigiPulsesEnabled){
+        fDigiPulses = new DigiPulseMonitor("Kmu2");
+        vector<TH1*> digiPulseHistos;
+        fDigiPulses->BookHistos(digiPulseHistos);
+        for(size_t iHisto=0; iHisto<digiPulseHistos.size(); iHisto++) BookHisto(digiPulseHistos[iHisto]);
+    }
+    if(fHeapCountEnabled){
+        fHeapCounter = new HeapCounter("Kmu2");
+        vector<TH1*> heapHistos;
+        fHeapCounter->BookHistos(heapHistos);
+        for(size_t iHisto=0; iHisto<heapHistos.size(); iHisto++) BookHisto(heapHistos[iHisto]);
+    }
+
+    if(fEfficiencyEnabled){
+        vector<TH1*> efficiencyHistos;
+        vector<TGraphAsymmErrors*> efficiencyGraphs;
+        for(size_t iMap=0; iMap<fEfficiency.size(); iMap++) fEfficiency[iMap].BookHistos(efficiencyHistos, efficiencyGraphs);
+        for(size_t iHisto=0; iHisto<efficiencyHistos.size(); iHisto++) BookHisto(efficiencyHistos[iHisto]);
+        for(size_t iGraph=0; iGraph<efficiencyGraphs.size(); iGraph++) BookHisto(efficiencyGraphs[iGraph]);
+    }
+
+    fCutScan.SetEnabled(fCutScanEnabled);
+    if(fCutScanEnabled){
+        vector<TH1D*> cutScanHistos;
+        fCutScan.BookHistos(cutScanHistos);
+        for(size_t iHisto=0; iHisto<cutScanHistos.size(); iHisto++) BookHisto(cutScanHistos[iHisto]);
+    }
+    fStageTimer.SetEnabled(fStageTimingEnabled);
+    if(fStageTimingEnabled){
+        vector<TH1D*> stageHistos;
+        fStageTimer.BookHistos(stageHistos);
+        for(size_t iHisto=0; iHisto<stageHistos.size(); iHisto++) BookHisto(stageHistos[iHisto]);
+    }
+
+    //Size of the histograms booked so far, then the report histograms of all the analyzers (first analyzer only, in AllAnalyzers/)
+    MemoryMonitor::Instance().BookInto(fMemoryIndex, this);
+    PerfCounters::Instance().BookInto(fPerfIndex, this);
 }
 
 void Kmu2::StartOfBurstUser(){
@@ -527,6 +810,7 @@ void Kmu2::StartOfBurstUser(){
     /// This method is called when a new file is opened in the ROOT TChain (corresponding to a start/end of burst in the normal NA62 data taking) + at the beginning of the first file\n
     /// Do here your start/end of burst processing if any
     /// \EndMemberDescr
+    fNBurstEvents = 0;
 }
 
 void Kmu2::Process(int iEvent){
@@ -647,16 +931,50 @@ void Kmu2::Process(int iEvent){
     /// @see ROOT TParticlePDG for the particle properties
     /// @see ROOT TDatabasePDG for a list of PDG codes and particle naming convention
     /// \EndMemberDescr
+    MemoryMonitor::ProcessScope memoryScope(fMemoryIndex);
+    PerfCounters::Scope perfScope(fPerfIndex);
+    SharedEvent::Instance().BeginEvent(fSharedIndex);
+    if(fHeapCounter) fHeapCounter->StartEvent();
+    fStageTimer.StartEvent();
     //if(fMCSimple.fStatus == MCSimple::kMissing){printIncompleteMCWarning(iEvent);return;}
     //      if(fMCSimple.fStatus == MCSimple::kEmpty){printNoMCWarning();return;}
-    TRecoLKrEvent          *LKrEvent = (TRecoLKrEvent*)GetEvent("LKr");
-    TRecoSpectrometerEvent *SpectrometerEvent = (TRecoSpectrometerEvent*)GetEvent("Spectrometer");
-    TRecoMUV1Event         *MUV1Event   = (TRecoMUV1Event*)GetEvent("MUV1");
-    TRecoMUV2Event         *MUV2Event   = (TRecoMUV2Event*)GetEvent("MUV2","Reco");
-    TRecoMUV3Event         *MUV3Event   = (TRecoMUV3Event*)GetEvent("MUV3");
-    TRecoRICHEvent         *RICHEvent   = (TRecoRICHEvent*)GetEvent("RICH");
-    TRecoCHODEvent         *CHODEvent   = (TRecoCHODEvent*)GetEvent("CHOD");
-    TRecoCedarEvent        *CedarEvent = (TRecoCedarEvent*)GetEvent("Cedar");
+    TRecoLKrEvent          *LKrEvent;
+    TRecoSpectrometerEvent *SpectrometerEvent;
+    TRecoMUV1Event         *MUV1Event;
+    TRecoMUV2Event         *MUV2Event;
+    TRecoMUV3Event         *MUV3Event;
+    TRecoRICHEvent         *RICHEvent;
+    TRecoCHODEvent         *CHODEvent;
+    TRecoCedarEvent        *CedarEvent;
+    {
+        StageTimer::Scope readScope(fStageTimer, kStageRead);
+        LKrEvent          = (TRecoLKrEvent*)GetEvent("LKr");
+        SpectrometerEvent = (TRecoSpectrometerEvent*)GetEvent("Spectrometer");
+        MUV1Event         = (TRecoMUV1Event*)GetEvent("MUV1");
+        MUV2Event         = (TRecoMUV2Event*)GetEvent("MUV2","Reco");
+        MUV3Event         = (TRecoMUV3Event*)GetEvent("MUV3");
+        RICHEvent         = (TRecoRICHEvent*)GetEvent("RICH");
+        CHODEvent         = (TRecoCHODEvent*)GetEvent("CHOD");
+        CedarEvent        = (TRecoCedarEvent*)GetEvent("Cedar");
+    }
+
+    fBurstID = MUV3Event->GetBurstID();
+    //The calibration prepass only uses a sample at the beginning of each burst
+    if(fTimeCalibrator && fCalibrationEvents>0 && fNBurstEvents++>=fCalibrationEvents){return;}
+    if(fBurstQuality){
+        //Occupancy of every channel, all the events
+        fBurstQuality->StartEvent();
+        TClonesArray *MUV1Hits = MUV1Event->GetHits();
+        for(int iMUV1Hit=0; iMUV1Hit<MUV1Event->GetNHits(); iMUV1Hit++){
+            fBurstQuality->FillHit(MUVChannelMap::kMUV1, MUVChannelMap::MUV1Channel(((TRecoMUV1Hit*)MUV1Hits->At(iMUV1Hit))->GetChannelID()));
+        }
+        TClonesArray *MUV2Hits = MUV2Event->GetHits();
+        for(int iMUV2Hit=0; iMUV2Hit<MUV2Event->GetNHits(); iMUV2Hit++){
+            fBurstQuality->FillHit(MUVChannelMap::kMUV2, MUVChannelMap::MUV2Channel(((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit))->GetChannelID()));
+        }
+    }
+    CUTFLOW_START(fCutFlow);
+    fCutScan.StartEvent();
 
     TRecoLKrCandidate*   LKrCluster;
     TRecoCHODCandidate*  CHODCandidate;
@@ -706,23 +1024,8 @@ void Kmu2::Process(int iEvent){
     TVector3 LkrPos;
 
 
-    //Time Offset for all the detectors differences (ATM using only CHOD as reference)
-    double LKrOffset   = +115; //Old 112.3 Use GetClusterTime new 115 Gia 121.2
-    double CedarOffset =0.; //old 0 new 0 Gia 6.23
-    double MUV1Offset  =0.;//new -5 old -8.5 Gia 6.08
-    double MUV2Offset  =0.;//new -5 old -20.4 Gia 5.59
-    double MUV3Offset  =0.;//old -11.35 Gia -2.75
-
-    //Cuts used on the timedifferences for the Kmu2 selection
-    double LKrOffsetCut  = 100.;//10;
-    double RICHOffsetCut = 100.;//10;
-    double MUV3OffsetCut = 100.;//5 ;
-    double MUV1OffsetCut = 100.;//20;
-    double MUV2OffsetCut = 100.;//20;
-    double CedarOffsetCut= 100.;//2 ;
-
     //CUTComment:: Only one candidate in the STRAW
-    if(SpectrometerEvent->GetNCandidates() != 1 ){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kSTRAWNCandidates, SpectrometerEvent->GetNCandidates() != 1)){return;}
 
 
 
@@ -730,7 +1033,7 @@ void Kmu2::Process(int iEvent){
     Track = ((TRecoSpectrometerCandidate*)SpectrometerEvent->GetCandidate(0));
 
     //CUTComment:: Check if track is positive (K+ beam in NA62)
-    if(Track->GetCharge() != 1){ return;}
+    if(CUTFLOW_REJECT(fCutFlow, kTrackCharge, Track->GetCharge() != 1)){ return;}
     //cout << "MUV L0 trig == " << CHODEvent->GetL0TriggerType() << "STRAW L0 trig == " << MUV3Event->GetTriggerType() << endl;
 
     //Comment:: All necessary STRAW variables are defined here
@@ -743,19 +1046,6 @@ void Kmu2::Process(int iEvent){
     int    STRAW_NC   = Track->GetNChambers();
     double STRAW_chi2 = Track->GetChi2();
 
-    //CUTComment:: Check if the the chi2 of the track fitter in the straw is >20
-    // and if there are at least 3 chambers fired
-    if(STRAW_chi2 > 20){ return;}
-    if(STRAW_NC   < 3){ return;}
-
-    for(int iCedarCand=0; iCedarCand < CedarEvent->GetNCandidates(); iCedarCand++){
-        CedarCandidate = ((TRecoCedarCandidate*)CedarEvent->GetCandidate(iCedarCand));
-        //CUTComment:: At least 5 sectors in CEDAR
-        if(CedarCandidate->GetNSectors() < 5 ){return;}
-
-    }
-
-
     //Getting the position vectors and the slopes of the tracks
     //before the magnet @ DCH1
     SlopesBefore.SetX(STRAW_bdxdz);
@@ -775,17 +1065,6 @@ void Kmu2::Process(int iEvent){
     BeamP.SetXYZ(beam_norm*KEnergy*XAngle*1000,0,beam_norm*KEnergy*1000.);
     BeamTrim5Pos.SetXYZ(0., 0., Ztrim*1000.);
 
-    //Calculating the intersection point between the kaon and
-    //the track and getting the cda using the VertexCDA routine by Giuseppe
-    double cda = 0;
-    Vertex = VertexCDA(PositionBefore, TrackP, BeamTrim5Pos, BeamP, cda );
-
-
-    //CUTComment:: Closest Approached Distance > 40.
-    //Zvtx to be incide of the fiducial volume of NA62 detector (105 - 180 m)
-    if(cda > 40.){return;}
-    if( Vertex.Z() < 105000 || Vertex.Z() > 180000){return;}
-
     //Computing the NuNubar 3vector (Missing mass)
     NuNubar = BeamP - TrackP;
 
@@ -824,690 +1103,792 @@ void Kmu2::Process(int iEvent){
     MUV2_extrap = PositionAfter + ( ZMUV2Start*1000 - PositionAfter.Z() )*SlopesAfter;
     MUV3_extrap = PositionAfter + ( ZMUV3Start*1000 - PositionAfter.Z() )*SlopesAfter;
     LKr_extrap  = PositionAfter + ( ZLKrStart *1000 - PositionAfter.Z() )*SlopesAfter;
+    double CHODR  = sqrt( pow(CHOD_extrap.X(),2) + pow(CHOD_extrap.Y(),2) );
+    double STRAW4R  = sqrt( pow(PositionAfter.X(),2) + pow(PositionAfter.Y(),2) );
 
-    //Energy scale correction and non-linearity correction for the LKr taken from Giuseppe
-    Double_t fEScale = 1.03;
-    for(int iLKrCand=0; iLKrCand<LKrEvent->GetNCandidates(); iLKrCand++){
-        LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(iLKrCand));
-        // ZS non linearity
-        Double_t ue = LKrCluster->GetClusterEnergy();
-        Double_t ce = ue;
-        if (LKrCluster->GetNCells()>9) {
-            if (ue<22) ce = ue/(0.7666+0.0573489*log(ue));
-            if (ue>=22 && ue<65) ce = ue/(0.828962+0.0369797*log(ue));
-            if (ue>=65) ce = ue/(0.828962+0.0369797*log(65));
-        }
-
-        LKrCluster->SetClusterEnergy(ce*fEScale);
-        double LKrClusterEnergy = 1000*LKrCluster->GetClusterEnergy(); //  [MeV]
-
-        //CUTComment:: MIP cluster requirement on number in LKr and the energy inside them
-        if(LKrClusterEnergy > 800 ) {return ;} //  [MeV]
-        if(LKrCluster->GetNCells()>5) {return;}
-        if(LKrClusterEnergy < 300 ) {return;}
-    }
-    //CUTComment:: At least one track in MUV3 and in CEDAR
-    if( MUV3Event->GetNCandidates() == 0 ){return;}
-    if( CedarEvent->GetNCandidates() == 0 ){return;}
-
-
-    //Passing the momentum of the particles together with the slopes after the magnet
-    //to the function FindClosestCluster which gives you the index of the cluster and
-    //the value of the closest distance between the extrapolated track and the cluster
+    //Expensive inputs of the cuts below, computed by produce() only when a cut needs them.
+    //The cuts are run by fCutScheduler in the order of their measured cost and rejection
+    double cda = 0;
+    bool LKrNotMIP = false;
     double CHODdtrkcl_min;
     double LKrdtrkcl_min;
     double MUV1dtrkcl_min;
     double MUV2dtrkcl_min;
     double MUV3dtrkcl_min;
-    vector <double> CEDAR_STRAW_tdiff;
-    int CHODClosestTrackIndex = FindClosestCluster(CHODEvent, CHOD_extrap, "CHOD" , CHODdtrkcl_min);
-    int LKrTrackClusterIndex  = FindClosestCluster(LKrEvent , LKr_extrap , "LKr"  , LKrdtrkcl_min);
-    int MUV1TrackClusterIndex = FindClosestCluster(MUV1Event, MUV1_extrap, "MUV1" , MUV1dtrkcl_min);
-    int MUV2TrackClusterIndex = FindClosestCluster(MUV2Event, MUV2_extrap, "MUV2" , MUV2dtrkcl_min);
-    int MUV3TrackClusterIndex = FindClosestCluster(MUV3Event, MUV3_extrap, "MUV3" , MUV3dtrkcl_min);
-
-
-    //CUTComment::At least one track associated with hit in the CHOD
-    //Missing mass cut to select pure muons
-    //Momentum measured by the STRAW to be between 10 and 65 GeV
-    //Momentum given by the STRAW - Momentum given just by the pattern recognition
-    // to be less than 20 GeV
-
-    if(CHODClosestTrackIndex < 0. ){return;}
-    if(MUV3TrackClusterIndex < 0. ){return;}
-    if(fabs(NuNubarP.M2()*0.000001) > 0.01 ){return;}
-    if(STRAW_P < 10000. || STRAW_P > 65000.){return;}
-    if(fabs(STRAW_P - STRAW_Pbf) > 20000.){return;}
-    double CHODR  = sqrt( pow(CHOD_extrap.X(),2) + pow(CHOD_extrap.Y(),2) );
-    double STRAW4R  = sqrt( pow(PositionAfter.X(),2) + pow(PositionAfter.Y(),2) );
+    int CHODClosestTrackIndex = -1;
+    int LKrTrackClusterIndex  = -1;
+    int MUV1TrackClusterIndex = -1;
+    int MUV2TrackClusterIndex = -1;
+    int MUV3TrackClusterIndex = -1;
+
+    auto produce = [&](int input){
+        switch(input){
+        case kTrackVertex:
+            //Calculating the intersection point between the kaon and
+            //the track and getting the cda using the VertexCDA routine by Giuseppe
+            Vertex = VertexCDA(PositionBefore, TrackP, BeamTrim5Pos, BeamP, cda );
+            break;
+        case kLKrCorrection:{
+            StageTimer::Scope correctionScope(fStageTimer, kStageLKrCorrection);
+            //Energy scale correction and non-linearity correction for the LKr taken from Giuseppe
+            //In place, once per event whatever the number of analyzers
+            SharedEvent::Instance().CorrectLKrEnergies(LKrEvent);
+            for(int iLKrCand=0; iLKrCand<LKrEvent->GetNCandidates(); iLKrCand++){
+                LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(iLKrCand));
+                double LKrClusterEnergy = 1000*LKrCluster->GetClusterEnergy(); //  [MeV]
+
+                //CUTComment:: MIP cluster requirement on number in LKr and the energy inside them
+                if(LKrClusterEnergy > 800 || LKrCluster->GetNCells()>5 || LKrClusterEnergy < 300) {LKrNotMIP = true; break;} //  [MeV]
+            }
+            break;
+        }
+        //Passing the momentum of the particles together with the slopes after the magnet
+        //to the function FindClosestCluster which gives you the index of the cluster and
+        //the value of the closest distance between the extrapolated track and the cluster
+        case kCHODCluster: CHODClosestTrackIndex = FindClosestCluster(CHODEvent, CHOD_extrap, AnalysisKernels::kCHOD , CHODdtrkcl_min); break;
+        case kLKrCluster : LKrTrackClusterIndex  = FindClosestCluster(LKrEvent , LKr_extrap , AnalysisKernels::kLKr  , LKrdtrkcl_min);  break;
+        case kMUV1Cluster: MUV1TrackClusterIndex = FindClosestCluster(MUV1Event, MUV1_extrap, AnalysisKernels::kMUV1 , MUV1dtrkcl_min); break;
+        case kMUV2Cluster: MUV2TrackClusterIndex = FindClosestCluster(MUV2Event, MUV2_extrap, AnalysisKernels::kMUV2 , MUV2dtrkcl_min); break;
+        case kMUV3Cluster: MUV3TrackClusterIndex = FindClosestCluster(MUV3Event, MUV3_extrap, AnalysisKernels::kMUV3 , MUV3dtrkcl_min); break;
+        }
+    };
+
+    auto reject = [&](int cut) -> bool {
+        switch(cut){
+        //CUTComment:: Check if the the chi2 of the track fitter in the straw is >20
+        // and if there are at least 3 chambers fired
+        case kSTRAWChi2     : return fCutScan.Reject(kScanSTRAWChi2, STRAW_chi2, CUTFLOW_REJECT(fCutFlow, kSTRAWChi2, STRAW_chi2 > 20));
+        case kSTRAWNChambers: return CUTFLOW_REJECT(fCutFlow, kSTRAWNChambers, STRAW_NC < 3);
+        case kCedarNSectors:{
+            bool CedarFewSectors = false;
+            for(int iCedarCand=0; iCedarCand < CedarEvent->GetNCandidates(); iCedarCand++){
+                CedarCandidate = ((TRecoCedarCandidate*)CedarEvent->GetCandidate(iCedarCand));
+                //CUTComment:: At least 5 sectors in CEDAR
+                if(CedarCandidate->GetNSectors() < 5 ){CedarFewSectors = true; break;}
+            }
+            return CUTFLOW_REJECT(fCutFlow, kCedarNSectors, CedarFewSectors);
+        }
+        //CUTComment:: Closest Approached Distance > 40.
+        //Zvtx to be incide of the fiducial volume of NA62 detector (105 - 180 m)
+        case kCDA    : return fCutScan.Reject(kScanCDA, cda, CUTFLOW_REJECT(fCutFlow, kCDA, cda > 40.));
+        case kVertexZ: return CUTFLOW_REJECT(fCutFlow, kVertexZ, Vertex.Z() < 105000 || Vertex.Z() > 180000);
+        case kLKrMIP : return CUTFLOW_REJECT(fCutFlow, kLKrMIP, LKrNotMIP);
+        //CUTComment:: At least one track in MUV3 and in CEDAR
+        case kMUV3NCandidates : return CUTFLOW_REJECT(fCutFlow, kMUV3NCandidates, MUV3Event->GetNCandidates() == 0);
+        case kCedarNCandidates: return CUTFLOW_REJECT(fCutFlow, kCedarNCandidates, CedarEvent->GetNCandidates() == 0);
+        //CUTComment::At least one track associated with hit in the CHOD
+        //Missing mass cut to select pure muons
+        //Momentum measured by the STRAW to be between 10 and 65 GeV
+        //Momentum given by the STRAW - Momentum given just by the pattern recognition
+        // to be less than 20 GeV
+        case kCHODAssociation  : return CUTFLOW_REJECT(fCutFlow, kCHODAssociation, CHODClosestTrackIndex < 0.);
+        case kMUV3Association  : return CUTFLOW_REJECT(fCutFlow, kMUV3Association, MUV3TrackClusterIndex < 0.);
+        case kMissingMass      : return CUTFLOW_REJECT(fCutFlow, kMissingMass, fabs(NuNubarP.M2()*0.000001) > 0.01);
+        case kSTRAWMomentum    : return CUTFLOW_REJECT(fCutFlow, kSTRAWMomentum, STRAW_P < 10000. || STRAW_P > 65000.);
+        case kSTRAWMomentumDiff: return CUTFLOW_REJECT(fCutFlow, kSTRAWMomentumDiff, fabs(STRAW_P - STRAW_Pbf) > 20000.);
+        //CUTComment:: Distance to the extrapolated track bigger than 8 cm
+        //Tracks to be in the CHOD and DCH 4 acceptance
+        case kCHODDistance    : return fCutScan.Reject(kScanCHODDistance, CHODdtrkcl_min, CUTFLOW_REJECT(fCutFlow, kCHODDistance, CHODdtrkcl_min > 80.));
+        case kCHODAcceptance  : return CUTFLOW_REJECT(fCutFlow, kCHODAcceptance, CHODR < 100. || CHODR > 1200); //[mm]
+        case kSTRAW4Acceptance: return CUTFLOW_REJECT(fCutFlow, kSTRAW4Acceptance, STRAW4R < 75. || STRAW4R > 1200); //[mm]
+        }
+        return false;
+    };
+
+    {
+        StageTimer::Scope cutsScope(fStageTimer, kStageCuts);
+        if(fCutScheduler.Run(reject, produce) >= 0){return;}
+        //Associations not needed by the cuts above are used by the rest of the selection
+        fCutScheduler.Complete(produce);
+    }
+
     double CD_CHODTime    = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(CHODClosestTrackIndex))->GetTime();
     TVector2 CD_CHODPos   = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(CHODClosestTrackIndex))->GetHitPosition();
 
-    //CUTComment:: Distance to the extrapolated track bigger than 8 cm
-    //Tracks to be in the CHOD and DCH 4 acceptance
-    if(CHODdtrkcl_min > 80. ) {return;}
-    if(CHODR < 100. || CHODR > 1200) {return;} //[mm]
-    if(STRAW4R < 75. || STRAW4R > 1200) {return;} //[mm]
-    //if(PositionAfter.Mag() < 120 || PositionAfter.Mag() > 1100) {return;}//[mm]
-    //cout << PositionAfter.Mag() << endl;
-
-
-    for(int iCHODCand=0; iCHODCand<CHODEvent->GetNCandidates(); iCHODCand++){
-
-        CHODCandidate     = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(iCHODCand));
-        TRecoCHODCandidate* CHODNtCandidate = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(CHODClosestTrackIndex));
-
-        CHODPos           = CHODCandidate->GetHitPosition();
-        TVector2 CHODNtPos= CHODNtCandidate->GetHitPosition();
-        double CHODTime   = CHODCandidate->GetTime();
-        double CHODntTime = CHODNtCandidate->GetTime();
-        double CHOD_dtrk  = sqrt(pow(CHODPos.X()*10. - CHOD_extrap.X(), 2 ) + pow(CHODPos.Y()*10. - CHOD_extrap.Y(), 2 ) ) ;
-
-        FillHisto("CHOD_trk_dist", CHOD_dtrk);
-        FillHisto("CHOD_x_vs_y", CHODPos.X()*10.,CHODPos.Y()*10.);
-        if(iCHODCand == CHODClosestTrackIndex){continue;}
-        if(fabs(CHODntTime - CHODTime) < 5 && sqrt(pow(CHODPos.X()*10. - CHODNtPos.X()*10, 2 ) + pow(CHODPos.Y()*10. - CHODNtPos.Y()*10., 2 ) ) < 100){return;}
-        FillHisto("CHOD_nt_timediff", CHODntTime - CHODTime);
-        FillHisto("CHOD_nt_dtrk", sqrt(pow(CHODPos.X()*10. - CHODNtPos.X()*10, 2 ) + pow(CHODPos.Y()*10. - CHODNtPos.Y()*10., 2 ) ));
-
+    //Candidate and hit times of the event, sorted once for the coincidence windows of all the variants
+    {
+        StageTimer::Scope timelineScope(fStageTimer, kStageTimeline);
+        fTimeline.Clear();
+        for(int iCand=0; iCand<CHODEvent->GetNCandidates(); iCand++) fTimeline.Add(kTimeCHOD, ((TRecoCHODCandidate*)CHODEvent->GetCandidate(iCand))->GetTime(), iCand);
+        for(int iCand=0; iCand<CedarEvent->GetNCandidates(); iCand++) fTimeline.Add(kTimeCedar, ((TRecoCedarCandidate*)CedarEvent->GetCandidate(iCand))->GetTime(), iCand);
+        for(int iCand=0; iCand<LKrEvent->GetNCandidates(); iCand++) fTimeline.Add(kTimeLKr, ((TRecoLKrCandidate*)LKrEvent->GetCandidate(iCand))->GetClusterTime(), iCand);
+        for(int iHit=0; iHit<MUV1Event->GetNHits(); iHit++) fTimeline.Add(kTimeMUV1Hits, ((TRecoMUV1Hit*)MUV1Event->GetHits()->At(iHit))->GetTime(), iHit);
+        for(int iHit=0; iHit<MUV2Event->GetNHits(); iHit++) fTimeline.Add(kTimeMUV2Hits, ((TRecoMUV2Hit*)MUV2Event->GetHits()->At(iHit))->GetTime(), iHit);
+        fTimeline.Sort();
     }
 
-//Do the same procedure for track cluster matching for CEDAR, but
-    //matching only in time
-    for(int iCedarCand=0; iCedarCand < CedarEvent->GetNCandidates(); iCedarCand++){
-        CedarCandidate = ((TRecoCedarCandidate*)CedarEvent->GetCandidate(iCedarCand));
-        double CedarCandidateTime = CedarCandidate->GetTime();
-        double CedarTimeDiff      = CD_CHODTime - CedarCandidateTime + CedarOffset;
-        CEDAR_STRAW_tdiff.push_back(CedarTimeDiff);
-    }
-
-    if(CEDAR_STRAW_tdiff.size() !=0){
-        double CedarTime = *min_element(CEDAR_STRAW_tdiff.begin(), CEDAR_STRAW_tdiff.end());
-
+    //The reconstruction and the cuts above do not depend on the time offsets and are shared by
+    //all the configuration variants. The rest of the selection and the histograms run once per
+    //variant (returning from the lambda rejects the event for this variant only)
+    auto selectVariant = [&](int iVariant){
+        TimeConfig config = fVariants[iVariant];
+        if(iVariant==0 && fTimeOffsets.IsOpen()){
+            //Calibrated offsets of the burst, the hard-coded ones if the burst could not be fitted
+            config.fLKrOffset   = fTimeOffsets.Get(fBurstID, TimeOffsetTable::kLKr  , config.fLKrOffset);
+            config.fCedarOffset = fTimeOffsets.Get(fBurstID, TimeOffsetTable::kCedar, config.fCedarOffset);
+            config.fMUV1Offset  = fTimeOffsets.Get(fBurstID, TimeOffsetTable::kMUV1 , config.fMUV1Offset);
+            config.fMUV2Offset  = fTimeOffsets.Get(fBurstID, TimeOffsetTable::kMUV2 , config.fMUV2Offset);
+            config.fMUV3Offset  = fTimeOffsets.Get(fBurstID, TimeOffsetTable::kMUV3 , config.fMUV3Offset);
+        }
+        CutFlow& cutFlow = iVariant>0 ? fVariantCutFlows[iVariant-1] : fCutFlow;
+        if(iVariant>0){ CUTFLOW_START(cutFlow); }
+
+        //Time Offset for all the detectors differences (ATM using only CHOD as reference)
+        double LKrOffset   = config.fLKrOffset;
+        double CedarOffset = config.fCedarOffset;
+        double MUV1Offset  = config.fMUV1Offset;
+        double MUV2Offset  = config.fMUV2Offset;
+        double MUV3Offset  = config.fMUV3Offset;
+
+        //Cuts used on the timedifferences for the Kmu2 selection
+        double LKrOffsetCut  = config.fLKrOffsetCut;
+        double RICHOffsetCut = config.fRICHOffsetCut;
+        double MUV3OffsetCut = config.fMUV3OffsetCut;
+        double MUV1OffsetCut = config.fMUV1OffsetCut;
+        double MUV2OffsetCut = config.fMUV2OffsetCut;
+        double CedarOffsetCut= config.fCedarOffsetCut;
+
+        //if(PositionAfter.Mag() < 120 || PositionAfter.Mag() > 1100) {return;}//[mm]
+        //cout << PositionAfter.Mag() << endl;
+
+
+        //Neighbour: another candidate within 5 ns and 10 cm of the associated one, searched in the
+        //time window only. The histograms are filled up to the first neighbour in candidate order
+        int NCHODCand = CHODEvent->GetNCandidates();
+        int CHODNeighbourIndex = NCHODCand;
+        HitTimeline::Range CHODWindow = fTimeline.GetWindow(kTimeCHOD, CD_CHODTime - 5., CD_CHODTime + 5.);
+        for(const HitTimeline::Entry* Cand=CHODWindow.first; Cand!=CHODWindow.second; Cand++){
+            if(Cand->fIndex == CHODClosestTrackIndex || Cand->fIndex > CHODNeighbourIndex){continue;}
+            CHODPos = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(Cand->fIndex))->GetHitPosition();
+            if(fabs(CD_CHODTime - Cand->fTime) < 5 && sqrt(pow(CHODPos.X()*10. - CD_CHODPos.X()*10, 2 ) + pow(CHODPos.Y()*10. - CD_CHODPos.Y()*10., 2 ) ) < 100){CHODNeighbourIndex = Cand->fIndex;}
+        }
+        bool CHODNeighbour = CHODNeighbourIndex < NCHODCand;
+
+        for(int iCHODCand=0; fCutScan.IsNominal() && iCHODCand<NCHODCand && iCHODCand<=CHODNeighbourIndex; iCHODCand++){
+            CHODCandidate     = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(iCHODCand));
+            CHODPos           = CHODCandidate->GetHitPosition();
+            double CHOD_dtrk  = sqrt(pow(CHODPos.X()*10. - CHOD_extrap.X(), 2 ) + pow(CHODPos.Y()*10. - CHOD_extrap.Y(), 2 ) ) ;
+
+            FillVariant("CHOD_trk_dist", iVariant, CHOD_dtrk);
+            FillVariant("CHOD_x_vs_y", iVariant, CHODPos.X()*10.,CHODPos.Y()*10.);
+            if(iCHODCand == CHODClosestTrackIndex || iCHODCand == CHODNeighbourIndex){continue;}
+            FillVariant("CHOD_nt_timediff", iVariant, CD_CHODTime - CHODCandidate->GetTime());
+            FillVariant("CHOD_nt_dtrk", iVariant, sqrt(pow(CHODPos.X()*10. - CD_CHODPos.X()*10, 2 ) + pow(CHODPos.Y()*10. - CD_CHODPos.Y()*10., 2 ) ));
+        }
+        if(CUTFLOW_REJECT(cutFlow, kCHODNeighbour, CHODNeighbour)){return;}
+
+        //Cedar candidate matching only in time: the smallest time difference is the one of the
+        //latest candidate
+        HitTimeline::Range CedarCandidates = fTimeline.GetEntries(kTimeCedar);
+        if(CedarCandidates.first != CedarCandidates.second){
+            double CedarTime = CD_CHODTime - (CedarCandidates.second - 1)->fTime + CedarOffset;
+
+            //CUTComment:: Cedar time difference cut
+            if(CUTFLOW_REJECT(cutFlow, kCedarTime, fabs(CedarTime) > CedarOffsetCut)){return;}
+            if(fCutScan.IsNominal()) FillVariant("CEDAR_timediff", iVariant, CedarTime);
+            if(fTimeCalibrator) fTimeCalibrator->Fill(TimeOffsetTable::kCedar, CedarTime);
+        }
 
-        //CUTComment:: Cedar time difference cut
-        if(fabs(CedarTime) > CedarOffsetCut){return;}
-        FillHisto("CEDAR_timediff", CedarTime);
-    }
 
 
+        if(MUV1TrackClusterIndex > -1){
+            TRecoMUV1Candidate* CD_MUV1Cluster = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex));
+            double CD_MUV1ClusterTime = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex))->GetTime();
+            double MUV1T0 = CD_CHODTime - CD_MUV1ClusterTime + MUV1Offset;
+            //TClonesArray *MUV1Hits = MUV1Event->GetHits();
+            //double MUV1Cluster_Charge=0;
+            //double MUV1Cluster_SW=CD_MUV1Cluster->GetShowerWidth();
 
-    if(MUV1TrackClusterIndex > -1){
-        TRecoMUV1Candidate* CD_MUV1Cluster = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex));
-        double CD_MUV1ClusterTime = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex))->GetTime();
-        double MUV1T0 = CD_CHODTime - CD_MUV1ClusterTime + MUV1Offset;
-        //TClonesArray *MUV1Hits = MUV1Event->GetHits();
-        //double MUV1Cluster_Charge=0;
-        //double MUV1Cluster_SW=CD_MUV1Cluster->GetShowerWidth();
-
-
-
-        // FillHisto("MUV1_Nhits", CD_MUV1Cluster->GetNHits() );
-        // FillHisto("MUV1_timediff", MUV1T0);
-        // FillHisto("MUV1_nearest_track_dtrkcl", MUV1dtrkcl_min);
-        // FillHisto("MUV1_nearest_track_cluster_charge", MUV1Cluster_Charge);
-        // FillHisto("MUV1_near_charge_vs_dtrkcl", MUV1Cluster_Charge, MUV1dtrkcl_min);
-        // FillHisto("MUV1_nearest_track_x_vs_y", MUV1_extrap.X(), MUV1_extrap.Y() );
-        // //Old Reco
-        // //FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X() + 60., CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() + 60. );
-        // //New Reco
-        // FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X(), CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() );
-        // FillHisto("MUV1_nt_SW", MUV1Cluster_SW);
-        // FillHisto("MUV1_TrP_SW", STRAW_P ,MUV1Cluster_SW);
-
-
-        if(fabs(MUV1T0) > MUV1OffsetCut){return;}
-        if(MUV1dtrkcl_min > 100.) {return;}
-        if(fabs(MUV1_extrap.X()) <= 130. && fabs(MUV1_extrap.Y()) <= 130.){return;}
-        if(fabs(MUV1_extrap.X()) >= 1100. || fabs(MUV1_extrap.Y()) >= 1100.){return;}
-        //Getting the closest cluster to the track, which is in a square with a side 40mm (+60 mm for old reconstruction)
-        //Old Reco
-        //if( fabs(CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X() + 60.) > 160. ||
-        //    fabs(CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() + 60.) > 160.){return;}
-        //New Reco
-        if( fabs(CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X()) > 160. ||
-            fabs(CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y()) > 160.){return;}
-        // if(MUV1_extrap.X() <= 90. || MUV1_extrap.Y() >= -24.){
-        if(MUV1_extrap.X() <= 90. && MUV1_extrap.X() >= -24.){
-            //cout << "GetPos.X == " << CD_MUV1Cluster->GetPosition().X() << "GetPos.Y == " << CD_MUV1Cluster->GetPosition().Y() << " WTFFF"<< endl;
-            //cout << "GetVChannel == " << CD_MUV1Cluster->GetVerticalChannel() << "GetHChannel == " << CD_MUV1Cluster->GetHorizontalChannel() << " WTFFF" << endl;
-        }
-    }
 
-    if(MUV2TrackClusterIndex > -1){
-
-        TRecoMUV2Candidate* CD_MUV2Cluster = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex));
-        double CD_MUV2ClusterTime   = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex))->GetTime();
-        double MUV2T0 = CD_CHODTime - CD_MUV2ClusterTime + MUV2Offset;
-        //double MUV2Cluster_Charge=0;
-        //double MUV2Cluster_SW=CD_MUV2Cluster->GetShowerWidth();
-        //TClonesArray *MUV2Hits = MUV2Event->GetHits();
-        ////double MUV2R  = sqrt( pow(MUV2_extrap.X(),2) + pow(MUV2_extrap.Y(),2) );
-        //for(int iMUV2Hit = 0; iMUV2Hit <CD_MUV2Cluster->GetNHits(); iMUV2Hit++ ){
-        //    TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit));
-        //    double MUV2HitCharge = MUV2Hit->GetCharge();
-        //    MUV2Cluster_Charge  += MUV2HitCharge;
-        //}
-
-        // FillHisto("MUV2_Nhits", CD_MUV2Cluster->GetNHits() );
-        // FillHisto("MUV2_timediff", MUV2T0);
-        // FillHisto("MUV2_nearest_track_dtrkcl", MUV2dtrkcl_min);
-        // FillHisto("MUV2_nearest_track_cluster_charge", MUV2Cluster_Charge);
-        // FillHisto("MUV2_near_charge_vs_dtrkcl", MUV2Cluster_Charge, MUV2dtrkcl_min);
-        // FillHisto("MUV2_nearest_track_x_vs_y", MUV2_extrap.X(), MUV2_extrap.Y() );
-        // FillHisto("MUV2_cda_x_vs_y", CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X(), CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y());
-        // FillHisto("MUV2_nt_SW", MUV2Cluster_SW);
-        // FillHisto("MUV2_TrP_SW", STRAW_P ,MUV2Cluster_SW);
-
-        if(fabs(MUV2_extrap.X()) <= 130.  && fabs(MUV2_extrap.Y()) <= 130.){return;}
-        if(fabs(MUV2_extrap.X()) >= 1100. || fabs(MUV2_extrap.Y()) >= 1100.){return;}
-        if(fabs(MUV2T0) > MUV2OffsetCut){return;}
-        if(MUV2dtrkcl_min > 150.) {return;}
-        if( fabs(CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X()) > 260. ||
-            fabs(CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y()) > 260.){return;}
-    }
-    //Before
-    //cout << "Before --" << endl;
-    //cout << "MUV1 Cand == " <<  MUV1Event->GetNCandidates() <<  "MUV3 Cand == " <<  MUV3Event->GetNCandidates() << "MUV2 Cand == " <<  MUV2Event->GetNCandidates() << endl;
-    //cout << "MUV1 == " << MUV1TrackClusterIndex << " MUV2 == " << MUV2TrackClusterIndex << " MUV3 == " << MUV3TrackClusterIndex << endl;
-    //cout << "ENDOF" << endl;
-    //if(MUV1Event->GetNHits() < 1 && ){return;}
-    //if(MUV2Event->GetNHits() < 1){return;}
-    if(LKrEvent->GetNHits() < 1){return;}
-    if(MUV3TrackClusterIndex > -1){
-
-        TRecoMUV3Candidate* CD_MUV3Cluster = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex));
-        double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
-        double MUV3T0 = CD_CHODTime - CD_MUV3ClusterTime + MUV3Offset;
-        if(fabs(MUV3T0) > MUV3OffsetCut){return;}
-        if(fabs(MUV3_extrap.X()) <= 130. && fabs(MUV3_extrap.Y()) <= 130.){return;}
-        if(fabs(MUV3_extrap.X()) >= 1100. || fabs(MUV3_extrap.Y()) >= 1100.){return;}
-        if( fabs(CD_MUV3Cluster->GetX() - MUV3_extrap.X()) > 200. ||
-            fabs(CD_MUV3Cluster->GetY() - MUV3_extrap.Y()) > 200.){return;}
-        //if(MUV2dtrkcl_min > 150.) {return;}
-        //cout << "Channel one  == " << CD_MUV3Cluster->GetChannel1() << "Channel two == " << CD_MUV3Cluster->GetChannel2() << "Tile ID == " << CD_MUV3Cluster->GetTileID() << endl;
-        //        cout << "ROChannel one  == " << CD_MUV3Cluster->GetROChannel1() << "ROChannel  two == " << CD_MUV3Cluster->GetROChannel2() << "Tile ID == " << CD_MUV3Cluster->GetTileID()  << endl;
-        //FillHisto("MUV3_timediff", MUV3T0);
-        //FillHisto("MUV3_nearest_track_dtrkcl", MUV3dtrkcl_min);
-        //FillHisto("MUV3_nearest_track_x_vs_y", MUV3_extrap.X(), MUV3_extrap.Y() );
-        //FillHisto("MUV3_cda_x_vs_y", CD_MUV3Cluster->GetX() - MUV3_extrap.X(), CD_MUV3Cluster->GetY() - MUV3_extrap.Y() );
 
+            // FillHisto("MUV1_Nhits", CD_MUV1Cluster->GetNHits() );
+            // FillHisto("MUV1_timediff", MUV1T0);
+            // FillHisto("MUV1_nearest_track_dtrkcl", MUV1dtrkcl_min);
+            // FillHisto("MUV1_nearest_track_cluster_charge", MUV1Cluster_Charge);
+            // FillHisto("MUV1_near_charge_vs_dtrkcl", MUV1Cluster_Charge, MUV1dtrkcl_min);
+            // FillHisto("MUV1_nearest_track_x_vs_y", MUV1_extrap.X(), MUV1_extrap.Y() );
+            // //Old Reco
+            // //FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X() + 60., CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() + 60. );
+            // //New Reco
+            // FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X(), CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() );
+            // FillHisto("MUV1_nt_SW", MUV1Cluster_SW);
+            // FillHisto("MUV1_TrP_SW", STRAW_P ,MUV1Cluster_SW);
 
-    }
 
-    if(LKrTrackClusterIndex > -1){
-        TRecoLKrCandidate* CD_LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex));
-        double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
-        double CD_LKrClusterDDead = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterDDeadCell();
-        double LKrT0 = CD_CHODTime  - CD_LKrClusterTime + LKrOffset;
-        double LKrR  = sqrt( pow(LKr_extrap.X(),2) + pow(LKr_extrap.Y(),2) );
-        double Cluster_X = CD_LKrCluster->GetClusterX()*10;
-        double Cluster_Y = CD_LKrCluster->GetClusterY()*10;
-
-
-        //CUTComment:: LKr cluster Quality cuts
-        //1. and 2. Detector acceptance ( 15cm < R < 110cm)
-        //3. Distance between track and closest cluster
-        //4. Time matching of the cluster
-        //5. Distance to deadcell > 2cm
-        if(LKrR < 150. ) {return;}
-        if(LKrR > 1100. ) {return;}
-        if(LKrdtrkcl_min  > 50. ) {return;}
-        if(fabs(LKrT0) > LKrOffsetCut){return;}
-        if(CD_LKrClusterDDead < 2.){return;}
-
-
-        FillHisto("LKr_nearest_track_DDeadCell", CD_LKrClusterDDead );
-        FillHisto("LKr_timediff" , LKrT0);
-        FillHisto("LKr_nearest_track_dtrkcl", LKrdtrkcl_min );
-        FillHisto("LKr_nearest_track_x_vs_y", Cluster_X, Cluster_Y );
-        FillHisto("LKr_extrap_x_vs_y", LKr_extrap.X(), LKr_extrap.Y() );
+            if(CUTFLOW_REJECT(cutFlow, kMUV1Time, fabs(MUV1T0) > MUV1OffsetCut)){return;}
+            if(CUTFLOW_REJECT(cutFlow, kMUV1Distance, MUV1dtrkcl_min > 100.)) {return;}
+            if(CUTFLOW_REJECT(cutFlow, kMUV1Acceptance, (fabs(MUV1_extrap.X()) <= 130. && fabs(MUV1_extrap.Y()) <= 130.) ||
+                                                      (fabs(MUV1_extrap.X()) >= 1100. || fabs(MUV1_extrap.Y()) >= 1100.))){return;}
+            //Getting the closest cluster to the track, which is in a square with a side 40mm (+60 mm for old reconstruction)
+            //Old Reco
+            //if( fabs(CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X() + 60.) > 160. ||
+            //    fabs(CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() + 60.) > 160.){return;}
+            //New Reco
+            //Square window: scanned as the larger of the two distances
+            double MUV1Window = TMath::Max(fabs(CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X()), fabs(CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y()));
+            if(fCutScan.Reject(kScanMUV1Window, MUV1Window, CUTFLOW_REJECT(cutFlow, kMUV1Window, MUV1Window > 160.))){return;}
+            // if(MUV1_extrap.X() <= 90. || MUV1_extrap.Y() >= -24.){
+            if(MUV1_extrap.X() <= 90. && MUV1_extrap.X() >= -24.){
+                //cout << "GetPos.X == " << CD_MUV1Cluster->GetPosition().X() << "GetPos.Y == " << CD_MUV1Cluster->GetPosition().Y() << " WTFFF"<< endl;
+                //cout << "GetVChannel == " << CD_MUV1Cluster->GetVerticalChannel() << "GetHChannel == " << CD_MUV1Cluster->GetHorizontalChannel() << " WTFFF" << endl;
+            }
+        }
 
-    }
-    //if(MUV3Event->GetBurstID() == 232 || MUV3Event->GetBurstID() == 389 || MUV3Event->GetBurstID() == 432 || MUV3Event->GetBurstID() == 855 ||
-    //   MUV3Event->GetBurstID() == 772 || MUV3Event->GetBurstID() == 885 || MUV3Event->GetBurstID() == 1069|| MUV3Event->GetBurstID() == 1111||
-    //   MUV3Event->GetBurstID() == 965){return;}
-    //if(MUV3Event->GetBurstID() == 453 || MUV3Event->GetBurstID() == 901 || MUV3Event->GetBurstID() == 1038 || MUV3Event->GetBurstID() == 792){ return;}
-
-
-    for(int iLKrCand=0; iLKrCand<LKrEvent->GetNCandidates(); iLKrCand++){
-        LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(iLKrCand));
-        TRecoLKrCandidate* LKrNtCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex));
-
-        LkrPos.SetX ( LKrCluster->GetClusterX() );
-        LkrPos.SetY ( LKrCluster->GetClusterY() );
-        TVector3 LkrNtPos;
-        LkrNtPos.SetX ( LKrNtCluster->GetClusterX() );
-        LkrNtPos.SetY ( LKrNtCluster->GetClusterY() );
-        double LKrEcluster   = 1000*LKrCluster->GetClusterEnergy(); //  [MeV]
-        double LKrEseed      = 1000*LKrCluster->GetClusterSeedEnergy(); //  [MeV]
-        double LKrE77        = 1000*LKrCluster->GetCluster77Energy(); //  [MeV]
-        int    LKrNcells     = LKrCluster->GetNCells();
-        double ClusterTime   = LKrCluster->GetClusterTime();
-        double ClusterNtTime = LKrNtCluster->GetClusterTime();
-
-        FillHisto("LKr_x_vs_y", LkrNtPos.X()*10.,LkrNtPos.Y()*10.);
-        FillHisto("LKr_cda_x_vs_y", LkrNtPos.X()*10. - LKr_extrap.X() , LkrNtPos.Y()*10. - LKr_extrap.Y());
-        FillHisto("LKr_Ecl_vs_NCell", LKrEcluster, LKrNcells);
-        FillHisto("LKr_EoP", LKrEcluster/STRAW_P );
-        FillHisto("LKr_Ecl", LKrEcluster );
-        FillHisto("LKr_Eseed_over_Ecl", LKrEseed/LKrEcluster );
-        FillHisto("LKr_Es_Ecl_vs_E77_Ecl", LKrEseed/LKrEcluster , 1 - LKrE77/LKrEcluster );
-
-        if(iLKrCand == LKrTrackClusterIndex){continue;}
-        FillHisto("LKr_nt_timediff", ClusterNtTime - ClusterTime);
-        FillHisto("LKr_nt_dtrk", sqrt(pow(LkrPos.X()*10. - LkrNtPos.X()*10, 2 ) + pow(LkrPos.Y()*10. - LkrNtPos.Y()*10., 2 ) ));
-        if(fabs(ClusterNtTime - ClusterTime) < 5 && sqrt(pow(LkrPos.X()*10. - LkrNtPos.X()*10, 2 ) + pow(LkrPos.Y()*10. - LkrNtPos.Y()*10., 2 ) ) < 200){return;}
+        if(MUV2TrackClusterIndex > -1){
+
+            TRecoMUV2Candidate* CD_MUV2Cluster = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex));
+            double CD_MUV2ClusterTime   = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex))->GetTime();
+            double MUV2T0 = CD_CHODTime - CD_MUV2ClusterTime + MUV2Offset;
+            //double MUV2Cluster_Charge=0;
+            //double MUV2Cluster_SW=CD_MUV2Cluster->GetShowerWidth();
+            //TClonesArray *MUV2Hits = MUV2Event->GetHits();
+            ////double MUV2R  = sqrt( pow(MUV2_extrap.X(),2) + pow(MUV2_extrap.Y(),2) );
+            //for(int iMUV2Hit = 0; iMUV2Hit <CD_MUV2Cluster->GetNHits(); iMUV2Hit++ ){
+            //    TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit));
+            //    double MUV2HitCharge = MUV2Hit->GetCharge();
+            //    MUV2Cluster_Charge  += MUV2HitCharge;
+            //}
+
+            // FillHisto("MUV2_Nhits", CD_MUV2Cluster->GetNHits() );
+            // FillHisto("MUV2_timediff", MUV2T0);
+            // FillHisto("MUV2_nearest_track_dtrkcl", MUV2dtrkcl_min);
+            // FillHisto("MUV2_nearest_track_cluster_charge", MUV2Cluster_Charge);
+            // FillHisto("MUV2_near_charge_vs_dtrkcl", MUV2Cluster_Charge, MUV2dtrkcl_min);
+            // FillHisto("MUV2_nearest_track_x_vs_y", MUV2_extrap.X(), MUV2_extrap.Y() );
+            // FillHisto("MUV2_cda_x_vs_y", CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X(), CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y());
+            // FillHisto("MUV2_nt_SW", MUV2Cluster_SW);
+            // FillHisto("MUV2_TrP_SW", STRAW_P ,MUV2Cluster_SW);
+
+            if(CUTFLOW_REJECT(cutFlow, kMUV2Acceptance, (fabs(MUV2_extrap.X()) <= 130.  && fabs(MUV2_extrap.Y()) <= 130.) ||
+                                                      (fabs(MUV2_extrap.X()) >= 1100. || fabs(MUV2_extrap.Y()) >= 1100.))){return;}
+            if(CUTFLOW_REJECT(cutFlow, kMUV2Time, fabs(MUV2T0) > MUV2OffsetCut)){return;}
+            if(CUTFLOW_REJECT(cutFlow, kMUV2Distance, MUV2dtrkcl_min > 150.)) {return;}
+            double MUV2Window = TMath::Max(fabs(CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X()), fabs(CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y()));
+            if(fCutScan.Reject(kScanMUV2Window, MUV2Window, CUTFLOW_REJECT(cutFlow, kMUV2Window, MUV2Window > 260.))){return;}
+        }
+        //Before
+        //cout << "Before --" << endl;
+        //cout << "MUV1 Cand == " <<  MUV1Event->GetNCandidates() <<  "MUV3 Cand == " <<  MUV3Event->GetNCandidates() << "MUV2 Cand == " <<  MUV2Event->GetNCandidates() << endl;
+        //cout << "MUV1 == " << MUV1TrackClusterIndex << " MUV2 == " << MUV2TrackClusterIndex << " MUV3 == " << MUV3TrackClusterIndex << endl;
+        //cout << "ENDOF" << endl;
+        //if(MUV1Event->GetNHits() < 1 && ){return;}
+        //if(MUV2Event->GetNHits() < 1){return;}
+        if(CUTFLOW_REJECT(cutFlow, kLKrNHits, LKrEvent->GetNHits() < 1)){return;}
+        if(MUV3TrackClusterIndex > -1){
+
+            TRecoMUV3Candidate* CD_MUV3Cluster = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex));
+            double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
+            double MUV3T0 = CD_CHODTime - CD_MUV3ClusterTime + MUV3Offset;
+            if(CUTFLOW_REJECT(cutFlow, kMUV3Time, fabs(MUV3T0) > MUV3OffsetCut)){return;}
+            if(CUTFLOW_REJECT(cutFlow, kMUV3Acceptance, (fabs(MUV3_extrap.X()) <= 130. && fabs(MUV3_extrap.Y()) <= 130.) ||
+                                                      (fabs(MUV3_extrap.X()) >= 1100. || fabs(MUV3_extrap.Y()) >= 1100.))){return;}
+            if(CUTFLOW_REJECT(cutFlow, kMUV3Window, fabs(CD_MUV3Cluster->GetX() - MUV3_extrap.X()) > 200. ||
+                                                  fabs(CD_MUV3Cluster->GetY() - MUV3_extrap.Y()) > 200.)){return;}
+            //if(MUV2dtrkcl_min > 150.) {return;}
+            //cout << "Channel one  == " << CD_MUV3Cluster->GetChannel1() << "Channel two == " << CD_MUV3Cluster->GetChannel2() << "Tile ID == " << CD_MUV3Cluster->GetTileID() << endl;
+            //        cout << "ROChannel one  == " << CD_MUV3Cluster->GetROChannel1() << "ROChannel  two == " << CD_MUV3Cluster->GetROChannel2() << "Tile ID == " << CD_MUV3Cluster->GetTileID()  << endl;
+            //FillHisto("MUV3_timediff", MUV3T0);
+            //FillHisto("MUV3_nearest_track_dtrkcl", MUV3dtrkcl_min);
+            //FillHisto("MUV3_nearest_track_x_vs_y", MUV3_extrap.X(), MUV3_extrap.Y() );
+            //FillHisto("MUV3_cda_x_vs_y", CD_MUV3Cluster->GetX() - MUV3_extrap.X(), CD_MUV3Cluster->GetY() - MUV3_extrap.Y() );
 
-    }
 
+        }
 
-    FillHisto("CHOD_cda_x_vs_y", CD_CHODPos.X()*10. - CHOD_extrap.X() , CD_CHODPos.Y()*10. - CHOD_extrap.Y());
-    FillHisto("CHOD_nearest_track_dtrkcl", CHODdtrkcl_min);
-    FillHisto("CHOD_nearest_track_x_vs_y", CD_CHODPos.X()*10.,CD_CHODPos.Y()*10. );
-    FillHisto("CHOD_extrap_x_vs_y", CHOD_extrap.X(), CHOD_extrap.Y() );
+        if(LKrTrackClusterIndex > -1){
+            TRecoLKrCandidate* CD_LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex));
+            double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
+            double CD_LKrClusterDDead = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterDDeadCell();
+            double LKrT0 = CD_CHODTime  - CD_LKrClusterTime + LKrOffset;
+            double LKrR  = sqrt( pow(LKr_extrap.X(),2) + pow(LKr_extrap.Y(),2) );
+            double Cluster_X = CD_LKrCluster->GetClusterX()*10;
+            double Cluster_Y = CD_LKrCluster->GetClusterY()*10;
+
+
+            //CUTComment:: LKr cluster Quality cuts
+            //1. and 2. Detector acceptance ( 15cm < R < 110cm)
+            //3. Distance between track and closest cluster
+            //4. Time matching of the cluster
+            //5. Distance to deadcell > 2cm
+            if(CUTFLOW_REJECT(cutFlow, kLKrAcceptance, LKrR < 150. || LKrR > 1100.)) {return;}
+            if(CUTFLOW_REJECT(cutFlow, kLKrDistance, LKrdtrkcl_min > 50.)) {return;}
+            if(CUTFLOW_REJECT(cutFlow, kLKrTime, fabs(LKrT0) > LKrOffsetCut)){return;}
+            if(CUTFLOW_REJECT(cutFlow, kLKrDeadCell, CD_LKrClusterDDead < 2.)){return;}
+
+
+            if(fCutScan.IsNominal()){
+                FillVariant("LKr_nearest_track_DDeadCell", iVariant, CD_LKrClusterDDead );
+                FillVariant("LKr_timediff", iVariant, LKrT0);
+                if(fTimeCalibrator) fTimeCalibrator->Fill(TimeOffsetTable::kLKr, LKrT0);
+                FillVariant("LKr_nearest_track_dtrkcl", iVariant, LKrdtrkcl_min );
+                FillVariant("LKr_nearest_track_x_vs_y", iVariant, Cluster_X, Cluster_Y );
+                FillVariant("LKr_extrap_x_vs_y", iVariant, LKr_extrap.X(), LKr_extrap.Y() );
+            }
 
-    if(MUV1TrackClusterIndex > -1){
-        TRecoMUV1Candidate* CD_MUV1Cluster = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex));
-        double CD_MUV1ClusterTime = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex))->GetTime();
-        double MUV1T0 = CD_CHODTime - CD_MUV1ClusterTime + MUV1Offset;
-        TClonesArray *MUV1Hits = MUV1Event->GetHits();
-        double MUV1Cluster_Charge=0;
-        double MUV1Cluster_SW=CD_MUV1Cluster->GetShowerWidth();
-        double MUV1Quality = CD_MUV1Cluster->GetQuality();
-        TVector2 CD_MUV1Pos = CD_MUV1Cluster->GetPosition();
-        for(int iMUV1Hit = 0; iMUV1Hit <CD_MUV1Cluster->GetNHits(); iMUV1Hit++ ){
-            TRecoMUV1Hit* MUV1Hit = ((TRecoMUV1Hit*)MUV1Hits->At(iMUV1Hit));
-            double MUV1HitCharge = MUV1Hit->GetCharge();
-            MUV1Cluster_Charge  += MUV1HitCharge;
         }
+        //if(MUV3Event->GetBurstID() == 232 || MUV3Event->GetBurstID() == 389 || MUV3Event->GetBurstID() == 432 || MUV3Event->GetBurstID() == 855 ||
+        //   MUV3Event->GetBurstID() == 772 || MUV3Event->GetBurstID() == 885 || MUV3Event->GetBurstID() == 1069|| MUV3Event->GetBurstID() == 1111||
+        //   MUV3Event->GetBurstID() == 965){return;}
+        //if(MUV3Event->GetBurstID() == 453 || MUV3Event->GetBurstID() == 901 || MUV3Event->GetBurstID() == 1038 || MUV3Event->GetBurstID() == 792){ return;}
 
 
-
-        FillHisto("Quality", MUV1Quality);
-        if(MUV1Quality==0){
-            FillHisto("Q0_nearest_track_x_vs_y", CD_MUV1Pos.X(), CD_MUV1Pos.Y()  );
-        }
-        if(MUV1Quality==1){
-            FillHisto("Q1_nearest_track_x_vs_y", CD_MUV1Pos.X(), CD_MUV1Pos.Y()  );
+        //Neighbour: another cluster within 5 ns and 20 cm of the associated one, searched in the
+        //time window only. The histograms are filled up to the first neighbour in cluster order
+        int NLKrCand = LKrEvent->GetNCandidates();
+        int LKrNeighbourIndex = NLKrCand;
+        if(LKrTrackClusterIndex > -1){
+            TRecoLKrCandidate* LKrNtCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex));
+            double ClusterNtTime = LKrNtCluster->GetClusterTime();
+            HitTimeline::Range LKrWindow = fTimeline.GetWindow(kTimeLKr, ClusterNtTime - 5., ClusterNtTime + 5.);
+            for(const HitTimeline::Entry* Cand=LKrWindow.first; Cand!=LKrWindow.second; Cand++){
+                if(Cand->fIndex == LKrTrackClusterIndex || Cand->fIndex > LKrNeighbourIndex){continue;}
+                LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(Cand->fIndex));
+                if(fabs(ClusterNtTime - Cand->fTime) < 5 && sqrt(pow(LKrCluster->GetClusterX()*10. - LKrNtCluster->GetClusterX()*10, 2 ) + pow(LKrCluster->GetClusterY()*10. - LKrNtCluster->GetClusterY()*10., 2 ) ) < 200){LKrNeighbourIndex = Cand->fIndex;}
+            }
         }
-        if(MUV1Quality==2){
-            FillHisto("Q2_nearest_track_x_vs_y", CD_MUV1Pos.X(), CD_MUV1Pos.Y()  );
+        bool LKrNeighbour = LKrNeighbourIndex < NLKrCand;
+
+        for(int iLKrCand=0; fCutScan.IsNominal() && iLKrCand<NLKrCand && iLKrCand<=LKrNeighbourIndex; iLKrCand++){
+            LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(iLKrCand));
+            TRecoLKrCandidate* LKrNtCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex));
+
+            LkrPos.SetX ( LKrCluster->GetClusterX() );
+            LkrPos.SetY ( LKrCluster->GetClusterY() );
+            TVector3 LkrNtPos;
+            LkrNtPos.SetX ( LKrNtCluster->GetClusterX() );
+            LkrNtPos.SetY ( LKrNtCluster->GetClusterY() );
+            double LKrEcluster   = 1000*LKrCluster->GetClusterEnergy(); //  [MeV]
+            double LKrEseed      = 1000*LKrCluster->GetClusterSeedEnergy(); //  [MeV]
+            double LKrE77        = 1000*LKrCluster->GetCluster77Energy(); //  [MeV]
+            int    LKrNcells     = LKrCluster->GetNCells();
+
+            FillVariant("LKr_x_vs_y", iVariant, LkrNtPos.X()*10.,LkrNtPos.Y()*10.);
+            FillVariant("LKr_cda_x_vs_y", iVariant, LkrNtPos.X()*10. - LKr_extrap.X() , LkrNtPos.Y()*10. - LKr_extrap.Y());
+            FillVariant("LKr_Ecl_vs_NCell", iVariant, LKrEcluster, LKrNcells);
+            FillVariant("LKr_EoP", iVariant, LKrEcluster/STRAW_P );
+            FillVariant("LKr_Ecl", iVariant, LKrEcluster );
+            FillVariant("LKr_Eseed_over_Ecl", iVariant, LKrEseed/LKrEcluster );
+            FillVariant("LKr_Es_Ecl_vs_E77_Ecl", iVariant, LKrEseed/LKrEcluster , 1 - LKrE77/LKrEcluster );
+
+            if(iLKrCand == LKrTrackClusterIndex){continue;}
+            FillVariant("LKr_nt_timediff", iVariant, LKrNtCluster->GetClusterTime() - LKrCluster->GetClusterTime());
+            FillVariant("LKr_nt_dtrk", iVariant, sqrt(pow(LkrPos.X()*10. - LkrNtPos.X()*10, 2 ) + pow(LkrPos.Y()*10. - LkrNtPos.Y()*10., 2 ) ));
         }
-        FillHisto("MUV1_Nhits", CD_MUV1Cluster->GetNHits() );
-        FillHisto("MUV1_timediff", MUV1T0);
-        FillHisto("MUV1_nearest_track_dtrkcl", MUV1dtrkcl_min);
-        FillHisto("MUV1_nearest_track_cluster_charge", MUV1Cluster_Charge);
-        FillHisto("MUV1_near_charge_vs_dtrkcl", MUV1Cluster_Charge, MUV1dtrkcl_min);
-        FillHisto("MUV1_PvsQ", STRAW_P, MUV1Cluster_Charge);
-
-        FillHisto("MUV1_nearest_track_x_vs_y", CD_MUV1Cluster->GetPosition().X(), CD_MUV1Cluster->GetPosition().Y() );
-        FillHisto("MUV1_extrap_x_vs_y", MUV1_extrap.X(), MUV1_extrap.Y() );
-        FillHisto("MUV1_nearest_track_VvsH", CD_MUV1Cluster->GetVerticalChannel(), CD_MUV1Cluster->GetHorizontalChannel() );
-        //Old Reco
-        //FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X() + 60., CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() + 60. );
-        //New Reco
-        FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X(), CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() );
-        FillHisto("MUV1_nt_SW", MUV1Cluster_SW);
-        FillHisto("MUV1_TrP_SW", STRAW_P ,MUV1Cluster_SW);
+        if(CUTFLOW_REJECT(cutFlow, kLKrNeighbour, LKrNeighbour)){return;}
+
+        //End of the selection: N-1 distributions of the scanned cuts, then only the events passing them
+        if(!fCutScan.Commit()){return;}
+
+
+        FillVariant("CHOD_cda_x_vs_y", iVariant, CD_CHODPos.X()*10. - CHOD_extrap.X() , CD_CHODPos.Y()*10. - CHOD_extrap.Y());
+        FillVariant("CHOD_nearest_track_dtrkcl", iVariant, CHODdtrkcl_min);
+        FillVariant("CHOD_nearest_track_x_vs_y", iVariant, CD_CHODPos.X()*10.,CD_CHODPos.Y()*10. );
+        FillVariant("CHOD_extrap_x_vs_y", iVariant, CHOD_extrap.X(), CHOD_extrap.Y() );
+
+        if(MUV1TrackClusterIndex > -1){
+            TRecoMUV1Candidate* CD_MUV1Cluster = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex));
+            double CD_MUV1ClusterTime = ((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex))->GetTime();
+            double MUV1T0 = CD_CHODTime - CD_MUV1ClusterTime + MUV1Offset;
+            TClonesArray *MUV1Hits = MUV1Event->GetHits();
+            double MUV1Cluster_Charge=0;
+            double MUV1Cluster_SW=CD_MUV1Cluster->GetShowerWidth();
+            double MUV1Quality = CD_MUV1Cluster->GetQuality();
+            TVector2 CD_MUV1Pos = CD_MUV1Cluster->GetPosition();
+            for(int iMUV1Hit = 0; iMUV1Hit <CD_MUV1Cluster->GetNHits(); iMUV1Hit++ ){
+                TRecoMUV1Hit* MUV1Hit = ((TRecoMUV1Hit*)MUV1Hits->At(iMUV1Hit));
+                double MUV1HitCharge = MUV1Hit->GetCharge();
+                MUV1Cluster_Charge  += MUV1HitCharge;
+            }
 
-    }
-    if(MUV2TrackClusterIndex > -1){
 
-        TRecoMUV2Candidate* CD_MUV2Cluster = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex));
-        double CD_MUV2ClusterTime   = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex))->GetTime();
-        double MUV2T0 = CD_CHODTime - CD_MUV2ClusterTime + MUV2Offset;
-        double MUV2Cluster_Charge=0;
-        double MUV2Cluster_SW=CD_MUV2Cluster->GetShowerWidth();
-        TClonesArray *MUV2Hits = MUV2Event->GetHits();
-        //double MUV2R  = sqrt( pow(MUV2_extrap.X(),2) + pow(MUV2_extrap.Y(),2) );
-        for(int iMUV2Hit = 0; iMUV2Hit <CD_MUV2Cluster->GetNHits(); iMUV2Hit++ ){
-            TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit));
-            double MUV2HitCharge = MUV2Hit->GetCharge();
-            MUV2Cluster_Charge  += MUV2HitCharge;
-        }
 
+            FillVariant("Quality", iVariant, MUV1Quality);
+            if(MUV1Quality==0){
+                FillVariant("Q0_nearest_track_x_vs_y", iVariant, CD_MUV1Pos.X(), CD_MUV1Pos.Y()  );
+            }
+            if(MUV1Quality==1){
+                FillVariant("Q1_nearest_track_x_vs_y", iVariant, CD_MUV1Pos.X(), CD_MUV1Pos.Y()  );
+            }
+            if(MUV1Quality==2){
+                FillVariant("Q2_nearest_track_x_vs_y", iVariant, CD_MUV1Pos.X(), CD_MUV1Pos.Y()  );
+            }
+            FillVariant("MUV1_Nhits", iVariant, CD_MUV1Cluster->GetNHits() );
+            FillVariant("MUV1_timediff", iVariant, MUV1T0);
+            if(fTimeCalibrator) fTimeCalibrator->Fill(TimeOffsetTable::kMUV1, MUV1T0);
+            FillVariant("MUV1_nearest_track_dtrkcl", iVariant, MUV1dtrkcl_min);
+            FillVariant("MUV1_nearest_track_cluster_charge", iVariant, MUV1Cluster_Charge);
+            FillVariant("MUV1_near_charge_vs_dtrkcl", iVariant, MUV1Cluster_Charge, MUV1dtrkcl_min);
+            FillVariant("MUV1_PvsQ", iVariant, STRAW_P, MUV1Cluster_Charge);
+
+            FillVariant("MUV1_nearest_track_x_vs_y", iVariant, CD_MUV1Cluster->GetPosition().X(), CD_MUV1Cluster->GetPosition().Y() );
+            FillVariant("MUV1_extrap_x_vs_y", iVariant, MUV1_extrap.X(), MUV1_extrap.Y() );
+            FillVariant("MUV1_nearest_track_VvsH", iVariant, CD_MUV1Cluster->GetVerticalChannel(), CD_MUV1Cluster->GetHorizontalChannel() );
+            //Old Reco
+            //FillHisto("MUV1_cda_x_vs_y", CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X() + 60., CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() + 60. );
+            //New Reco
+            FillVariant("MUV1_cda_x_vs_y", iVariant, CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X(), CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y() );
+            FillVariant("MUV1_nt_SW", iVariant, MUV1Cluster_SW);
+            FillVariant("MUV1_TrP_SW", iVariant, STRAW_P ,MUV1Cluster_SW);
 
-        FillHisto("MUV2_Nhits", CD_MUV2Cluster->GetNHits() );
-        FillHisto("MUV2_timediff", MUV2T0);
-        FillHisto("MUV2_nearest_track_dtrkcl", MUV2dtrkcl_min);
-        FillHisto("MUV2_nearest_track_cluster_charge", MUV2Cluster_Charge);
-        FillHisto("MUV2_near_charge_vs_dtrkcl", MUV2Cluster_Charge, MUV2dtrkcl_min);
-        FillHisto("MUV2_PvsQ", STRAW_P, MUV2Cluster_Charge);
-        FillHisto("MUV2_nearest_track_x_vs_y", CD_MUV2Cluster->GetPosition().X(), CD_MUV2Cluster->GetPosition().Y() );
-        FillHisto("MUV2_nearest_track_VvsH", CD_MUV2Cluster->GetVerticalChannel(), CD_MUV2Cluster->GetHorizontalChannel() );
-        FillHisto("MUV2_extrap_x_vs_y", MUV2_extrap.X(), MUV2_extrap.Y());
-        FillHisto("MUV2_cda_x_vs_y", CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X(), CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y());
-        FillHisto("MUV2_nt_SW", MUV2Cluster_SW);
-        FillHisto("MUV2_TrP_SW", STRAW_P ,MUV2Cluster_SW);
+        }
+        if(MUV2TrackClusterIndex > -1){
+
+            TRecoMUV2Candidate* CD_MUV2Cluster = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex));
+            double CD_MUV2ClusterTime   = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex))->GetTime();
+            double MUV2T0 = CD_CHODTime - CD_MUV2ClusterTime + MUV2Offset;
+            double MUV2Cluster_Charge=0;
+            double MUV2Cluster_SW=CD_MUV2Cluster->GetShowerWidth();
+            TClonesArray *MUV2Hits = MUV2Event->GetHits();
+            //double MUV2R  = sqrt( pow(MUV2_extrap.X(),2) + pow(MUV2_extrap.Y(),2) );
+            for(int iMUV2Hit = 0; iMUV2Hit <CD_MUV2Cluster->GetNHits(); iMUV2Hit++ ){
+                TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit));
+                double MUV2HitCharge = MUV2Hit->GetCharge();
+                MUV2Cluster_Charge  += MUV2HitCharge;
+            }
 
-    }
 
-    if(MUV3TrackClusterIndex > -1){
+            FillVariant("MUV2_Nhits", iVariant, CD_MUV2Cluster->GetNHits() );
+            FillVariant("MUV2_timediff", iVariant, MUV2T0);
+            if(fTimeCalibrator) fTimeCalibrator->Fill(TimeOffsetTable::kMUV2, MUV2T0);
+            FillVariant("MUV2_nearest_track_dtrkcl", iVariant, MUV2dtrkcl_min);
+            FillVariant("MUV2_nearest_track_cluster_charge", iVariant, MUV2Cluster_Charge);
+            FillVariant("MUV2_near_charge_vs_dtrkcl", iVariant, MUV2Cluster_Charge, MUV2dtrkcl_min);
+            FillVariant("MUV2_PvsQ", iVariant, STRAW_P, MUV2Cluster_Charge);
+            FillVariant("MUV2_nearest_track_x_vs_y", iVariant, CD_MUV2Cluster->GetPosition().X(), CD_MUV2Cluster->GetPosition().Y() );
+            FillVariant("MUV2_nearest_track_VvsH", iVariant, CD_MUV2Cluster->GetVerticalChannel(), CD_MUV2Cluster->GetHorizontalChannel() );
+            FillVariant("MUV2_extrap_x_vs_y", iVariant, MUV2_extrap.X(), MUV2_extrap.Y());
+            FillVariant("MUV2_cda_x_vs_y", iVariant, CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X(), CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y());
+            FillVariant("MUV2_nt_SW", iVariant, MUV2Cluster_SW);
+            FillVariant("MUV2_TrP_SW", iVariant, STRAW_P ,MUV2Cluster_SW);
 
-        TRecoMUV3Candidate* CD_MUV3Cluster = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex));
-        double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
-        double MUV3T0 = CD_CHODTime - CD_MUV3ClusterTime + MUV3Offset;
+        }
 
-        FillHisto("MUV3_timediff", MUV3T0);
-        FillHisto("MUV3_nearest_track_dtrkcl", MUV3dtrkcl_min);
-        FillHisto("MUV3_extrap_x_vs_y", MUV3_extrap.X(), MUV3_extrap.Y() );
-        FillHisto("MUV3_nearest_track_x_vs_y", CD_MUV3Cluster->GetX(), CD_MUV3Cluster->GetY() );
-        FillHisto("MUV3_cda_x_vs_y", CD_MUV3Cluster->GetX() - MUV3_extrap.X(), CD_MUV3Cluster->GetY() - MUV3_extrap.Y() );
+        if(MUV3TrackClusterIndex > -1){
 
+            TRecoMUV3Candidate* CD_MUV3Cluster = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex));
+            double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
+            double MUV3T0 = CD_CHODTime - CD_MUV3ClusterTime + MUV3Offset;
 
-    }
+            FillVariant("MUV3_timediff", iVariant, MUV3T0);
+            if(fTimeCalibrator) fTimeCalibrator->Fill(TimeOffsetTable::kMUV3, MUV3T0);
+            if(fChannelT0 && iVariant==0) fChannelT0->Fill(MUVChannelMap::kMUV3, MUVChannelMap::MUV3Channel(CD_MUV3Cluster->GetTileID()), MUV3T0);
+            FillVariant("MUV3_nearest_track_dtrkcl", iVariant, MUV3dtrkcl_min);
+            FillVariant("MUV3_extrap_x_vs_y", iVariant, MUV3_extrap.X(), MUV3_extrap.Y() );
+            FillVariant("MUV3_nearest_track_x_vs_y", iVariant, CD_MUV3Cluster->GetX(), CD_MUV3Cluster->GetY() );
+            FillVariant("MUV3_cda_x_vs_y", iVariant, CD_MUV3Cluster->GetX() - MUV3_extrap.X(), CD_MUV3Cluster->GetY() - MUV3_extrap.Y() );
 
-    double MUVs123=0;
-    //Testung MUV candidates
-    if(MUV3TrackClusterIndex > -1 &&
-       MUV2TrackClusterIndex > -1 &&
-       MUV1TrackClusterIndex > -1 ){
-        TRecoMUV3Candidate* MUV3Cl_123 = (TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex);
-        MUVs123 = 1;
-        Int_t  MUV1_Hindex_MUV123 = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.Y());
-        Int_t  MUV1_Vindex_MUV123 = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.X());
-        Int_t  MUV2_Hindex_MUV123 = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.Y());
-        Int_t  MUV2_Vindex_MUV123 = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.X());
-        FillHisto("BadMUV1_HitMap_MUV123", MUV1_Vindex_MUV123, MUV1_Hindex_MUV123);
-        FillHisto("BadMUV2_HitMap_MUV123", MUV2_Vindex_MUV123, MUV2_Hindex_MUV123);
-        FillHisto("MUV3Hit_GoodEvent", MUV3Cl_123->GetTileID());
-        FillHisto("BurstID_vs_MUV123", MUV3Event->GetBurstID(),MUVs123);
-        FillHisto("MUV3_nearest_track_dtrkcl_MUV123", MUV3dtrkcl_min);
-        FillHisto("MUV123", MUVs123);
-
-        FillHisto("Nhits123_MUV1", MUV1Event->GetNHits());
-        FillHisto("Nhits123_MUV2", MUV2Event->GetNHits());
 
+        }
 
-        if(LKrTrackClusterIndex > -1){
+        //MUV categories: the bits are set once and every category or DQ selection is a predicate on them
+        int BurstID = MUV3Event->GetBurstID();
+        fSelection.StartEvent();
+        fSelection.Set(kBitMUV1, MUV1TrackClusterIndex > -1);
+        fSelection.Set(kBitMUV2, MUV2TrackClusterIndex > -1);
+        fSelection.Set(kBitMUV3, MUV3TrackClusterIndex > -1);
+        fSelection.Set(kBitLKr , LKrTrackClusterIndex  > -1);
+        //Bad bursts: inefficient or with channels dead/hot in the burst only
+        fSelection.Set(kBitBadBurstMUV1, fBadBursts.IsBad(BurstID, BadBurstList::kMUV1));
+        fSelection.Set(kBitBadBurstMUV2, fBadBursts.IsBad(BurstID, BadBurstList::kMUV2));
+        SelectionMask::Mask passed = fSelection.Evaluate(iVariant==0);
+
+        //Histograms common to the categories, named after them
+        Int_t  MUV1_Hindex = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.Y());
+        Int_t  MUV1_Vindex = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.X());
+        Int_t  MUV2_Hindex = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.Y());
+        Int_t  MUV2_Vindex = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.X());
+        if(fBurstQuality && iVariant==0){
+            if(fSelection.IsSet(kBitMUV2) && fSelection.IsSet(kBitMUV3)) fBurstQuality->FillProbe(MUVChannelMap::kMUV1, fSelection.IsSet(kBitMUV1));
+            if(fSelection.IsSet(kBitMUV1) && fSelection.IsSet(kBitMUV3)) fBurstQuality->FillProbe(MUVChannelMap::kMUV2, fSelection.IsSet(kBitMUV2));
+        }
+        if(fEfficiencyEnabled && iVariant==0){
+            if(fSelection.IsSet(kBitMUV2) && fSelection.IsSet(kBitMUV3)){
+                fEfficiency[kEffMUV1Strips].Fill(MUV1_Vindex, MUV1_Hindex, fSelection.IsSet(kBitMUV1));
+                fEfficiency[kEffMUV1Position].Fill(MUV1_extrap.X(), MUV1_extrap.Y(), fSelection.IsSet(kBitMUV1));
+            }
+            if(fSelection.IsSet(kBitMUV1) && fSelection.IsSet(kBitMUV3)){
+                fEfficiency[kEffMUV2Strips].Fill(MUV2_Vindex, MUV2_Hindex, fSelection.IsSet(kBitMUV2));
+                fEfficiency[kEffMUV2Position].Fill(MUV2_extrap.X(), MUV2_extrap.Y(), fSelection.IsSet(kBitMUV2));
+            }
+        }
+        double MUV3LKrTime = 0;
+        if(fSelection.IsSet(kBitMUV3) && fSelection.IsSet(kBitLKr)){
             double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
             double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
-            FillHisto("MUV3_LKr_tdiff_MUV123", CD_MUV3ClusterTime - CD_LKrClusterTime + LKrOffset);
-            FillHisto("Nhits123_LKr", LKrEvent->GetNHits());
-        }
-    }
-    //return;
-    double MUVs23=0;
-    if(MUV3TrackClusterIndex > -1 &&
-       MUV2TrackClusterIndex > -1 &&
-       MUV1TrackClusterIndex < 0 ){
-        MUVs23 = 1;
-        TRecoMUV3Candidate* MUV3Cl_23 = (TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex);
-
-        Int_t  MUV1_Hindex_MUV23 = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.Y());
-        Int_t  MUV1_Vindex_MUV23 = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.X());
-        Int_t  MUV2_Hindex_MUV23 = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.Y());
-        Int_t  MUV2_Vindex_MUV23 = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.X());
-        FillHisto("BadMUV1_HitMap_MUV23", MUV1_Vindex_MUV23, MUV1_Hindex_MUV23);
-        FillHisto("BadMUV2_HitMap_MUV23", MUV2_Vindex_MUV23, MUV2_Hindex_MUV23);
-        FillHisto("MUV1_Ncandidates_MUV23", MUV1Event->GetNCandidates());
-        FillHisto("MUV2_Ncandidates_MUV23", MUV2Event->GetNCandidates());
-        FillHisto("MUV3_Ncandidates_MUV23", MUV3Event->GetNCandidates());
-        FillHisto("MUV3_nearest_track_dtrkcl_MUV23", MUV3dtrkcl_min);
-        FillHisto("MUV3Hit_NoMUV1", MUV3Cl_23->GetTileID());
-
-        FillHisto("BurstID_vs_MUV23", MUV3Event->GetBurstID(),MUVs23);
-        FillHisto("TrackP_MUV23", STRAW_P);
-        FillHisto("TrackPfit_TrackP_MUV23", STRAW_P - STRAW_Pbf);
-        FillHisto("MUV23", MUVs23);
-        FillHisto("Nhits0C23_MUV1", MUV1Event->GetNHits());
-        FillHisto("Nhits0C23_MUV2", MUV2Event->GetNHits());
-        //Checking MUV Nhits for the inefficient bursts
-        if(MUV3Event->GetBurstID() == 232 || MUV3Event->GetBurstID() == 389 || MUV3Event->GetBurstID() == 432 || MUV3Event->GetBurstID() == 855 ||
-           MUV3Event->GetBurstID() == 772 || MUV3Event->GetBurstID() == 885 || MUV3Event->GetBurstID() == 1069|| MUV3Event->GetBurstID() == 1111||
-           MUV3Event->GetBurstID() == 965){
-            FillHisto("Nhits0C23_MUV1_BB", MUV1Event->GetNHits());
+            MUV3LKrTime = CD_MUV3ClusterTime - CD_LKrClusterTime + LKrOffset;
         }
-        TClonesArray *MUV1Hits = MUV1Event->GetHits();
-        double MUV1_counter=0;
-        double MUV1_Hcounter=0;
-        double MUV1_Vcounter=0;
-
-        for(int iMUV1Hit=0;  iMUV1Hit <  MUV1Event->GetNHits(); iMUV1Hit++){
-            TRecoMUV1Hit* MUV1Hit = ((TRecoMUV1Hit*)MUV1Hits->At(iMUV1Hit));
-            double Hit_CHOD_tdiff = CD_CHODTime -  MUV1Hit->GetTime() + MUV1Offset;
-
-            if(MUV1Hit->GetChannelID()%100 < 50){
-                //if(MUV1Hit->GetTime() -  < 50)
-                FillHisto("0C_ChID_MUV1", MUV1Hit->GetChannelID());
-                FillHisto("0C_VChID_diff_M1", (MUV1Hit->GetChannelID()%50) - MUV1_Vindex_MUV23);
-                if(fabs((MUV1Hit->GetChannelID()%50) - MUV1_Vindex_MUV23) < 2){
-                    FillHisto("0C_VM1_CHOD_t", Hit_CHOD_tdiff);
-                    if(fabs(Hit_CHOD_tdiff) < 30){
-                        MUV1_counter++;
-                        MUV1_Vcounter++;
-                        FillHisto("0C_VChID_MUV1", MUV1Hit->GetChannelID()%50);
-                        FillHisto("MUV23_Vsaved_M1",(MUV1Hit->GetChannelID()%50 ));
-                    }
+        {
+            //Category histograms: filling timed apart from the selection of the variant
+            StageTimer::Scope histoScope(fStageTimer, kStageHistos);
+            for(SelectionMask::Mask categories = passed & fCategories; categories; ){
+                //Names composed on the stack: no TString temporary per fill
+                const char* category = fSelection.GetName(SelectionMask::Next(categories)).Data();
+                char name[64];
+                snprintf(name, sizeof(name), "BadMUV1_HitMap_%s", category);
+                FillVariant(name, iVariant, MUV1_Vindex, MUV1_Hindex);
+                snprintf(name, sizeof(name), "BadMUV2_HitMap_%s", category);
+                FillVariant(name, iVariant, MUV2_Vindex, MUV2_Hindex);
+                snprintf(name, sizeof(name), "BurstID_vs_%s", category);
+                FillVariant(name, iVariant, BurstID, 1.);
+                snprintf(name, sizeof(name), "MUV3_nearest_track_dtrkcl_%s", category);
+                FillVariant(name, iVariant, MUV3dtrkcl_min);
+                if(fSelection.IsSet(kBitLKr)){
+                    snprintf(name, sizeof(name), "MUV3_LKr_tdiff_%s", category);
+                    FillVariant(name, iVariant, MUV3LKrTime);
                 }
+            }
+            if(fSelection.Passed(kMUV23BadBurst)) FillVariant("Nhits0C23_MUV1_BB", iVariant, MUV1Event->GetNHits());
+            if(fSelection.Passed(kMUV13BadBurst)) FillVariant("Nhits0C13_MUV2_BB", iVariant, MUV2Event->GetNHits());
+        }
 
+        if(fSelection.Passed(kMUV123)){
+            StageTimer::Scope muvScope(fStageTimer, kStageMUVHits);
+            TRecoMUV3Candidate* MUV3Cl_123 = (TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex);
+            FillVariant("MUV3Hit_GoodEvent", iVariant, MUV3Cl_123->GetTileID());
+            FillVariant("MUV123", iVariant, 1.);
+
+            FillVariant("Nhits123_MUV1", iVariant, MUV1Event->GetNHits());
+            FillVariant("Nhits123_MUV2", iVariant, MUV2Event->GetNHits());
+            if(fSelection.IsSet(kBitLKr)) FillVariant("Nhits123_LKr", iVariant, LKrEvent->GetNHits());
+
+            if(fChannelGain && iVariant==0){
+                //MIP spectra: in time hits of the strips crossed by the muon, both readout ends
+                TClonesArray *MUV1Hits = MUV1Event->GetHits();
+                HitTimeline::Range MUV1Window = fTimeline.GetWindow(kTimeMUV1Hits, CD_CHODTime + MUV1Offset - 30., CD_CHODTime + MUV1Offset + 30.);
+                for(const HitTimeline::Entry* Hit=MUV1Window.first; Hit!=MUV1Window.second; Hit++){
+                    TRecoMUV1Hit* MUV1Hit = ((TRecoMUV1Hit*)MUV1Hits->At(Hit->fIndex));
+                    int ChannelID = MUV1Hit->GetChannelID();
+                    int Strip = (ChannelID%100 < 50) ? MUV1_Vindex : MUV1_Hindex;
+                    if(ChannelID%50 != Strip || fabs(CD_CHODTime - MUV1Hit->GetTime() + MUV1Offset) > 30){continue;}
+                    fChannelGain->Fill(MUVChannelMap::kMUV1, MUVChannelMap::MUV1Channel(ChannelID), MUV1Hit->GetCharge());
+                }
+                TClonesArray *MUV2Hits = MUV2Event->GetHits();
+                HitTimeline::Range MUV2Window = fTimeline.GetWindow(kTimeMUV2Hits, CD_CHODTime + MUV2Offset - 30., CD_CHODTime + MUV2Offset + 30.);
+                for(const HitTimeline::Entry* Hit=MUV2Window.first; Hit!=MUV2Window.second; Hit++){
+                    TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(Hit->fIndex));
+                    int ChannelID = MUV2Hit->GetChannelID();
+                    int Strip = (ChannelID%100 < 50) ? MUV2_Vindex : MUV2_Hindex;
+                    if(ChannelID%50 != Strip || fabs(CD_CHODTime - MUV2Hit->GetTime() + MUV2Offset) > 30){continue;}
+                    fChannelGain->Fill(MUVChannelMap::kMUV2, MUVChannelMap::MUV2Channel(ChannelID), MUV2Hit->GetCharge());
+                }
             }
+        }
 
-            if(MUV1Hit->GetChannelID()%100 > 50){
-                //if(MUV1Hit->GetChannelID()%50 - 1 < 50)
-                FillHisto("0C_ChID_MUV1", MUV1Hit->GetChannelID());
-                FillHisto("0C_HChID_diff_M1", (MUV1Hit->GetChannelID()%50) - MUV1_Hindex_MUV23);
+        if(fSelection.Passed(kMUV23)){
+            StageTimer::Scope muvScope(fStageTimer, kStageMUVHits);
+            TRecoMUV3Candidate* MUV3Cl_23 = (TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex);
+
+            FillVariant("MUV1_Ncandidates_MUV23", iVariant, MUV1Event->GetNCandidates());
+            FillVariant("MUV2_Ncandidates_MUV23", iVariant, MUV2Event->GetNCandidates());
+            FillVariant("MUV3_Ncandidates_MUV23", iVariant, MUV3Event->GetNCandidates());
+            FillVariant("MUV3Hit_NoMUV1", iVariant, MUV3Cl_23->GetTileID());
+
+            FillVariant("TrackP_MUV23", iVariant, STRAW_P);
+            FillVariant("TrackPfit_TrackP_MUV23", iVariant, STRAW_P - STRAW_Pbf);
+            FillVariant("MUV23", iVariant, 1.);
+            FillVariant("Nhits0C23_MUV1", iVariant, MUV1Event->GetNHits());
+            FillVariant("Nhits0C23_MUV2", iVariant, MUV2Event->GetNHits());
+            TClonesArray *MUV1Hits = MUV1Event->GetHits();
+            double MUV1_counter=0;
+            double MUV1_Hcounter=0;
+            double MUV1_Vcounter=0;
+
+            for(int iMUV1Hit=0;  iMUV1Hit <  MUV1Event->GetNHits(); iMUV1Hit++){
+                TRecoMUV1Hit* MUV1Hit = ((TRecoMUV1Hit*)MUV1Hits->At(iMUV1Hit));
+                double Hit_CHOD_tdiff = CD_CHODTime -  MUV1Hit->GetTime() + MUV1Offset;
+                int MUV1Strip = AnalysisKernels::MatchStrip(MUV1Hit->GetChannelID(), Hit_CHOD_tdiff, MUV1_Vindex, MUV1_Hindex);
+
+                if(MUV1Hit->GetChannelID()%100 < 50){
+                    //if(MUV1Hit->GetTime() -  < 50)
+                    FillVariant("0C_ChID_MUV1", iVariant, MUV1Hit->GetChannelID());
+                    FillVariant("0C_VChID_diff_M1", iVariant, (MUV1Hit->GetChannelID()%50) - MUV1_Vindex);
+                    if(fabs((MUV1Hit->GetChannelID()%50) - MUV1_Vindex) < 2){
+                        FillVariant("0C_VM1_CHOD_t", iVariant, Hit_CHOD_tdiff);
+                        if(fChannelT0 && iVariant==0) fChannelT0->Fill(MUVChannelMap::kMUV1, MUVChannelMap::MUV1Channel(MUV1Hit->GetChannelID()), Hit_CHOD_tdiff);
+                        if(MUV1Strip == AnalysisKernels::kVerticalStrip){
+                            MUV1_counter++;
+                            MUV1_Vcounter++;
+                            FillVariant("0C_VChID_MUV1", iVariant, MUV1Hit->GetChannelID()%50);
+                            FillVariant("MUV23_Vsaved_M1", iVariant, (MUV1Hit->GetChannelID()%50 ));
+                        }
+                    }
+
+                }
 
-                if(fabs(MUV1Hit->GetChannelID()%50 - MUV1_Hindex_MUV23) < 2){
-                    FillHisto("0C_HM1_CHOD_t", Hit_CHOD_tdiff );
+                if(MUV1Hit->GetChannelID()%100 > 50){
+                    //if(MUV1Hit->GetChannelID()%50 - 1 < 50)
+                    FillVariant("0C_ChID_MUV1", iVariant, MUV1Hit->GetChannelID());
+                    FillVariant("0C_HChID_diff_M1", iVariant, (MUV1Hit->GetChannelID()%50) - MUV1_Hindex);
 
-                    if( fabs(Hit_CHOD_tdiff) < 35 && fabs(Hit_CHOD_tdiff) > 15 ){
+                    if(fabs(MUV1Hit->GetChannelID()%50 - MUV1_Hindex) < 2){
+                        FillVariant("0C_HM1_CHOD_t", iVariant, Hit_CHOD_tdiff );
+                        if(fChannelT0 && iVariant==0) fChannelT0->Fill(MUVChannelMap::kMUV1, MUVChannelMap::MUV1Channel(MUV1Hit->GetChannelID()), Hit_CHOD_tdiff);
 
-                        //TMUV1Digi* MUV1Digi = (TMUV1Digi*) MUV1Hit->GetDigi();
-                        //Double_t *DigiSamples = MUV1Digi->GetAllSamples();
-                        //for(int i = 0; i < MUV1Digi->GetNSamples(); i++){
-                        //    cout << DigiSamples[i] << endl;
-                        //}
-                        FillHisto("ChannelID_25ns_away_M1",MUV1Hit->GetChannelID());
+                        if( fabs(Hit_CHOD_tdiff) < 35 && fabs(Hit_CHOD_tdiff) > 15 ){
 
-                    }
+                            //TMUV1Digi* MUV1Digi = (TMUV1Digi*) MUV1Hit->GetDigi();
+                            //Double_t *DigiSamples = MUV1Digi->GetAllSamples();
+                            //for(int i = 0; i < MUV1Digi->GetNSamples(); i++){
+                            //    cout << DigiSamples[i] << endl;
+                            //}
+                            FillVariant("ChannelID_25ns_away_M1", iVariant, MUV1Hit->GetChannelID());
 
-                    if(fabs(Hit_CHOD_tdiff) < 30){
-                        MUV1_counter++;
-                        MUV1_Hcounter++;
-                        FillHisto("0C_HChID_MUV1", MUV1Hit->GetChannelID()%50);
-                        FillHisto("MUV23_Hsaved_M1",(MUV1Hit->GetChannelID()%50));
+                        }
+
+                        if(MUV1Strip == AnalysisKernels::kHorizontalStrip){
+                            MUV1_counter++;
+                            MUV1_Hcounter++;
+                            FillVariant("0C_HChID_MUV1", iVariant, MUV1Hit->GetChannelID()%50);
+                            FillVariant("MUV23_Hsaved_M1", iVariant, (MUV1Hit->GetChannelID()%50));
+                        }
                     }
                 }
-            }
 
-            if(iMUV1Hit == (MUV1Event->GetNHits() - 1) ){
+                if(iMUV1Hit == (MUV1Event->GetNHits() - 1) ){
 
-                FillHisto("RecVHits_M1", MUV1_Vcounter);
-                FillHisto("RecHHits_M1", MUV1_Hcounter);
-                //cout << "MUV1 ---------------------- " << endl;
-                //cout << " VSaved == " << MUV1_Vcounter << " HSaved == " << MUV1_Hcounter << "CHOD_Tdiff == " << fabs(Hit_CHOD_tdiff) <<  "Test == " << CD_CHODTime -  MUV1Hit->GetTime() + MUV1Offset << endl;
-                if(MUV1_Vcounter != 0  && MUV1_Hcounter != 0 // &&  fabs(Hit_CHOD_tdiff) < 30
-                   ){
-                    FillHisto("RecHits_M1", MUV1_counter);
-                }
+                    FillVariant("RecVHits_M1", iVariant, MUV1_Vcounter);
+                    FillVariant("RecHHits_M1", iVariant, MUV1_Hcounter);
+                    //cout << "MUV1 ---------------------- " << endl;
+                    //cout << " VSaved == " << MUV1_Vcounter << " HSaved == " << MUV1_Hcounter << "CHOD_Tdiff == " << fabs(Hit_CHOD_tdiff) <<  "Test == " << CD_CHODTime -  MUV1Hit->GetTime() + MUV1Offset << endl;
+                    if(MUV1_Vcounter != 0  && MUV1_Hcounter != 0 // &&  fabs(Hit_CHOD_tdiff) < 30
+                       ){
+                        FillVariant("RecHits_M1", iVariant, MUV1_counter);
+                    }
 
+                }
             }
-        }
-
-        if(LKrTrackClusterIndex > -1){
-            double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
-            double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
-            FillHisto("MUV3_LKr_tdiff_MUV23", CD_MUV3ClusterTime - CD_LKrClusterTime + LKrOffset);
-            FillHisto("Nhits0C23_LKr", LKrEvent->GetNHits());
-        }
-    }
 
-    double MUVs13=0;
-    if(MUV3TrackClusterIndex > -1 &&
-       MUV1TrackClusterIndex > -1 &&
-       MUV2TrackClusterIndex < 0 ){
-        MUVs13 = 1;
-        TRecoMUV3Candidate* MUV3Cl_13 = (TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex);
-        Int_t  MUV1_Hindex_MUV13 = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.Y());
-        Int_t  MUV1_Vindex_MUV13 = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.X());
-        Int_t  MUV2_Hindex_MUV13 = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.Y());
-        Int_t  MUV2_Vindex_MUV13 = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.X());
-        FillHisto("BadMUV1_HitMap_MUV13", MUV1_Vindex_MUV13, MUV1_Hindex_MUV13);
-        FillHisto("BadMUV2_HitMap_MUV13", MUV2_Vindex_MUV13, MUV2_Hindex_MUV13);
-        FillHisto("TrackP_MUV13", STRAW_P);
-        FillHisto("TrackPfit_TrackP_MUV13", STRAW_P - STRAW_Pbf);
-        FillHisto("MUV1_Ncandidates_MUV13", MUV1Event->GetNCandidates());
-        FillHisto("MUV2_Ncandidates_MUV13", MUV2Event->GetNCandidates());
-        FillHisto("MUV3_Ncandidates_MUV13", MUV3Event->GetNCandidates());
-        FillHisto("MUV3_nearest_track_dtrkcl_MUV13", MUV3dtrkcl_min);
-        FillHisto("MUV3Hit_NoMUV2", MUV3Cl_13->GetTileID());
-        FillHisto("MUV13", MUVs13);
-        FillHisto("BurstID_vs_MUV13", MUV3Event->GetBurstID(),MUVs13);
-        FillHisto("Nhits0C13_MUV1", MUV1Event->GetNHits());
-        FillHisto("Nhits0C13_MUV2", MUV2Event->GetNHits());
-        //Checking MUV Nhits for the inefficient bursts
-        if(MUV3Event->GetBurstID() == 453 || MUV3Event->GetBurstID() == 901 || MUV3Event->GetBurstID() == 1038 || MUV3Event->GetBurstID() == 792){
-            FillHisto("Nhits0C13_MUV2_BB", MUV2Event->GetNHits());
+            if(fSelection.IsSet(kBitLKr)) FillVariant("Nhits0C23_LKr", iVariant, LKrEvent->GetNHits());
         }
 
-        TClonesArray *MUV2Hits = MUV2Event->GetHits();
-        double MUV2_counter=0;
-        double MUV2_Hcounter=0;
-        double MUV2_Vcounter=0;
-        for(int iMUV2Hit=0; iMUV2Hit < MUV2Event->GetNHits(); iMUV2Hit++){
-            TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit));
-            double Hit_M2CHOD_tdiff = CD_CHODTime -  MUV2Hit->GetTime() + MUV2Offset;
-            FillHisto("0C_ChID_MUV2", MUV2Hit->GetChannelID());
-            //FillHisto("0C_ChID_diff_M2", MUV2Hit->GetChannelID() - MUV1_);
-
-            if(MUV2Hit->GetChannelID()%100 < 50){
-                //if(MUV2Hit->GetChannelID()%50 - 1 < 50)
-                FillHisto("0C_ChID_MUV2", MUV2Hit->GetChannelID());
-                FillHisto("0C_VChID_diff_M2", (MUV2Hit->GetChannelID()%50) - MUV2_Vindex_MUV13);
-                if( fabs((MUV2Hit->GetChannelID()%50) - MUV2_Vindex_MUV13) < 2){
-                    FillHisto("0C_VM2_CHOD_t", Hit_M2CHOD_tdiff);
-
-                    if( fabs(Hit_M2CHOD_tdiff) < 35 && fabs(Hit_M2CHOD_tdiff) > 15 ){
-
-
-                           //Remove when over :D
-        //TMUV2Event *Event = (TMUV2Event*)GetEvent("Digis","MUV2");
-        FADCEvent *Event = (FADCEvent*)GetEvent("MUV2","Digis");
-        //TClonesArray *MUV2Hits = MUV2Event->GetHits();
-        //TMUV2Event* DetectorMUV2Event = (TMUV2Event*);
-        // TClonesArray &Digis = (*(Event->GetHits()));
-        TClonesArray* Digis = Event->GetHits();
-
-        Int_t NDigis = Event->GetNHits();
-        for(int iMUV2Hit=0;  iMUV2Hit <  NDigis; iMUV2Hit++){
-
-            TMUV2Digi* MUV2Digi = (TMUV2Digi*) Digis->At(iMUV2Hit);
-            Double_t* DigiSamples = MUV2Digi->GetAllSamples();
-            Double_t Samples[12] = {1,2,3,4,5,6,7,8,9,10,11,12};
-
-            Int_t DigiNSamples = MUV2Digi->GetNSamples();
-            Int_t MUV2Quality = MUV2Digi->GetQuality();
-
-            BookHisto(Form("Digi_%d",MUV2Event->GetID()),new TGraph(Form("Digi_%d",MUV2Event->GetID()),Form("Digi for event with ID = %d",MUV2Event->GetID())));
-
-            for(int i = 0; i < MUV2Digi->GetNSamples(); i++){
-                 // FillHisto(Form("Digi_%d",MUV2Event->GetID()), i, DigiSamples[i]);
-                cout << "NS == " << DigiNSamples << "Sampe["<<i<<"]"<< DigiSamples[i]<< endl;
+        if(fSelection.Passed(kMUV13)){
+            StageTimer::Scope muvScope(fStageTimer, kStageMUVHits);
+            TRecoMUV3Candidate* MUV3Cl_13 = (TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex);
+            FillVariant("TrackP_MUV13", iVariant, STRAW_P);
+            FillVariant("TrackPfit_TrackP_MUV13", iVariant, STRAW_P - STRAW_Pbf);
+            FillVariant("MUV1_Ncandidates_MUV13", iVariant, MUV1Event->GetNCandidates());
+            FillVariant("MUV2_Ncandidates_MUV13", iVariant, MUV2Event->GetNCandidates());
+            FillVariant("MUV3_Ncandidates_MUV13", iVariant, MUV3Event->GetNCandidates());
+            FillVariant("MUV3Hit_NoMUV2", iVariant, MUV3Cl_13->GetTileID());
+            FillVariant("MUV13", iVariant, 1.);
+            FillVariant("Nhits0C13_MUV1", iVariant, MUV1Event->GetNHits());
+            FillVariant("Nhits0C13_MUV2", iVariant, MUV2Event->GetNHits());
+
+            if(fDigiPulses && iVariant==0){
+                //Pulse shapes of the MUV1/MUV2 digis of the events without MUV2 cluster
+                FADCEvent *MUV1Digis = (FADCEvent*)GetEvent("MUV1","Digis");
+                TClonesArray *MUV1DigiArray = MUV1Digis ? MUV1Digis->GetHits() : 0;
+                for(int iDigi=0; MUV1DigiArray && iDigi<MUV1Digis->GetNHits(); iDigi++){
+                    TMUV1Digi* MUV1Digi = (TMUV1Digi*)MUV1DigiArray->At(iDigi);
+                    fDigiPulses->Fill(MUVChannelMap::kMUV1, MUVChannelMap::MUV1Channel(MUV1Digi->GetChannelID()), MUV1Digi->GetAllSamples(), MUV1Digi->GetNSamples(), MUV1Digi->GetQuality());
+                }
+                FADCEvent *MUV2Digis = (FADCEvent*)GetEvent("MUV2","Digis");
+                TClonesArray *MUV2DigiArray = MUV2Digis ? MUV2Digis->GetHits() : 0;
+                for(int iDigi=0; MUV2DigiArray && iDigi<MUV2Digis->GetNHits(); iDigi++){
+                    TMUV2Digi* MUV2Digi = (TMUV2Digi*)MUV2DigiArray->At(iDigi);
+                    fDigiPulses->Fill(MUVChannelMap::kMUV2, MUVChannelMap::MUV2Channel(MUV2Digi->GetChannelID()), MUV2Digi->GetAllSamples(), MUV2Digi->GetNSamples(), MUV2Digi->GetQuality());
+                }
             }
-        }
-
-
-                        FillHisto("ChannelID_25ns_away_M2",MUV2Hit->GetChannelID());
 
+            TClonesArray *MUV2Hits = MUV2Event->GetHits();
+            double MUV2_counter=0;
+            double MUV2_Hcounter=0;
+            double MUV2_Vcounter=0;
+            for(int iMUV2Hit=0; iMUV2Hit < MUV2Event->GetNHits(); iMUV2Hit++){
+                TRecoMUV2Hit* MUV2Hit = ((TRecoMUV2Hit*)MUV2Hits->At(iMUV2Hit));
+                double Hit_M2CHOD_tdiff = CD_CHODTime -  MUV2Hit->GetTime() + MUV2Offset;
+                int MUV2Strip = AnalysisKernels::MatchStrip(MUV2Hit->GetChannelID(), Hit_M2CHOD_tdiff, MUV2_Vindex, MUV2_Hindex);
+                FillVariant("0C_ChID_MUV2", iVariant, MUV2Hit->GetChannelID());
+                //FillHisto("0C_ChID_diff_M2", MUV2Hit->GetChannelID() - MUV1_);
+
+                if(MUV2Hit->GetChannelID()%100 < 50){
+                    //if(MUV2Hit->GetChannelID()%50 - 1 < 50)
+                    FillVariant("0C_ChID_MUV2", iVariant, MUV2Hit->GetChannelID());
+                    FillVariant("0C_VChID_diff_M2", iVariant, (MUV2Hit->GetChannelID()%50) - MUV2_Vindex);
+                    if( fabs((MUV2Hit->GetChannelID()%50) - MUV2_Vindex) < 2){
+                        FillVariant("0C_VM2_CHOD_t", iVariant, Hit_M2CHOD_tdiff);
+                        if(fChannelT0 && iVariant==0) fChannelT0->Fill(MUVChannelMap::kMUV2, MUVChannelMap::MUV2Channel(MUV2Hit->GetChannelID()), Hit_M2CHOD_tdiff);
+
+                        if( fabs(Hit_M2CHOD_tdiff) < 35 && fabs(Hit_M2CHOD_tdiff) > 15 ){
+                            FillVariant("ChannelID_25ns_away_M2", iVariant, MUV2Hit->GetChannelID());
+
+                        }
+
+                        if(MUV2Strip == AnalysisKernels::kVerticalStrip) {
+                            MUV2_counter++;
+                            MUV2_Vcounter++;
+                            FillVariant("0C_VChID_MUV2", iVariant, MUV2Hit->GetChannelID()%50);
+                            FillVariant("MUV13_Vsaved_M2", iVariant, (MUV2Hit->GetChannelID()%50));
+                        }
                     }
 
-                    if(fabs(Hit_M2CHOD_tdiff) < 30) {
-                        MUV2_counter++;
-                        MUV2_Vcounter++;
-                        FillHisto("0C_VChID_MUV2", MUV2Hit->GetChannelID()%50);
-                        FillHisto("MUV13_Vsaved_M2",(MUV2Hit->GetChannelID()%50));
-                    }
                 }
+                if(MUV2Hit->GetChannelID()%100 > 50){
+                    //if(MUV2Hit->GetChannelID()%50 - 1 < 50)
+                    FillVariant("0C_ChID_MUV2", iVariant, MUV2Hit->GetChannelID());
+                    FillVariant("0C_HChID_diff_M2", iVariant, (MUV2Hit->GetChannelID()%50) - MUV2_Hindex);
+
+                    if( fabs((MUV2Hit->GetChannelID()%50) - MUV2_Hindex) < 2){
+                        FillVariant("0C_HM2_CHOD_t", iVariant, Hit_M2CHOD_tdiff);
+                        if(fChannelT0 && iVariant==0) fChannelT0->Fill(MUVChannelMap::kMUV2, MUVChannelMap::MUV2Channel(MUV2Hit->GetChannelID()), Hit_M2CHOD_tdiff);
+
+                        if(MUV2Strip == AnalysisKernels::kHorizontalStrip) {
+                            MUV2_counter++;
+                            MUV2_Hcounter++;
+                            FillVariant("0C_HChID_MUV2", iVariant, MUV2Hit->GetChannelID()%50);
+                            FillVariant("MUV13_Hsaved_M2", iVariant, (MUV2Hit->GetChannelID()%50));
+                        }
 
-            }
-            if(MUV2Hit->GetChannelID()%100 > 50){
-                //if(MUV2Hit->GetChannelID()%50 - 1 < 50)
-                FillHisto("0C_ChID_MUV2", MUV2Hit->GetChannelID());
-                FillHisto("0C_HChID_diff_M2", (MUV2Hit->GetChannelID()%50) - MUV2_Hindex_MUV13);
-
-                if( fabs((MUV2Hit->GetChannelID()%50) - MUV2_Hindex_MUV13) < 2){
-                    FillHisto("0C_HM2_CHOD_t", Hit_M2CHOD_tdiff);
-
-                    if(fabs(Hit_M2CHOD_tdiff) < 30) {
-                        MUV2_counter++;
-                        MUV2_Hcounter++;
-                        FillHisto("0C_HChID_MUV2", MUV2Hit->GetChannelID()%50);
-                        FillHisto("MUV13_Hsaved_M2",(MUV2Hit->GetChannelID()%50));
                     }
 
                 }
 
-            }
+                if(iMUV2Hit == (MUV2Event->GetNHits() - 1) ){
 
-            if(iMUV2Hit == (MUV2Event->GetNHits() - 1) ){
+                    FillVariant("RecVHits_M2", iVariant, MUV2_Vcounter);
+                    FillVariant("RecHHits_M2", iVariant, MUV2_Hcounter);
+                    //cout << "MUV2 ---------------------- " << endl;
+                    //cout << " VSaved == " << MUV2_Vcounter << " HSaved == " << MUV2_Hcounter << "CHOD_Tdiff == " << fabs(Hit_M2CHOD_tdiff) << "Test == " << CD_CHODTime -  MUV2Hit->GetTime() + MUV2Offset << endl;
+                    if(MUV2_Vcounter != 0  && MUV2_Hcounter != 0 // &&  fabs(Hit_M2CHOD_tdiff) < 30
+                       ){
+                        FillVariant("RecHits_M2", iVariant, MUV2_counter);
+                    }
 
-                FillHisto("RecVHits_M2", MUV2_Vcounter);
-                FillHisto("RecHHits_M2", MUV2_Hcounter);
-                //cout << "MUV2 ---------------------- " << endl;
-                //cout << " VSaved == " << MUV2_Vcounter << " HSaved == " << MUV2_Hcounter << "CHOD_Tdiff == " << fabs(Hit_M2CHOD_tdiff) << "Test == " << CD_CHODTime -  MUV2Hit->GetTime() + MUV2Offset << endl;
-                if(MUV2_Vcounter != 0  && MUV2_Hcounter != 0 // &&  fabs(Hit_M2CHOD_tdiff) < 30
-                   ){
-                    FillHisto("RecHits_M2", MUV2_counter);
                 }
 
             }
 
-        }
+            if(fSelection.IsSet(kBitLKr)) FillVariant("Nhits0C13_LKr", iVariant, LKrEvent->GetNHits());
 
-        if(LKrTrackClusterIndex > -1){
-            double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
-            double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
-            FillHisto("Nhits0C13_LKr", LKrEvent->GetNHits());
-            FillHisto("MUV3_LKr_tdiff_MUV13", CD_MUV3ClusterTime - CD_LKrClusterTime + LKrOffset);
         }
 
-    }
-
-    double MUVs3=0;
-    if(MUV3TrackClusterIndex > -1 &&
-       MUV2TrackClusterIndex < 0  &&
-       MUV1TrackClusterIndex < 0 ){
-        MUVs3 = 1;
-        Int_t  MUV1_Hindex_MUV3only = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.Y());
-        Int_t  MUV1_Vindex_MUV3only = MUV1Geometry::GetInstance()->GetScintillatorAt(MUV1_extrap.X());
-        Int_t  MUV2_Hindex_MUV3only = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.Y());
-        Int_t  MUV2_Vindex_MUV3only = MUV2Geometry::GetInstance()->GetScintillatorAt(MUV2_extrap.X());
-        FillHisto("BadMUV1_HitMap_MUV3", MUV1_Vindex_MUV3only, MUV1_Hindex_MUV3only);
-        FillHisto("BadMUV2_HitMap_MUV3", MUV2_Vindex_MUV3only, MUV2_Hindex_MUV3only);
-        FillHisto("TrackP_MUV3", STRAW_P);
-        FillHisto("TrackPfit_TrackP_MUV3", STRAW_P - STRAW_Pbf);
-        FillHisto("MUV1_Ncandidates_MUV3", MUV1Event->GetNCandidates());
-        FillHisto("MUV2_Ncandidates_MUV3", MUV2Event->GetNCandidates());
-        FillHisto("MUV3_Ncandidates_MUV3", MUV3Event->GetNCandidates());
-        FillHisto("MUV3_nearest_track_dtrkcl_MUV3", MUV3dtrkcl_min);
-        FillHisto("MUV3Only", MUVs3);
-        FillHisto("BurstID_vs_MUV3", MUV3Event->GetBurstID(),MUVs3);
-        if(LKrTrackClusterIndex > -1){
-            double CD_MUV3ClusterTime = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(MUV3TrackClusterIndex))->GetTime();
-            double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
-            FillHisto("MUV3_LKr_tdiff_MUV3", CD_MUV3ClusterTime - CD_LKrClusterTime + LKrOffset);
+        if(fSelection.Passed(kMUV3Only)){
+            StageTimer::Scope muvScope(fStageTimer, kStageMUVHits);
+            FillVariant("TrackP_MUV3", iVariant, STRAW_P);
+            FillVariant("TrackPfit_TrackP_MUV3", iVariant, STRAW_P - STRAW_Pbf);
+            FillVariant("MUV1_Ncandidates_MUV3", iVariant, MUV1Event->GetNCandidates());
+            FillVariant("MUV2_Ncandidates_MUV3", iVariant, MUV2Event->GetNCandidates());
+            FillVariant("MUV3_Ncandidates_MUV3", iVariant, MUV3Event->GetNCandidates());
+            FillVariant("MUV3Only", iVariant, 1.);
+
+            //Checking MUV Nhits for the inefficient bursts
+            FillVariant("Nhits0C3_MUV2_BB", iVariant, MUV2Event->GetNHits());
+            FillVariant("Nhits0C3_MUV1_BB", iVariant, MUV1Event->GetNHits());
+
+            //for(int iMUV3Cand=0; iMUV3Cand < MUV3Event->GetNCandidates(); iMUV3Cand++){
+            //    MUV3Cluster  = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(iMUV3Cand));
+            //    double MUV3ClusterTime_MUV3  = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(iMUV3Cand))->GetTime();
+            //
+            //    if(LKrTrackClusterIndex > -1){
+            //        //double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
+            //        FillHisto("MUV3_LKr_tdiff_MUV3", MUV3ClusterTime_MUV3);
+            //    }
+            //}
         }
+        FillVariant("STRAW1_x_vs_y", iVariant, PositionBefore.X() , PositionBefore.Y());
+        FillVariant("STRAW4_x_vs_y", iVariant, PositionAfter.X() , PositionAfter.Y());
 
-        //Checking MUV Nhits for the inefficient bursts
-        FillHisto("Nhits0C3_MUV2_BB", MUV2Event->GetNHits());
-        FillHisto("Nhits0C3_MUV1_BB", MUV1Event->GetNHits());
-
-        //for(int iMUV3Cand=0; iMUV3Cand < MUV3Event->GetNCandidates(); iMUV3Cand++){
-        //    MUV3Cluster  = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(iMUV3Cand));
-        //    double MUV3ClusterTime_MUV3  = ((TRecoMUV3Candidate*)MUV3Event->GetCandidate(iMUV3Cand))->GetTime();
-        //
-        //    if(LKrTrackClusterIndex > -1){
-        //        //double CD_LKrClusterTime  = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(LKrTrackClusterIndex))->GetClusterTime();
-        //        FillHisto("MUV3_LKr_tdiff_MUV3", MUV3ClusterTime_MUV3);
-        //    }
-        //}
-    }
-    FillHisto("STRAW1_x_vs_y", PositionBefore.X() , PositionBefore.Y());
-    FillHisto("STRAW4_x_vs_y", PositionAfter.X() , PositionAfter.Y());
-
-    ///
+        ///
 
 
 
@@ -1516,159 +1897,162 @@ void Kmu2::Process(int iEvent){
 
 
 
-    for(int iRICHCand=0; iRICHCand<RICHEvent->GetNRingCandidates(); iRICHCand++){ //loop su Ring Cand
+        for(int iRICHCand=0; iRICHCand<RICHEvent->GetNRingCandidates(); iRICHCand++){ //loop su Ring Cand
+            StageTimer::Scope richScope(fStageTimer, kStageRICH);
 
-        RingCandidate = RICHEvent->GetRingCandidate(iRICHCand);
-        RingCandidate->SetEvent(RICHEvent);
+            RingCandidate = RICHEvent->GetRingCandidate(iRICHCand);
+            RingCandidate->SetEvent(RICHEvent);
 
-        TVector2 RingCenter= RingCandidate->GetRingCenter();
-        double RingCenterR = RingCandidate->GetRingRadius();
-        double RingTime    = RingCandidate->GetRingTime();
-        double NeonN       = 1.000067;
-        double RICHAngle   = TMath::ATan( RingCenterR/17000. );
-        double RICHMass    = STRAW_P*0.001*sqrt( pow(NeonN*TMath::Cos(RICHAngle), 2 ) - 1.);
-        double slopex      = RingCenter.X()/17000.;
-        double slopey      = RingCenter.Y()/17000.;
-        //cout << "Beta == " << 1./(NeonN*TMath::Cos(RICHAngle)) << " 1/beta == " << NeonN*TMath::Cos(RICHAngle) << "Track_P == " << STRAW_P << endl;
+            TVector2 RingCenter= RingCandidate->GetRingCenter();
+            double RingCenterR = RingCandidate->GetRingRadius();
+            double RingTime    = RingCandidate->GetRingTime();
+            double RICHMass    = AnalysisKernels::RICHMass(STRAW_P, RingCenterR);
+            double slopex      = RingCenter.X()/17000.;
+            double slopey      = RingCenter.Y()/17000.;
+            //cout << "Beta == " << 1./(NeonN*TMath::Cos(RICHAngle)) << " 1/beta == " << NeonN*TMath::Cos(RICHAngle) << "Track_P == " << STRAW_P << endl;
 
-        FillHisto("RICHRadius",RingCandidate->GetRingRadius());
-        FillHisto("RICHAngle",RingCenterR/17000.);
-        FillHisto("RICHMass",RICHMass);
-        FillHisto("RICHMvsP", STRAW_P*0.001 , RICHMass);
-        //FillHisto("RICHRvsp",RingCandidate->GetRingRadius(),STRAWCandidate->GetMomentum());
+            FillVariant("RICHRadius", iVariant, RingCandidate->GetRingRadius());
+            FillVariant("RICHAngle", iVariant, RingCenterR/17000.);
+            FillVariant("RICHMass", iVariant, RICHMass);
+            FillVariant("RICHMvsP", iVariant, STRAW_P*0.001 , RICHMass);
+            //FillHisto("RICHRvsp",RingCandidate->GetRingRadius(),STRAWCandidate->GetMomentum());
 
-        FillHisto("RICH_STRAW_dxdzdiff", STRAW_dxdz - RingCenter.X()/17000. );
-        FillHisto("RICH_STRAW_dydzdiff", STRAW_dydz - RingCenter.Y()/17000. );
-        FillHisto("RICHRvsP", STRAW_P , RingCandidate->GetRingRadius());
-        FillHisto("RICH_x_vs_y", RICH_extrap.X() , RICH_extrap.Y());
-        FillHisto("RICH_cda_x_vs_y", RICH_extrap.X() - RingCenter.X() , RICH_extrap.Y() - RingCenter.Y());
-        FillHisto("RICH_timediff", RingTime - CD_CHODTime + RICHOffsetCut);
-        //if (RICH_extrap.X()>0) {
-        //slopex+=0.00035;
-        //slopey+=0.00057;
-        FillHisto("RICH_dxdz_vs_dydz", slopex , slopey );
-        // }
-        //if (RICH_extrap.X()<0) {
-        //slopex+=0.00049;
-        //slopey+=0.00068;
-        // FillHisto("RICH_dxdz_vs_dydz", slopex , slopey );
-        //}
-    }
-    for(int iMUV1Cand=0; iMUV1Cand < MUV1Event->GetNCandidates(); iMUV1Cand++){
-
-        MUV1Cluster =((TRecoMUV1Candidate*)MUV1Event->GetCandidate(iMUV1Cand));
-        TRecoMUV1Candidate* MUV1NtCluster =((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex));
-
-        TVector2 MUV1PosOld       = MUV1Cluster->GetPosition();
-        TVector2 MUV1NtPosOld     = MUV1NtCluster->GetPosition();
-        int MUV1VerticalChannel   = MUV1Cluster->GetVerticalChannel();
-        int MUV1NtVerticalChannel   = MUV1NtCluster->GetVerticalChannel();
-        int MUV1HorizontalChannel = MUV1Cluster->GetHorizontalChannel();
-        int MUV1NtHorizontalChannel = MUV1NtCluster->GetHorizontalChannel();
-        double MUV1Time           = MUV1Cluster->GetTime();
-        double MUV1ntTime         = MUV1NtCluster->GetTime();
-        double MUV1SeedEnergy     = MUV1Cluster->GetSeedEnergy();
-        double MUV1ClusterEnergy  = MUV1Cluster->GetEnergy();
-        double MUV1SeedEnergyX    = MUV1Cluster->GetSeedEnergyHorizontal();
-        double MUV1SeedEnergyY    = MUV1Cluster->GetSeedEnergyVertical();
-        double MUV1_dtrk = sqrt(pow(MUV1Pos.X() - MUV1_extrap.X(),2 ) + pow(MUV1Pos.Y() - MUV1_extrap.Y(),2 ) ) ;
-
-        // Old Reco!!!!!!!!!!!!!!!!!!!!!!
-        //MUV1Pos   = MUV1PosOld + 60.;
-        //New Reco
-        MUV1Pos   = MUV1PosOld;
-        TVector2 MUV1NtPos = MUV1NtPosOld + 60.;
-
-        //cout << "Old positionX = " << MUV1PosOld.X() << "And new == " << MUV1Pos.X() << endl;
-        FillHisto("MUV1_ClusterEnergy",MUV1ClusterEnergy);
-        FillHisto("MUV1_Eseed_over_Ecl",MUV1SeedEnergy/MUV1ClusterEnergy);
-        FillHisto("MUV1_SeedEnergy",MUV1SeedEnergy);
-        FillHisto("MUV1_SeedEnergy_vs_ClusterEnergy",MUV1SeedEnergy, MUV1ClusterEnergy);
-        FillHisto("MUV1_SeedEnergy_xvsy",MUV1SeedEnergyX,MUV1SeedEnergyY);
-        FillHisto("MUV1xvsy", MUV1Pos.X(), MUV1Pos.Y());
-        // FillHisto("MUV1_cda_x_vs_y", MUV1Pos.X() - MUV1_extrap.X(), MUV1Pos.Y() - MUV1_extrap.Y());
-        FillHisto("MUV1_trk_dist",MUV1_dtrk);
-
-        if(iMUV1Cand == MUV1TrackClusterIndex){continue;}
-
-        FillHisto("MUV1_nt_timediff", MUV1ntTime - MUV1Time);
-        FillHisto("MUV1_sc_HitMap", MUV1HorizontalChannel, MUV1VerticalChannel);
-        FillHisto("MUV1_hz_nt_chdiff", MUV1NtHorizontalChannel - MUV1HorizontalChannel);
-        FillHisto("MUV1_vt_nt_chdiff", MUV1NtVerticalChannel - MUV1VerticalChannel);
-        FillHisto("MUV1_hz_vt_chdiff", MUV1NtHorizontalChannel - MUV1HorizontalChannel, MUV1NtVerticalChannel - MUV1VerticalChannel);
-        if( fabs(MUV1NtHorizontalChannel - MUV1HorizontalChannel) < 4 || fabs(MUV1NtVerticalChannel - MUV1VerticalChannel) < 4 ){
-
-            FillHisto("MUV1_zero_distance_timediff", MUV1ntTime - MUV1Time);
+            FillVariant("RICH_STRAW_dxdzdiff", iVariant, STRAW_dxdz - RingCenter.X()/17000. );
+            FillVariant("RICH_STRAW_dydzdiff", iVariant, STRAW_dydz - RingCenter.Y()/17000. );
+            FillVariant("RICHRvsP", iVariant, STRAW_P , RingCandidate->GetRingRadius());
+            FillVariant("RICH_x_vs_y", iVariant, RICH_extrap.X() , RICH_extrap.Y());
+            FillVariant("RICH_cda_x_vs_y", iVariant, RICH_extrap.X() - RingCenter.X() , RICH_extrap.Y() - RingCenter.Y());
+            FillVariant("RICH_timediff", iVariant, RingTime - CD_CHODTime + RICHOffsetCut);
+            //if (RICH_extrap.X()>0) {
+            //slopex+=0.00035;
+            //slopey+=0.00057;
+            FillVariant("RICH_dxdz_vs_dydz", iVariant, slopex , slopey );
+            // }
+            //if (RICH_extrap.X()<0) {
+            //slopex+=0.00049;
+            //slopey+=0.00068;
+            // FillHisto("RICH_dxdz_vs_dydz", slopex , slopey );
+            //}
         }
+        for(int iMUV1Cand=0; iMUV1Cand < MUV1Event->GetNCandidates(); iMUV1Cand++){
+
+            MUV1Cluster =((TRecoMUV1Candidate*)MUV1Event->GetCandidate(iMUV1Cand));
+            TRecoMUV1Candidate* MUV1NtCluster =((TRecoMUV1Candidate*)MUV1Event->GetCandidate(MUV1TrackClusterIndex));
+
+            TVector2 MUV1PosOld       = MUV1Cluster->GetPosition();
+            TVector2 MUV1NtPosOld     = MUV1NtCluster->GetPosition();
+            int MUV1VerticalChannel   = MUV1Cluster->GetVerticalChannel();
+            int MUV1NtVerticalChannel   = MUV1NtCluster->GetVerticalChannel();
+            int MUV1HorizontalChannel = MUV1Cluster->GetHorizontalChannel();
+            int MUV1NtHorizontalChannel = MUV1NtCluster->GetHorizontalChannel();
+            double MUV1Time           = MUV1Cluster->GetTime();
+            double MUV1ntTime         = MUV1NtCluster->GetTime();
+            double MUV1SeedEnergy     = MUV1Cluster->GetSeedEnergy();
+            double MUV1ClusterEnergy  = MUV1Cluster->GetEnergy();
+            double MUV1SeedEnergyX    = MUV1Cluster->GetSeedEnergyHorizontal();
+            double MUV1SeedEnergyY    = MUV1Cluster->GetSeedEnergyVertical();
+            double MUV1_dtrk = sqrt(pow(MUV1Pos.X() - MUV1_extrap.X(),2 ) + pow(MUV1Pos.Y() - MUV1_extrap.Y(),2 ) ) ;
+
+            // Old Reco!!!!!!!!!!!!!!!!!!!!!!
+            //MUV1Pos   = MUV1PosOld + 60.;
+            //New Reco
+            MUV1Pos   = MUV1PosOld;
+            TVector2 MUV1NtPos = MUV1NtPosOld + 60.;
+
+            //cout << "Old positionX = " << MUV1PosOld.X() << "And new == " << MUV1Pos.X() << endl;
+            FillVariant("MUV1_ClusterEnergy", iVariant, MUV1ClusterEnergy);
+            FillVariant("MUV1_Eseed_over_Ecl", iVariant, MUV1SeedEnergy/MUV1ClusterEnergy);
+            FillVariant("MUV1_SeedEnergy", iVariant, MUV1SeedEnergy);
+            FillVariant("MUV1_SeedEnergy_vs_ClusterEnergy", iVariant, MUV1SeedEnergy, MUV1ClusterEnergy);
+            FillVariant("MUV1_SeedEnergy_xvsy", iVariant, MUV1SeedEnergyX,MUV1SeedEnergyY);
+            FillVariant("MUV1xvsy", iVariant, MUV1Pos.X(), MUV1Pos.Y());
+            // FillHisto("MUV1_cda_x_vs_y", MUV1Pos.X() - MUV1_extrap.X(), MUV1Pos.Y() - MUV1_extrap.Y());
+            FillVariant("MUV1_trk_dist", iVariant, MUV1_dtrk);
+
+            if(iMUV1Cand == MUV1TrackClusterIndex){continue;}
+
+            FillVariant("MUV1_nt_timediff", iVariant, MUV1ntTime - MUV1Time);
+            FillVariant("MUV1_sc_HitMap", iVariant, MUV1HorizontalChannel, MUV1VerticalChannel);
+            FillVariant("MUV1_hz_nt_chdiff", iVariant, MUV1NtHorizontalChannel - MUV1HorizontalChannel);
+            FillVariant("MUV1_vt_nt_chdiff", iVariant, MUV1NtVerticalChannel - MUV1VerticalChannel);
+            FillVariant("MUV1_hz_vt_chdiff", iVariant, MUV1NtHorizontalChannel - MUV1HorizontalChannel, MUV1NtVerticalChannel - MUV1VerticalChannel);
+            if( fabs(MUV1NtHorizontalChannel - MUV1HorizontalChannel) < 4 || fabs(MUV1NtVerticalChannel - MUV1VerticalChannel) < 4 ){
+
+                FillVariant("MUV1_zero_distance_timediff", iVariant, MUV1ntTime - MUV1Time);
+            }
 
-    }
-
-    for(int iMUV2Cand=0; iMUV2Cand < MUV2Event->GetNCandidates(); iMUV2Cand++){
-        MUV2Cluster = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(iMUV2Cand));
-        TRecoMUV2Candidate* MUV2NtCluster =((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex));
-        MUV2Pos           = MUV2Cluster->GetPosition();
-        TVector2 MUV2ntPosOld     = MUV2NtCluster->GetPosition();
-        int MUV2NtVerticalChannel   = MUV2NtCluster->GetVerticalChannel();
-        int MUV2HorizontalChannel = MUV2Cluster->GetHorizontalChannel();
-        int MUV2NtHorizontalChannel = MUV2NtCluster->GetHorizontalChannel();
-        int MUV2VerticalChannel   = MUV2Cluster->GetVerticalChannel();
-        double MUV2Time          = MUV2Cluster->GetTime();
-        double MUV2ntTime        = MUV2NtCluster->GetTime();
-        double MUV2SeedEnergy    = MUV2Cluster->GetSeedEnergy();
-        double MUV2ClusterEnergy = MUV2Cluster->GetEnergy();
-        double MUV2SeedEnergyX   = MUV2Cluster->GetSeedEnergyHorizontal();
-        double MUV2SeedEnergyY   = MUV2Cluster->GetSeedEnergyVertical();
-        double MUV2_dtrk = sqrt(pow(MUV2Pos.X() - MUV2_extrap.X(),2 ) + pow(MUV2Pos.Y() - MUV2_extrap.Y(),2 ) ) ;
-
-
-
-        FillHisto("MUV2_ClusterEnergy",MUV2ClusterEnergy);
-        FillHisto("MUV2_Eseed_over_Ecl",MUV2SeedEnergy/MUV2ClusterEnergy);
-        FillHisto("MUV2_SeedEnergy",MUV2SeedEnergy);
-        FillHisto("MUV2_SeedEnergy_xvsy",MUV2SeedEnergyX,MUV2SeedEnergyY);
-        FillHisto("MUV2_SeedEnergy_vs_ClusterEnergy",MUV2SeedEnergy, MUV2ClusterEnergy);
-        FillHisto("MUV2xvsy", MUV2Pos.X(), MUV2Pos.Y());
-        // FillHisto("MUV2_cda_x_vs_y", MUV2Pos.X() - MUV2_extrap.X(), MUV2Pos.Y() - MUV2_extrap.Y());
-        FillHisto("MUV2_trk_dist",MUV2_dtrk);
-        if(iMUV2Cand == MUV2TrackClusterIndex){continue;}
-        FillHisto("MUV2_nt_timediff", MUV2ntTime - MUV2Time);
-        FillHisto("MUV2_sc_HitMap", MUV2HorizontalChannel, MUV2VerticalChannel);
-        FillHisto("MUV2_hz_nt_chdiff", MUV2NtHorizontalChannel - MUV2HorizontalChannel);
-        FillHisto("MUV2_vt_nt_chdiff", MUV2NtVerticalChannel - MUV2VerticalChannel);
-        FillHisto("MUV2_hz_vt_chdiff", MUV2NtHorizontalChannel - MUV2HorizontalChannel, MUV2NtVerticalChannel - MUV2VerticalChannel);
-
-        if( fabs(MUV2NtHorizontalChannel - MUV2HorizontalChannel) < 4 || fabs(MUV2NtVerticalChannel - MUV2VerticalChannel) < 4 ){
-            FillHisto("MUV2_zero_distance_timediff", MUV2ntTime - MUV2Time);
         }
-    }
-
-    FillHisto("BurstID", MUV1Event->GetBurstID());
-
-    FillHisto("BeamP",BeamP.Mag());
-    FillHisto("Vertex_Z",Vertex.Z());
-    FillHisto("Vertex_Y",Vertex.Y());
-    FillHisto("Vertex_X",Vertex.X());
-    FillHisto("Vertex_cda",cda);
-
-
-    FillHisto("MUV1_Ncandidates",MUV1Event->GetNCandidates());
-    FillHisto("MUV2_Ncandidates",MUV2Event->GetNCandidates());
-    FillHisto("MUV3_Ncandidates",MUV3Event->GetNCandidates());
-    FillHisto("CHOD_Ncandidates",CHODEvent->GetNCandidates());
-    FillHisto("RICH_Ncandidates",RICHEvent->GetNCandidates());
-    FillHisto("CEDAR_Ncandidates",CedarEvent->GetNCandidates());
-    FillHisto("LKr_Ncandidates" ,LKrEvent ->GetNCandidates());
-    FillHisto("STRAW_Nchambers",STRAW_NC);
-    FillHisto("TrackChi2",STRAW_chi2);
-
-    FillHisto("TrackPfit_TrackP", STRAW_P - STRAW_Pbf);
-    FillHisto("TrackP",STRAW_P);
-    //Missing mass squared
-    FillHisto("MM2",NuNubarP.M2()*0.000001); //Converting MeV^2 to GeV^2
-    FillHisto("Track_P_vs_MM2",TrackP.Mag()*0.001, NuNubarP.M2()*0.000001); //Converting MeV^2 to GeV^2
-    FillHisto("Track_P_vs_Theta",TrackP.Mag()*0.001, TMath::ACos(theta) ); //Converting MeV^2 to GeV^2
 
+        for(int iMUV2Cand=0; iMUV2Cand < MUV2Event->GetNCandidates(); iMUV2Cand++){
+            MUV2Cluster = ((TRecoMUV2Candidate*)MUV2Event->GetCandidate(iMUV2Cand));
+            TRecoMUV2Candidate* MUV2NtCluster =((TRecoMUV2Candidate*)MUV2Event->GetCandidate(MUV2TrackClusterIndex));
+            MUV2Pos           = MUV2Cluster->GetPosition();
+            TVector2 MUV2ntPosOld     = MUV2NtCluster->GetPosition();
+            int MUV2NtVerticalChannel   = MUV2NtCluster->GetVerticalChannel();
+            int MUV2HorizontalChannel = MUV2Cluster->GetHorizontalChannel();
+            int MUV2NtHorizontalChannel = MUV2NtCluster->GetHorizontalChannel();
+            int MUV2VerticalChannel   = MUV2Cluster->GetVerticalChannel();
+            double MUV2Time          = MUV2Cluster->GetTime();
+            double MUV2ntTime        = MUV2NtCluster->GetTime();
+            double MUV2SeedEnergy    = MUV2Cluster->GetSeedEnergy();
+            double MUV2ClusterEnergy = MUV2Cluster->GetEnergy();
+            double MUV2SeedEnergyX   = MUV2Cluster->GetSeedEnergyHorizontal();
+            double MUV2SeedEnergyY   = MUV2Cluster->GetSeedEnergyVertical();
+            double MUV2_dtrk = sqrt(pow(MUV2Pos.X() - MUV2_extrap.X(),2 ) + pow(MUV2Pos.Y() - MUV2_extrap.Y(),2 ) ) ;
+
+
+
+            FillVariant("MUV2_ClusterEnergy", iVariant, MUV2ClusterEnergy);
+            FillVariant("MUV2_Eseed_over_Ecl", iVariant, MUV2SeedEnergy/MUV2ClusterEnergy);
+            FillVariant("MUV2_SeedEnergy", iVariant, MUV2SeedEnergy);
+            FillVariant("MUV2_SeedEnergy_xvsy", iVariant, MUV2SeedEnergyX,MUV2SeedEnergyY);
+            FillVariant("MUV2_SeedEnergy_vs_ClusterEnergy", iVariant, MUV2SeedEnergy, MUV2ClusterEnergy);
+            FillVariant("MUV2xvsy", iVariant, MUV2Pos.X(), MUV2Pos.Y());
+            // FillHisto("MUV2_cda_x_vs_y", MUV2Pos.X() - MUV2_extrap.X(), MUV2Pos.Y() - MUV2_extrap.Y());
+            FillVariant("MUV2_trk_dist", iVariant, MUV2_dtrk);
+            if(iMUV2Cand == MUV2TrackClusterIndex){continue;}
+            FillVariant("MUV2_nt_timediff", iVariant, MUV2ntTime - MUV2Time);
+            FillVariant("MUV2_sc_HitMap", iVariant, MUV2HorizontalChannel, MUV2VerticalChannel);
+            FillVariant("MUV2_hz_nt_chdiff", iVariant, MUV2NtHorizontalChannel - MUV2HorizontalChannel);
+            FillVariant("MUV2_vt_nt_chdiff", iVariant, MUV2NtVerticalChannel - MUV2VerticalChannel);
+            FillVariant("MUV2_hz_vt_chdiff", iVariant, MUV2NtHorizontalChannel - MUV2HorizontalChannel, MUV2NtVerticalChannel - MUV2VerticalChannel);
+
+            if( fabs(MUV2NtHorizontalChannel - MUV2HorizontalChannel) < 4 || fabs(MUV2NtVerticalChannel - MUV2VerticalChannel) < 4 ){
+                FillVariant("MUV2_zero_distance_timediff", iVariant, MUV2ntTime - MUV2Time);
+            }
+        }
 
+        //Summary histograms of the selected events, up to the end of the variant
+        StageTimer::Scope histoScope(fStageTimer, kStageHistos);
+        FillVariant("BurstID", iVariant, MUV1Event->GetBurstID());
+
+        FillVariant("BeamP", iVariant, BeamP.Mag());
+        FillVariant("Vertex_Z", iVariant, Vertex.Z());
+        FillVariant("Vertex_Y", iVariant, Vertex.Y());
+        FillVariant("Vertex_X", iVariant, Vertex.X());
+        FillVariant("Vertex_cda", iVariant, cda);
+
+
+        FillVariant("MUV1_Ncandidates", iVariant, MUV1Event->GetNCandidates());
+        FillVariant("MUV2_Ncandidates", iVariant, MUV2Event->GetNCandidates());
+        FillVariant("MUV3_Ncandidates", iVariant, MUV3Event->GetNCandidates());
+        FillVariant("CHOD_Ncandidates", iVariant, CHODEvent->GetNCandidates());
+        FillVariant("RICH_Ncandidates", iVariant, RICHEvent->GetNCandidates());
+        FillVariant("CEDAR_Ncandidates", iVariant, CedarEvent->GetNCandidates());
+        FillVariant("LKr_Ncandidates", iVariant, LKrEvent ->GetNCandidates());
+        FillVariant("STRAW_Nchambers", iVariant, STRAW_NC);
+        FillVariant("TrackChi2", iVariant, STRAW_chi2);
+
+        FillVariant("TrackPfit_TrackP", iVariant, STRAW_P - STRAW_Pbf);
+        FillVariant("TrackP", iVariant, STRAW_P);
+        //Missing mass squared
+        FillVariant("MM2", iVariant, NuNubarP.M2()*0.000001); //Converting MeV^2 to GeV^2
+        FillVariant("Track_P_vs_MM2", iVariant, TrackP.Mag()*0.001, NuNubarP.M2()*0.000001); //Converting MeV^2 to GeV^2
+        FillVariant("Track_P_vs_Theta", iVariant, TrackP.Mag()*0.001, TMath::ACos(theta) ); //Converting MeV^2 to GeV^2
+    };
+
+    StageTimer::Scope variantsScope(fStageTimer, kStageVariants);
+    for(int iVariant=0; iVariant<(int)fVariants.size(); iVariant++) selectVariant(iVariant);
 }
 
 void Kmu2::PostProcess(){
@@ -1676,7 +2060,8 @@ void Kmu2::PostProcess(){
     /// This function is called after an event has been processed by all analyzers. It could be used to free some memory allocated
     /// during the Process.
     /// \EndMemberDescr
-
+    if(fHeapCounter) fHeapCounter->EndEvent();
+    fStageTimer.EndEvent();
 }
 
 void Kmu2::EndOfBurstUser(){
@@ -1684,6 +2069,15 @@ void Kmu2::EndOfBurstUser(){
     /// This method is called when a new file is opened in the ROOT TChain (corresponding to a start/end of burst in the normal NA62 data taking) + at the end of the last file\n
     /// Do here your start/end of burst processing if any
     /// \EndMemberDescr
+    if(fTimeCalibrator) fTimeCalibrator->EndBurst(fBurstID);
+    if(fChannelT0) fChannelT0->EndBurst();
+    if(fBurstQuality) fBurstQuality->EndBurst(fBurstID);
+    if(fEfficiencyEnabled){
+        for(size_t iMap=0; iMap<fEfficiency.size(); iMap++) fEfficiency[iMap].EndBurst(fBurstID);
+    }
+    MemoryMonitor::Instance().EndBurst(fMemoryIndex, fBurstID);
+    //Snapshot taken here, written to fBurstOutput by the writer thread while the next burst is processed
+    if(fBurstWriter) fBurstWriter->Snapshot(fBurstID, GetIteratorTH1(), GetIteratorTH2());
 }
 
 void Kmu2::EndOfRunUser(){
@@ -1720,8 +2114,77 @@ void Kmu2::EndOfRunUser(){
     /// Although this is described here, Iterators can be used anywhere after the
     /// histograms have been booked.
     /// \EndMemberDescr
+    //The scheduled cuts are listed in their final order, the variants use the same bins
+    fCutFlow.SetGroup(fCutScheduler.GetOrder());
+    fCutFlow.Fill();
+    fCutFlow.Print(cout);
+    fCutScheduler.Print(cout);
+    fSelection.Print(cout);
+    for(size_t iVariant=0; iVariant<fVariantCutFlows.size(); iVariant++){
+        fVariantCutFlows[iVariant].SetGroup(fCutScheduler.GetOrder());
+        fVariantCutFlows[iVariant].Fill();
+        fVariantCutFlows[iVariant].Print(cout);
+    }
+    fCutScan.Fill();
+    if(fStageTimingEnabled){
+        fStageTimer.Fill();
+        fStageTimer.Print(cout);
+    }
+    if(fEfficiencyEnabled){
+        cout << endl << "Efficiencies (68% Clopper-Pearson intervals):" << endl;
+        for(size_t iMap=0; iMap<fEfficiency.size(); iMap++){
+            fEfficiency[iMap].Fill();
+            fEfficiency[iMap].Print(cout);
+        }
+    }
+    if(fBurstQuality){
+        fBurstQuality->Classify();
+        fBurstQuality->Print(cout);
+        if(fBurstQuality->Write(fBurstQualityFile)) cout << "Kmu2: bad burst list written to " << fBurstQualityFile << endl;
+        else cout << "Kmu2: unable to write the bad burst list to " << fBurstQualityFile << endl;
+    }
+    if(fDigiPulses){
+        fDigiPulses->FillHistos();
+        fDigiPulses->Print(cout);
+    }
+    if(fHeapCounter) fHeapCounter->Print(cout);
+    if(fChannelGain){
+        fChannelGain->Fit();
+        fChannelGain->Print(cout);
+        if(!fChannelGain->Write(fChannelGainFile)) cout << "Kmu2: unable to write the channel gains to " << fChannelGainFile << endl;
+    }
+    if(fChannelT0){
+        fChannelT0->Print(cout);
+        if(!fChannelT0->Write(fChannelT0File)) cout << "Kmu2: unable to write the channel T0 to " << fChannelT0File << endl;
+    }
+    MemoryMonitor::Instance().Report(fMemoryIndex, cout);
+    PerfCounters::Instance().Report(fPerfIndex, cout);
+    SharedEvent::Instance().Report(fSharedIndex, cout);
     SaveAllPlots();
 
+    if(fTimeCalibrator){
+        fTimeCalibrator->Print(cout);
+        if(fTimeCalibrator->Write(fTimeOffsetsFile)) cout << "Kmu2: time offsets written to " << fTimeOffsetsFile << endl;
+        else cout << "Kmu2: unable to write the time offsets to " << fTimeOffsetsFile << endl;
+        delete fTimeCalibrator;
+        fTimeCalibrator = 0;
+    }
+    delete fChannelT0;
+    fChannelT0 = 0;
+    delete fChannelGain;
+    fChannelGain = 0;
+    delete fBurstQuality;
+    fBurstQuality = 0;
+    delete fDigiPulses;
+    fDigiPulses = 0;
+    delete fHeapCounter;
+    fHeapCounter = 0;
+
+    if(fBurstWriter){
+        fBurstWriter->Finish();
+        delete fBurstWriter;
+        fBurstWriter = 0;
+    }
 }
 
 void Kmu2::DrawPlot(){
@@ -1744,87 +2207,121 @@ void Kmu2::DrawPlot(){
 TVector3 Kmu2::VertexCDA(TVector3 pos1, TVector3 p1, TVector3 pos2, TVector3 p2, Double_t &cda)
 {
     // Vertex function using CDA method.
+    return AnalysisKernels::VertexCDA(pos1, p1, pos2, p2, cda);
+}
+
+int Kmu2::FindClosestCluster(TRecoVEvent* Event, const TVector3& Extrap_track, AnalysisKernels::Detector detector, double& minimum){
 
-    TVector3 d = pos1 - pos2;
-    double p12 = p1.Dot(p2);
-    double det = p12*p12 - p1.Mag2() * p2.Mag2();
-    if (!det) return TVector3(-9999,-9999,-9999);
-    double t1 = (p2.Mag2()*d.Dot(p1) - p1.Dot(p2)*d.Dot(p2)) / det;
-    double t2 = (p1.Dot(p2)*d.Dot(p1) - p1.Mag2()*d.Dot(p2)) / det;
-    TVector3 q1 = pos1 + t1*p1;
-    TVector3 q2 = pos2 + t2*p2;
-    TVector3 vertex = 0.5*(q1 + q2);
-    cda = (q1 - q2).Mag();
-    return vertex;
+    StageTimer::Scope associationScope(fStageTimer, kStageAssociation);
+    int position = SharedEvent::Instance().FindClosestCluster(Event, Extrap_track, detector, minimum);
+    LOG_DEBUG(AnalysisKernels::GetDetectorName(detector) << ": " << Event->GetNCandidates() << " candidates");
+    if(position > -1) LOG_DEBUG(AnalysisKernels::GetDetectorName(detector) << ": closest candidate " << position << " at " << minimum << " mm");
+    return position;
 
 }
 
-int Kmu2::FindClosestCluster( TRecoVEvent* Event, TVector3 Extrap_track, string detector_type, double& minimum){
-
-    std::vector<double> dtrkcl;
-    //std::vector<int>    clindex;
-    std::vector<double>::iterator VIterator;
-    int position= -1;
-    for (int iCand=0; iCand < Event->GetNCandidates(); iCand++){
-        if(detector_type == "LKr"){
-            TRecoLKrCandidate* Cluster = ((TRecoLKrCandidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetClusterX();
-            double clustery = Cluster->GetClusterY();
-            double distance = sqrt(pow(clusterx*10. - Extrap_track.X(),2 ) + pow(clustery*10. - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV1"){
-            TRecoMUV1Candidate* Cluster = ((TRecoMUV1Candidate*)Event->GetCandidate(iCand));
-            //Old Reco
-            //double clusterx = Cluster->GetPosition().X()+ 60;
-            //double clustery = Cluster->GetPosition().Y()+ 60;
-            //New Reco
-            double clusterx = Cluster->GetPosition().X();
-            double clustery = Cluster->GetPosition().Y();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV2"){
-            TRecoMUV2Candidate* Cluster = ((TRecoMUV2Candidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetPosition().X();
-            double clustery = Cluster->GetPosition().Y();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV3"){
-            TRecoMUV3Candidate* Cluster = ((TRecoMUV3Candidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetX();
-            double clustery = Cluster->GetY();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "CHOD"){
-            TRecoCHODCandidate* Cluster = ((TRecoCHODCandidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetHitPosition().X();
-            double clustery = Cluster->GetHitPosition().Y();
-            double distance = sqrt(pow(clusterx*10. - Extrap_track.X(),2 ) + pow(clustery*10. - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
+void Kmu2::BookVariantHisto(TH1* histo){
+    /// \MemberDescr
+    /// \param histo : histogram filled by the selection of every configuration variant
+    ///
+    /// Books the histogram of the nominal configuration. StartOfRunUser books one copy with the
+    /// _vK suffix per variant and FillVariant() fills the copy of the variant.
+    /// \EndMemberDescr
+    BookHisto(histo);
+    //Keyed on the name owned by the histogram: the lookups need no TString
+    fVariantHistos[histo->GetName()] = vector<TH1*>(1, histo);
+}
 
+void Kmu2::BookVariantHisto(TH1* histo, TString directory){
+    /// \MemberDescr
+    /// \param histo : histogram filled by the selection of every configuration variant
+    /// \param directory : output directory of the histogram and of its _vK copies
+    /// \EndMemberDescr
+    BookHisto(histo, directory);
+    fVariantHistos[histo->GetName()] = vector<TH1*>(1, histo);
+    fVariantDirectories[histo->GetName()] = directory;
+}
+
+void Kmu2::FillVariant(const char* name, int iVariant, double x){
+    /// \MemberDescr
+    /// \param name : name of the histogram of the nominal configuration (BookVariantHisto)
+    /// \param iVariant : index of the configuration variant, 0 for the nominal one
+    /// \param x : value
+    /// \EndMemberDescr
+    VariantHistoTable::iterator it = fVariantHistos.find(name);
+    if(it==fVariantHistos.end()){
+        cerr << "Kmu2: " << name << " is not booked with BookVariantHisto" << endl;
+        return;
     }
-    //Debugging!!!
-    //cout << " Event -----" << detector_type.data() << endl;
-    //for ( VIterator = dtrkcl.begin() ; VIterator != dtrkcl.end(); VIterator++ ){
-    //    cout << *VIterator << endl;
-    //}
-    //
-    if(dtrkcl.size() !=0){
-        minimum= *min_element(dtrkcl.begin(), dtrkcl.end());
-        position = distance(dtrkcl.begin(), min_element(dtrkcl.begin(), dtrkcl.end()));
-        dtrkcl.clear();
-        //    cout << " Minimum = " << minimum << endl;
-        //    cout << "Index of minimum = " << position << endl;
-
-        //cout << "WOWW == " <<  clindex(min_element(dtrkcl.begin(), dtrkcl.end())) << endl;
-        //cout << " Event OVER-----" << detector_type.data() << endl;
-        //cout << minimum << endl;
+    it->second[iVariant]->Fill(x);
+}
 
+void Kmu2::FillVariant(const char* name, int iVariant, double x, double y){
+    /// \MemberDescr
+    /// \param name : name of the histogram of the nominal configuration (BookVariantHisto)
+    /// \param iVariant : index of the configuration variant, 0 for the nominal one
+    /// \param x : value (x for a TH2)
+    /// \param y : weight (y for a TH2)
+    /// \EndMemberDescr
+    VariantHistoTable::iterator it = fVariantHistos.find(name);
+    if(it==fVariantHistos.end()){
+        cerr << "Kmu2: " << name << " is not booked with BookVariantHisto" << endl;
+        return;
     }
-    return position;
+    it->second[iVariant]->Fill(x, y);
+}
 
+bool Kmu2::ReadVariants(TString fileName){
+    /// \MemberDescr
+    /// \param fileName : file declaring the configuration variants
+    /// \return true if at least one variant was declared
+    ///
+    /// One variant per line, made of "name value" pairs overriding the nominal configuration,
+    /// e.g. the old and Gia's offsets:
+    /// \code
+    /// LKrOffset 112.3 MUV1Offset -8.5 MUV2Offset -20.4 MUV3Offset -11.35
+    /// LKrOffset 121.2 CedarOffset 6.23 MUV1Offset 6.08 MUV2Offset 5.59 MUV3Offset -2.75
+    /// \endcode
+    /// Names are the TimeConfig members without the f (LKrOffset ... CedarOffsetCut). Lines starting
+    /// with # are ignored. The histograms of the variant K (first line: 1) have the _vK suffix.
+    /// \EndMemberDescr
+    ifstream in(fileName.Data());
+    if(!in.is_open()){
+        cerr << "Kmu2: unable to open the variants file " << fileName << endl;
+        return false;
+    }
+    string line;
+    while(getline(in, line)){
+        if(line.empty() || line[0]=='#') continue;
+        istringstream fields(line);
+        TimeConfig config = fVariants[0];
+        string name;
+        double value;
+        bool valid = true;
+        int nValues = 0;
+        while(fields >> name >> value){
+            double* member = 0;
+            if(name=="LKrOffset")           member = &config.fLKrOffset;
+            else if(name=="CedarOffset")    member = &config.fCedarOffset;
+            else if(name=="MUV1Offset")     member = &config.fMUV1Offset;
+            else if(name=="MUV2Offset")     member = &config.fMUV2Offset;
+            else if(name=="MUV3Offset")     member = &config.fMUV3Offset;
+            else if(name=="LKrOffsetCut")   member = &config.fLKrOffsetCut;
+            else if(name=="RICHOffsetCut")  member = &config.fRICHOffsetCut;
+            else if(name=="MUV1OffsetCut")  member = &config.fMUV1OffsetCut;
+            else if(name=="MUV2OffsetCut")  member = &config.fMUV2OffsetCut;
+            else if(name=="MUV3OffsetCut")  member = &config.fMUV3OffsetCut;
+            else if(name=="CedarOffsetCut") member = &config.fCedarOffsetCut;
+            if(!member){
+                cerr << "Kmu2: unknown variant parameter " << name << ", line ignored: " << line << endl;
+                valid = false;
+                break;
+            }
+            *member = value;
+            nValues++;
+        }
+        if(valid && nValues>0) fVariants.push_back(config);
+    }
+    cout << "Kmu2: " << fVariants.size()-1 << " configuration variants read from " << fileName << endl;
+    return fVariants.size()>1;
 }
@@ -7,6 +7,13 @@
 #include "Event.hh"
 #include "Persistency.hh"
 #include "Definition.h"
+#include "Logger.hh"
+#include "AsyncHistoWriter.hh"
+#include "HeapCounter.hh"
+#include "MemoryMonitor.hh"
+#include "PerfCounters.hh"
+#include "SharedEvent.hh"
+#include "AnalysisKernels.hh"
 #include "MUV1Geometry.hh"
 #include "MUV2Geometry.hh"
 #include "TRecoVCandidate.hh"
@@ -57,7 +64,7 @@ using namespace NA62Constants;
 ///
 /// \EndDetailed
 
-OneTrack::OneTrack(Core::BaseAnalysis *ba) : Analyzer(ba, "OneTrack")
+OneTrack::OneTrack(Core::BaseAnalysis *ba) : Analyzer(ba, "OneTrack"), fCutFlow("OneTrack"), fHeapCounter(0), fBurstWriter(0), fBurstID(-1)
 {
     /// \MemberDescr
     /// \param ba : parent BaseAnalysis
@@ -95,6 +102,21 @@ OneTrack::OneTrack(Core::BaseAnalysis *ba) : Analyzer(ba, "OneTrack")
     RequestTree("RICH",new TRecoRICHEvent);
     RequestTree("CHOD",new TRecoCHODEvent);
     RequestTree("Cedar",new TRecoCedarEvent);
+    fMemoryIndex = MemoryMonitor::Instance().AddAnalyzer("OneTrack");
+    fPerfIndex = PerfCounters::Instance().AddAnalyzer("OneTrack");
+    fSharedIndex = SharedEvent::Instance().AddAnalyzer("OneTrack");
+
+    fCutFlow.AddCut(kSTRAWNCandidates, "STRAW_NCandidates");
+    fCutFlow.AddCut(kTrackCharge     , "Track_charge");
+    fCutFlow.AddCut(kSTRAWChi2       , "STRAW_chi2");
+    fCutFlow.AddCut(kSTRAWNChambers  , "STRAW_NChambers");
+    fCutFlow.AddCut(kCedarNCandidates, "Cedar_NCandidates");
+    fCutFlow.AddCut(kCedarNSectors   , "Cedar_NSectors");
+    fCutFlow.AddCut(kCDA             , "cda");
+    fCutFlow.AddCut(kVertexZ         , "Vertex_Z");
+    fCutFlow.AddCut(kLKrEnergy       , "LKr_energy");
+    fCutFlow.AddCut(kLKrNGammas      , "LKr_NGammas");
+    fCutFlow.AddCut(kCHODAssociation , "CHOD_association");
 
 
 
@@ -143,6 +165,10 @@ void OneTrack::InitOutput(){
     ///     CreateStandardTree("TTreeName", "TTreeTitle");
     /// \endcode
     /// \EndMemberDescr
+    //Path of the file receiving the per burst histogram snapshots (empty: disabled)
+    AddParam("BurstOutput", &fBurstOutput, "");
+    //Heap allocations per event of the analyzers, after the first 100 events (build with -DHEAP_COUNTER=ON)
+    AddParam("HeapCount", &fHeapCountEnabled, false);
 }
 
 void OneTrack::InitHist(){
@@ -167,6 +193,11 @@ void OneTrack::InitHist(){
     BookHisto(new TH1F("CHOD_nearest_track_dtrkcl", "Distance beteen extrapolated track and position in the CHOD for the closest track;CHOD_trkd [mm] ", 150, 0., 300.));
     BookHisto(new TH2F("CHOD_nearest_track_x_vs_y", "CHOD candidate x vs y ; x[mm];y[mm]", 520, -1300., 1300., 520, -1300., 1300.));
     BookHisto(new TH2F("CHOD_extrap_x_vs_y", "CHOD extrapolated track x vs y ; x[mm];y[mm]", 260, -1300., 1300., 260, -1300., 1300.));
+
+    //Cut flow
+    vector<TH1D*> cutFlowHistos;
+    fCutFlow.BookHistos(cutFlowHistos);
+    for(size_t iHisto=0; iHisto<cutFlowHistos.size(); iHisto++) BookHisto(cutFlowHistos[iHisto]);
 }
 
 void OneTrack::DefineMCSimple(){
@@ -197,6 +228,17 @@ void OneTrack::StartOfRunUser(){
     /// This method is called at the beginning of the processing (corresponding to a start of run in the normal NA62 data taking)\n
     /// Do here your start of run processing if any
     /// \EndMemberDescr
+    if(fBurstOutput.Length()>0) fBurstWriter = new AsyncHistoWriter(fBurstOutput);
+    if(fHeapCountEnabled){
+        fHeapCounter = new HeapCounter("OneTrack");
+        vector<TH1*> heapHistos;
+        fHeapCounter->BookHistos(heapHistos);
+        for(size_t iHisto=0; iHisto<heapHistos.size(); iHisto++) BookHisto(heapHistos[iHisto]);
+    }
+
+    //Size of the histograms booked so far, then the report histograms of all the analyzers (first analyzer only, in AllAnalyzers/)
+    MemoryMonitor::Instance().BookInto(fMemoryIndex, this);
+    PerfCounters::Instance().BookInto(fPerfIndex, this);
 }
 
 void OneTrack::StartOfBurstUser(){
@@ -207,6 +249,10 @@ void OneTrack::StartOfBurstUser(){
 }
 
 void OneTrack::Process(int iEvent){
+    MemoryMonitor::ProcessScope memoryScope(fMemoryIndex);
+    PerfCounters::Scope perfScope(fPerfIndex);
+    SharedEvent::Instance().BeginEvent(fSharedIndex);
+    if(fHeapCounter) fHeapCounter->StartEvent();
 
     //if(fMCSimple.fStatus == MCSimple::kMissing){printIncompleteMCWarning(iEvent);return;}
     //if(fMCSimple.fStatus == MCSimple::kEmpty){printNoMCWarning();return;}
@@ -219,6 +265,9 @@ void OneTrack::Process(int iEvent){
     TRecoRICHEvent *RICHEvent = (TRecoRICHEvent*)GetEvent("RICH");
     TRecoCHODEvent *CHODEvent = (TRecoCHODEvent*)GetEvent("CHOD");
     TRecoCedarEvent *CedarEvent = (TRecoCedarEvent*)GetEvent("Cedar");
+
+    fBurstID = SpectrometerEvent->GetBurstID();
+    CUTFLOW_START(fCutFlow);
     //Time Offset for all the detectors differences (ATM using only CHOD as reference)
     double LKrOffset   = +115; //Old 112.3 Use GetClusterTime
     double CedarOffset = 0; //old 0
@@ -241,7 +290,7 @@ void OneTrack::Process(int iEvent){
 
     //CUTComment:: Only one candidate in the STRAW
     FillHisto("STRAW_NCandidates", SpectrometerEvent->GetNCandidates());
-    if(SpectrometerEvent->GetNCandidates() != 1 )return;
+    if(CUTFLOW_REJECT(fCutFlow, kSTRAWNCandidates, SpectrometerEvent->GetNCandidates() != 1))return;
 
     TRecoSpectrometerCandidate* Track;
     Track = ((TRecoSpectrometerCandidate*)SpectrometerEvent->GetCandidate(0));
@@ -269,18 +318,21 @@ void OneTrack::Process(int iEvent){
     //3. Number of STRAW chambers fired has to be >= 3
     //4. At least one Cedar candidate
     //5. Cedar sectors > 5
-    if(Track->GetCharge() != 1){ return;}
+    if(CUTFLOW_REJECT(fCutFlow, kTrackCharge, Track->GetCharge() != 1)){ return;}
 
-    if( STRAW_chi2 > 20 || STRAW_NC   < 3 ){ return; }
+    if(CUTFLOW_REJECT(fCutFlow, kSTRAWChi2, STRAW_chi2 > 20)){ return; }
+    if(CUTFLOW_REJECT(fCutFlow, kSTRAWNChambers, STRAW_NC < 3)){ return; }
 
 
-    if( CedarEvent->GetNCandidates() == 0 ){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kCedarNCandidates, CedarEvent->GetNCandidates() == 0)){return;}
+    bool CedarFewSectors = false;
     for(int iCedarCand=0; iCedarCand < CedarEvent->GetNCandidates(); iCedarCand++){
 
         TRecoCedarCandidate*  CedarCandidate = ((TRecoCedarCandidate*)CedarEvent->GetCandidate(iCedarCand));
-        if(CedarCandidate->GetNSectors() < 5 ){return;}
+        if(CedarCandidate->GetNSectors() < 5 ){CedarFewSectors = true; break;}
 
     }
+    if(CUTFLOW_REJECT(fCutFlow, kCedarNSectors, CedarFewSectors)){return;}
 
 
 
@@ -317,8 +369,8 @@ void OneTrack::Process(int iEvent){
     //CUTComment:: Cut Stage 1
     //6.Closest Approached Distance > 40.
     //7.Zvtx to be incide of the fiducial volume of NA62 detector (105 - 180 m)
-    if(cda > 40.){return;}
-    if( Vertex.Z() < 105000 || Vertex.Z() > 180000){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kCDA, cda > 40.)){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kVertexZ, Vertex.Z() < 105000 || Vertex.Z() > 180000)){return;}
 
     //Computing the NuNubar 3vector (Missing mass)
     TVector3 NuNubar;
@@ -367,35 +419,21 @@ void OneTrack::Process(int iEvent){
     double MUV1dtrkcl_min;
     double MUV2dtrkcl_min;
     double MUV3dtrkcl_min;
-    vector <double> CEDAR_STRAW_tdiff;
-    int CHODClosestTrackIndex = FindClosestCluster(CHODEvent, CHOD_extrap, "CHOD" , CHODdtrkcl_min);
-    int LKrTrackClusterIndex  = FindClosestCluster(LKrEvent , LKr_extrap , "LKr"  , LKrdtrkcl_min);
-    int MUV1TrackClusterIndex = FindClosestCluster(MUV1Event, MUV1_extrap, "MUV1" , MUV1dtrkcl_min);
-    int MUV2TrackClusterIndex = FindClosestCluster(MUV2Event, MUV2_extrap, "MUV2" , MUV2dtrkcl_min);
-    int MUV3TrackClusterIndex = FindClosestCluster(MUV3Event, MUV3_extrap, "MUV3" , MUV3dtrkcl_min);
+    int CHODClosestTrackIndex = FindClosestCluster(CHODEvent, CHOD_extrap, AnalysisKernels::kCHOD , CHODdtrkcl_min);
+    int LKrTrackClusterIndex  = FindClosestCluster(LKrEvent , LKr_extrap , AnalysisKernels::kLKr  , LKrdtrkcl_min);
+    int MUV1TrackClusterIndex = FindClosestCluster(MUV1Event, MUV1_extrap, AnalysisKernels::kMUV1 , MUV1dtrkcl_min);
+    int MUV2TrackClusterIndex = FindClosestCluster(MUV2Event, MUV2_extrap, AnalysisKernels::kMUV2 , MUV2dtrkcl_min);
+    int MUV3TrackClusterIndex = FindClosestCluster(MUV3Event, MUV3_extrap, AnalysisKernels::kMUV3 , MUV3dtrkcl_min);
 
 
 
     //Energy scale correction and non-linearity correction for the LKr taken from Giuseppe
-    Double_t fEScale = 1.03;
-    for(int iLKrCand=0; iLKrCand<LKrEvent->GetNCandidates(); iLKrCand++){
-        TRecoLKrCandidate* LKrCluster = ((TRecoLKrCandidate*)LKrEvent->GetCandidate(iLKrCand));
+    //In place, once per event whatever the number of analyzers
+    SharedEvent::Instance().CorrectLKrEnergies(LKrEvent);
 
-        // ZS non linearity
-        Double_t ue = LKrCluster->GetClusterEnergy();
-        Double_t ce = ue;
-        if (LKrCluster->GetNCells()>9) {
-            if (ue<22) ce = ue/(0.7666+0.0573489*log(ue));
-            if (ue>=22 && ue<65) ce = ue/(0.828962+0.0369797*log(ue));
-            if (ue>=65) ce = ue/(0.828962+0.0369797*log(65));
-        }
-
-        LKrCluster->SetClusterEnergy(ce*fEScale);
-
-    }
-
-    //map that will contain the gamma`s`
-    map<string, int> gammas;
+    //map that will contain the gamma`s`, keyed on the gamma number: no string built per event
+    ArenaMap<int, int> gammas(fArena);
+    bool LKrLowEnergy = false;
 
     for(int iLKrCand=0; iLKrCand<LKrEvent->GetNCandidates(); iLKrCand++){
 
@@ -426,7 +464,7 @@ void OneTrack::Process(int iEvent){
             //if(LKrClusterEnergy < 300 ){return;}
             //if(LKrCluster->GetNCells()>5 ) { return;} //  [MeV]
             //CUTComment:: Only high energy deposition in the LKr
-            if(LKrClusterEnergy < 1500 ) { return;} //  [MeV]
+            if(LKrClusterEnergy < 1500 ) { LKrLowEnergy = true; break;} //  [MeV]
 
         }
 
@@ -439,23 +477,24 @@ void OneTrack::Process(int iEvent){
                 //cout << gammas.size() << endl;
                 if( gammas.size() == 0 ){
 
-                    gammas["g1"] = iLKrCand;
-                    //cout << "G1 Before == " << gammas["g1"] << "iLKrcand" << iLKrCand << endl;
+                    gammas[1] = iLKrCand;
+                    //cout << "G1 Before == " << gammas[1] << "iLKrcand" << iLKrCand << endl;
                 } else if( gammas.size()==1 ){
-                    gammas["g2"] = iLKrCand;
-                    //cout << "G1 == " << gammas["g1"] << "G2 == " << gammas["g2"] << "iLkrcand == " << iLKrCand << endl;
+                    gammas[2] = iLKrCand;
+                    //cout << "G1 == " << gammas[1] << "G2 == " << gammas[2] << "iLkrcand == " << iLKrCand << endl;
                 } else if( gammas.size()==2 ){
-                    gammas["g3"] = iLKrCand;
-                    cout << "G1 == " << gammas["g1"] << "G2 == " << gammas["g2"]<< "G3 == " << gammas["g3"] <<  endl;
+                    gammas[3] = iLKrCand;
+                    LOG_DEBUG("G1 == " << gammas[1] << " G2 == " << gammas[2] << " G3 == " << gammas[3]);
                 }
             }
 
         }
 
     }
-    if(gammas.size() < 2 ){ return;}
+    if(CUTFLOW_REJECT(fCutFlow, kLKrEnergy, LKrLowEnergy)){ return;}
+    if(CUTFLOW_REJECT(fCutFlow, kLKrNGammas, gammas.size() < 2)){ return;}
 
-    if(CHODClosestTrackIndex < 0. ){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kCHODAssociation, CHODClosestTrackIndex < 0.)){return;}
 
     TVector2 CD_CHODPos   = ((TRecoCHODCandidate*)CHODEvent->GetCandidate(CHODClosestTrackIndex))->GetHitPosition();
     FillHisto("CHOD_cda_x_vs_y", CD_CHODPos.X()*10. - CHOD_extrap.X() , CD_CHODPos.Y()*10. - CHOD_extrap.Y());
@@ -472,7 +511,8 @@ void OneTrack::PostProcess(){
     /// This function is called after an event has been processed by all analyzers. It could be used to free some memory allocated
     /// during the Process.
     /// \EndMemberDescr
-
+    if(fHeapCounter) fHeapCounter->EndEvent();
+    fArena.Reset();
 }
 
 void OneTrack::EndOfBurstUser(){
@@ -480,6 +520,9 @@ void OneTrack::EndOfBurstUser(){
     /// This method is called when a new file is opened in the ROOT TChain (corresponding to a start/end of burst in the normal NA62 data taking) + at the end of the last file\n
     /// Do here your start/end of burst processing if any
     /// \EndMemberDescr
+    MemoryMonitor::Instance().EndBurst(fMemoryIndex, fBurstID);
+    //Snapshot taken here, written to fBurstOutput by the writer thread while the next burst is processed
+    if(fBurstWriter) fBurstWriter->Snapshot(fBurstID, GetIteratorTH1(), GetIteratorTH2());
 }
 
 void OneTrack::EndOfRunUser(){
@@ -518,7 +561,25 @@ void OneTrack::EndOfRunUser(){
     /// histograms have been booked.
     /// \EndMemberDescr
 
+    fCutFlow.Fill();
+    fCutFlow.Print(cout);
+    MemoryMonitor::Instance().Report(fMemoryIndex, cout);
+    PerfCounters::Instance().Report(fPerfIndex, cout);
+    SharedEvent::Instance().Report(fSharedIndex, cout);
+    if(fHeapCounter){
+        fHeapCounter->Print(cout);
+        cout << "  event arena: " << fArena.GetHighWater() << " bytes at most, " << fArena.GetNBlockAllocations() << " block allocations" << endl;
+    }
     SaveAllPlots();
+
+    delete fHeapCounter;
+    fHeapCounter = 0;
+
+    if(fBurstWriter){
+        fBurstWriter->Finish();
+        delete fBurstWriter;
+        fBurstWriter = 0;
+    }
 }
 
 void OneTrack::DrawPlot(){
@@ -542,87 +603,14 @@ void OneTrack::DrawPlot(){
 TVector3 OneTrack::VertexCDA(TVector3 pos1, TVector3 p1, TVector3 pos2, TVector3 p2, Double_t &cda)
 {
     // Vertex function using CDA method.
-
-    TVector3 d = pos1 - pos2;
-    double p12 = p1.Dot(p2);
-    double det = p12*p12 - p1.Mag2() * p2.Mag2();
-    if (!det) return TVector3(-9999,-9999,-9999);
-    double t1 = (p2.Mag2()*d.Dot(p1) - p1.Dot(p2)*d.Dot(p2)) / det;
-    double t2 = (p1.Dot(p2)*d.Dot(p1) - p1.Mag2()*d.Dot(p2)) / det;
-    TVector3 q1 = pos1 + t1*p1;
-    TVector3 q2 = pos2 + t2*p2;
-    TVector3 vertex = 0.5*(q1 + q2);
-    cda = (q1 - q2).Mag();
-    return vertex;
-
+    return AnalysisKernels::VertexCDA(pos1, p1, pos2, p2, cda);
 }
 
-int OneTrack::FindClosestCluster( TRecoVEvent* Event, TVector3 Extrap_track, string detector_type, double& minimum){
-
-    std::vector<double> dtrkcl;
-    //std::vector<int>    clindex;
-    std::vector<double>::iterator VIterator;
-    int position= -1;
-    for (int iCand=0; iCand < Event->GetNCandidates(); iCand++){
-        if(detector_type == "LKr"){
-            TRecoLKrCandidate* Cluster = ((TRecoLKrCandidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetClusterX();
-            double clustery = Cluster->GetClusterY();
-            double distance = sqrt(pow(clusterx*10. - Extrap_track.X(),2 ) + pow(clustery*10. - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV1"){
-            TRecoMUV1Candidate* Cluster = ((TRecoMUV1Candidate*)Event->GetCandidate(iCand));
-            //Old Reco
-            //double clusterx = Cluster->GetPosition().X()+ 60;
-            //double clustery = Cluster->GetPosition().Y()+ 60;
-            //New Reco
-            double clusterx = Cluster->GetPosition().X();
-            double clustery = Cluster->GetPosition().Y();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV2"){
-            TRecoMUV2Candidate* Cluster = ((TRecoMUV2Candidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetPosition().X();
-            double clustery = Cluster->GetPosition().Y();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV3"){
-            TRecoMUV3Candidate* Cluster = ((TRecoMUV3Candidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetX();
-            double clustery = Cluster->GetY();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "CHOD"){
-            TRecoCHODCandidate* Cluster = ((TRecoCHODCandidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetHitPosition().X();
-            double clustery = Cluster->GetHitPosition().Y();
-            double distance = sqrt(pow(clusterx*10. - Extrap_track.X(),2 ) + pow(clustery*10. - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
+int OneTrack::FindClosestCluster(TRecoVEvent* Event, const TVector3& Extrap_track, AnalysisKernels::Detector detector, double& minimum){
 
-    }
-    //Debugging!!!
-    //cout << " Event -----" << detector_type.data() << endl;
-    //for ( VIterator = dtrkcl.begin() ; VIterator != dtrkcl.end(); VIterator++ ){
-    //    cout << *VIterator << endl;
-    //}
-    //
-    if(dtrkcl.size() !=0){
-        minimum= *min_element(dtrkcl.begin(), dtrkcl.end());
-        position = distance(dtrkcl.begin(), min_element(dtrkcl.begin(), dtrkcl.end()));
-        dtrkcl.clear();
-        //    cout << " Minimum = " << minimum << endl;
-        //    cout << "Index of minimum = " << position << endl;
-
-        //cout << "WOWW == " <<  clindex(min_element(dtrkcl.begin(), dtrkcl.end())) << endl;
-        //cout << " Event OVER-----" << detector_type.data() << endl;
-        //cout << minimum << endl;
-
-    }
+    int position = SharedEvent::Instance().FindClosestCluster(Event, Extrap_track, detector, minimum);
+    LOG_DEBUG(AnalysisKernels::GetDetectorName(detector) << ": " << Event->GetNCandidates() << " candidates");
+    if(position > -1) LOG_DEBUG(AnalysisKernels::GetDetectorName(detector) << ": closest candidate " << position << " at " << minimum << " mm");
     return position;
 
 }
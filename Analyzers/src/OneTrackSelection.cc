@@ -8,13 +8,20 @@
 #include "Persistency.hh"
 #include "TRecoVEvent.hh"
 #include "Definition.h"
+#include "Logger.hh"
+#include "AsyncHistoWriter.hh"
+#include "HeapCounter.hh"
+#include "MemoryMonitor.hh"
+#include "PerfCounters.hh"
+#include "SharedEvent.hh"
+#include "AnalysisKernels.hh"
 
 using namespace std;
 using namespace NA62Analysis;
 using namespace NA62Constants;
 
 
-OneTrackSelection::OneTrackSelection(Core::BaseAnalysis *ba) : Analyzer(ba, "OneTrackSelection")
+OneTrackSelection::OneTrackSelection(Core::BaseAnalysis *ba) : Analyzer(ba, "OneTrackSelection"), fCutFlow("OneTrackSelection"), fCutScan("OneTrackSelection"), fHeapCounter(0), fBurstWriter(0), fBurstID(-1)
 {
 
     RequestTree("LKr",new TRecoLKrEvent);
@@ -25,27 +32,91 @@ OneTrackSelection::OneTrackSelection(Core::BaseAnalysis *ba) : Analyzer(ba, "One
     RequestTree("RICH",new TRecoRICHEvent);
     RequestTree("CHOD",new TRecoCHODEvent);
     RequestTree("Cedar",new TRecoCedarEvent);
-
+    fMemoryIndex = MemoryMonitor::Instance().AddAnalyzer("OneTrackSelection");
+    fPerfIndex = PerfCounters::Instance().AddAnalyzer("OneTrackSelection");
+    fSharedIndex = SharedEvent::Instance().AddAnalyzer("OneTrackSelection");
+
+    fCutFlow.AddCut(kSTRAWNCandidates, "STRAW_NCandidates");
+    fCutFlow.AddCut(kTrackCharge     , "Track_charge");
+    fCutFlow.AddCut(kSTRAWChi2       , "STRAW_chi2");
+    fCutFlow.AddCut(kSTRAWNChambers  , "STRAW_NChambers");
+    fCutFlow.AddCut(kCedarNCandidates, "Cedar_NCandidates");
+    fCutFlow.AddCut(kCedarNSectors   , "Cedar_NSectors");
+    fCutFlow.AddCut(kCHODAssociation , "CHOD_association");
+    fCutFlow.AddCut(kCHODDistance    , "CHOD_dtrkcl");
+    fCutFlow.AddCut(kCHODAcceptance  , "CHOD_acceptance");
+    fCutFlow.AddCut(kCedarTime       , "Cedar_time");
+    fCutFlow.AddCut(kLKrAcceptance   , "LKr_acceptance");
+    fCutFlow.AddCut(kLKrDistance     , "LKr_dtrkcl");
+    fCutFlow.AddCut(kLKrDeadCell     , "LKr_DDeadCell");
+    fCutFlow.AddCut(kLKrTime         , "LKr_time");
+    fCutFlow.AddCut(kMUV1Acceptance  , "MUV1_acceptance");
+    fCutFlow.AddCut(kMUV1Window      , "MUV1_window");
+    fCutFlow.AddCut(kMUV1Time        , "MUV1_time");
+    fCutFlow.AddCut(kMUV2Acceptance  , "MUV2_acceptance");
+    fCutFlow.AddCut(kMUV2Window      , "MUV2_window");
+    fCutFlow.AddCut(kMUV2Time        , "MUV2_time");
+    fCutFlow.AddCut(kMUV3Acceptance  , "MUV3_acceptance");
+    fCutFlow.AddCut(kMUV3Window      , "MUV3_window");
+    fCutFlow.AddCut(kMUV3Time        , "MUV3_time");
+
+    //Scanned variables, binned finely enough to place the cut anywhere in the range
+    fCutScan.AddCut(kScanSTRAWChi2   , "STRAW_chi2" , 1000, 0., 100.);
+    fCutScan.AddCut(kScanCHODDistance, "CHOD_dtrkcl", 800 , 0., 400.);
+    fCutScan.AddCut(kScanMUV1Window  , "MUV1_window", 1200, 0., 600.);
+    fCutScan.AddCut(kScanMUV2Window  , "MUV2_window", 1200, 0., 600.);
 
 }
 
 void OneTrackSelection::InitOutput(){
+    //Path of the file receiving the per burst histogram snapshots (empty: disabled)
+    AddParam("BurstOutput", &fBurstOutput, "");
+    //Heap allocations per event of the analyzers, after the first 100 events (build with -DHEAP_COUNTER=ON)
+    AddParam("HeapCount", &fHeapCountEnabled, false);
+    //N-1 distributions and efficiency curves of the scanned cuts in a single pass
+    AddParam("CutScan", &fCutScanEnabled, false);
 }
 
 void OneTrackSelection::InitHist(){
     BookHisto(new TH1F("CEDAR_timediff"," CEDAR_{time} - CHOD_{time} ; CEDAR_{time}- CHOD_{time} [ns]", 400, -100, 100.));
+
+    vector<TH1D*> cutFlowHistos;
+    fCutFlow.BookHistos(cutFlowHistos);
+    for(size_t iHisto=0; iHisto<cutFlowHistos.size(); iHisto++) BookHisto(cutFlowHistos[iHisto]);
 }
 
 void OneTrackSelection::DefineMCSimple(){
 }
 
 void OneTrackSelection::StartOfRunUser(){
+    if(fBurstOutput.Length()>0) fBurstWriter = new AsyncHistoWriter(fBurstOutput);
+    if(fHeapCountEnabled){
+        fHeapCounter = new HeapCounter("OneTrackSelection");
+        vector<TH1*> heapHistos;
+        fHeapCounter->BookHistos(heapHistos);
+        for(size_t iHisto=0; iHisto<heapHistos.size(); iHisto++) BookHisto(heapHistos[iHisto]);
+    }
+
+    fCutScan.SetEnabled(fCutScanEnabled);
+    if(fCutScanEnabled){
+        vector<TH1D*> cutScanHistos;
+        fCutScan.BookHistos(cutScanHistos);
+        for(size_t iHisto=0; iHisto<cutScanHistos.size(); iHisto++) BookHisto(cutScanHistos[iHisto]);
+    }
+
+    //Size of the histograms booked so far, then the report histograms of all the analyzers (first analyzer only, in AllAnalyzers/)
+    MemoryMonitor::Instance().BookInto(fMemoryIndex, this);
+    PerfCounters::Instance().BookInto(fPerfIndex, this);
 }
 
 void OneTrackSelection::StartOfBurstUser(){
 }
 
 void OneTrackSelection::Process(int iEvent){
+    MemoryMonitor::ProcessScope memoryScope(fMemoryIndex);
+    PerfCounters::Scope perfScope(fPerfIndex);
+    SharedEvent::Instance().BeginEvent(fSharedIndex);
+    if(fHeapCounter) fHeapCounter->StartEvent();
 //    if(fMCSimple.fStatus == MCSimple::kMissing){printIncompleteMCWarning(iEvent);return;}
 //    if(fMCSimple.fStatus == MCSimple::kEmpty){printNoMCWarning();return;}
 
@@ -58,13 +129,17 @@ void OneTrackSelection::Process(int iEvent){
     TRecoCHODEvent *CHODEvent = (TRecoCHODEvent*)GetEvent("CHOD");
     TRecoCedarEvent *CedarEvent = (TRecoCedarEvent*)GetEvent("Cedar");
 
+    fBurstID = SpectrometerEvent->GetBurstID();
+    CUTFLOW_START(fCutFlow);
+    fCutScan.StartEvent();
+
     //CUTComment:: Only one candidate in the STRAW
-    if(SpectrometerEvent->GetNCandidates() != 1 ){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kSTRAWNCandidates, SpectrometerEvent->GetNCandidates() != 1)){return;}
 
     TRecoSpectrometerCandidate* Track = ((TRecoSpectrometerCandidate*)SpectrometerEvent->GetCandidate(0));
 
     //CUTComment:: Check if track is positive (K+ beam in NA62)
-    if(Track->GetCharge() != 1){ return;}
+    if(CUTFLOW_REJECT(fCutFlow, kTrackCharge, Track->GetCharge() != 1)){ return;}
     //cout << "MUV L0 trig == " << CHODEvent->GetL0TriggerType() << "STRAW L0 trig == " << MUV3Event->GetTriggerType() << endl;
 
     //Comment:: All necessary STRAW variables are defined here
@@ -79,20 +154,22 @@ void OneTrackSelection::Process(int iEvent){
 
     //CUTComment:: Check if the the chi2 of the track fitter in the straw is >20
     // and if there are at least 3 chambers fired
-    if(STRAW_chi2 > 20){ return;}
-    if(STRAW_NC   < 3){ return;}
+    if(fCutScan.Reject(kScanSTRAWChi2, STRAW_chi2, CUTFLOW_REJECT(fCutFlow, kSTRAWChi2, STRAW_chi2 > 20))){ return;}
+    if(CUTFLOW_REJECT(fCutFlow, kSTRAWNChambers, STRAW_NC < 3)){ return;}
 
     //CUTComment:: At least one candidate in the Cedar
-    if(CedarEvent->GetNCandidates() == 0){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kCedarNCandidates, CedarEvent->GetNCandidates() == 0)){return;}
 
+    bool CedarFewSectors = false;
     for( int iCedarCand=0; iCedarCand < CedarEvent->GetNCandidates(); iCedarCand++){
 
         TRecoCedarCandidate* CedarCandidate = ((TRecoCedarCandidate*)CedarEvent->GetCandidate(iCedarCand));
 
         //CUTComment:: At least 5 sectors in the CEDAR
-        if(CedarCandidate->GetNSectors() < 5 ){return;}
+        if(CedarCandidate->GetNSectors() < 5 ){CedarFewSectors = true; break;}
 
     }
+    if(CUTFLOW_REJECT(fCutFlow, kCedarNSectors, CedarFewSectors)){return;}
 
     //Getting the position vectors and the slopes of the tracks
     //given by the spectrometer before the magnet @ DCH1 (dxdz and dydz)
@@ -133,16 +210,18 @@ void OneTrackSelection::Process(int iEvent){
     double MUV2dtrkcl_min;
     double MUV3dtrkcl_min;
 
-    vector <double> CEDAR_STRAW_tdiff;
+    //Per event temporary drawn from fArena, no heap allocation after the first events
+    ArenaVector<double> CEDAR_STRAW_tdiff((ArenaAllocator<double>(fArena)));
+    CEDAR_STRAW_tdiff.reserve(CedarEvent->GetNCandidates());
 
-    int CHODClosestTrackIndex = FindClosestCluster(CHODEvent, CHOD_extrap, "CHOD" , CHODdtrkcl_min);
-    int LKrTrackClusterIndex  = FindClosestCluster(LKrEvent , LKr_extrap , "LKr"  , LKrdtrkcl_min);
-    int MUV1TrackClusterIndex = FindClosestCluster(MUV1Event, MUV1_extrap, "MUV1" , MUV1dtrkcl_min);
-    int MUV2TrackClusterIndex = FindClosestCluster(MUV2Event, MUV2_extrap, "MUV2" , MUV2dtrkcl_min);
-    int MUV3TrackClusterIndex = FindClosestCluster(MUV3Event, MUV3_extrap, "MUV3" , MUV3dtrkcl_min);
+    int CHODClosestTrackIndex = FindClosestCluster(CHODEvent, CHOD_extrap, AnalysisKernels::kCHOD , CHODdtrkcl_min);
+    int LKrTrackClusterIndex  = FindClosestCluster(LKrEvent , LKr_extrap , AnalysisKernels::kLKr  , LKrdtrkcl_min);
+    int MUV1TrackClusterIndex = FindClosestCluster(MUV1Event, MUV1_extrap, AnalysisKernels::kMUV1 , MUV1dtrkcl_min);
+    int MUV2TrackClusterIndex = FindClosestCluster(MUV2Event, MUV2_extrap, AnalysisKernels::kMUV2 , MUV2dtrkcl_min);
+    int MUV3TrackClusterIndex = FindClosestCluster(MUV3Event, MUV3_extrap, AnalysisKernels::kMUV3 , MUV3dtrkcl_min);
 
     //CUTComment::At least one track associated with hit in the CHOD
-    if(CHODClosestTrackIndex < 0. ){return;}
+    if(CUTFLOW_REJECT(fCutFlow, kCHODAssociation, CHODClosestTrackIndex < 0.)){return;}
 
     //Setting up the time of the track. STRAW time is not available, therefore
     //CHOD time will be used as the track time
@@ -151,8 +230,8 @@ void OneTrackSelection::Process(int iEvent){
 
     //CUTComment:: Distance to the extrapolated track in the CHOD bigger than 8 cm
     //Track to be in the CHOD geometrical  acceptance
-    if(CHODdtrkcl_min > 80. ) {return;}
-    if(CHODR < 100. || CHODR > 1200) {return;} //[mm]
+    if(fCutScan.Reject(kScanCHODDistance, CHODdtrkcl_min, CUTFLOW_REJECT(fCutFlow, kCHODDistance, CHODdtrkcl_min > 80.))) {return;}
+    if(CUTFLOW_REJECT(fCutFlow, kCHODAcceptance, CHODR < 100. || CHODR > 1200)) {return;} //[mm]
 
     //Cedar event with the closest time to the track time selected
 
@@ -172,8 +251,8 @@ void OneTrackSelection::Process(int iEvent){
         double CedarTime = *min_element(CEDAR_STRAW_tdiff.begin(), CEDAR_STRAW_tdiff.end());
 
         //CUTComment:: Cedar time difference cut
-        if(fabs(CedarTime) > 3){return;}
-        FillHisto("CEDAR_timediff", CedarTime);
+        if(CUTFLOW_REJECT(fCutFlow, kCedarTime, fabs(CedarTime) > 3)){return;}
+        if(fCutScan.IsNominal()) FillHisto("CEDAR_timediff", CedarTime);
     }
 
     //Quality of the LKr cluster, associated with the track (if any)
@@ -196,13 +275,13 @@ void OneTrackSelection::Process(int iEvent){
         //4. Distance to deadcell > 2cm
         //5. Cluster to be in time with the Track ( Current cut 10 ns)
 
-        if(LKrR < 150. || LKrR > 1100. ) {return;}
+        if(CUTFLOW_REJECT(fCutFlow, kLKrAcceptance, LKrR < 150. || LKrR > 1100.)) {return;}
 
-        if(LKrdtrkcl_min  > 50. ) {return;}
+        if(CUTFLOW_REJECT(fCutFlow, kLKrDistance, LKrdtrkcl_min > 50.)) {return;}
 
-        if(CD_LKrClusterDDead < 2.){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kLKrDeadCell, CD_LKrClusterDDead < 2.)){return;}
 
-        if(fabs(LKrTrkTime) > 10){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kLKrTime, fabs(LKrTrkTime) > 10)){return;}
 
     }
 
@@ -222,13 +301,14 @@ void OneTrackSelection::Process(int iEvent){
         //3. Distance between track and associated cluster 12 cm ??
         //4. Cluster to be in time with the Track ( Current cut 20 ns)
 
-        if(fabs(MUV1_extrap.X()) <= 130. && fabs(MUV1_extrap.Y()) <= 130.){return;}
-        if(fabs(MUV1_extrap.X()) >= 1100. || fabs(MUV1_extrap.Y()) >= 1100.){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV1Acceptance, (fabs(MUV1_extrap.X()) <= 130. && fabs(MUV1_extrap.Y()) <= 130.) ||
+                                                  (fabs(MUV1_extrap.X()) >= 1100. || fabs(MUV1_extrap.Y()) >= 1100.))){return;}
 
-        if( fabs(CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X()) > 120. ||
-            fabs(CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y()) > 120.){return;}
+        //Square window: scanned as the larger of the two distances
+        double MUV1Window = TMath::Max(fabs(CD_MUV1Cluster->GetPosition().X() - MUV1_extrap.X()), fabs(CD_MUV1Cluster->GetPosition().Y() - MUV1_extrap.Y()));
+        if(fCutScan.Reject(kScanMUV1Window, MUV1Window, CUTFLOW_REJECT(fCutFlow, kMUV1Window, MUV1Window > 120.))){return;}
 
-        if(fabs(MUV1TrkTime) > 20){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV1Time, fabs(MUV1TrkTime) > 20)){return;}
         //if(MUV1dtrkcl_min > 120.) {return;}
 
     }
@@ -249,14 +329,14 @@ void OneTrackSelection::Process(int iEvent){
         //3. Distance between track and associated cluster 24 cm ??
         //4. Cluster to be in time with the Track ( Current cut 20 ns)
 
-        if(fabs(MUV2_extrap.X()) <= 130.  && fabs(MUV2_extrap.Y()) <= 130.){return;}
-        if(fabs(MUV2_extrap.X()) >= 1100. || fabs(MUV2_extrap.Y()) >= 1100.){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV2Acceptance, (fabs(MUV2_extrap.X()) <= 130.  && fabs(MUV2_extrap.Y()) <= 130.) ||
+                                                  (fabs(MUV2_extrap.X()) >= 1100. || fabs(MUV2_extrap.Y()) >= 1100.))){return;}
 
-        if( fabs(CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X()) > 240. ||
-            fabs(CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y()) > 240.){return;}
+        double MUV2Window = TMath::Max(fabs(CD_MUV2Cluster->GetPosition().X() - MUV2_extrap.X()), fabs(CD_MUV2Cluster->GetPosition().Y() - MUV2_extrap.Y()));
+        if(fCutScan.Reject(kScanMUV2Window, MUV2Window, CUTFLOW_REJECT(fCutFlow, kMUV2Window, MUV2Window > 240.))){return;}
 
         //if(MUV2dtrkcl_min > 240.) {return;}
-        if(fabs(MUV2TrkTime) > MUV2OffsetCut){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV2Time, fabs(MUV2TrkTime) > MUV2OffsetCut)){return;}
     }
 
     //Quality of the MUV3 cluster, associated with the track (if any)
@@ -276,24 +356,26 @@ void OneTrackSelection::Process(int iEvent){
         //3. Distance between track and associated cluster 24 cm ??
         //4. Cluster to be in time with the Track ( Current cut 5 ns)
 
-        if(fabs(MUV3_extrap.X()) <= 130. && fabs(MUV3_extrap.Y()) <= 130.){return;}
-        if(fabs(MUV3_extrap.X()) >= 1100. || fabs(MUV3_extrap.Y()) >= 1100.){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV3Acceptance, (fabs(MUV3_extrap.X()) <= 130. && fabs(MUV3_extrap.Y()) <= 130.) ||
+                                                  (fabs(MUV3_extrap.X()) >= 1100. || fabs(MUV3_extrap.Y()) >= 1100.))){return;}
 
-        if( fabs(CD_MUV3Cluster->GetX() - MUV3_extrap.X()) > 200. ||
-            fabs(CD_MUV3Cluster->GetY() - MUV3_extrap.Y()) > 200.){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV3Window, fabs(CD_MUV3Cluster->GetX() - MUV3_extrap.X()) > 200. ||
+                                              fabs(CD_MUV3Cluster->GetY() - MUV3_extrap.Y()) > 200.)){return;}
 
-        if(fabs(MUV3TrkTime) > 5){return;}
+        if(CUTFLOW_REJECT(fCutFlow, kMUV3Time, fabs(MUV3TrkTime) > 5)){return;}
         //if(MUV2dtrkcl_min > 150.) {return;}
 
 
     }
 
-
+    //End of the selection: N-1 distributions of the scanned cuts
+    fCutScan.Commit();
 
 }
 
 void OneTrackSelection::PostProcess(){
-
+    if(fHeapCounter) fHeapCounter->EndEvent();
+    fArena.Reset();
 }
 
 void OneTrackSelection::EndOfBurstUser(){
@@ -301,10 +383,32 @@ void OneTrackSelection::EndOfBurstUser(){
     /// This method is called when a new file is opened in the ROOT TChain (corresponding to a start/end of burst in the normal NA62 data taking) + at the end of the last file\n
     /// Do here your start/end of burst processing if any
     /// \EndMemberDescr
+    MemoryMonitor::Instance().EndBurst(fMemoryIndex, fBurstID);
+    //Snapshot taken here, written to fBurstOutput by the writer thread while the next burst is processed
+    if(fBurstWriter) fBurstWriter->Snapshot(fBurstID, GetIteratorTH1(), GetIteratorTH2());
 }
 
 void OneTrackSelection::EndOfRunUser(){
+    fCutFlow.Fill();
+    fCutFlow.Print(cout);
+    fCutScan.Fill();
+    MemoryMonitor::Instance().Report(fMemoryIndex, cout);
+    PerfCounters::Instance().Report(fPerfIndex, cout);
+    SharedEvent::Instance().Report(fSharedIndex, cout);
+    if(fHeapCounter){
+        fHeapCounter->Print(cout);
+        cout << "  event arena: " << fArena.GetHighWater() << " bytes at most, " << fArena.GetNBlockAllocations() << " block allocations" << endl;
+    }
     SaveAllPlots();
+
+    delete fHeapCounter;
+    fHeapCounter = 0;
+
+    if(fBurstWriter){
+        fBurstWriter->Finish();
+        delete fBurstWriter;
+        fBurstWriter = 0;
+    }
 }
 
 void OneTrackSelection::DrawPlot(){
@@ -324,72 +428,11 @@ void OneTrackSelection::DrawPlot(){
     /// and manipulate it as usual (TCanvas, Draw, ...)\n
     /// \EndMemberDescr
 }
-int OneTrackSelection::FindClosestCluster( TRecoVEvent* Event, TVector3 Extrap_track, string detector_type, double& minimum){
-
-    std::vector<double> dtrkcl;
-    //std::vector<int>    clindex;
-    std::vector<double>::iterator VIterator;
-    int position= -1;
-    for (int iCand=0; iCand < Event->GetNCandidates(); iCand++){
-        if(detector_type == "LKr"){
-            TRecoLKrCandidate* Cluster = ((TRecoLKrCandidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetClusterX();
-            double clustery = Cluster->GetClusterY();
-            double distance = sqrt(pow(clusterx*10. - Extrap_track.X(),2 ) + pow(clustery*10. - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV1"){
-            TRecoMUV1Candidate* Cluster = ((TRecoMUV1Candidate*)Event->GetCandidate(iCand));
-            //Old Reco
-            //double clusterx = Cluster->GetPosition().X()+ 60;
-            //double clustery = Cluster->GetPosition().Y()+ 60;
-            //New Reco
-            double clusterx = Cluster->GetPosition().X();
-            double clustery = Cluster->GetPosition().Y();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV2"){
-            TRecoMUV2Candidate* Cluster = ((TRecoMUV2Candidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetPosition().X();
-            double clustery = Cluster->GetPosition().Y();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "MUV3"){
-            TRecoMUV3Candidate* Cluster = ((TRecoMUV3Candidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetX();
-            double clustery = Cluster->GetY();
-            double distance = sqrt(pow(clusterx - Extrap_track.X(),2 ) + pow(clustery - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-        if(detector_type == "CHOD"){
-            TRecoCHODCandidate* Cluster = ((TRecoCHODCandidate*)Event->GetCandidate(iCand));
-            double clusterx = Cluster->GetHitPosition().X();
-            double clustery = Cluster->GetHitPosition().Y();
-            double distance = sqrt(pow(clusterx*10. - Extrap_track.X(),2 ) + pow(clustery*10. - Extrap_track.Y(),2 ) ) ;
-            dtrkcl.push_back(distance);
-        }
-
-    }
-    //Debugging!!!
-    //cout << " Event -----" << detector_type.data() << endl;
-    //for ( VIterator = dtrkcl.begin() ; VIterator != dtrkcl.end(); VIterator++ ){
-    //    cout << *VIterator << endl;
-    //}
-    //
-    if(dtrkcl.size() !=0){
-        minimum= *min_element(dtrkcl.begin(), dtrkcl.end());
-        position = distance(dtrkcl.begin(), min_element(dtrkcl.begin(), dtrkcl.end()));
-        dtrkcl.clear();
-        //    cout << " Minimum = " << minimum << endl;
-        //    cout << "Index of minimum = " << position << endl;
-
-        //cout << "WOWW == " <<  clindex(min_element(dtrkcl.begin(), dtrkcl.end())) << endl;
-        //cout << " Event OVER-----" << detector_type.data() << endl;
-        //cout << minimum << endl;
+int OneTrackSelection::FindClosestCluster(TRecoVEvent* Event, const TVector3& Extrap_track, AnalysisKernels::Detector detector, double& minimum){
 
-    }
+    int position = SharedEvent::Instance().FindClosestCluster(Event, Extrap_track, detector, minimum);
+    LOG_DEBUG(AnalysisKernels::GetDetectorName(detector) << ": " << Event->GetNCandidates() << " candidates");
+    if(position > -1) LOG_DEBUG(AnalysisKernels::GetDetectorName(detector) << ": closest candidate " << position << " at " << minimum << " mm");
     return position;
 
 }
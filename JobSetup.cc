@@ -0,0 +1,300 @@
+#include <stdlib.h>
+
+#include <TSystem.h>
+
+#include "FileListCache.hh"
+#include "FileStager.hh"
+#include "MemoryMonitor.hh"
+#include "PerfCounters.hh"
+#include "JobSetup.hh"
+
+using namespace std;
+using NA62Analysis::Verbosity::VerbosityLevel;
+
+JobSetup::JobSetup() :
+	fOutFileName("outFile.root"),
+	fNEvt(0),
+	fEvtNb(-1),
+	fNFiles(0),
+	fGraphicMode(false),
+	fFromList(false),
+	fIgnoreNonExisting(false),
+	fVerbosity(VerbosityLevel::kStandard),
+	fReadPlots(false),
+	fContinuousReading(false),
+	fDownscaling(false),
+	fFastStart(false),
+	fLogToFile(false),
+	fMemoryReport(false),
+	fPerfCounters(false),
+	fStageSize(50.),
+	fStageAhead(3),
+	fStager(0)
+{
+}
+
+JobSetup::~JobSetup(){
+	delete fStager;
+	if(fStartList.Length()>0) gSystem->Unlink(fStartList);
+}
+
+void JobSetup::PrintOptions(ostream& out){
+	/// \MemberDescr
+	/// \param out : receives the help of the common options, after the ones of the executable
+	/// \EndMemberDescr
+	out << "  -v [level]\t\t: Verbosity level." << endl
+		<< "\t\t\t  Possible values: kNo, kStandard, kUser, kNormal, kExtended, kDebug, kTrace or 0,1,2,3,4,5,6;" << endl
+		<< "\t\t\t  Default=kStandard; If level not specified: kNormal" << endl;
+	out << "  -g\t\t\t: Graphical mode. Starts a ROOT application for display." << endl
+		<< "\t\t\t  Do not automatically exit at the end of the processing, Ctrl-C to exit." << endl;
+	out << "  -n/--nevt int\t\t: Maximum number of events to process." << endl;
+	out << "  -o/--output path\t: Path to output ROOT file. Will be overwritten if already exists." << endl;
+	out << "  -p/--params string\t: List of parameters to pass to analyzers." << endl
+		<< "\t\t\t  The format of the string is " << endl
+		<< "\t\t\t  \"analyzerName:param=val;param=val&analyzerName:param=val&...\"" << endl;
+	out << "  -d/--downscaling\t: Activate downscaling (dowscaling factor in .settingsna62file)." << endl;
+	out << "  --histo\t\t: Read histograms only and bypass TTree reading." << endl;
+	out << "  --start int\t\t: Index of the first event to process." << endl
+		<< "\t\t\t  Event index starts at 0." << endl;
+	out << "  --config path\t\t: Path to a configuration file containing analyzers parameters." << endl;
+	out << "  --reffile path\t: Path to a ROOT file containing reference plots." << endl;
+	out << "  --ignore\t\t: Ignore non-existing trees and continue processing." << endl;
+	out << "  --logtofile path\t: Write the log output to the specified file instead of standard output." << endl;
+	out << "  --fast-start\t: Start processing immediately without reading input files headers." << endl;
+	out << "\t\t\t Entry counts are taken from the <list>.cache sidecar (created on first use)" << endl
+		<< "\t\t\t so that the total number of events and --start stay exact." << endl;
+	out << "  --stage-dir path\t: Copy the next input files of the list to this local directory before they are read." << endl
+		<< "\t\t\t  The directory can be shared by all the jobs of the node." << endl;
+	out << "  --stage-size float\t: Maximum size of the staging directory in GB. (Default: 50)" << endl;
+	out << "  --stage-ahead int\t: Number of files staged in advance. (Default: 3)" << endl;
+	out << "  --memory-report\t: Heap allocations per analyzer, histogram memory and resident memory per burst." << endl
+		<< "\t\t\t  Printed at the end of the run and written to the AllAnalyzers/Memory_ histograms of the first analyzer." << endl;
+	out << "  --perf-counters\t: Time, cycles, instructions, cache and branch misses per event of each analyzer (Linux perf_event_open)." << endl
+		<< "\t\t\t  Printed at the end of the run with the IPC and written to the AllAnalyzers/Perf_ histograms of the first analyzer." << endl;
+	out << endl;
+	out << "Mutually exclusive options groups:" << endl;
+	out << " Group1:" << endl;
+	out << "  -i path\t\t: Path to an input ROOT file." << endl;
+	out << " Group2:" << endl;
+	out << "  -l/--list path\t: Path to a text file containing a list of paths to input ROOT files." << endl
+		<< "\t\t\t  One file per line." << endl;
+	out << "  -B/-b/--nfiles int\t: Maximum number of files to process from the list. (Default: All)" << endl
+		<< "\t\t\t  !Warning. When using -g option, do not use the -b but -B or --nfiles." << endl;
+	out << "  --continous \t\t: Use continuous reading (automatically enables -g" << endl;
+	out << endl << endl;
+}
+
+bool JobSetup::ParseOptions(int argc, char** argv, TString extraShort, const vector<struct option>& extraLong, OptionHandler handler){
+	/// \MemberDescr
+	/// \param argc, argv : command line
+	/// \param extraShort : getopt short options of the executable, on top of the common ones
+	/// \param extraLong : long options of the executable
+	/// \param handler : receives the extra options
+	/// \return false if the usage has to be printed: no option, unknown or invalid option, -h
+	/// \EndMemberDescr
+	int opt;
+	int n_options_read = 0;
+	int flReadPlots = 0;
+	int flIgnoreNonExisting = 0;
+	int flContinuousReading = 0;
+	int flFastStart = 0;
+	int flMemoryReport = 0;
+	int flPerfCounters = 0;
+
+	vector<struct option> longopts = {
+			{ "list",		required_argument,	NULL,					'l'},
+			{ "nfiles",		required_argument,	NULL,					'B'},
+			{ "nevt",		required_argument,	NULL,					'n'},
+			{ "output",		required_argument,	NULL,					'o'},
+			{ "params",		required_argument,	NULL,					'p'},
+			{ "downscaling",required_argument,	NULL,					'd'},
+			{ "histo",		no_argument,		&flReadPlots,			1},
+			{ "start",		required_argument,	NULL,					'0'},
+			{ "config",		required_argument,	NULL,					'1'},
+			{ "reffile",	required_argument,	NULL,					'2'},
+			{ "ignore",		no_argument,		&flIgnoreNonExisting,	1},
+			{ "logtofile",	required_argument,	NULL,					'3'},
+			{ "continuous",	no_argument,		&flContinuousReading,	1},
+			{ "fast-start",	no_argument,		&flFastStart,			1},
+			{ "stage-dir",	required_argument,	NULL,					'4'},
+			{ "stage-size",	required_argument,	NULL,					'5'},
+			{ "stage-ahead",required_argument,	NULL,					'6'},
+			{ "memory-report",no_argument,		&flMemoryReport,		1},
+			{ "perf-counters",no_argument,		&flPerfCounters,		1}
+	};
+	longopts.insert(longopts.end(), extraLong.begin(), extraLong.end());
+	longopts.push_back({0,0,0,0});
+	TString shortopts = "h" + extraShort + "i:v:gl:B:b:n:o:p:0:1:2:3:4:5:6:d";
+
+	TString argTS;
+	while ((opt = getopt_long(argc, argv, shortopts.Data(), longopts.data(), NULL)) != -1) {
+		n_options_read++;
+		switch (opt) {
+		case 'i': /* Input file */
+			fInFileName = TString(optarg);
+			break;
+		case 'v':
+			if(optarg){
+				argTS = TString(optarg);
+				if(argTS.IsDec()) fVerbosity = (VerbosityLevel)argTS.Atoi();
+				else fVerbosity = NA62Analysis::Verbose::GetVerbosityLevelFromName(argTS);
+			}
+			else fVerbosity = VerbosityLevel::kNormal;
+			break;
+		case 'g':
+			fGraphicMode = true;
+			break;
+
+		case 'l': /* Input files list, long_option: list */
+			if(!fNFiles) fNFiles = -1;
+			fInFileName = TString(optarg);
+			fFromList = true;
+			break;
+		case 'B': /* Number of files to read, long_option: nfiles */
+			fNFiles = TString(optarg).Atoi();
+			break;
+		case 'b': /* Number of files to read, long_option: nfiles */
+			fNFiles = TString(optarg).Atoi();
+			break;
+		case 'n': /* Maximum number of events to process, long_option: nevt */
+			fEvtNb = TString(optarg).Atoi();
+			break;
+		case 'o': /* Output file path, long_option: output */
+			fOutFileName = TString(optarg);
+			break;
+		case 'p': /* Analyzer params, long_options: params */
+			fParams = TString(optarg);
+			break;
+		case 'd': /* Downscaling, long_options: downscaling */
+			fDownscaling = true;
+			break;
+		case '0':	/* First event to process, long_option: start */
+			fNEvt = TString(optarg).Atoi();
+			break;
+		case '1': /* Config file to parse, long_option: config */
+			fConfigFile = TString(optarg);
+			break;
+		case '2': /* Reference file path, long_option: reffile */
+			fRefFileName = TString(optarg);
+			break;
+		case '3': /* log file, long_option: logtofile */
+			fLogFile = TString(optarg);
+			fLogToFile = true;
+			break;
+		case '4': /* Local staging directory, long_option: stage-dir */
+			fStageDir = TString(optarg);
+			break;
+		case '5': /* Staging directory size [GB], long_option: stage-size */
+			fStageSize = TString(optarg).Atof();
+			break;
+		case '6': /* Number of files staged in advance, long_option: stage-ahead */
+			fStageAhead = TString(optarg).Atoi();
+			break;
+
+		case 0: /* getopt_long() set a variable, continue */
+			break;
+
+		case 'h':
+		case '?':
+			return false;
+
+		default: /* Options of the executable */
+			if(!handler || !handler(opt, optarg)) return false;
+		}
+	}
+	if (!n_options_read) return false;
+
+	fIgnoreNonExisting = flIgnoreNonExisting;
+	fReadPlots = flReadPlots;
+	fContinuousReading = flContinuousReading;
+	if(fContinuousReading) fGraphicMode = true;
+	fFastStart = flFastStart;
+	fMemoryReport = flMemoryReport;
+	fPerfCounters = flPerfCounters;
+	return true;
+}
+
+bool JobSetup::Prepare(){
+	/// \MemberDescr
+	/// \return false if the job cannot run, the reason is printed
+	///
+	/// Enables the monitors, skips the files before --start with the entry counts of the
+	/// sidecar cache (--fast-start) and starts the staging of the input files (--stage-dir).
+	/// \EndMemberDescr
+	if(!fFromList && fNFiles>0){
+		cerr << "Option -B can only be used with the -l parameter" << endl;
+		return false;
+	}
+
+	MemoryMonitor::Instance().SetEnabled(fMemoryReport);
+	if(fPerfCounters) PerfCounters::Instance().SetEnabled(true);
+
+	if(fFastStart && fFromList){
+		//Exact event addressing without opening the files: entry counts come from the sidecar cache
+		FileListCache headerCache(fInFileName);
+		if(headerCache.Build(fNFiles)){
+			cout << "Fast start: " << headerCache.GetNFiles() << " files, " << headerCache.GetNEvents() << " events ("
+				 << headerCache.GetNOpened() << " file headers read)" << endl;
+			int firstFile = headerCache.FindFile(fNEvt);
+			if(fNEvt>0 && firstFile<0){
+				cerr << "--start " << fNEvt << " is beyond the last event of the list" << endl;
+				return false;
+			}
+			if(firstFile>0){
+				//Skip the files before the first event: the chain then starts at the right file
+				fStartList = Form("%s/%s.%d.start", gSystem->TempDirectory(), gSystem->BaseName(fInFileName.Data()), gSystem->GetPid());
+				if(headerCache.WriteList(fStartList, firstFile, fNFiles>0 ? fNFiles-firstFile : -1)){
+					fNEvt -= headerCache.GetEntry(firstFile).fFirstEvent;
+					if(fNFiles>0) fNFiles -= firstFile;
+					fInFileName = fStartList;
+				}
+				else fStartList = "";
+			}
+		}
+		else cerr << "Fast start: entry counts unavailable, --start is applied by the framework" << endl;
+	}
+
+	if(fStageDir.Length()>0 && fFromList && !fContinuousReading){
+		//The list given to the framework points to links which are switched to the local copies
+		fStager = new FileStager(fStageDir, fStageSize, fStageAhead);
+		if(fStager->Start(fInFileName, fNFiles)) fInFileName = fStager->GetList();
+		else{
+			delete fStager;
+			fStager = 0;
+		}
+	}
+	return true;
+}
+
+NA62Analysis::Core::BaseAnalysis* JobSetup::CreateAnalysis() const{
+	/// \MemberDescr
+	/// \return analysis configured with the options, owned by the caller which adds the analyzers
+	/// \EndMemberDescr
+	NA62Analysis::Core::BaseAnalysis* ban = new NA62Analysis::Core::BaseAnalysis();
+	ban->SetGlobalVerbosity(fVerbosity);
+	if(fLogToFile) ban->SetLogToFile(fLogFile);
+	ban->SetGraphicMode(fGraphicMode);
+	ban->SetDownscaling(fDownscaling);
+	if(fReadPlots) ban->SetReadType(NA62Analysis::Core::IOHandlerType::kHISTO);
+	else ban->SetReadType(NA62Analysis::Core::IOHandlerType::kTREE);
+	if(fFastStart) ban->SetFastStart(fFastStart);
+	if(fContinuousReading) ban->SetContinuousReading(fContinuousReading);
+	return ban;
+}
+
+bool JobSetup::Run(NA62Analysis::Core::BaseAnalysis* ban){
+	/// \MemberDescr
+	/// \param ban : analysis of CreateAnalysis() with its analyzers
+	/// \return false if the processing failed
+	/// \EndMemberDescr
+	bool retCode = false;
+	ban->Init(fInFileName, fOutFileName, fParams, fConfigFile, fNFiles, fRefFileName, fIgnoreNonExisting);
+	if(fContinuousReading) ban->StartContinuous(fInFileName);
+	else retCode = ban->Process(fNEvt, fEvtNb);
+	if(fStager) fStager->Stop();
+	if(fStartList.Length()>0){
+		gSystem->Unlink(fStartList);
+		fStartList = "";
+	}
+	return retCode;
+}
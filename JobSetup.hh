@@ -0,0 +1,77 @@
+#ifndef JOBSETUP_HH
+#define JOBSETUP_HH
+
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <getopt.h>
+
+#include <TString.h>
+
+#include "BaseAnalysis.hh"
+#include "Verbose.hh"
+
+class FileStager;
+
+/// \class JobSetup
+/// \Brief
+/// Command line and input preparation shared by the executables (main.cc, combined.cc)
+/// \EndBrief
+///
+/// \Detailed
+/// ParseOptions() reads the framework options (input, output, verbosity, parameters, ...) and
+/// the ones of the physics objects (--fast-start, --stage-*, --memory-report, --perf-counters);
+/// an executable adds its own options with the extra short/long options and a handler.\n
+/// Prepare() enables the monitors, applies --start through the FileListCache sidecar and starts
+/// the FileStager. CreateAnalysis() returns the configured BaseAnalysis, to which the executable
+/// adds its analyzers, and Run() processes the input and stops the stager.
+/// \EndDetailed
+class JobSetup
+{
+public:
+	/// Called with the option character and argument of each extra option, false if invalid
+	typedef std::function<bool(int, const char*)> OptionHandler;
+
+	JobSetup();
+	~JobSetup();
+
+	static void PrintOptions(std::ostream& out);
+
+	bool ParseOptions(int argc, char** argv, TString extraShort="", const std::vector<struct option>& extraLong=std::vector<struct option>(), OptionHandler handler=OptionHandler());
+	bool Prepare();
+	NA62Analysis::Core::BaseAnalysis* CreateAnalysis() const;
+	bool Run(NA62Analysis::Core::BaseAnalysis* ban);
+
+	bool IsGraphicMode() const { return fGraphicMode; }
+
+private:
+	TString fInFileName;
+	TString fOutFileName;
+	TString fRefFileName;
+	TString fParams;
+	TString fConfigFile;
+	TString fLogFile;
+	TString fStageDir;
+	TString fStartList;                  ///< Sub list starting at the first event (--fast-start), removed by Run()
+
+	int fNEvt;
+	int fEvtNb;
+	int fNFiles;
+	bool fGraphicMode;
+	bool fFromList;
+	bool fIgnoreNonExisting;
+	NA62Analysis::Verbosity::VerbosityLevel fVerbosity;
+	bool fReadPlots;
+	bool fContinuousReading;
+	bool fDownscaling;
+	bool fFastStart;
+	bool fLogToFile;
+	bool fMemoryReport;
+	bool fPerfCounters;
+	double fStageSize;
+	int fStageAhead;
+
+	FileStager* fStager;
+};
+
+#endif
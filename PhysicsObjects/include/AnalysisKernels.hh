@@ -0,0 +1,40 @@
+#ifndef ANALYSISKERNELS_HH
+#define ANALYSISKERNELS_HH
+
+#include <TVector3.h>
+
+class TRecoVEvent;
+
+/// \class AnalysisKernels
+/// \Brief
+/// Per event computations shared by the analyzers and measured by the microbenchmarks
+/// \EndBrief
+///
+/// \Detailed
+/// The hot loops of OneTrack and Kmu2, outside of the analyzers so that MicroBenchmarks can
+/// time exactly the code which runs in the event loop:\n
+/// VertexCDA(): closest distance of approach of the track and the beam kaon\n
+/// FindClosestCluster(): candidate of a downstream detector closest to the extrapolated track
+/// (CHOD and LKr positions in cm, MUV1/2/3 in mm, distance in mm)\n
+/// LKrCorrectedEnergy(): zero suppression non-linearity and energy scale of the LKr clusters\n
+/// MatchStrip(), MatchStrips(): MUV1/MUV2 hits in time on the strips around the extrapolated
+/// track, vertical (channel%100 < 50) and horizontal (channel%100 > 50) planes\n
+/// RICHMass(): mass from the track momentum and the Cherenkov ring radius (neon, f = 17 m)
+/// \EndDetailed
+class AnalysisKernels
+{
+public:
+    enum Detector { kCHOD, kLKr, kMUV1, kMUV2, kMUV3, kNDetectors };
+    enum StripMatch { kNoStrip, kVerticalStrip, kHorizontalStrip };
+
+    static TVector3 VertexCDA(const TVector3& pos1, const TVector3& p1, const TVector3& pos2, const TVector3& p2, double& cda);
+    static int FindClosestCluster(TRecoVEvent* event, const TVector3& extrapolation, int detector, double& minimum);
+    static double LKrCorrectedEnergy(double energy, int nCells);
+    static int MatchStrip(int channelID, double tdiff, int vIndex, int hIndex);
+    static int MatchStrips(TRecoVEvent* event, int vIndex, int hIndex, double time, int& nVertical, int& nHorizontal);
+    static double RICHMass(double momentum, double ringRadius);
+
+    static const char* GetDetectorName(int detector);
+};
+
+#endif
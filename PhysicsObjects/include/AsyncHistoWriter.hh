@@ -0,0 +1,78 @@
+#ifndef ASYNCHISTOWRITER_HH
+#define ASYNCHISTOWRITER_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <TString.h>
+
+class TFile;
+class TH1;
+
+/// \class AsyncHistoWriter
+/// \Brief
+/// Writes end of burst snapshots of the analyzer histograms from a background thread
+/// \EndBrief
+///
+/// \Detailed
+/// The analyzer calls Snapshot() in EndOfBurstUser. The histograms are cloned on the
+/// event loop thread (memory copy only) and handed to a writer thread which owns its
+/// own ROOT file. For each burst the writer stores the content accumulated during the
+/// burst in the directory Burst_<BurstID> and the running total in the directory
+/// Cumulative, so the output can be inspected while the job is still running.\n
+/// The event loop never waits for the file: if the writer falls behind, the oldest
+/// pending snapshot is dropped (the next delta then covers several bursts).\n
+/// The errors of the delta are sqrt(|sigma2_now - sigma2_previous|) per bin: the fills of
+/// the burst are independent of the previous ones, so their variances subtract.
+/// \EndDetailed
+class AsyncHistoWriter
+{
+public:
+    AsyncHistoWriter(TString fileName, size_t maxPending=4);
+    ~AsyncHistoWriter();
+
+    void Snapshot(int burstID, const std::vector<TH1*>& histos);
+
+    /// Snapshot of all the booked histograms of an analyzer: Snapshot(fBurstID, GetIteratorTH1(), GetIteratorTH2())
+    template <typename IteratorTH1, typename IteratorTH2>
+    void Snapshot(int burstID, IteratorTH1 itTH1, IteratorTH2 itTH2){
+        std::vector<TH1*> histos;
+        for(; itTH1!=itTH1.End(); ++itTH1) histos.push_back(*itTH1);
+        for(; itTH2!=itTH2.End(); ++itTH2) histos.push_back(*itTH2);
+        Snapshot(burstID, histos);
+    }
+    void Finish();
+
+    int GetNWritten() const { return fNWritten; }
+    int GetNDropped() const { return fNDropped; }
+
+private:
+    struct Job {
+        int fBurstID;
+        std::vector<TH1*> fHistos;
+    };
+
+    void Run();
+    void Write(Job& job);
+    static void Subtract(TH1* previous, const TH1* snapshot);
+    static void Delete(Job& job);
+
+    TString fFileName;
+    size_t fMaxPending;
+    TFile* fFile;                        ///< Only accessed from the writer thread
+    std::map<TString, TH1*> fPrevious;   ///< Last written cumulative snapshot, per histogram name
+
+    std::deque<Job> fQueue;
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    std::thread fThread;
+    bool fStop;
+    std::atomic<int> fNWritten;
+    std::atomic<int> fNDropped;
+};
+
+#endif
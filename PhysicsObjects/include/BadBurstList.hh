@@ -0,0 +1,57 @@
+#ifndef BADBURSTLIST_HH
+#define BADBURSTLIST_HH
+
+#include <map>
+#include <ostream>
+#include <vector>
+#include <TString.h>
+
+/// \class BadBurstList
+/// \Brief
+/// Data quality flags of the bad bursts, read from a text list and looked up by burst ID
+/// \EndBrief
+///
+/// \Detailed
+/// The list is written by BurstQuality::Write() (or by hand) with one line per bad burst:\n
+/// burst <BurstID> <Flag> [<Flag> ...]\n
+/// where the flags are the names of the Flag bits (MUV1Inefficient, MUV1Channels, ...).
+/// Empty lines, comments (#) and the lines of other types (channel ...) are ignored.
+/// Read() stores the flags in a dense array indexed by burstID - first bad burst, so that
+/// Get() is a subtraction and an array access. Bursts outside the list have no flag.
+/// \EndDetailed
+class BadBurstList
+{
+public:
+    enum Flag {
+        kMUV1Inefficient = 1<<0, ///< Efficiency of the burst significantly below the run efficiency
+        kMUV1Channels    = 1<<1, ///< Channels dead or hot in the burst only
+        kMUV2Inefficient = 1<<2,
+        kMUV2Channels    = 1<<3,
+        kMUV1 = kMUV1Inefficient | kMUV1Channels,
+        kMUV2 = kMUV2Inefficient | kMUV2Channels
+    };
+    static const int kNFlags = 4;
+
+    BadBurstList();
+
+    bool Read(TString path);
+    void Set(const std::map<int, UInt_t>& bursts);
+
+    inline UInt_t Get(int burstID) const{
+        unsigned int iBurst = burstID - fFirstBurst;
+        return iBurst<fFlags.size() ? fFlags[iBurst] : 0;
+    }
+    inline bool IsBad(int burstID, UInt_t flags) const { return (Get(burstID) & flags)!=0; }
+
+    int GetNBadBursts() const { return fNBadBursts; }
+
+    static bool Write(std::ostream& out, int burstID, UInt_t flags);
+    static const char* GetFlagName(int bit);
+
+private:
+    int fFirstBurst;
+    int fNBadBursts;
+    std::vector<UChar_t> fFlags; ///< Flags of the bursts fFirstBurst to the last bad burst
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef BURSTQUALITY_HH
+#define BURSTQUALITY_HH
+
+#include <map>
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "BadBurstList.hh"
+#include "MUVChannelMap.hh"
+
+class TH1D;
+
+/// \class BurstQuality
+/// \Brief
+/// Automatic detection of the bad bursts and of the dead/hot channels of MUV1 and MUV2
+/// \EndBrief
+///
+/// \Detailed
+/// The analyzer calls StartEvent() for each event, FillHit() for each MUV1/MUV2 hit
+/// (MUVChannelMap channel index) and FillProbe() for each efficiency probe. EndBurst()
+/// stores the counters of the burst and updates the running mean and variance across
+/// bursts (Welford) of the occupancy (hits per event) of every channel and of the
+/// efficiency of each detector. Classify(), at the end of the run, tests every burst
+/// against this run reference:\n
+/// - channel: the number of hits is compared to the Poisson expectation from the mean
+///   occupancy. The channel is flagged in the burst if the Poisson tail probability is
+///   below the p-value and the occupancy is more than nSigma standard deviations (burst to
+///   burst spread) away from the mean. A burst with flagged channels gets the Channels flag.\n
+/// - efficiency: the number of failed probes is compared to the Poisson expectation from
+///   the run efficiency, with the same two conditions (Inefficient flag).\n
+/// The channels whose run occupancy is below deadFraction (above hotFactor) times the median
+/// occupancy of the detector, with a significant Poisson probability, are dead (hot) for the
+/// whole run and not tested burst by burst.\n
+/// Write() produces the list read by BadBurstList (burst lines) with the dead and hot
+/// channels (channel lines).
+/// \EndDetailed
+class BurstQuality
+{
+public:
+    /// MUV1 and MUV2, the first two MUVChannelMap detectors
+    static const int kNDetectors = 2;
+    enum ChannelStatus { kGood, kDead, kHot };
+
+    BurstQuality(TString name, double pValue=1e-6, double nSigma=3., double deadFraction=0.1, double hotFactor=10.);
+
+    inline void StartEvent(){
+        fBurstEvents++;
+    }
+    inline void FillHit(int detector, int channel){
+        if(channel>=0) fBurstHits[detector][channel]++;
+    }
+    inline void FillProbe(int detector, bool passed){
+        fBurstProbes[detector]++;
+        fBurstPassed[detector] += passed;
+    }
+
+    void EndBurst(int burstID);
+    void Classify();
+
+    void BookHistos(std::vector<TH1D*>& histos);
+    bool Write(TString path) const;
+    void Print(std::ostream& out) const;
+
+    const BadBurstList& GetBadBursts() const { return fBadBursts; }
+    int GetChannelStatus(int detector, int channel) const { return fStatus[detector][channel]; }
+
+private:
+    /// Running mean and variance (Welford)
+    struct RunningStat {
+        Long64_t fN;
+        double fMean;
+        double fM2;
+
+        inline void Add(double x){
+            fN++;
+            double delta = x - fMean;
+            fMean += delta/fN;
+            fM2 += delta*(x - fMean);
+        }
+        double GetVariance() const { return fN>1 ? fM2/(fN-1) : 0.; }
+    };
+
+    struct Burst {
+        int fBurstID;
+        UInt_t fEvents;
+        std::vector<UInt_t> fHits[kNDetectors];
+        UInt_t fProbes[kNDetectors];
+        UInt_t fPassed[kNDetectors];
+    };
+
+    bool IsOutlier(UInt_t observed, double expected, double value, const RunningStat& reference, bool low) const;
+
+    TString fName;
+    double fPValue;
+    double fNSigma;
+    double fDeadFraction;
+    double fHotFactor;
+
+    UInt_t fBurstEvents;                          ///< Current burst
+    std::vector<UInt_t> fBurstHits[kNDetectors];
+    UInt_t fBurstProbes[kNDetectors];
+    UInt_t fBurstPassed[kNDetectors];
+
+    std::vector<Burst> fBursts;                   ///< Bursts already ended
+    Long64_t fEvents;
+    std::vector<Long64_t> fHits[kNDetectors];
+    Long64_t fProbes[kNDetectors];
+    Long64_t fPassed[kNDetectors];
+    std::vector<RunningStat> fOccupancy[kNDetectors]; ///< Hits per event of each channel, across bursts
+    RunningStat fEfficiency[kNDetectors];             ///< Efficiency across bursts
+
+    std::vector<int> fStatus[kNDetectors];        ///< ChannelStatus of each channel for the run
+    std::vector<int> fNFlagged[kNDetectors];      ///< Number of bursts in which each channel is flagged
+    double fMedian[kNDetectors];                  ///< Median channel occupancy
+    std::map<int, UInt_t> fFlags;
+    BadBurstList fBadBursts;
+
+    TH1D* fOccupancyHistos[kNDetectors];          ///< Owned by the analyzer once booked
+    TH1D* fStatusHistos[kNDetectors];             ///< Owned by the analyzer once booked
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef CHANNELGAINCALIBRATOR_HH
+#define CHANNELGAINCALIBRATOR_HH
+
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "ChannelHistogramBlock.hh"
+#include "MUVChannelMap.hh"
+#include "PeakFinder.hh"
+
+class TH1D;
+
+/// \class ChannelGainCalibrator
+/// \Brief
+/// Per channel gain equalisation of MUV1 and MUV2 from the charge of minimum ionising muons
+/// \EndBrief
+///
+/// \Detailed
+/// The analyzer calls Fill() with the charge of each readout channel of the strips
+/// crossed by a clean muon. The spectra of a detector are kept in one
+/// ChannelHistogramBlock<UShort_t> indexed by the MUVChannelMap channel index (2 bytes per
+/// bin, 176x400 bins for MUV1). Fit() locates the MIP peak of every channel above the
+/// pedestal threshold (PeakFinder, channels split over threads) and computes the gain
+/// constant of each channel as the median MIP peak of the detector divided by the peak of
+/// the channel: the reconstructed charges multiplied by their constant have the same MIP
+/// peak in all the channels. Write() produces the gain table.
+/// \EndDetailed
+class ChannelGainCalibrator
+{
+public:
+    /// MUV1 and MUV2, the first two MUVChannelMap detectors
+    static const int kNDetectors = 2;
+
+    ChannelGainCalibrator(TString name, int nBins=400, double min=0., double max=4000., double threshold=200., double window=400.);
+
+    inline void Fill(int detector, int channel, double charge){
+        fBlocks[detector].Fill(channel, charge);
+    }
+
+    void BookHistos(std::vector<TH1D*>& histos);
+    void Fit(int nThreads=0);
+    bool Write(TString path) const;
+    void Print(std::ostream& out) const;
+
+    double GetGain(int detector, int channel) const;
+
+private:
+    TString fName;
+    double fThreshold;
+    PeakFinder fPeakFinder;
+    std::vector<ChannelHistogramBlock<UShort_t> > fBlocks;
+    std::vector<ChannelPeak> fPeaks[kNDetectors];
+    double fReference[kNDetectors];  ///< Median MIP peak of the detector
+    TH1D* fPeakHistos[kNDetectors];  ///< Owned by the analyzer once booked
+    TH1D* fGainHistos[kNDetectors];  ///< Owned by the analyzer once booked
+};
+
+#endif
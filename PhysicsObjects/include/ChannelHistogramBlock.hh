@@ -0,0 +1,65 @@
+#ifndef CHANNELHISTOGRAMBLOCK_HH
+#define CHANNELHISTOGRAMBLOCK_HH
+
+#include <limits>
+#include <vector>
+#include <TString.h>
+#include "PeakFinder.hh"
+
+/// Result of PeakFinder for one channel of a ChannelHistogramBlock
+struct ChannelPeak {
+    double fPeak;    ///< NaN if the channel has not enough entries
+    double fRMS;
+    double fEntries; ///< Entries inside the window of the peak
+};
+
+/// \class ChannelHistogramBlock
+/// \Brief
+/// Same 1D distribution for every channel of a detector, in one contiguous block of counts
+/// \EndBrief
+///
+/// \Detailed
+/// Replaces a TH1 per channel for the online calibrations: the channels are indexed by a
+/// dense channel index (e.g. MUVChannelMap), the counts of channel i are the nBins values
+/// starting at i*nBins, and Fill() is a multiplication and an increment. The count type sets the memory footprint (T=UShort_t: 2 bytes per bin,
+/// saturating at 65535; T=UInt_t for long runs).\n
+/// FindPeaks() locates the peak of every channel with a PeakFinder, splitting the channels
+/// over several threads. The bins below an optional threshold (pedestal, noise) are ignored.
+/// \EndDetailed
+template <typename T>
+class ChannelHistogramBlock
+{
+public:
+    ChannelHistogramBlock(int nChannels, int nBins, double min, double max);
+
+    inline void Fill(int channel, double x){
+        if(channel<0 || channel>=fNChannels) return;
+        double bin = (x-fMin)*fInvBinWidth;
+        if(bin<0. || bin>=fNBins) return;
+        T& count = fCounts[channel*fNBins + (int)bin];
+        if(count<std::numeric_limits<T>::max()) count++;
+    }
+
+    void Reset();
+    void Add(const ChannelHistogramBlock<T>& other);
+    void FindPeaks(const PeakFinder& finder, std::vector<ChannelPeak>& peaks, int nThreads=0, double threshold=-1e30) const;
+
+    const T* GetCounts(int channel) const { return &fCounts[channel*fNBins]; }
+    double GetEntries(int channel) const;
+    int GetNChannels() const { return fNChannels; }
+    int GetNBins() const { return fNBins; }
+    double GetMin() const { return fMin; }
+    double GetMax() const { return fMax; }
+
+private:
+    void FindPeaks(const PeakFinder& finder, std::vector<ChannelPeak>& peaks, int firstBin, int firstChannel, int lastChannel) const;
+
+    int fNChannels;
+    int fNBins;
+    double fMin;
+    double fMax;
+    double fInvBinWidth;
+    std::vector<T> fCounts;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef CHANNELT0CALIBRATOR_HH
+#define CHANNELT0CALIBRATOR_HH
+
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "ChannelHistogramBlock.hh"
+#include "MUVChannelMap.hh"
+#include "PeakFinder.hh"
+
+class TH1D;
+
+/// \class ChannelT0Calibrator
+/// \Brief
+/// Per channel T0 of the MUV1/MUV2 strips and of the MUV3 tiles, from online accumulators
+/// \EndBrief
+///
+/// \Detailed
+/// The analyzer calls Fill() with the time difference CHOD - hit + detector offset of the
+/// hits it associates to the track. The distributions of each detector (MUVChannelMap::Detector)
+/// are kept in one ChannelHistogramBlock indexed by the MUVChannelMap channel index
+/// (176 MUV1 channels, 88 MUV2 channels, 152 MUV3 tiles).\n
+/// EndBurst() estimates the peak of every channel (PeakFinder, channels split over
+/// threads) from the counts accumulated since the start of the run, so that the T0 are
+/// up to date in the per burst snapshots. The T0 of a channel is the opposite of its peak:
+/// CHOD - hit + detector offset + T0 peaks at 0. Write() produces the T0 table, one line
+/// per channel with enough entries.
+/// \EndDetailed
+class ChannelT0Calibrator
+{
+public:
+    ChannelT0Calibrator(TString name, int nBins=400, double min=-50., double max=50., double window=5.);
+
+    inline void Fill(int detector, int channel, double timeDiff){
+        fBlocks[detector].Fill(channel, timeDiff);
+    }
+
+    void BookHistos(std::vector<TH1D*>& histos);
+    void EndBurst(int nThreads=0);
+    bool Write(TString path) const;
+    void Print(std::ostream& out) const;
+
+    int GetNChannels(int detector) const { return fBlocks[detector].GetNChannels(); }
+    double GetT0(int detector, int channel) const { return -fPeaks[detector][channel].fPeak; }
+
+private:
+    TString fName;
+    PeakFinder fPeakFinder;
+    std::vector<ChannelHistogramBlock<UInt_t> > fBlocks;
+    std::vector<ChannelPeak> fPeaks[MUVChannelMap::kNDetectors];
+    TH1D* fT0Histos[MUVChannelMap::kNDetectors]; ///< Owned by the analyzer once booked
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef CUTFLOW_HH
+#define CUTFLOW_HH
+
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "CycleClock.hh"
+
+class TH1D;
+
+/// \class CutFlow
+/// \Brief
+/// Pass/fail counters and time spent for each cut of a selection
+/// \EndBrief
+///
+/// \Detailed
+/// Each cut of the selection is a stage declared once with AddCut(). In Process, the
+/// selection calls StartEvent() and then wraps each cut condition in CUTFLOW_REJECT:
+/// \code
+///     CUTFLOW_START(fCutFlow);
+///     if(CUTFLOW_REJECT(fCutFlow, kSTRAWChi2, STRAW_chi2 > 20)){return;}
+/// \endcode
+/// The time elapsed since the previous stage (or since StartEvent()) is accounted to the
+/// stage, i.e. a stage costs the computation of its variables plus the test itself.
+/// Stages which are not reached (early return, optional detector) are not counted.\n
+/// The cut flow is the one of the nominal selection: when the event goes on after a rejection
+/// (CutScan enabled, the condition of a scanned cut being given to CUTFLOW_REJECT inside
+/// CutScan::Reject()), the stages after the first rejection are not counted.\n
+/// BookHistos() creates the cut flow (events surviving each stage) and timing histograms,
+/// to be booked by the analyzer and filled by Fill() at the end of the run. Print()
+/// writes the same information as a table.\n
+/// The cuts of a group run by a CutScheduler are evaluated in an order which changes after
+/// the warm up: SetGroup() lists them in the scheduled order and, as the events did not all
+/// see the same order, gives their own counters only, the survivors being counted after the
+/// last cut of the group.\n
+/// Compiling with -DNO_CUTFLOW (cmake -DCUTFLOW=OFF) reduces the macros to the bare
+/// conditions.
+/// \EndDetailed
+class CutFlow
+{
+public:
+    CutFlow(TString name);
+    CutFlow(TString name, const CutFlow& stages);
+
+    void AddCut(int cut, TString name);
+    void SetGroup(const std::vector<int>& order);
+    void BookHistos(std::vector<TH1D*>& histos);
+
+    inline void StartEvent(){
+        fNEvents++;
+        fRejected = false;
+        fLast = CycleClock::Now();
+    }
+    inline bool Reject(int cut, bool rejected){
+        if(fRejected) return rejected;
+        fRejected = rejected;
+        CycleClock::Ticks now = CycleClock::Now();
+        Stage& stage = fStages[cut];
+        stage.fTicks += now - fLast;
+        stage.fNRejected += rejected;
+        stage.fNEvaluated++;
+        fLast = now;
+        return rejected;
+    }
+
+    void Fill() const;
+    void Print(std::ostream& out) const;
+
+    Long64_t GetNEvents() const { return fNEvents; }
+    Long64_t GetNEvaluated(int cut) const { return fStages[cut].fNEvaluated; }
+    Long64_t GetNRejected(int cut) const { return fStages[cut].fNRejected; }
+    double GetTime(int cut) const { return CycleClock::ToNs(fStages[cut].fTicks); }
+
+private:
+    struct Stage {
+        TString fName;
+        Long64_t fNEvaluated;
+        Long64_t fNRejected;
+        CycleClock::Ticks fTicks;
+    };
+
+    Long64_t Survivors(int cut, Long64_t& survivors, Long64_t& groupRejected) const;
+
+    TString fName;
+    std::vector<Stage> fStages;
+    std::vector<int> fOrder;     ///< Stages in the order of the histograms and of the table
+    std::vector<char> fInGroup;  ///< Stages of the SetGroup() group
+    int fGroupLast;              ///< Last stage of the group in fOrder, -1 without group
+    Long64_t fNEvents;
+    bool fRejected;              ///< The current event failed a stage
+    CycleClock::Ticks fLast;
+
+    TH1D* fFlowHisto; ///< Owned by the analyzer once booked
+    TH1D* fTimeHisto; ///< Owned by the analyzer once booked
+};
+
+#ifdef NO_CUTFLOW
+#define CUTFLOW_START(flow)
+#define CUTFLOW_REJECT(flow, cut, condition) (condition)
+#else
+#define CUTFLOW_START(flow) (flow).StartEvent()
+#define CUTFLOW_REJECT(flow, cut, condition) (flow).Reject(cut, (condition))
+#endif
+
+#endif
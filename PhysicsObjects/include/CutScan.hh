@@ -0,0 +1,76 @@
+#ifndef CUTSCAN_HH
+#define CUTSCAN_HH
+
+#include <vector>
+#include <TString.h>
+
+class TH1D;
+
+/// \class CutScan
+/// \Brief
+/// N-1 distributions and efficiency curves of a set of cuts in a single pass
+/// \EndBrief
+///
+/// \Detailed
+/// Each scanned cut is declared with its variable range and wrapped in Reject(), around the
+/// CUTFLOW_REJECT of the cut so that the cut flow sees the condition itself:
+/// \code
+///     if(fCutScan.Reject(kScanChi2, STRAW_chi2, CUTFLOW_REJECT(fCutFlow, kSTRAWChi2, STRAW_chi2 > 20))){ return;}
+/// \endcode
+/// When the scan is disabled Reject() only returns the condition. When it is enabled the
+/// variable is recorded, the event is never rejected by a scanned cut and the selection
+/// goes on with all the other cuts. At the end of the selection Commit() fills the N-1
+/// histogram of each scanned cut with the events passing all the other cuts (scanned or
+/// not), then returns whether the event also passes the scanned cuts, in which case the
+/// analyzer continues as usual. Histograms filled in the middle of the selection should
+/// be guarded with IsNominal() so that they see exactly the nominal events.\n
+/// At the end of the run Fill() integrates each N-1 histogram into the fraction of
+/// events that a cut at the bin edge would keep (<name>_Eff), for the whole range at once.
+/// \EndDetailed
+class CutScan
+{
+public:
+    CutScan(TString name);
+
+    void AddCut(int cut, TString name, int nBins, double min, double max, bool rejectAbove=true);
+    void BookHistos(std::vector<TH1D*>& histos);
+    void SetEnabled(bool enabled) { fEnabled = enabled; }
+    bool IsEnabled() const { return fEnabled; }
+
+    inline void StartEvent(){
+        fEvaluated = 0;
+        fFailed = 0;
+    }
+    inline bool Reject(int cut, double value, bool rejected){
+        if(!fEnabled) return rejected;
+        fValues[cut] = value;
+        fEvaluated |= 1ULL<<cut;
+        if(rejected) fFailed |= 1ULL<<cut;
+        return false;
+    }
+    /// True while the event passes all the scanned cuts evaluated so far
+    bool IsNominal() const { return fFailed==0; }
+    bool Commit();
+
+    void Fill() const;
+
+private:
+    struct Cut {
+        TString fName;
+        int fNBins;
+        double fMin;
+        double fMax;
+        bool fRejectAbove;
+        TH1D* fNMinus1;
+        TH1D* fEfficiency;
+    };
+
+    TString fName;
+    bool fEnabled;
+    std::vector<Cut> fCuts;
+    std::vector<double> fValues;
+    unsigned long long fEvaluated; ///< Bit per scanned cut
+    unsigned long long fFailed;    ///< Bit per scanned cut
+};
+
+#endif
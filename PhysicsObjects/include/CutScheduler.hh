@@ -0,0 +1,120 @@
+#ifndef CUTSCHEDULER_HH
+#define CUTSCHEDULER_HH
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "CycleClock.hh"
+
+/// \class CutScheduler
+/// \Brief
+/// Runs a group of independent cuts in the order minimising the expected cost per event
+/// \EndBrief
+///
+/// \Detailed
+/// The cuts of the group are declared once with the producers they need (expensive
+/// inputs such as a cluster association, computed at most once per event and only when
+/// a cut asks for them) and the cuts which must have passed before them (a cut reading
+/// an index only valid after an association cut). In Process the analyzer gives two
+/// callables: produce(producerID) fills the inputs and reject(cutID) returns true if
+/// the event fails the cut.
+/// \code
+///     int rejectedBy = fCutScheduler.Run(reject, produce);
+///     if(rejectedBy>=0) return;
+///     fCutScheduler.Complete(produce); //inputs still needed by the rest of the selection
+/// \endcode
+/// The first nWarmUp events use the declaration order while the time spent in each cut
+/// and producer and the fraction of rejected events are measured. The group is then
+/// reordered greedily: among the cuts whose prerequisites are placed, the next one is
+/// the one with the lowest (own cost + cost of its producers not run yet) / rejected
+/// fraction. Since the event passes the group only if it passes every cut, and the
+/// cuts do not modify their inputs, the selected events are the same in any order.
+/// \EndDetailed
+class CutScheduler
+{
+public:
+    CutScheduler(TString name, int nWarmUp=1000);
+
+    void AddProducer(int producer, TString name);
+    void AddCut(int cut, TString name, const std::vector<int>& producers, const std::vector<int>& after=std::vector<int>());
+    void SetWarmUp(int nWarmUp) { fNWarmUp = nWarmUp; } ///< <=0: keep the declaration order
+
+    template <class Reject, class Produce> int Run(Reject& reject, Produce& produce);
+    template <class Produce> void Complete(Produce& produce);
+
+    const std::vector<int>& GetOrder() const { return fOrder; }
+    void Print(std::ostream& out) const;
+
+private:
+    struct Cut {
+        TString fName;
+        std::vector<int> fProducers;
+        std::vector<int> fAfter;
+        Long64_t fNEvaluated;
+        Long64_t fNRejected;
+        CycleClock::Ticks fTicks;
+    };
+    struct Producer {
+        TString fName;
+        Long64_t fNRuns;
+        CycleClock::Ticks fTicks;
+    };
+
+    template <class Produce> inline void RunProducer(int producer, Produce& produce){
+        if(fDone[producer]) return;
+        CycleClock::Ticks start = CycleClock::Now();
+        produce(producer);
+        fProducers[producer].fTicks += CycleClock::Now() - start;
+        fProducers[producer].fNRuns++;
+        fDone[producer] = 1;
+    }
+    void Reorder();
+
+    TString fName;
+    std::vector<Cut> fCuts;           ///< Indexed by cut ID
+    std::vector<Producer> fProducers; ///< Indexed by producer ID
+    std::vector<int> fOrder;          ///< Cut IDs in the order of evaluation
+    std::vector<char> fDone;          ///< Producers already run for the current event
+    Long64_t fNEvents;
+    int fNWarmUp;
+    bool fReordered;
+};
+
+template <class Reject, class Produce> int CutScheduler::Run(Reject& reject, Produce& produce){
+    /// \MemberDescr
+    /// \param reject : callable bool(int cutID)
+    /// \param produce : callable void(int producerID)
+    /// \return ID of the cut rejecting the event, -1 if the event passes all the cuts
+    /// \EndMemberDescr
+    if(!fReordered && fNWarmUp>0 && fNEvents==fNWarmUp) Reorder();
+    fNEvents++;
+    std::fill(fDone.begin(), fDone.end(), 0);
+
+    for(size_t iOrder=0; iOrder<fOrder.size(); iOrder++){
+        Cut& cut = fCuts[fOrder[iOrder]];
+        for(size_t iProducer=0; iProducer<cut.fProducers.size(); iProducer++) RunProducer(cut.fProducers[iProducer], produce);
+
+        CycleClock::Ticks start = CycleClock::Now();
+        bool rejected = reject(fOrder[iOrder]);
+        cut.fTicks += CycleClock::Now() - start;
+        cut.fNEvaluated++;
+        if(rejected){
+            cut.fNRejected++;
+            return fOrder[iOrder];
+        }
+    }
+    return -1;
+}
+
+template <class Produce> void CutScheduler::Complete(Produce& produce){
+    /// \MemberDescr
+    /// \param produce : callable void(int producerID)
+    ///
+    /// Runs the producers not needed by the cuts of the group for this event, so the
+    /// code after the group sees the same inputs whatever the order.
+    /// \EndMemberDescr
+    for(size_t iProducer=0; iProducer<fProducers.size(); iProducer++) RunProducer(iProducer, produce);
+}
+
+#endif
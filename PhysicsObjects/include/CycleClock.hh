@@ -0,0 +1,37 @@
+#ifndef CYCLECLOCK_HH
+#define CYCLECLOCK_HH
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/// \class CycleClock
+/// \Brief
+/// Cheapest available timestamp, for instrumentation of the event loop
+/// \EndBrief
+///
+/// \Detailed
+/// Now() reads the time stamp counter on x86 (a few ns, no system call) and falls back to
+/// std::chrono::steady_clock elsewhere. Ticks are only meaningful as differences and are
+/// converted to nanoseconds with GetNsPerTick(), which is calibrated once per process
+/// against steady_clock.
+/// \EndDetailed
+class CycleClock
+{
+public:
+    typedef unsigned long long Ticks;
+
+    static inline Ticks Now(){
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static double GetNsPerTick();
+    static double ToNs(Ticks ticks) { return ticks*GetNsPerTick(); }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef DIGIPULSEMONITOR_HH
+#define DIGIPULSEMONITOR_HH
+
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "MUVChannelMap.hh"
+
+class TH1;
+class TH1D;
+class TH2D;
+
+/// Result of the analysis of the samples of one FADC digi
+struct FADCPulse {
+    double fPedestal;   ///< Mean of the first samples
+    double fAmplitude;  ///< Maximum sample - pedestal
+    double fPeakTime;   ///< Time of the maximum from the first sample, parabolic interpolation [ns]
+    double fIntegral;   ///< Sum of the samples - pedestal
+    int fPeakSample;    ///< Index of the maximum sample
+    bool fSaturated;    ///< Maximum sample at or above the ADC saturation
+};
+
+/// \class DigiPulseMonitor
+/// \Brief
+/// Pulse analysis of the MUV1/MUV2 FADC digis and per channel pulse shape summaries
+/// \EndBrief
+///
+/// \Detailed
+/// Analyze() computes the pedestal, peak amplitude, peak time and integral of the samples
+/// of a digi. The sums and maxima run two samples per instruction (SSE2, scalar loop for
+/// the remaining sample and when SSE2 is not available). Fill() analyzes a digi and adds
+/// it to the summary of its channel (MUVChannelMap channel index): number of pulses,
+/// sums of the amplitude, amplitude squared, peak time and integral, and the mean pulse
+/// shape normalised to the amplitude (kMaxSamples samples). Saturated pulses and digis with
+/// a quality different from 0 are only counted. There is no I/O in Fill(): FillHistos()
+/// sets the booked histograms at the end of the run.\n
+/// BookHistos() creates, for each detector:\n
+/// <name>_<detector>_PulseAmplitude, _PulsePeakTime, _PulseIntegral: mean per channel index\n
+/// <name>_<detector>_PulseSaturated, _PulseBadQuality: number of flagged pulses per channel index\n
+/// <name>_<detector>_PulseShape: mean normalised pulse shape, channel index vs sample
+/// \EndDetailed
+class DigiPulseMonitor
+{
+public:
+    /// MUV1 and MUV2, the first two MUVChannelMap detectors
+    static const int kNDetectors = 2;
+    static const int kMaxSamples = 32;
+
+    DigiPulseMonitor(TString name, int nPedestalSamples=2, double samplePeriod=25., double saturation=16383.);
+
+    void Fill(int detector, int channel, const double* samples, int nSamples, int quality);
+    FADCPulse Analyze(const double* samples, int nSamples) const;
+
+    void BookHistos(std::vector<TH1*>& histos);
+    void FillHistos() const;
+    void Print(std::ostream& out) const;
+
+private:
+    struct ChannelSummary {
+        Long64_t fNPulses;
+        Long64_t fNSaturated;
+        Long64_t fNBadQuality;
+        double fSumAmplitude;
+        double fSumAmplitude2;
+        double fSumPeakTime;
+        double fSumIntegral;
+    };
+
+    TString fName;
+    int fNPedestalSamples;
+    double fSamplePeriod;
+    double fSaturation;
+    std::vector<ChannelSummary> fSummaries[kNDetectors];
+    std::vector<double> fShapes[kNDetectors];   ///< Sum of the normalised samples, channel*kMaxSamples + sample
+
+    TH1D* fAmplitudeHistos[kNDetectors];        ///< Owned by the analyzer once booked (same for the others)
+    TH1D* fPeakTimeHistos[kNDetectors];
+    TH1D* fIntegralHistos[kNDetectors];
+    TH1D* fSaturatedHistos[kNDetectors];
+    TH1D* fBadQualityHistos[kNDetectors];
+    TH2D* fShapeHistos[kNDetectors];
+};
+
+#endif
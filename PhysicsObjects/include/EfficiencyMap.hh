@@ -0,0 +1,88 @@
+#ifndef EFFICIENCYMAP_HH
+#define EFFICIENCYMAP_HH
+
+#include <map>
+#include <ostream>
+#include <vector>
+#include <TString.h>
+
+class TH1;
+class TH2D;
+class TGraphAsymmErrors;
+
+/// \class EfficiencyMap
+/// \Brief
+/// Incremental 2D efficiency (numerator and denominator counters) with per burst totals
+/// \EndBrief
+///
+/// \Detailed
+/// Fill() adds a probe (an event in the denominator) at (x, y), in the numerator if it
+/// passed. The counters are flat arrays of nX*nY bins for the current burst; EndBurst()
+/// adds them to the run arrays and records the totals of the burst, which make the
+/// efficiency time series. Add() merges another map with the same binning (other thread,
+/// other job) by adding the arrays and the burst totals.\n
+/// BookHistos() creates:\n
+/// <name>_Num, <name>_Den: run counters (additive, can be merged with hadd)\n
+/// <name>_Eff, <name>_EffLow, <name>_EffUp: efficiency and Clopper-Pearson interval per bin\n
+/// <name>_Burst: efficiency vs burst ID with its Clopper-Pearson interval (TGraphAsymmErrors)\n
+/// which are filled by Fill() at the end of the run. FillEfficiency() recomputes the
+/// efficiency histograms from merged _Num/_Den histograms.
+/// \EndDetailed
+class EfficiencyMap
+{
+public:
+    EfficiencyMap(TString name, TString title, int nX, double xMin, double xMax, int nY, double yMin, double yMax, double level=0.682689);
+
+    inline void Fill(double x, double y, bool passed){
+        double binX = (x-fXMin)*fInvWidthX;
+        double binY = (y-fYMin)*fInvWidthY;
+        if(binX<0. || binX>=fNX || binY<0. || binY>=fNY) return;
+        int bin = (int)binY*fNX + (int)binX;
+        fBurstDen[bin]++;
+        fBurstNum[bin] += passed;
+    }
+
+    void EndBurst(int burstID);
+    void Add(const EfficiencyMap& other);
+
+    void BookHistos(std::vector<TH1*>& histos, std::vector<TGraphAsymmErrors*>& graphs);
+    void Fill() const;
+    void Print(std::ostream& out) const;
+
+    Long64_t GetNumerator() const;
+    Long64_t GetDenominator() const;
+    static void FillEfficiency(const TH1* num, const TH1* den, TH1* eff, TH1* low, TH1* up, double level=0.682689);
+
+private:
+    struct BurstCounts {
+        Long64_t fNum;
+        Long64_t fDen;
+    };
+
+    TString fName;
+    TString fTitle;
+    int fNX;
+    double fXMin;
+    double fXMax;
+    double fInvWidthX;
+    int fNY;
+    double fYMin;
+    double fYMax;
+    double fInvWidthY;
+    double fLevel;
+
+    std::vector<UInt_t> fBurstNum;     ///< Current burst, bin iX + iY*nX
+    std::vector<UInt_t> fBurstDen;
+    std::vector<Long64_t> fNum;        ///< Bursts already ended
+    std::vector<Long64_t> fDen;
+    std::map<int, BurstCounts> fBursts;
+
+    TH2D* fNumHisto;                   ///< Owned by the analyzer once booked (same for the others)
+    TH2D* fDenHisto;
+    TH2D* fEffHisto;
+    TH2D* fLowHisto;
+    TH2D* fUpHisto;
+    TGraphAsymmErrors* fBurstGraph;
+};
+
+#endif
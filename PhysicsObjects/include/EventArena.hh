@@ -0,0 +1,128 @@
+#ifndef EVENTARENA_HH
+#define EVENTARENA_HH
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// \class EventArena
+/// \Brief
+/// Bump allocator for the temporaries of one event, rewound by Reset()
+/// \EndBrief
+///
+/// \Detailed
+/// Allocate() moves a pointer forward in the current block; nothing is freed individually.
+/// The analyzer calls Reset() in PostProcess(), once the containers using the arena are
+/// destroyed: the next event reuses the same memory. If an event did not fit in the first
+/// block, Reset() replaces the blocks by a single block large enough for it, so that after
+/// the first events the arena does not touch the heap any more.\n
+/// ArenaVector and ArenaMap are the containers for analyzer code:
+/// \code
+///     ArenaVector<double> dtrkcl((ArenaAllocator<double>(fArena)));
+///     dtrkcl.reserve(Event->GetNCandidates());
+/// \endcode
+/// A vector growing beyond its reserved size leaves its old buffer unused until Reset().
+/// \EndDetailed
+class EventArena
+{
+public:
+    explicit EventArena(size_t blockSize=65536);
+    ~EventArena();
+
+    inline void* Allocate(size_t size, size_t alignment){
+        char* start = (char*)(((size_t)fCurrent + alignment-1) & ~(alignment-1));
+        if(start + size > fEnd) return Grow(size, alignment);
+        fCurrent = start + size;
+        return start;
+    }
+    void Reset();
+
+    size_t GetUsed() const { return fUsedBefore + (fCurrent - fBlocks.back().first); }
+    size_t GetHighWater() const { return fHighWater; }
+    size_t GetCapacity() const;
+    long GetNBlockAllocations() const { return fNBlockAllocations; }
+
+private:
+    EventArena(const EventArena&);
+    EventArena& operator=(const EventArena&);
+    void* Grow(size_t size, size_t alignment);
+    void AddBlock(size_t size);
+
+    std::vector<std::pair<char*, size_t> > fBlocks;   ///< Start and size, the last one is in use
+    char* fCurrent;
+    char* fEnd;
+    size_t fUsedBefore;          ///< Bytes used in the previous blocks of the event
+    size_t fHighWater;           ///< Largest event [bytes]
+    long fNBlockAllocations;
+};
+
+/// Standard allocator drawing from an EventArena, deallocate() does nothing
+template <class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(EventArena& arena) : fArena(&arena) {}
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : fArena(other.GetArena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(fArena->Allocate(n*sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    EventArena* GetArena() const { return fArena; }
+
+private:
+    EventArena* fArena;
+};
+
+template <class T, class U>
+inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena()==b.GetArena(); }
+template <class T, class U>
+inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena()!=b.GetArena(); }
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+/// \class ArenaMap
+/// \Brief
+/// Map of a few entries in an EventArena: linear search, insertion order
+/// \EndBrief
+template <class Key, class Value>
+class ArenaMap
+{
+public:
+    typedef std::pair<Key, Value> value_type;
+    typedef typename ArenaVector<value_type>::iterator iterator;
+    typedef typename ArenaVector<value_type>::const_iterator const_iterator;
+
+    explicit ArenaMap(EventArena& arena, size_t capacity=8) : fEntries(ArenaAllocator<value_type>(arena)) { fEntries.reserve(capacity); }
+
+    Value& operator[](const Key& key){
+        iterator entry = find(key);
+        if(entry!=end()) return entry->second;
+        fEntries.push_back(value_type(key, Value()));
+        return fEntries.back().second;
+    }
+    iterator find(const Key& key){
+        for(iterator entry=begin(); entry!=end(); ++entry) if(entry->first==key) return entry;
+        return end();
+    }
+    const_iterator find(const Key& key) const{
+        for(const_iterator entry=begin(); entry!=end(); ++entry) if(entry->first==key) return entry;
+        return end();
+    }
+    size_t count(const Key& key) const { return find(key)!=end(); }
+    size_t size() const { return fEntries.size(); }
+    bool empty() const { return fEntries.empty(); }
+    void clear() { fEntries.clear(); }
+
+    iterator begin() { return fEntries.begin(); }
+    iterator end() { return fEntries.end(); }
+    const_iterator begin() const { return fEntries.begin(); }
+    const_iterator end() const { return fEntries.end(); }
+
+private:
+    ArenaVector<value_type> fEntries;
+};
+
+#endif
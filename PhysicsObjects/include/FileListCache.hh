@@ -0,0 +1,59 @@
+#ifndef FILELISTCACHE_HH
+#define FILELISTCACHE_HH
+
+#include <vector>
+#include <TString.h>
+
+/// \class FileListCache
+/// \Brief
+/// Sidecar cache of the entry counts of the files of an input list
+/// \EndBrief
+///
+/// \Detailed
+/// With --fast-start the framework does not open the input files before processing, so
+/// the total number of events and the position of each file in the chain are unknown.
+/// This class keeps, next to the list (<list>.cache), one line per input file with its
+/// size, modification time, number of entries, burst ID and the trees it contains.
+/// Lines whose size/mtime still match the file are trusted, the other files are opened
+/// once and the cache is rewritten. The second start on the same list does not open any
+/// input file.
+/// \EndDetailed
+class FileListCache
+{
+public:
+    /// Bits of Entry::fTrees
+    enum TreeBits { kReco=1, kDigis=2, kMC=4 };
+
+    struct Entry {
+        TString fPath;
+        Long64_t fSize;
+        Long64_t fMTime;
+        Long64_t fNEntries;
+        Int_t fBurstID;
+        UInt_t fTrees;
+        Long64_t fFirstEvent; ///< Index of the first event of this file in the whole list
+    };
+
+    FileListCache(TString listFile, TString cacheFile="");
+
+    bool Build(int maxFiles=-1);
+
+    Long64_t GetNEvents() const;
+    int GetNFiles() const { return fEntries.size(); }
+    int GetNOpened() const { return fNOpened; }
+    const Entry& GetEntry(int iFile) const { return fEntries[iFile]; }
+    int FindFile(Long64_t event) const;
+    bool WriteList(TString path, int firstFile, int nFiles=-1) const;
+
+private:
+    bool ReadCache(std::vector<Entry>& cached) const;
+    bool WriteCache() const;
+    static bool Inspect(Entry& entry);
+
+    TString fListFile;
+    TString fCacheFile;
+    std::vector<Entry> fEntries;
+    int fNOpened;
+};
+
+#endif
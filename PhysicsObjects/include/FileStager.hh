@@ -0,0 +1,89 @@
+#ifndef FILESTAGER_HH
+#define FILESTAGER_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <TString.h>
+
+/// \class FileStager
+/// \Brief
+/// Copies the next input files of a list to a local scratch directory ahead of processing
+/// \EndBrief
+///
+/// \Detailed
+/// The scratch directory is shared by all the jobs running on the node:\n
+/// <stageDir>/files/ contains the staged copies, <stageDir>/index the list of staged files
+/// (size, time of last use, owner while the copy is in progress) and <stageDir>/lock is the
+/// flock() protecting the index. The total size of the staged files is kept below the
+/// limit by removing the least recently used files which no running job still needs.\n
+/// Each job works on its own list (GetList()) pointing to symbolic links in
+/// <stageDir>/jobs/<pid>/. A link first points to the original file and is atomically
+/// replaced by a link to the local copy as soon as the copy is complete, so the framework
+/// can open any file of the list at any time. The stager follows the progress of the job
+/// by looking at the files opened by the process (/proc/self/fd) and stages the next
+/// nAhead files. The links of the files already processed are removed, which releases
+/// them for eviction.\n
+/// Only files reachable through the local file system (including network file systems
+/// mounted on the node) are staged. URLs (root://...) cannot be the target of a link:
+/// they are written unchanged to the job list and read directly by the framework.
+/// \EndDetailed
+class FileStager
+{
+public:
+    FileStager(TString stageDir, double maxSizeGB, int nAhead=3);
+    ~FileStager();
+
+    bool Start(TString listFile, int maxFiles=-1);
+    void Stop();
+    TString GetList() const { return fJobList; }
+
+    int GetNStaged() const { return fNStaged; }
+    int GetNShared() const { return fNShared; }
+
+private:
+    struct IndexEntry {
+        TString fName;
+        Long64_t fSize;
+        Long64_t fLastUse;
+        Int_t fOwner; ///< pid of the job copying the file, 0 once complete
+    };
+
+    void Run();
+    int FindCurrentFile() const;
+    bool Stage(int iFile);
+    void Release(int iFile);
+    bool CopyFile(TString source, TString destination) const;
+
+    int Lock() const;
+    void Unlock(int fd) const;
+    void ReadIndex(std::vector<IndexEntry>& index) const;
+    void WriteIndex(const std::vector<IndexEntry>& index) const;
+    bool MakeRoom(std::vector<IndexEntry>& index, Long64_t size) const;
+    void CollectPinned(std::vector<TString>& pinned) const;
+    void CleanDeadJobs() const;
+
+    TString CachedName(int iFile) const;
+    TString LinkPath(int iFile) const;
+    bool Relink(int iFile, TString target) const;
+
+    TString fStageDir;
+    TString fJobDir;
+    TString fJobList;
+    Long64_t fMaxSize;
+    int fNAhead;
+
+    std::vector<TString> fSources;
+    std::vector<int> fState; ///< 0: not staged, 1: staged or shared, -1: staging failed, 2: released or read directly
+
+    std::thread fThread;
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    bool fStop;
+    std::atomic<int> fNStaged;
+    std::atomic<int> fNShared;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef HEAPCOUNTER_HH
+#define HEAPCOUNTER_HH
+
+#include <iostream>
+#include <vector>
+#include <TString.h>
+
+class TH1;
+class TH1D;
+
+/// \class HeapCounter
+/// \Brief
+/// Heap allocations per event, to check that the event loop does not allocate after warm-up
+/// \EndBrief
+///
+/// \Detailed
+/// The counts come from the global operator new and delete of HeapCounterHooks.cc, which count
+/// the allocations of each thread (GetNAllocations(), GetNBytes()) at the cost of one thread
+/// local increment per allocation. They replace the allocator of the whole process, so they are
+/// only linked with the CMake option HEAP_COUNTER (-DHEAP_COUNTER=ON); otherwise the counts stay 0.\n
+/// The analyzer calls StartEvent() at the beginning of Process() and EndEvent() in
+/// PostProcess(), which counts the allocations of the analyzers in between. After the
+/// warm-up events the counter keeps the number of events which allocated, the mean and the
+/// maximum, and fills the optional histogram.
+/// \EndDetailed
+class HeapCounter
+{
+public:
+    HeapCounter(TString name, int warmUpEvents=100);
+
+    static Long64_t GetNAllocations();  ///< Of the calling thread, since its start
+    static Long64_t GetNBytes();        ///< Of the calling thread, since its start
+
+    inline void StartEvent(){
+        fStartAllocations = GetNAllocations();
+        fStartBytes = GetNBytes();
+    }
+    void EndEvent();
+
+    void BookHistos(std::vector<TH1*>& histos);
+    void Print(std::ostream& out) const;
+
+    Long64_t GetLastAllocations() const { return fLastAllocations; }
+    Long64_t GetNAllocatingEvents() const { return fNAllocatingEvents; }
+
+private:
+    TString fName;
+    int fWarmUpEvents;
+    Long64_t fStartAllocations;
+    Long64_t fStartBytes;
+    Long64_t fLastAllocations;
+    Long64_t fNEvents;
+    Long64_t fNAllocatingEvents;    ///< After warm-up
+    Long64_t fSumAllocations;       ///< After warm-up
+    Long64_t fSumBytes;             ///< After warm-up
+    Long64_t fMaxAllocations;       ///< After warm-up
+    TH1D* fAllocationsHisto;        ///< Owned by the analyzer once booked
+};
+
+#endif
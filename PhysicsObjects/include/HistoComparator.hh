@@ -0,0 +1,63 @@
+#ifndef HISTOCOMPARATOR_HH
+#define HISTOCOMPARATOR_HH
+
+#include <iostream>
+#include <vector>
+#include <TString.h>
+
+class TDirectory;
+class TH1;
+
+/// \class HistoComparator
+/// \Brief
+/// Bin by bin comparison of all the histograms of an output file with a golden file
+/// \EndBrief
+///
+/// \Detailed
+/// Compare() walks the golden directory recursively and compares each histogram (TH1, TH2,
+/// profiles, ...) with the one at the same path in the output: binning, number of entries
+/// and the content and error of every cell, underflow and overflow included.\n
+/// Exact mode (default, SetTolerance(0,0)): the values must be identical, which is what an
+/// optimisation which does not change the physics gives. Tolerance mode: two values agree if
+/// |a-b| <= absolute + relative*max(|a|,|b|), for changes of the summation order.\n
+/// A histogram missing in the output is a failure, one only in the output is reported.
+/// Histograms matching an AddExclude() regular expression (e.g. the timing histograms, which
+/// differ from run to run) are skipped.
+/// \EndDetailed
+class HistoComparator
+{
+public:
+    HistoComparator();
+
+    void SetTolerance(double relative, double absolute);
+    void AddExclude(TString regexp) { fExcludes.push_back(regexp); }
+
+    int Compare(TDirectory* golden, TDirectory* output);
+    int GetNFailures() const { return fFailures.size(); }
+    void Print(std::ostream& out, int maxFailures=20) const;
+
+private:
+    /// Histogram which does not match, with the first difference found
+    struct Failure {
+        TString fPath;
+        TString fReason;
+    };
+
+    void CompareDirectories(TDirectory* golden, TDirectory* output, TString path);
+    bool CompareHistos(const TH1* golden, const TH1* output, TString& reason);
+    bool IsExcluded(TString path) const;
+    bool Agree(double golden, double output);
+
+    double fRelative;
+    double fAbsolute;
+    std::vector<TString> fExcludes;
+    int fNCompared;
+    int fNExcluded;
+    double fMaxDeviation;             ///< Largest |a-b|/max(|a|,|b|) of the values in tolerance
+    TString fMaxDeviationPath;
+    TString fCurrentPath;
+    std::vector<Failure> fFailures;
+    std::vector<TString> fExtra;      ///< Histograms only in the output
+};
+
+#endif
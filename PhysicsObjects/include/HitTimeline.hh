@@ -0,0 +1,56 @@
+#ifndef HITTIMELINE_HH
+#define HITTIMELINE_HH
+
+#include <utility>
+#include <vector>
+
+/// \class HitTimeline
+/// \Brief
+/// Candidates and hits of several detectors sorted by time, for time window queries
+/// \EndBrief
+///
+/// \Detailed
+/// The analyzer fills the timeline once per event: Clear(), Add() for each candidate or
+/// hit (detector is a small index chosen by the analyzer, index the position of the
+/// object in its event), then Sort(). The queries return ranges of entries in time order:\n
+/// GetEntries(detector): all the entries of a detector (the last one is the latest)\n
+/// GetWindow(detector, min, max): entries with min <= time <= max (binary search)\n
+/// GetMergedWindow(min, max): entries of all the detectors in the window, merged in time
+/// order, for a single sweep over several detectors.\n
+/// The arrays keep their capacity between events: after the first events, filling and
+/// sorting do not allocate.
+/// \EndDetailed
+class HitTimeline
+{
+public:
+    struct Entry {
+        double fTime;
+        int fDetector;
+        int fIndex;     ///< Position of the candidate or hit in its event
+    };
+    typedef std::pair<const Entry*, const Entry*> Range;
+
+    explicit HitTimeline(int nDetectors);
+
+    void Clear();
+    inline void Add(int detector, double time, int index){
+        Entry entry = {time, detector, index};
+        fEntries[detector].push_back(entry);
+    }
+    void Sort();
+
+    Range GetEntries(int detector) const { return MakeRange(fEntries[detector]); }
+    Range GetWindow(int detector, double min, double max) const { return Find(fEntries[detector], min, max); }
+    Range GetMergedWindow(double min, double max) const { return Find(fMerged, min, max); }
+    int GetN(int detector) const { return fEntries[detector].size(); }
+
+private:
+    static Range MakeRange(const std::vector<Entry>& entries);
+    static Range Find(const std::vector<Entry>& entries, double min, double max);
+
+    std::vector<std::vector<Entry> > fEntries;  ///< Per detector, sorted by Sort()
+    std::vector<Entry> fMerged;                 ///< All the detectors, sorted
+    std::vector<Entry> fBuffer;                 ///< Merge buffer
+};
+
+#endif
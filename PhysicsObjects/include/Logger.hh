@@ -0,0 +1,137 @@
+#ifndef LOGGER_HH
+#define LOGGER_HH
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <TString.h>
+#include "CycleClock.hh"
+
+/// \class Logger
+/// \Brief
+/// Asynchronous, rate limited logging for the event loop
+/// \EndBrief
+///
+/// \Detailed
+/// Messages are written with the LOG_ERROR, LOG_WARNING, LOG_INFO and LOG_DEBUG macros:
+/// \code
+///     LOG_DEBUG("G1 == " << gammas["g1"] << " G2 == " << gammas["g2"]);
+/// \endcode
+/// Levels above LOG_LEVEL (cmake -DLOG_LEVEL=0 error, 1 warning, 2 info (default), 3 debug)
+/// are removed by the preprocessor: the message is not even evaluated.\n
+/// Each call site has a static Site which lets at most GetRateLimit() messages per second
+/// through and counts the others. The suppressed count is attached to the next message of
+/// the site, and reported at the end of the job if no message followed.\n
+/// A message which passes is formatted on the calling thread into a slot of a fixed size
+/// ring buffer (lock-free, several producers) and written by a background thread to cout
+/// (info, debug) or cerr (warning, error): the event loop never waits for the terminal or
+/// the log file. If the buffer is full the message is dropped and counted (GetNDropped()).
+/// Flush() waits until the pending messages are written.
+/// \EndDetailed
+class Logger
+{
+public:
+    enum Level { kError, kWarning, kInfo, kDebug };
+
+    /// Rate limiter and suppressed message counter of one call site
+    class Site {
+    public:
+        Site(int level, const char* file, int line);
+        ~Site();
+
+        inline bool Allow(){
+            //Relaxed atomics: a few messages more or less at a window boundary do not matter
+            CycleClock::Ticks now = CycleClock::Now();
+            CycleClock::Ticks start = fWindowStart.load(std::memory_order_relaxed);
+            if(now - start > fWindowTicks && fWindowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) fNInWindow.store(0, std::memory_order_relaxed);
+            if(fNInWindow.fetch_add(1, std::memory_order_relaxed) < Logger::Instance().GetRateLimit()) return true;
+            fNSuppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+    private:
+        friend class Logger;
+        int fLevel;
+        const char* fFile;
+        int fLine;
+        std::atomic<CycleClock::Ticks> fWindowStart;
+        CycleClock::Ticks fWindowTicks;       ///< One second
+        std::atomic<UInt_t> fNInWindow;
+        std::atomic<UInt_t> fNSuppressed;     ///< Since the last message of the site
+    };
+
+    static Logger& Instance();
+    ~Logger();
+
+    bool Push(Site& site, const std::string& message);
+    void Flush();
+
+    void SetRateLimit(UInt_t messagesPerSecond) { fRateLimit = messagesPerSecond; }
+    UInt_t GetRateLimit() const { return fRateLimit.load(std::memory_order_relaxed); }
+    Long64_t GetNDropped() const { return fNDropped; }
+
+    static const char* GetLevelName(int level);
+
+private:
+    static const size_t kNSlots = 1024;       ///< Power of 2
+    static const size_t kMessageSize = 240;
+
+    struct Slot {
+        std::atomic<size_t> fSequence;        ///< Position the slot is free for, +1 once written
+        int fLevel;
+        const char* fFile;
+        int fLine;
+        UInt_t fNSuppressed;
+        char fMessage[kMessageSize];
+    };
+
+    Logger();
+    bool Push(int level, const char* file, int line, UInt_t nSuppressed, const std::string& message);
+    bool Pop();
+    void Run();
+
+    Slot fSlots[kNSlots];
+    std::atomic<size_t> fHead;                ///< Next position to write (producers)
+    std::atomic<size_t> fTail;                ///< Next position to read (writer thread)
+    std::atomic<UInt_t> fRateLimit;
+    std::atomic<Long64_t> fNDropped;
+    std::atomic<bool> fStop;
+    std::thread fThread;
+};
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 2
+#endif
+
+#define LOG_AT(level, message) do{ \
+        static Logger::Site logSite_(level, __FILE__, __LINE__); \
+        if(logSite_.Allow()){ \
+            std::ostringstream logStream_; \
+            logStream_ << message; \
+            Logger::Instance().Push(logSite_, logStream_.str()); \
+        } \
+    } while(0)
+
+#if LOG_LEVEL >= 0
+#define LOG_ERROR(message) LOG_AT(Logger::kError, message)
+#else
+#define LOG_ERROR(message) do{} while(0)
+#endif
+#if LOG_LEVEL >= 1
+#define LOG_WARNING(message) LOG_AT(Logger::kWarning, message)
+#else
+#define LOG_WARNING(message) do{} while(0)
+#endif
+#if LOG_LEVEL >= 2
+#define LOG_INFO(message) LOG_AT(Logger::kInfo, message)
+#else
+#define LOG_INFO(message) do{} while(0)
+#endif
+#if LOG_LEVEL >= 3
+#define LOG_DEBUG(message) LOG_AT(Logger::kDebug, message)
+#else
+#define LOG_DEBUG(message) do{} while(0)
+#endif
+
+#endif
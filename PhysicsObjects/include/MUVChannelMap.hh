@@ -0,0 +1,40 @@
+#ifndef MUVCHANNELMAP_HH
+#define MUVCHANNELMAP_HH
+
+/// \class MUVChannelMap
+/// \Brief
+/// Dense channel indices of the MUV1/MUV2 readout channels and of the MUV3 tiles
+/// \EndBrief
+///
+/// \Detailed
+/// The MUV1 and MUV2 channel IDs are side*100 + plane*50 + strip, with side 1 or 2 (the
+/// two ends of a strip), plane 0 (vertical strips) or 1 (horizontal strips) and strip 1 to
+/// 44 (MUV1) or 22 (MUV2). The per channel calibrations index their arrays with
+/// (2*(side-1) + plane)*nStrips + strip-1:\n
+/// MUV1: 176 channels, MUV2: 88 channels, MUV3: 152 tiles indexed by tile ID.\n
+/// The Channel() functions return -1 for IDs outside the detector.
+/// \EndDetailed
+class MUVChannelMap
+{
+public:
+    enum Detector { kMUV1, kMUV2, kMUV3, kNDetectors };
+
+    static inline int MUV1Channel(int channelID) { return StripChannel(channelID, 44); }
+    static inline int MUV2Channel(int channelID) { return StripChannel(channelID, 22); }
+    static inline int MUV3Channel(int tileID) { return (tileID>=0 && tileID<152) ? tileID : -1; }
+
+    static int GetNChannels(int detector);
+    static int GetChannelID(int detector, int channel);
+    static const char* GetDetectorName(int detector);
+
+private:
+    static inline int StripChannel(int channelID, int nStrips){
+        int side  = channelID/100 - 1;
+        int plane = (channelID%100)/50;
+        int strip = channelID%50;
+        if(side<0 || side>1 || strip<1 || strip>nStrips) return -1;
+        return (2*side + plane)*nStrips + strip-1;
+    }
+};
+
+#endif
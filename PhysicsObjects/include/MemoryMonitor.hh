@@ -0,0 +1,125 @@
+#ifndef MEMORYMONITOR_HH
+#define MEMORYMONITOR_HH
+
+#include <iostream>
+#include <vector>
+#include <TString.h>
+#include "HeapCounter.hh"
+
+class TH1;
+class TH1D;
+class TGraph;
+
+/// \class MemoryMonitor
+/// \Brief
+/// Memory used by each analyzer: heap allocations of Process, histograms, RSS per burst
+/// \EndBrief
+///
+/// \Detailed
+/// Opt-in (--memory-report, SetEnabled()); when disabled the hooks cost one test per call.
+/// Each analyzer registers in its constructor with AddAnalyzer() and then:\n
+/// Process(): MemoryMonitor::ProcessScope memoryScope(fMemoryIndex); counts the heap
+/// allocations (HeapCounter operator new hooks) until the end of the call\n
+/// StartOfRunUser(): BookInto(), which calls AddHisto() for each booked histogram (estimated
+/// size of the bin arrays) and books the histograms of BookHistos()\n
+/// EndOfBurstUser(): EndBurst(), reading the resident set size and its high-water mark\n
+/// EndOfRunUser(): Report(), before SaveAllPlots().\n
+/// The first registered analyzer drives the burst series and owns the output:
+/// Memory_AllocationsPerCall and Memory_HistoMemory (one labelled bin per analyzer), the
+/// Memory_BurstRSS, Memory_BurstHighWater and Memory_BurstAllocations trends vs burst ID, and
+/// the printed table. The calls of the other analyzers are ignored. The histograms cover all the
+/// analyzers: BookInto() books them in the AllAnalyzers subdirectory of the first analyzer.
+/// \EndDetailed
+class MemoryMonitor
+{
+public:
+    /// Heap allocations of the enclosing scope, accounted to an analyzer
+    class ProcessScope {
+    public:
+        inline explicit ProcessScope(int analyzer) : fAnalyzer(-1){
+            if(!MemoryMonitor::Instance().IsEnabled()) return;
+            fAnalyzer = analyzer;
+            fStartAllocations = HeapCounter::GetNAllocations();
+            fStartBytes = HeapCounter::GetNBytes();
+        }
+        inline ~ProcessScope(){
+            if(fAnalyzer<0) return;
+            MemoryMonitor::Instance().AddProcess(fAnalyzer, HeapCounter::GetNAllocations() - fStartAllocations, HeapCounter::GetNBytes() - fStartBytes);
+        }
+    private:
+        int fAnalyzer;
+        Long64_t fStartAllocations;
+        Long64_t fStartBytes;
+    };
+
+    static MemoryMonitor& Instance();
+
+    void SetEnabled(bool enabled) { fEnabled = enabled; }
+    bool IsEnabled() const { return fEnabled; }
+
+    int AddAnalyzer(TString name);
+    void AddProcess(int analyzer, Long64_t nAllocations, Long64_t nBytes);
+    void AddHisto(int analyzer, TH1* histo);
+    void EndBurst(int analyzer, int burstID);
+
+    void BookHistos(int analyzer, std::vector<TH1*>& histos, std::vector<TGraph*>& graphs);
+
+    /// AddHisto() of the histograms booked so far by the analyzer, then BookHistos() booked by it
+    /// in AllAnalyzers/: MemoryMonitor::Instance().BookInto(fMemoryIndex, this) at the end of StartOfRunUser
+    template <typename AnalyzerType>
+    void BookInto(int analyzer, AnalyzerType* owner){
+        if(!fEnabled) return;
+        for(auto itTH1 = owner->GetIteratorTH1(); itTH1!=itTH1.End(); ++itTH1) AddHisto(analyzer, *itTH1);
+        for(auto itTH2 = owner->GetIteratorTH2(); itTH2!=itTH2.End(); ++itTH2) AddHisto(analyzer, *itTH2);
+        std::vector<TH1*> histos;
+        std::vector<TGraph*> graphs;
+        BookHistos(analyzer, histos, graphs);
+        for(size_t iHisto=0; iHisto<histos.size(); iHisto++) owner->BookHisto(histos[iHisto], false, "AllAnalyzers");
+        for(size_t iGraph=0; iGraph<graphs.size(); iGraph++) owner->BookHisto(graphs[iGraph], false, "AllAnalyzers");
+    }
+    void Report(int analyzer, std::ostream& out);
+
+    static bool ReadRSS(Long64_t& rss, Long64_t& highWater);
+    static Long64_t GetHistoBytes(const TH1* histo);
+
+private:
+    struct AnalyzerMemory {
+        TString fName;
+        Long64_t fNCalls;
+        Long64_t fNAllocations;
+        Long64_t fNBytes;
+        Long64_t fMaxAllocations;     ///< In one call
+        int fNHistos;
+        Long64_t fHistoBytes;
+    };
+    struct HistoMemory {
+        int fAnalyzer;
+        TString fName;
+        Long64_t fBytes;
+    };
+    struct BurstMemory {
+        int fBurstID;
+        Long64_t fRSS;                ///< [kB]
+        Long64_t fHighWater;          ///< [kB]
+        Long64_t fNAllocations;       ///< During the burst, all the analyzers and the framework
+    };
+
+    MemoryMonitor();
+    MemoryMonitor(const MemoryMonitor&);
+    MemoryMonitor& operator=(const MemoryMonitor&);
+    void Fill() const;
+    void Print(std::ostream& out) const;
+
+    bool fEnabled;
+    std::vector<AnalyzerMemory> fAnalyzers;
+    std::vector<HistoMemory> fHistos;
+    std::vector<BurstMemory> fBursts;
+    Long64_t fBurstStartAllocations;
+    TH1D* fAllocationsHisto;          ///< Owned by the analyzer once booked
+    TH1D* fHistoMemoryHisto;          ///< Owned by the analyzer once booked
+    TGraph* fRSSGraph;                ///< Owned by the analyzer once booked
+    TGraph* fHighWaterGraph;          ///< Owned by the analyzer once booked
+    TGraph* fBurstAllocationsGraph;   ///< Owned by the analyzer once booked
+};
+
+#endif
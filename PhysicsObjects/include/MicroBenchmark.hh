@@ -0,0 +1,76 @@
+#ifndef MICROBENCHMARK_HH
+#define MICROBENCHMARK_HH
+
+#include <iostream>
+#include <vector>
+#include <TString.h>
+#include "CycleClock.hh"
+
+/// \class MicroBenchmark
+/// \Brief
+/// Robust timing of small kernels: warm-up, repetitions, median and MAD, JSON output
+/// \EndBrief
+///
+/// \Detailed
+/// Run() times a kernel (any callable returning a double, which is accumulated so that the
+/// compiler cannot drop the computation):\n
+/// the number of calls per repetition is doubled until one repetition lasts at least
+/// fMinTime, then fNWarmup repetitions are discarded (caches, branch predictors, frequency
+/// scaling) and fNRepetitions are measured. The result is the median time per call and the
+/// median absolute deviation (MAD) over the repetitions, which are insensitive to the
+/// occasional interrupted repetition, plus the minimum.\n
+/// Print() writes a table, WriteJSON() one record per kernel and parameter, with the label
+/// of the run (commit, machine), so that runs can be compared with any JSON tool.
+/// \EndDetailed
+class MicroBenchmark
+{
+public:
+    struct Result {
+        TString fKernel;
+        int fParameter;                 ///< Size of the input (candidates, hits), 0 if none
+        Long64_t fCalls;                ///< Calls per repetition
+        int fRepetitions;
+        double fMedian;                 ///< [ns per call]
+        double fMAD;                    ///< [ns per call]
+        double fMin;                    ///< [ns per call]
+    };
+
+    MicroBenchmark(int nWarmup, int nRepetitions, double minTime);
+
+    template <typename Kernel>
+    const Result& Run(TString kernel, int parameter, Kernel body){
+        Long64_t calls = 1;
+        while(calls<(1LL<<40) && Time(body, calls)<fMinTime) calls *= 2;
+        for(int iWarmup=0; iWarmup<fNWarmup; iWarmup++) Time(body, calls);
+        std::vector<double> times(fNRepetitions);
+        for(int iRepetition=0; iRepetition<fNRepetitions; iRepetition++) times[iRepetition] = Time(body, calls)/calls;
+        return AddResult(kernel, parameter, calls, times);
+    }
+
+    const std::vector<Result>& GetResults() const { return fResults; }
+    void Print(std::ostream& out) const;
+    void WriteJSON(std::ostream& out, TString label) const;
+
+    static double Median(std::vector<double> values);
+
+private:
+    /// \return time of calls calls of the kernel [ns]
+    template <typename Kernel>
+    inline double Time(Kernel& body, Long64_t calls){
+        double sum = 0.;
+        CycleClock::Ticks start = CycleClock::Now();
+        for(Long64_t iCall=0; iCall<calls; iCall++) sum += body();
+        CycleClock::Ticks end = CycleClock::Now();
+        fSink = fSink + sum;
+        return CycleClock::ToNs(end - start);
+    }
+    const Result& AddResult(TString kernel, int parameter, Long64_t calls, std::vector<double>& times);
+
+    int fNWarmup;
+    int fNRepetitions;
+    double fMinTime;                    ///< Minimum duration of one repetition [ns]
+    volatile double fSink;              ///< Sum of the kernel results, never read
+    std::vector<Result> fResults;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef PEAKFINDER_HH
+#define PEAKFINDER_HH
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/// \class PeakFinder
+/// \Brief
+/// Robust position of the peak of a binned distribution, for the online calibrations
+/// \EndBrief
+///
+/// \Detailed
+/// The distribution is a plain array of counts (any integer or floating point type) in
+/// nBins equal bins between xMin and xMax, as filled by the accumulators of the
+/// calibrations. The peak is seeded by the highest sum of counts over 2*seedHalfWidth+1
+/// consecutive bins (a single noisy bin does not move it), then refined by the mean of
+/// the distribution truncated to +-window around the current estimate, iterated until it
+/// moves by less than a tenth of a bin.\n
+/// Tails and flat backgrounds only bias the result through their asymmetry inside the
+/// window, and no minimizer is involved: Find() is const and can be called from several
+/// threads on different distributions.
+/// \EndDetailed
+class PeakFinder
+{
+public:
+    PeakFinder(double window, double minEntries=50., int seedHalfWidth=2);
+
+    template <typename T>
+    double Find(const T* counts, int nBins, double xMin, double xMax, double* rms=0, double* nEntries=0) const;
+
+    double GetWindow() const { return fWindow; }
+
+private:
+    double fWindow;
+    double fMinEntries;
+    int fSeedHalfWidth;
+    int fMaxIterations;
+};
+
+template <typename T>
+double PeakFinder::Find(const T* counts, int nBins, double xMin, double xMax, double* rms, double* nEntries) const{
+    /// \MemberDescr
+    /// \param counts : content of the nBins bins
+    /// \param nBins : number of bins
+    /// \param xMin : lower edge of the first bin
+    /// \param xMax : upper edge of the last bin
+    /// \param rms : if not null, receives the rms of the distribution inside the final window
+    /// \param nEntries : if not null, receives the number of entries inside the final window
+    /// \return position of the peak, NaN if there are less than minEntries entries around it
+    /// \EndMemberDescr
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const int seedWidth = 2*fSeedHalfWidth+1;
+    if(nBins<seedWidth) return nan;
+    double width = (xMax-xMin)/nBins;
+
+    double sum = 0., bestSum = -1.;
+    int seed = -1;
+    for(int iBin=0; iBin<nBins; iBin++){
+        sum += counts[iBin];
+        if(iBin>=seedWidth) sum -= counts[iBin-seedWidth];
+        if(iBin>=seedWidth-1 && sum>bestSum){
+            bestSum = sum;
+            seed = iBin-fSeedHalfWidth;
+        }
+    }
+    if(bestSum<=0.) return nan;
+
+    double peak = xMin + (seed+0.5)*width;
+    double sumW = 0., variance = 0.;
+    for(int iIteration=0; iIteration<fMaxIterations; iIteration++){
+        int first = std::max(0, (int)std::floor((peak-fWindow-xMin)/width));
+        int last  = std::min(nBins-1, (int)std::floor((peak+fWindow-xMin)/width));
+        double sumWX = 0., sumWX2 = 0.;
+        sumW = 0.;
+        for(int iBin=first; iBin<=last; iBin++){
+            double x = xMin + (iBin+0.5)*width - peak;
+            sumW   += counts[iBin];
+            sumWX  += counts[iBin]*x;
+            sumWX2 += counts[iBin]*x*x;
+        }
+        if(sumW<=0.) return nan;
+        double shift = sumWX/sumW;
+        variance = sumWX2/sumW - shift*shift;
+        peak += shift;
+        if(std::fabs(shift)<0.1*width) break;
+    }
+
+    if(nEntries) *nEntries = sumW;
+    if(sumW<fMinEntries) return nan;
+    if(rms) *rms = std::sqrt(std::max(variance, 0.));
+    return peak;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef PERFCOUNTERS_HH
+#define PERFCOUNTERS_HH
+
+#include <iostream>
+#include <vector>
+#include <TString.h>
+#include "CycleClock.hh"
+
+class TH1;
+class TH1D;
+
+/// \class PerfCounters
+/// \Brief
+/// Time and hardware performance counters (cycles, instructions, cache and branch misses) per analyzer
+/// \EndBrief
+///
+/// \Detailed
+/// Opt-in (--perf-counters, SetEnabled()); when disabled the hooks cost one test per call.
+/// SetEnabled(true) opens one group of Linux perf_event_open counters on the calling thread
+/// (user space only, so that the default perf_event_paranoid setting is enough). A counter
+/// which the machine does not provide is reported as n/a; when no counter can be opened
+/// (no PMU in the virtual machine, perf_event_open forbidden) the reason is printed and only
+/// the time is reported. The time of each scope is read with CycleClock, so the per analyzer
+/// time of Process is always available.\n
+/// Each analyzer registers in its constructor with AddAnalyzer() and then:\n
+/// Process(): PerfCounters::Scope perfScope(fPerfIndex); reads the group at the beginning
+/// and at the end of the call (one system call each)\n
+/// StartOfRunUser(): BookInto(), booking the histograms of BookHistos()\n
+/// EndOfRunUser(): Report(), before SaveAllPlots().\n
+/// The counts between the first and the last Process call which are not inside any analyzer
+/// are reported as "Outside analyzers": the tree reading (I/O) and the framework. As in
+/// MemoryMonitor the first registered analyzer owns the output: Perf_TimePerEvent, Perf_IPC,
+/// Perf_CyclesPerEvent, Perf_CacheMissesPerEvent and Perf_BranchMissesPerEvent (one labelled bin
+/// per analyzer and one for outside the analyzers), booked in its AllAnalyzers subdirectory, and the
+/// printed table of the per event averages.
+/// \EndDetailed
+class PerfCounters
+{
+public:
+    enum Counter { kCycles, kInstructions, kCacheMisses, kBranchMisses, kNCounters };
+
+    /// Counts of the group at one time, scaled if the kernel multiplexed the counters
+    struct Values {
+        CycleClock::Ticks fTicks;
+        Long64_t fCount[kNCounters];
+    };
+
+    /// Counts of the enclosing scope, accounted to an analyzer
+    class Scope {
+    public:
+        inline explicit Scope(int analyzer) : fAnalyzer(-1){
+            PerfCounters& counters = PerfCounters::Instance();
+            if(counters.IsEnabled() && counters.Read(fStart)) fAnalyzer = analyzer;
+        }
+        inline ~Scope(){
+            if(fAnalyzer<0) return;
+            PerfCounters::Instance().AddScope(fAnalyzer, fStart);
+        }
+    private:
+        int fAnalyzer;
+        Values fStart;
+    };
+
+    static PerfCounters& Instance();
+
+    bool SetEnabled(bool enabled);
+    bool IsEnabled() const { return fEnabled; }
+    bool IsAvailable(int counter) const { return fGroupIndex[counter]>=0; }
+
+    int AddAnalyzer(TString name);
+    bool Read(Values& values) const;
+    void AddScope(int analyzer, const Values& start);
+
+    void BookHistos(int analyzer, std::vector<TH1*>& histos);
+
+    /// BookHistos() booked by the analyzer in AllAnalyzers/: PerfCounters::Instance().BookInto(fPerfIndex, this)
+    template <typename AnalyzerType>
+    void BookInto(int analyzer, AnalyzerType* owner){
+        if(!fEnabled) return;
+        std::vector<TH1*> histos;
+        BookHistos(analyzer, histos);
+        for(size_t iHisto=0; iHisto<histos.size(); iHisto++) owner->BookHisto(histos[iHisto], false, "AllAnalyzers");
+    }
+    void Report(int analyzer, std::ostream& out);
+
+    static const char* GetCounterName(int counter);
+
+private:
+    struct AnalyzerCounts {
+        TString fName;
+        Long64_t fNCalls;
+        CycleClock::Ticks fTicks;
+        Long64_t fCount[kNCounters];
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+    bool Open();
+    void Close();
+    AnalyzerCounts GetOutside() const;
+    void Fill() const;
+    void Print(std::ostream& out) const;
+
+    bool fEnabled;
+    int fLeader;                      ///< File descriptor of the group leader, -1 if not open
+    int fFD[kNCounters];              ///< -1 if not available
+    int fGroupIndex[kNCounters];      ///< Position of the counter in the group read, -1 if not available
+    int fNOpen;
+    mutable bool fMultiplexed;        ///< The kernel did not count all the time, the values are scaled
+    std::vector<AnalyzerCounts> fAnalyzers;
+    bool fStarted;
+    Values fFirst;                    ///< At the beginning of the first scope
+    Values fLast;                     ///< At the end of the last scope
+    TH1D* fTimeHisto;                 ///< Owned by the analyzer once booked
+    TH1D* fIPCHisto;                  ///< Owned by the analyzer once booked
+    TH1D* fCyclesHisto;               ///< Owned by the analyzer once booked
+    TH1D* fCacheMissesHisto;          ///< Owned by the analyzer once booked
+    TH1D* fBranchMissesHisto;         ///< Owned by the analyzer once booked
+};
+
+#endif
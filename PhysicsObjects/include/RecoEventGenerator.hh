@@ -0,0 +1,113 @@
+#ifndef RECOEVENTGENERATOR_HH
+#define RECOEVENTGENERATOR_HH
+
+#include <TLorentzVector.h>
+#include <TRandom3.h>
+#include <TString.h>
+#include <TVector3.h>
+
+class TTree;
+class TRecoSpectrometerEvent;
+class TRecoCHODEvent;
+class TRecoLKrEvent;
+class TRecoMUV1Event;
+class TRecoMUV2Event;
+class TRecoMUV3Event;
+class TRecoCedarEvent;
+class TRecoRICHEvent;
+
+/// \class RecoEventGenerator
+/// \Brief
+/// Synthetic reconstructed events (Kmu2/Kpi2 single track and accidentals) for benchmarks
+/// \EndBrief
+///
+/// \Detailed
+/// Fills the reco events requested by the analyzers (Spectrometer, CHOD, LKr, MUV1/2/3,
+/// Cedar, RICH) with the candidates and hits of one beam kaon decay, without the simulation
+/// and the reconstruction:\n
+/// the K+ (KEnergy, XAngle from Trim5) decays in the fiducial volume to mu+ nu or to
+/// pi+ pi0, the charged track is kept in the STRAW acceptance, gets the magnet kick and is
+/// extrapolated to each detector like the analyzers do. The detectors respond with smeared
+/// positions and times (the nominal Kmu2 offsets, e.g. LKr = CHOD + 115 ns): MIP or hadronic
+/// clusters in LKr/MUV1/MUV2 with the hits of the strips crossed, MUV3 tile for the muons,
+/// RICH ring above threshold, Cedar kaon, LKr clusters of the pi0 photons.\n
+/// On top, each event receives accidental activity in a +-fTimeWindow window: halo muons
+/// and pions (CHOD, RICH, LKr, MUV1/2/3 but not the spectrometer), Cedar kaons and MUV1/MUV2
+/// noise hits, with Poisson multiplicities from the Config. The output is physically
+/// plausible, not a simulation: it exercises the same code paths as the data at a
+/// controlled multiplicity.\n
+/// Branch() attaches the events to a tree written with the layout of the reco files
+/// (one branch per detector), Generate() refills them for each event.
+/// \EndDetailed
+class RecoEventGenerator
+{
+public:
+    struct Config {
+        double fKpi2Fraction;       ///< Kpi2 events, the others are Kmu2
+        double fAccidentals;        ///< Mean number of accidental halo muons and pions per event
+        double fCedarAccidentals;   ///< Mean number of accidental kaons in the Cedar per event
+        double fNoiseHits;          ///< Mean number of noise hits in MUV1 and in MUV2 per event
+        double fTimeWindow;         ///< Half width of the window of the accidentals [ns]
+    };
+
+    RecoEventGenerator(const Config& config, unsigned int seed);
+    ~RecoEventGenerator();
+
+    static Config GetDefaultConfig();
+
+    void Branch(TTree* tree);
+    void Generate(int burstID, int eventID);
+    bool IsKpi2() const { return fKpi2; }
+
+    TRecoSpectrometerEvent* GetSpectrometerEvent() const { return fSpectrometerEvent; }
+    TRecoCHODEvent* GetCHODEvent() const { return fCHODEvent; }
+    TRecoLKrEvent* GetLKrEvent() const { return fLKrEvent; }
+    TRecoMUV1Event* GetMUV1Event() const { return fMUV1Event; }
+    TRecoMUV2Event* GetMUV2Event() const { return fMUV2Event; }
+    TRecoMUV3Event* GetMUV3Event() const { return fMUV3Event; }
+    TRecoCedarEvent* GetCedarEvent() const { return fCedarEvent; }
+    TRecoRICHEvent* GetRICHEvent() const { return fRICHEvent; }
+
+private:
+    /// Charged particle downstream of the spectrometer [mm, MeV, ns]
+    struct Particle {
+        TVector3 fPosition;         ///< At the reference plane fPosition.Z()
+        TVector3 fSlopes;           ///< dx/dz, dy/dz, 1
+        double fMomentum;
+        double fMass;
+        double fTime;               ///< At the CHOD
+        bool fMuon;
+    };
+
+    RecoEventGenerator(const RecoEventGenerator&);
+    RecoEventGenerator& operator=(const RecoEventGenerator&);
+    void Clear(int burstID, int eventID);
+    TLorentzVector TwoBodyDecay(const TLorentzVector& parent, double mass1, double mass2, TLorentzVector& daughter2);
+    bool AddSignal(double t0);
+    void AddDownstream(const Particle& particle);
+    void AddCHOD(const TVector3& position, double time);
+    void AddRICH(const Particle& particle);
+    void AddLKr(const TVector3& position, double energy, int nCells, double time);
+    void AddMUV1(const TVector3& position, double energy, double time, bool shower);
+    void AddMUV2(const TVector3& position, double energy, double time, bool shower);
+    void AddMUV3(const TVector3& position, double time);
+    void AddCedar(double time);
+    void AddNoise();
+    TVector3 Extrapolate(const Particle& particle, double z) const;
+    double MIPCharge();
+
+    Config fConfig;
+    TRandom3 fRandom;
+    bool fKpi2;                     ///< Current event
+
+    TRecoSpectrometerEvent* fSpectrometerEvent;
+    TRecoCHODEvent* fCHODEvent;
+    TRecoLKrEvent* fLKrEvent;
+    TRecoMUV1Event* fMUV1Event;
+    TRecoMUV2Event* fMUV2Event;
+    TRecoMUV3Event* fMUV3Event;
+    TRecoCedarEvent* fCedarEvent;
+    TRecoRICHEvent* fRICHEvent;
+};
+
+#endif
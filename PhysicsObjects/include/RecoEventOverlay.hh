@@ -0,0 +1,81 @@
+#ifndef RECOEVENTOVERLAY_HH
+#define RECOEVENTOVERLAY_HH
+
+#include <TRandom3.h>
+#include <TString.h>
+
+class TTree;
+class TRecoSpectrometerEvent;
+class TRecoCHODEvent;
+class TRecoLKrEvent;
+class TRecoMUV1Event;
+class TRecoMUV2Event;
+class TRecoMUV3Event;
+class TRecoCedarEvent;
+class TRecoRICHEvent;
+
+/// \class RecoEventOverlay
+/// \Brief
+/// Overlays the candidates and hits of random other events on each reco event (pileup)
+/// \EndBrief
+///
+/// \Detailed
+/// Emulates a higher beam intensity with the accidental activity of the data themselves:
+/// for each event of the target tree, Overlay() reads K random entries of the donor tree
+/// (usually a chain of the same files) and appends their candidates and hits to the target
+/// events, all the times of a donor event shifted by one random offset uniform in
+/// +-fTimeWindow. The hit indexes of the copied candidates are moved after the target hits.\n
+/// Only the detectors of SetDetectors() are overlaid (default: all but the Spectrometer,
+/// so that the track multiplicity of the single track selections is not changed). \n
+/// Usage:\n
+/// SetTarget(inputTree) before cloning the tree, so that the clone writes the merged events\n
+/// SetDonors(chain)\n
+/// for each entry: inputTree->GetEntry(i); Overlay(K, i); outputTree->Fill();
+/// \EndDetailed
+class RecoEventOverlay
+{
+public:
+    enum Detector { kSpectrometer, kCHOD, kLKr, kMUV1, kMUV2, kMUV3, kCedar, kRICH, kNDetectors };
+
+    explicit RecoEventOverlay(unsigned int seed);
+    ~RecoEventOverlay();
+
+    bool SetDetectors(TString detectors);
+    void SetTimeWindow(double window) { fTimeWindow = window; }
+    void SetTarget(TTree* tree);
+    void SetDonors(TTree* tree);
+    int Overlay(int nDonors, Long64_t exclude);
+
+    static const char* GetDetectorName(int detector);
+
+private:
+    /// Event of each detector, set as branch address of a tree
+    struct Events {
+        TRecoSpectrometerEvent* fSpectrometer;
+        TRecoCHODEvent* fCHOD;
+        TRecoLKrEvent* fLKr;
+        TRecoMUV1Event* fMUV1;
+        TRecoMUV2Event* fMUV2;
+        TRecoMUV3Event* fMUV3;
+        TRecoCedarEvent* fCedar;
+        TRecoRICHEvent* fRICH;
+    };
+
+    RecoEventOverlay(const RecoEventOverlay&);
+    RecoEventOverlay& operator=(const RecoEventOverlay&);
+    void CreateEvents(Events& events);
+    void DeleteEvents(Events& events);
+    void SetAddresses(TTree* tree, Events& events, bool* present);
+    void Merge(double shift);
+
+    bool fEnabled[kNDetectors];
+    bool fInTarget[kNDetectors];      ///< Branch found in the target tree
+    bool fInDonors[kNDetectors];      ///< Branch found in the donor tree
+    double fTimeWindow;               ///< Half width of the window of the time shifts [ns]
+    TRandom3 fRandom;
+    TTree* fDonors;
+    Events fTarget;
+    Events fDonor;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef SELECTIONMASK_HH
+#define SELECTIONMASK_HH
+
+#include <ostream>
+#include <vector>
+#include <TString.h>
+
+/// \class SelectionMask
+/// \Brief
+/// Per event bit mask of cut results and selections defined as predicates on the mask
+/// \EndBrief
+///
+/// \Detailed
+/// Up to 64 bits (cut results, detector flags, ...) are declared once with AddBit() and up to
+/// 64 selections with AddSelection(name, required, vetoed): a selection passes when all the
+/// required bits are set and none of the vetoed ones. For each event, the analyzer sets the
+/// bits once, then Evaluate() tests every selection with two masking operations and returns
+/// the mask of the passing ones, so adding selections costs almost nothing:
+/// \code
+///     fSelection.StartEvent();
+///     fSelection.Set(kBitMUV1, MUV1TrackClusterIndex > -1);
+///     ...
+///     SelectionMask::Mask passed = fSelection.Evaluate();
+///     for(SelectionMask::Mask todo = passed; todo; ){
+///         int selection = SelectionMask::Next(todo);
+///         FillHisto("MUV3_nearest_track_dtrkcl_" + fSelection.GetName(selection), MUV3dtrkcl_min);
+///     }
+/// \endcode
+/// The number of events passing each selection is counted and written by Print().
+/// \EndDetailed
+class SelectionMask
+{
+public:
+    typedef unsigned long long Mask;
+
+    SelectionMask(TString name);
+
+    void AddBit(int bit, TString name);
+    void AddSelection(int selection, TString name, Mask required, Mask vetoed=0);
+
+    static inline Mask Bit(int bit){ return 1ULL<<bit; }
+    /// Index of the lowest bit of mask, which is cleared (mask must not be 0)
+    static inline int Next(Mask& mask){
+        int bit = __builtin_ctzll(mask);
+        mask &= mask-1;
+        return bit;
+    }
+
+    inline void StartEvent(){
+        fBits = 0;
+        fPassed = 0;
+    }
+    inline void Set(int bit, bool value){ if(value) fBits |= 1ULL<<bit; }
+    inline bool IsSet(int bit) const { return (fBits>>bit) & 1; }
+
+    /// \param count : false to leave the event out of the counters (e.g. configuration variants)
+    inline Mask Evaluate(bool count=true){
+        fPassed = 0;
+        for(size_t iSel=0; iSel<fSelections.size(); iSel++){
+            const Selection& selection = fSelections[iSel];
+            if((fBits & selection.fRequired)==selection.fRequired && !(fBits & selection.fVetoed)){
+                fPassed |= 1ULL<<iSel;
+                fCounts[iSel] += count;
+            }
+        }
+        return fPassed;
+    }
+    inline bool Passed(int selection) const { return (fPassed>>selection) & 1; }
+
+    Mask GetBits() const { return fBits; }
+    Mask GetPassed() const { return fPassed; }
+    const TString& GetName(int selection) const { return fSelections[selection].fName; }
+    Long64_t GetCount(int selection) const { return fCounts[selection]; }
+
+    void Print(std::ostream& out) const;
+
+private:
+    struct Selection {
+        TString fName;
+        Mask fRequired;
+        Mask fVetoed;
+    };
+
+    TString fName;
+    std::vector<TString> fBitNames;
+    std::vector<Selection> fSelections;
+    std::vector<Long64_t> fCounts;
+    Mask fBits;
+    Mask fPassed;
+};
+
+#endif
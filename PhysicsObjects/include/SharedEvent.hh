@@ -0,0 +1,64 @@
+#ifndef SHAREDEVENT_HH
+#define SHAREDEVENT_HH
+
+#include <iostream>
+#include <vector>
+#include <TString.h>
+#include <TVector3.h>
+
+class TRecoVEvent;
+class TRecoLKrEvent;
+
+/// \class SharedEvent
+/// \Brief
+/// Per event results shared by the analyzers running in the same event loop
+/// \EndBrief
+///
+/// \Detailed
+/// Each analyzer registers in its constructor with AddAnalyzer() and calls BeginEvent() first
+/// thing in Process(): the first analyzer called a second time marks the start of a new event,
+/// so no framework hook is needed and a single analyzer sees every event as new.\n
+/// FindClosestCluster(): AnalysisKernels::FindClosestCluster() memoized for the event, keyed
+/// by the detector event and the extrapolated position. The analyzers extrapolate the same
+/// track with the same expressions, so the later ones reuse the association of the first.\n
+/// CorrectLKrEnergies(): the LKr non-linearity correction modifies the clusters in place,
+/// it is applied once per event whatever the number of analyzers asking for it.\n
+/// Report(): lookups and shared results, printed by the first analyzer when there are several.
+/// \EndDetailed
+class SharedEvent
+{
+public:
+    static SharedEvent& Instance();
+
+    int AddAnalyzer(TString name);
+    void BeginEvent(int analyzer);
+
+    int FindClosestCluster(TRecoVEvent* event, const TVector3& extrapolation, int detector, double& minimum);
+    void CorrectLKrEnergies(TRecoLKrEvent* event);
+
+    void Report(int analyzer, std::ostream& out) const;
+
+private:
+    struct Association {
+        const TRecoVEvent* fEvent;
+        int fDetector;
+        double fX;                      ///< Extrapolated position [mm]
+        double fY;                      ///< Extrapolated position [mm]
+        int fPosition;                  ///< Closest candidate, -1 if none
+        double fMinimum;                ///< [mm]
+    };
+
+    SharedEvent();
+    SharedEvent(const SharedEvent&);
+    SharedEvent& operator=(const SharedEvent&);
+
+    std::vector<TString> fAnalyzers;
+    std::vector<char> fSeen;            ///< Analyzers which started the current event
+    std::vector<Association> fAssociations;
+    bool fLKrCorrected;
+    Long64_t fNEvents;
+    Long64_t fNLookups;
+    Long64_t fNShared;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef STAGETIMER_HH
+#define STAGETIMER_HH
+
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "CycleClock.hh"
+
+class TH1D;
+
+/// \class StageTimer
+/// \Brief
+/// Time distribution of the stages of Process (reading, corrections, associations, histograms)
+/// \EndBrief
+///
+/// \Detailed
+/// Each stage is declared once with AddStage() and timed by a scope in Process:
+/// \code
+///     {
+///         StageTimer::Scope stageScope(fStageTimer, kStageRICH);
+///         for(...) ...
+///     }
+/// \endcode
+/// The time of all the scopes of a stage in one event is summed, so a stage can be timed
+/// in several places (one scope per loop, per call of a function). The analyzer calls
+/// StartEvent() at the beginning of Process() and EndEvent() in PostProcess(), which adds
+/// the time of the event to the fixed log binned distribution of each stage reached in the
+/// event (20 bins per decade from 1 ns to 100 ms, no allocation in the event loop).\n
+/// A stage can be nested in another one (parent of AddStage()): its time is then also
+/// included in the parent. The share of a stage is relative to the total time of the events.\n
+/// The timer is switched at run time with SetEnabled(): when disabled the scopes and the
+/// event calls cost one test. BookHistos() creates <name>_StageTime_<stage> (time per event,
+/// log10 axis) and the <name>_StageP50, <name>_StageP99 and <name>_StageShare summaries,
+/// filled by Fill() at the end of the run; Print() writes the same summary as a table.
+/// \EndDetailed
+class StageTimer
+{
+public:
+    /// Time of the enclosing scope, accounted to a stage
+    class Scope {
+    public:
+        inline Scope(StageTimer& timer, int stage) : fTimer(0), fStage(stage){
+            if(!timer.fEnabled) return;
+            fTimer = &timer;
+            fStart = CycleClock::Now();
+        }
+        inline ~Scope(){
+            if(!fTimer) return;
+            Stage& stage = fTimer->fStages[fStage];
+            stage.fEventTicks += CycleClock::Now() - fStart;
+            stage.fReached = true;
+        }
+    private:
+        StageTimer* fTimer;
+        int fStage;
+        CycleClock::Ticks fStart;
+    };
+
+    StageTimer(TString name);
+
+    void AddStage(int stage, TString name, int parent=-1);
+    void BookHistos(std::vector<TH1D*>& histos);
+    void SetEnabled(bool enabled) { fEnabled = enabled; }
+    bool IsEnabled() const { return fEnabled; }
+
+    inline void StartEvent(){
+        if(fEnabled) fEventStart = CycleClock::Now();
+    }
+    inline void EndEvent(){
+        if(fEnabled && fEventStart>0) AddEvent(CycleClock::Now());
+    }
+
+    void Fill() const;
+    void Print(std::ostream& out) const;
+
+    double GetPercentile(int stage, double fraction) const;
+    double GetTotalPercentile(double fraction) const { return Percentile(fTotal, fraction); }
+    double GetShare(int stage) const;
+
+    static const int kBinsPerDecade = 20;
+    static const int kNBins = 8*kBinsPerDecade; ///< 1 ns to 100 ms, the last bin includes the longer times
+
+private:
+    struct Stage {
+        TString fName;
+        int fParent;
+        Long64_t fNEvents;                ///< Events reaching the stage
+        CycleClock::Ticks fTicks;
+        CycleClock::Ticks fEventTicks;    ///< Current event
+        bool fReached;                    ///< In the current event
+        std::vector<Long64_t> fBins;      ///< Events per log10(time/ns) bin
+        TH1D* fHisto;                     ///< Owned by the analyzer once booked
+    };
+
+    void AddEvent(CycleClock::Ticks now);
+    static void AddTime(Stage& stage, CycleClock::Ticks ticks);
+    static double Percentile(const Stage& stage, double fraction);
+    int GetDepth(int stage) const;
+
+    TString fName;
+    bool fEnabled;
+    std::vector<Stage> fStages;
+    Stage fTotal;                         ///< From StartEvent() to EndEvent()
+    CycleClock::Ticks fEventStart;
+
+    TH1D* fP50Histo;   ///< Owned by the analyzer once booked
+    TH1D* fP99Histo;   ///< Owned by the analyzer once booked
+    TH1D* fShareHisto; ///< Owned by the analyzer once booked
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef TIMEOFFSETCALIBRATOR_HH
+#define TIMEOFFSETCALIBRATOR_HH
+
+#include <map>
+#include <ostream>
+#include <vector>
+#include <TString.h>
+#include "PeakFinder.hh"
+#include "TimeOffsetTable.hh"
+
+/// \class TimeOffsetCalibrator
+/// \Brief
+/// Online accumulation and fit of the detector time offsets, burst by burst
+/// \EndBrief
+///
+/// \Detailed
+/// During the calibration prepass the analyzer calls Fill() with the raw time difference
+/// CHOD - detector (no offset applied) of each selected track, at the places where the
+/// _timediff histograms are filled. The distributions are kept as counts in fixed bins,
+/// one contiguous block per detector. EndBurst() locates their peaks with a PeakFinder,
+/// stores the offsets of the burst and adds the counts to the run sums. Write() fits
+/// the run sums and writes the TimeOffsetTable read by the main pass.\n
+/// The offset of a detector is the opposite of its peak: with the offsets applied,
+/// CHOD - detector + offset peaks at 0, as with the hard-coded offsets of the analyzers.
+/// \EndDetailed
+class TimeOffsetCalibrator
+{
+public:
+    TimeOffsetCalibrator(int nBins=2400, double min=-300., double max=300., double window=5.);
+
+    inline void Fill(int detector, double timeDiff){
+        double x = (timeDiff-fMin)*fInvBinWidth;
+        if(x<0. || x>=fNBins) return;
+        fCounts[detector*fNBins + (int)x]++;
+    }
+
+    void EndBurst(int burstID);
+    bool Write(TString path);
+    void Print(std::ostream& out) const;
+
+private:
+    void FitPeaks(const std::vector<UInt_t>& counts, TimeOffsetTable::Row& offsets) const;
+
+    int fNBins;
+    double fMin;
+    double fMax;
+    double fInvBinWidth;
+    PeakFinder fPeakFinder;
+    std::vector<UInt_t> fCounts;    ///< Current burst, bin iBin of detector iDetector at iDetector*fNBins+iBin
+    std::vector<UInt_t> fRunCounts; ///< Sum of the calibrated bursts
+    std::map<int, TimeOffsetTable::Row> fBursts;
+    TimeOffsetTable::Row fRun;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef TIMEOFFSETTABLE_HH
+#define TIMEOFFSETTABLE_HH
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <TString.h>
+
+/// \class TimeOffsetTable
+/// \Brief
+/// Per burst time offsets of the detectors with respect to the CHOD, mapped from a binary file
+/// \EndBrief
+///
+/// \Detailed
+/// The file is written by TimeOffsetCalibrator::Write() at the end of the calibration
+/// prepass. It is a fixed size header followed by one row of kNDetectors floats for the
+/// whole run and one row for each burst between the first and the last calibrated burst,
+/// so that the row of a burst is found by its index (bursts without calibration and
+/// offsets which could not be fitted are NaN). The file is memory mapped read-only by
+/// Open(): nothing is parsed and the jobs of a node share the same pages.\n
+/// Get() falls back to the run offset, then to the value given by the caller (the
+/// hard-coded offsets of the analyzer). The layout is the one of the machine which wrote
+/// the file (no byte swapping).
+/// \EndDetailed
+class TimeOffsetTable
+{
+public:
+    enum Detector { kLKr, kMUV1, kMUV2, kMUV3, kCedar, kNDetectors };
+
+    /// Offsets of all the detectors for one burst (or the whole run) [ns]
+    struct Row {
+        float fOffset[kNDetectors];
+    };
+
+    TimeOffsetTable();
+    ~TimeOffsetTable();
+
+    bool Open(TString path);
+    void Close();
+    bool IsOpen() const { return fHeader!=0; }
+
+    inline double Get(int burstID, int detector, double fallback) const{
+        float offset = fRun->fOffset[detector];
+        unsigned int iBurst = burstID - fHeader->fFirstBurst;
+        if(iBurst<(unsigned int)fHeader->fNBursts && !std::isnan(fBursts[iBurst].fOffset[detector])) offset = fBursts[iBurst].fOffset[detector];
+        return std::isnan(offset) ? fallback : offset;
+    }
+
+    int GetFirstBurst() const { return fHeader->fFirstBurst; }
+    int GetNBursts() const { return fHeader->fNBursts; }
+
+    static bool Write(TString path, const std::map<int, Row>& bursts, const Row& run);
+    static const char* GetDetectorName(int detector);
+
+private:
+    struct Header {
+        char fMagic[8];
+        UInt_t fVersion;
+        Int_t fNDetectors;
+        Int_t fFirstBurst;
+        Int_t fNBursts;
+    };
+
+    void* fMap;
+    size_t fMapSize;
+    const Header* fHeader;
+    const Row* fRun;
+    const Row* fBursts;
+};
+
+#endif
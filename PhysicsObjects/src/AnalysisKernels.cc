@@ -0,0 +1,155 @@
+#include <cmath>
+#include <TClonesArray.h>
+#include "AnalysisKernels.hh"
+#include "Persistency.hh"
+
+using namespace std;
+
+TVector3 AnalysisKernels::VertexCDA(const TVector3& pos1, const TVector3& p1, const TVector3& pos2, const TVector3& p2, double& cda){
+    /// \MemberDescr
+    /// \param pos1, p1 : point and direction of the first line
+    /// \param pos2, p2 : point and direction of the second line
+    /// \param cda : receives the closest distance of approach
+    /// \return middle point of the segment of closest approach, (-9999,-9999,-9999) for parallel lines
+    /// \EndMemberDescr
+    TVector3 d = pos1 - pos2;
+    double p12 = p1.Dot(p2);
+    double det = p12*p12 - p1.Mag2() * p2.Mag2();
+    if (!det) return TVector3(-9999,-9999,-9999);
+    double t1 = (p2.Mag2()*d.Dot(p1) - p1.Dot(p2)*d.Dot(p2)) / det;
+    double t2 = (p1.Dot(p2)*d.Dot(p1) - p1.Mag2()*d.Dot(p2)) / det;
+    TVector3 q1 = pos1 + t1*p1;
+    TVector3 q2 = pos2 + t2*p2;
+    TVector3 vertex = 0.5*(q1 + q2);
+    cda = (q1 - q2).Mag();
+    return vertex;
+}
+
+int AnalysisKernels::FindClosestCluster(TRecoVEvent* event, const TVector3& extrapolation, int detector, double& minimum){
+    /// \MemberDescr
+    /// \param event : reco event of the detector
+    /// \param extrapolation : track at the detector plane [mm]
+    /// \param detector : Detector of the event, selects the candidate class and position units
+    /// \param minimum : receives the distance to the closest candidate [mm], unchanged if there is none
+    /// \return index of the closest candidate (the first one for equal distances), -1 if there is none
+    /// \EndMemberDescr
+    int position = -1;
+    int nCandidates = event->GetNCandidates();
+    for(int iCand=0; iCand<nCandidates; iCand++){
+        double clusterx = 0.;
+        double clustery = 0.;
+        switch(detector){
+        case kCHOD:{
+            TRecoCHODCandidate* Cluster = ((TRecoCHODCandidate*)event->GetCandidate(iCand));
+            clusterx = Cluster->GetHitPosition().X()*10.;
+            clustery = Cluster->GetHitPosition().Y()*10.;
+            break;
+        }
+        case kLKr:{
+            TRecoLKrCandidate* Cluster = ((TRecoLKrCandidate*)event->GetCandidate(iCand));
+            clusterx = Cluster->GetClusterX()*10.;
+            clustery = Cluster->GetClusterY()*10.;
+            break;
+        }
+        case kMUV1:{
+            TRecoMUV1Candidate* Cluster = ((TRecoMUV1Candidate*)event->GetCandidate(iCand));
+            clusterx = Cluster->GetPosition().X();
+            clustery = Cluster->GetPosition().Y();
+            break;
+        }
+        case kMUV2:{
+            TRecoMUV2Candidate* Cluster = ((TRecoMUV2Candidate*)event->GetCandidate(iCand));
+            clusterx = Cluster->GetPosition().X();
+            clustery = Cluster->GetPosition().Y();
+            break;
+        }
+        case kMUV3:{
+            TRecoMUV3Candidate* Cluster = ((TRecoMUV3Candidate*)event->GetCandidate(iCand));
+            clusterx = Cluster->GetX();
+            clustery = Cluster->GetY();
+            break;
+        }
+        default:
+            return -1;
+        }
+        double distance = sqrt(pow(clusterx - extrapolation.X(),2 ) + pow(clustery - extrapolation.Y(),2 ) );
+        if(position<0 || distance<minimum){
+            minimum = distance;
+            position = iCand;
+        }
+    }
+    return position;
+}
+
+double AnalysisKernels::LKrCorrectedEnergy(double energy, int nCells){
+    /// \MemberDescr
+    /// \param energy : reconstructed cluster energy [GeV]
+    /// \param nCells : number of cells, the non-linearity only applies above 9
+    /// \return energy after the zero suppression non-linearity and the 1.03 scale [GeV]
+    /// \EndMemberDescr
+    //Energy scale correction and non-linearity correction for the LKr taken from Giuseppe
+    double ce = energy;
+    if (nCells>9) {
+        if (energy<22) ce = energy/(0.7666+0.0573489*log(energy));
+        if (energy>=22 && energy<65) ce = energy/(0.828962+0.0369797*log(energy));
+        if (energy>=65) ce = energy/(0.828962+0.0369797*log(65));
+    }
+    return ce*1.03;
+}
+
+int AnalysisKernels::MatchStrip(int channelID, double tdiff, int vIndex, int hIndex){
+    /// \MemberDescr
+    /// \param channelID : channel of the MUV1/MUV2 hit
+    /// \param tdiff : time of the track (CHOD) minus the time of the hit [ns]
+    /// \param vIndex, hIndex : vertical and horizontal strips crossed by the track
+    /// \return StripMatch of the hit: within one strip of the track and 30 ns of its time
+    /// \EndMemberDescr
+    if(fabs(tdiff) >= 30) return kNoStrip;
+    int plane = channelID%100;
+    int strip = channelID%50;
+    if(plane < 50 && fabs(strip - vIndex) < 2) return kVerticalStrip;
+    if(plane > 50 && fabs(strip - hIndex) < 2) return kHorizontalStrip;
+    return kNoStrip;
+}
+
+int AnalysisKernels::MatchStrips(TRecoVEvent* event, int vIndex, int hIndex, double time, int& nVertical, int& nHorizontal){
+    /// \MemberDescr
+    /// \param event : MUV1 or MUV2 reco event
+    /// \param vIndex, hIndex : vertical and horizontal strips crossed by the track
+    /// \param time : time of the track (CHOD) plus the offset of the detector [ns]
+    /// \param nVertical, nHorizontal : receive the matched hits of each plane
+    /// \return number of matched hits, MatchStrip() of each hit
+    /// \EndMemberDescr
+    nVertical = 0;
+    nHorizontal = 0;
+    TClonesArray* hits = event->GetHits();
+    int nHits = event->GetNHits();
+    for(int iHit=0; iHit<nHits; iHit++){
+        TRecoVHit* hit = (TRecoVHit*)hits->At(iHit);
+        switch(MatchStrip(hit->GetChannelID(), time - hit->GetTime(), vIndex, hIndex)){
+        case kVerticalStrip:
+            nVertical++;
+            break;
+        case kHorizontalStrip:
+            nHorizontal++;
+            break;
+        }
+    }
+    return nVertical + nHorizontal;
+}
+
+double AnalysisKernels::RICHMass(double momentum, double ringRadius){
+    /// \MemberDescr
+    /// \param momentum : track momentum [MeV]
+    /// \param ringRadius : ring radius [mm]
+    /// \return mass [GeV], NaN below the Cherenkov threshold
+    /// \EndMemberDescr
+    double NeonN     = 1.000067;
+    double RICHAngle = atan( ringRadius/17000. );
+    return momentum*0.001*sqrt( pow(NeonN*cos(RICHAngle), 2 ) - 1.);
+}
+
+const char* AnalysisKernels::GetDetectorName(int detector){
+    static const char* names[kNDetectors] = {"CHOD", "LKr", "MUV1", "MUV2", "MUV3"};
+    return names[detector];
+}
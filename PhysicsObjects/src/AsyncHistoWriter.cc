@@ -0,0 +1,185 @@
+#include <cmath>
+#include <iostream>
+#include <RVersion.h>
+#include <TROOT.h>
+#include <TFile.h>
+#include <TH1.h>
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+#include <TThread.h>
+#endif
+#include "AsyncHistoWriter.hh"
+
+using namespace std;
+
+AsyncHistoWriter::AsyncHistoWriter(TString fileName, size_t maxPending) :
+    fFileName(fileName),
+    fMaxPending(maxPending>0 ? maxPending : 1),
+    fFile(0),
+    fStop(false),
+    fNWritten(0),
+    fNDropped(0)
+{
+    /// \MemberDescr
+    /// \param fileName : path of the ROOT file receiving the per burst snapshots
+    /// \param maxPending : maximum number of snapshots waiting to be written
+    ///
+    /// Starts the writer thread. ROOT must be told that it is used from several threads
+    /// before the thread touches any TFile.
+    /// \EndMemberDescr
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+    ROOT::EnableThreadSafety();
+#else
+    TThread::Initialize();
+#endif
+    fThread = thread(&AsyncHistoWriter::Run, this);
+}
+
+AsyncHistoWriter::~AsyncHistoWriter(){
+    Finish();
+}
+
+void AsyncHistoWriter::Snapshot(int burstID, const vector<TH1*>& histos){
+    /// \MemberDescr
+    /// \param burstID : ID of the burst that just ended
+    /// \param histos : histograms to snapshot (not modified)
+    ///
+    /// Clones the histograms and queues them for writing. Never waits for the writer.
+    /// \EndMemberDescr
+    Job job;
+    job.fBurstID = burstID;
+    job.fHistos.reserve(histos.size());
+
+    //Clones must not be attached to the current directory (output file of the framework)
+    Bool_t addStatus = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    for(size_t iHisto=0; iHisto<histos.size(); iHisto++){
+        if(!histos[iHisto]) continue;
+        job.fHistos.push_back((TH1*)histos[iHisto]->Clone());
+    }
+    TH1::AddDirectory(addStatus);
+
+    lock_guard<mutex> lock(fMutex);
+    if(fStop){
+        Delete(job);
+        return;
+    }
+    if(fQueue.size() >= fMaxPending){
+        Delete(fQueue.front());
+        fQueue.pop_front();
+        fNDropped++;
+    }
+    fQueue.push_back(job);
+    fCondition.notify_one();
+}
+
+void AsyncHistoWriter::Finish(){
+    /// \MemberDescr
+    /// Writes the pending snapshots, stops the thread and closes the file. Only to be
+    /// called at the end of the run.
+    /// \EndMemberDescr
+    {
+        lock_guard<mutex> lock(fMutex);
+        if(fStop && !fThread.joinable()) return;
+        fStop = true;
+    }
+    fCondition.notify_one();
+    if(fThread.joinable()) fThread.join();
+
+    if(fNDropped>0)
+        cout << "AsyncHistoWriter: " << fNDropped << " burst snapshots were merged into the following ones (" << fFileName << ")" << endl;
+}
+
+void AsyncHistoWriter::Run(){
+    while(true){
+        Job job;
+        {
+            unique_lock<mutex> lock(fMutex);
+            while(!fStop && fQueue.empty()) fCondition.wait(lock);
+            if(fQueue.empty()) break;
+            job = fQueue.front();
+            fQueue.pop_front();
+        }
+        Write(job);
+    }
+
+    for(map<TString, TH1*>::iterator it=fPrevious.begin(); it!=fPrevious.end(); ++it) delete it->second;
+    fPrevious.clear();
+    if(fFile){
+        fFile->Close();
+        delete fFile;
+        fFile = 0;
+    }
+}
+
+void AsyncHistoWriter::Write(Job& job){
+    if(!fFile){
+        fFile = TFile::Open(fFileName, "RECREATE");
+        if(!fFile || fFile->IsZombie()){
+            cerr << "AsyncHistoWriter: unable to open " << fFileName << ", burst snapshots are discarded" << endl;
+            delete fFile;
+            fFile = 0;
+        }
+    }
+    if(!fFile){
+        Delete(job);
+        return;
+    }
+
+    TDirectory* cumulativeDir = fFile->GetDirectory("Cumulative");
+    if(!cumulativeDir) cumulativeDir = fFile->mkdir("Cumulative");
+    TDirectory* burstDir = fFile->mkdir(Form("Burst_%d", job.fBurstID));
+    if(!burstDir) burstDir = fFile->GetDirectory(Form("Burst_%d", job.fBurstID));
+
+    for(size_t iHisto=0; iHisto<job.fHistos.size(); iHisto++){
+        TH1* snapshot = job.fHistos[iHisto];
+        TString name = snapshot->GetName();
+
+        cumulativeDir->WriteTObject(snapshot, name, "Overwrite");
+
+        //Delta = snapshot - previous. The previous snapshot is turned into the delta in place
+        //so that no new histogram has to be created on this thread.
+        map<TString, TH1*>::iterator prev = fPrevious.find(name);
+        if(prev==fPrevious.end()){
+            burstDir->WriteTObject(snapshot, name);
+            fPrevious[name] = snapshot;
+        }
+        else{
+            Subtract(prev->second, snapshot);
+            burstDir->WriteTObject(prev->second, name);
+            delete prev->second;
+            prev->second = snapshot;
+        }
+    }
+    job.fHistos.clear();
+
+    fFile->SaveSelf(kTRUE);
+    cumulativeDir->SaveSelf(kTRUE);
+    burstDir->SaveSelf(kTRUE);
+    fFile->Flush();
+    fNWritten++;
+}
+
+void AsyncHistoWriter::Subtract(TH1* previous, const TH1* snapshot){
+    /// \MemberDescr
+    /// \param previous : cumulative histogram of the previous snapshot, replaced by the delta
+    /// \param snapshot : current cumulative histogram, same binning
+    ///
+    /// Add(snapshot, -1) would add the errors in quadrature: the variance of the delta is the
+    /// difference of the variances instead. Without Sumw2 the errors follow the contents.
+    /// \EndMemberDescr
+    double entries = snapshot->GetEntries() - previous->GetEntries();
+    bool sumw2 = previous->GetSumw2N()>0;
+    for(int iCell=0; iCell<previous->GetNcells(); iCell++){
+        double content = snapshot->GetBinContent(iCell) - previous->GetBinContent(iCell);
+        double variance = fabs(pow(snapshot->GetBinError(iCell), 2) - pow(previous->GetBinError(iCell), 2));
+        previous->SetBinContent(iCell, content);
+        if(sumw2) previous->SetBinError(iCell, sqrt(variance));
+    }
+    previous->ResetStats();
+    previous->SetEntries(entries);
+}
+
+void AsyncHistoWriter::Delete(Job& job){
+    for(size_t iHisto=0; iHisto<job.fHistos.size(); iHisto++) delete job.fHistos[iHisto];
+    job.fHistos.clear();
+}
@@ -0,0 +1,90 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "BadBurstList.hh"
+
+using namespace std;
+
+BadBurstList::BadBurstList() :
+    fFirstBurst(0),
+    fNBadBursts(0)
+{
+}
+
+bool BadBurstList::Read(TString path){
+    /// \MemberDescr
+    /// \param path : text list of the bad bursts
+    /// \return false if the file cannot be read or contains an unknown flag (the list is then empty)
+    /// \EndMemberDescr
+    ifstream in(path.Data());
+    if(!in.is_open()){
+        cerr << "BadBurstList: unable to read " << path << endl;
+        Set(map<int, UInt_t>());
+        return false;
+    }
+    map<int, UInt_t> bursts;
+    string line;
+    int iLine = 0;
+    while(getline(in, line)){
+        iLine++;
+        istringstream fields(line);
+        string type;
+        int burstID;
+        if(!(fields >> type) || type!="burst") continue;
+        if(!(fields >> burstID)){
+            cerr << "BadBurstList: " << path << ":" << iLine << ": missing burst ID" << endl;
+            Set(map<int, UInt_t>());
+            return false;
+        }
+        string name;
+        while(fields >> name){
+            int bit = 0;
+            while(bit<kNFlags && name!=GetFlagName(bit)) bit++;
+            if(bit==kNFlags){
+                cerr << "BadBurstList: " << path << ":" << iLine << ": unknown flag " << name << endl;
+                Set(map<int, UInt_t>());
+                return false;
+            }
+            bursts[burstID] |= 1<<bit;
+        }
+    }
+    Set(bursts);
+    return true;
+}
+
+void BadBurstList::Set(const map<int, UInt_t>& bursts){
+    /// \MemberDescr
+    /// \param bursts : flags of each bad burst (bursts without flag are ignored)
+    /// \EndMemberDescr
+    fFlags.clear();
+    fNBadBursts = 0;
+    fFirstBurst = 0;
+    for(map<int, UInt_t>::const_iterator it=bursts.begin(); it!=bursts.end(); ++it){
+        if(it->second==0) continue;
+        if(fNBadBursts==0) fFirstBurst = it->first;
+        fFlags.resize(it->first - fFirstBurst + 1, 0);
+        fFlags[it->first - fFirstBurst] = it->second;
+        fNBadBursts++;
+    }
+}
+
+bool BadBurstList::Write(ostream& out, int burstID, UInt_t flags){
+    /// \MemberDescr
+    /// \param out : stream receiving the line of the burst
+    /// \param burstID : bad burst
+    /// \param flags : its flags, nothing is written if there is none
+    /// \return true if the line was written
+    /// \EndMemberDescr
+    if(flags==0) return false;
+    out << "burst " << burstID;
+    for(int bit=0; bit<kNFlags; bit++){
+        if(flags & (1<<bit)) out << " " << GetFlagName(bit);
+    }
+    out << endl;
+    return true;
+}
+
+const char* BadBurstList::GetFlagName(int bit){
+    static const char* names[kNFlags] = {"MUV1Inefficient", "MUV1Channels", "MUV2Inefficient", "MUV2Channels"};
+    return (bit>=0 && bit<kNFlags) ? names[bit] : "Unknown";
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <Math/ProbFuncMathCore.h>
+#include <TH1D.h>
+#include <TSystem.h>
+#include "BurstQuality.hh"
+
+using namespace std;
+
+static const UInt_t kInefficientFlag[BurstQuality::kNDetectors] = {BadBurstList::kMUV1Inefficient, BadBurstList::kMUV2Inefficient};
+static const UInt_t kChannelsFlag[BurstQuality::kNDetectors]    = {BadBurstList::kMUV1Channels, BadBurstList::kMUV2Channels};
+
+BurstQuality::BurstQuality(TString name, double pValue, double nSigma, double deadFraction, double hotFactor) :
+    fName(name),
+    fPValue(pValue),
+    fNSigma(nSigma),
+    fDeadFraction(deadFraction),
+    fHotFactor(hotFactor),
+    fBurstEvents(0),
+    fEvents(0)
+{
+    /// \MemberDescr
+    /// \param name : prefix of the histograms
+    /// \param pValue : Poisson tail probability below which a count is significant
+    /// \param nSigma : minimal deviation from the run mean, in burst to burst standard deviations
+    /// \param deadFraction : a channel below deadFraction x median occupancy can be dead for the run
+    /// \param hotFactor : a channel above hotFactor x median occupancy can be hot for the run
+    /// \EndMemberDescr
+    RunningStat empty = {0, 0., 0.};
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        int nChannels = MUVChannelMap::GetNChannels(iDetector);
+        fBurstHits[iDetector].assign(nChannels, 0);
+        fBurstProbes[iDetector] = 0;
+        fBurstPassed[iDetector] = 0;
+        fHits[iDetector].assign(nChannels, 0);
+        fProbes[iDetector] = 0;
+        fPassed[iDetector] = 0;
+        fOccupancy[iDetector].assign(nChannels, empty);
+        fEfficiency[iDetector] = empty;
+        fStatus[iDetector].assign(nChannels, kGood);
+        fNFlagged[iDetector].assign(nChannels, 0);
+        fMedian[iDetector] = 0.;
+        fOccupancyHistos[iDetector] = 0;
+        fStatusHistos[iDetector] = 0;
+    }
+}
+
+void BurstQuality::EndBurst(int burstID){
+    /// \MemberDescr
+    /// \param burstID : burst of the events counted since the previous call
+    ///
+    /// Bursts without any event are not recorded.
+    /// \EndMemberDescr
+    if(fBurstEvents==0) return;
+    Burst burst;
+    burst.fBurstID = burstID;
+    burst.fEvents = fBurstEvents;
+    fEvents += fBurstEvents;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        for(size_t iChannel=0; iChannel<fBurstHits[iDetector].size(); iChannel++){
+            fHits[iDetector][iChannel] += fBurstHits[iDetector][iChannel];
+            fOccupancy[iDetector][iChannel].Add((double)fBurstHits[iDetector][iChannel]/fBurstEvents);
+        }
+        if(fBurstProbes[iDetector]>0) fEfficiency[iDetector].Add((double)fBurstPassed[iDetector]/fBurstProbes[iDetector]);
+        fProbes[iDetector] += fBurstProbes[iDetector];
+        fPassed[iDetector] += fBurstPassed[iDetector];
+        burst.fProbes[iDetector] = fBurstProbes[iDetector];
+        burst.fPassed[iDetector] = fBurstPassed[iDetector];
+        burst.fHits[iDetector].swap(fBurstHits[iDetector]);
+        fBurstHits[iDetector].assign(burst.fHits[iDetector].size(), 0);
+        fBurstProbes[iDetector] = 0;
+        fBurstPassed[iDetector] = 0;
+    }
+    fBurstEvents = 0;
+    fBursts.push_back(burst);
+}
+
+bool BurstQuality::IsOutlier(UInt_t observed, double expected, double value, const RunningStat& reference, bool low) const{
+    /// \MemberDescr
+    /// \param observed, expected : count of the burst and its Poisson expectation from the run reference
+    /// \param value : quantity of the burst (occupancy or efficiency) compared to the reference
+    /// \param reference : mean and variance of the quantity across bursts
+    /// \param low : test for a deficit (true) or an excess (false) of counts
+    /// \return true if the deviation is both significant and beyond the burst to burst spread
+    /// \EndMemberDescr
+    if(fabs(value - reference.fMean) <= fNSigma*sqrt(reference.GetVariance())) return false;
+    double probability;
+    if(low) probability = ROOT::Math::poisson_cdf(observed, expected);
+    else probability = observed==0 ? 1. : ROOT::Math::poisson_cdf_c(observed-1, expected);
+    return probability<fPValue;
+}
+
+void BurstQuality::Classify(){
+    /// \MemberDescr
+    /// Flags the dead/hot channels of the run and the bad bursts from the ended bursts
+    /// \EndMemberDescr
+    fFlags.clear();
+    if(fEvents==0) return;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        int nChannels = fHits[iDetector].size();
+        vector<double> occupancy(nChannels);
+        for(int iChannel=0; iChannel<nChannels; iChannel++) occupancy[iChannel] = (double)fHits[iDetector][iChannel]/fEvents;
+        vector<double> sorted(occupancy);
+        nth_element(sorted.begin(), sorted.begin()+nChannels/2, sorted.end());
+        fMedian[iDetector] = sorted[nChannels/2];
+
+        //Run: with respect to the median channel
+        for(int iChannel=0; iChannel<nChannels; iChannel++){
+            double expected = fMedian[iDetector]*fEvents;
+            Long64_t observed = fHits[iDetector][iChannel];
+            fStatus[iDetector][iChannel] = kGood;
+            fNFlagged[iDetector][iChannel] = 0;
+            if(occupancy[iChannel]<fDeadFraction*fMedian[iDetector] && ROOT::Math::poisson_cdf(observed, expected)<fPValue) fStatus[iDetector][iChannel] = kDead;
+            else if(occupancy[iChannel]>fHotFactor*fMedian[iDetector] && ROOT::Math::poisson_cdf_c(observed-1, expected)<fPValue) fStatus[iDetector][iChannel] = kHot;
+        }
+
+        //Bursts: with respect to the run
+        double efficiency = fProbes[iDetector]>0 ? (double)fPassed[iDetector]/fProbes[iDetector] : 1.;
+        for(size_t iBurst=0; iBurst<fBursts.size(); iBurst++){
+            const Burst& burst = fBursts[iBurst];
+            bool flagged = false;
+            for(int iChannel=0; iChannel<nChannels; iChannel++){
+                if(fStatus[iDetector][iChannel]!=kGood) continue;
+                const RunningStat& reference = fOccupancy[iDetector][iChannel];
+                UInt_t hits = burst.fHits[iDetector][iChannel];
+                double value = (double)hits/burst.fEvents;
+                if(!IsOutlier(hits, reference.fMean*burst.fEvents, value, reference, value<reference.fMean)) continue;
+                fNFlagged[iDetector][iChannel]++;
+                flagged = true;
+            }
+            if(flagged) fFlags[burst.fBurstID] |= kChannelsFlag[iDetector];
+
+            if(burst.fProbes[iDetector]==0) continue;
+            UInt_t failed = burst.fProbes[iDetector] - burst.fPassed[iDetector];
+            double value = (double)burst.fPassed[iDetector]/burst.fProbes[iDetector];
+            if(value<fEfficiency[iDetector].fMean && IsOutlier(failed, (1.-efficiency)*burst.fProbes[iDetector], value, fEfficiency[iDetector], false)) fFlags[burst.fBurstID] |= kInefficientFlag[iDetector];
+        }
+
+        if(!fOccupancyHistos[iDetector] || !fStatusHistos[iDetector]) continue;
+        for(int iChannel=0; iChannel<nChannels; iChannel++){
+            fOccupancyHistos[iDetector]->SetBinContent(iChannel+1, fOccupancy[iDetector][iChannel].fMean);
+            fOccupancyHistos[iDetector]->SetBinError(iChannel+1, sqrt(fOccupancy[iDetector][iChannel].GetVariance()));
+            fStatusHistos[iDetector]->SetBinContent(iChannel+1, fStatus[iDetector][iChannel]);
+        }
+    }
+    fBadBursts.Set(fFlags);
+}
+
+void BurstQuality::BookHistos(vector<TH1D*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book
+    ///
+    /// <name>_<detector>_Occupancy: mean hits per event of each channel index, error = burst to burst spread\n
+    /// <name>_<detector>_ChannelStatus: 0 good, 1 dead, 2 hot
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        TString detector = MUVChannelMap::GetDetectorName(iDetector);
+        int nChannels = fHits[iDetector].size();
+        fOccupancyHistos[iDetector] = new TH1D(fName + "_" + detector + "_Occupancy", fName + " " + detector + " occupancy;Channel index;Hits per event", nChannels, 0, nChannels);
+        fStatusHistos[iDetector] = new TH1D(fName + "_" + detector + "_ChannelStatus", fName + " " + detector + " channel status (1: dead, 2: hot);Channel index", nChannels, 0, nChannels);
+        histos.push_back(fOccupancyHistos[iDetector]);
+        histos.push_back(fStatusHistos[iDetector]);
+    }
+}
+
+bool BurstQuality::Write(TString path) const{
+    /// \MemberDescr
+    /// \param path : text file receiving the bad burst list (replaced)
+    /// \return false if the file cannot be written
+    ///
+    /// One burst line per bad burst (read by BadBurstList) followed by one channel line per
+    /// dead or hot channel: detector, channel ID, status, occupancy and median occupancy.
+    /// \EndMemberDescr
+    //Written next to the final file and renamed: a job reading the list never sees a partial file
+    TString tmpFile = Form("%s.%d", path.Data(), gSystem->GetPid());
+    ofstream out(tmpFile.Data());
+    if(!out.is_open()){
+        cerr << "BurstQuality: unable to write " << path << endl;
+        return false;
+    }
+    out << "# " << fName << " burst quality: " << fBursts.size() << " bursts, " << fEvents << " events, Poisson p-value < " << fPValue << " and " << fNSigma << " sigma" << endl;
+    out << "# burst BurstID Flags" << endl;
+    for(map<int, UInt_t>::const_iterator it=fFlags.begin(); it!=fFlags.end(); ++it) BadBurstList::Write(out, it->first, it->second);
+    out << "# channel Detector ChannelID Status Occupancy MedianOccupancy" << endl;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        for(size_t iChannel=0; iChannel<fStatus[iDetector].size(); iChannel++){
+            if(fStatus[iDetector][iChannel]==kGood) continue;
+            out << "channel " << MUVChannelMap::GetDetectorName(iDetector) << " " << MUVChannelMap::GetChannelID(iDetector, iChannel)
+                << " " << (fStatus[iDetector][iChannel]==kDead ? "Dead" : "Hot") << " " << (double)fHits[iDetector][iChannel]/fEvents
+                << " " << fMedian[iDetector] << endl;
+        }
+    }
+    out.close();
+    return gSystem->Rename(tmpFile, path)==0;
+}
+
+void BurstQuality::Print(ostream& out) const{
+    out << endl << "Burst quality " << fName << ": " << fBursts.size() << " bursts, " << fBadBursts.GetNBadBursts() << " bad" << endl;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        int nDead = count(fStatus[iDetector].begin(), fStatus[iDetector].end(), (int)kDead);
+        int nHot  = count(fStatus[iDetector].begin(), fStatus[iDetector].end(), (int)kHot);
+        int nFlagged = 0;
+        for(size_t iChannel=0; iChannel<fNFlagged[iDetector].size(); iChannel++) nFlagged += fNFlagged[iDetector][iChannel];
+        out << "  " << MUVChannelMap::GetDetectorName(iDetector) << ": " << nDead << " dead and " << nHot << " hot channels, " << nFlagged << " channel outliers in single bursts";
+        if(fEfficiency[iDetector].fN>0) out << ", efficiency per burst " << fEfficiency[iDetector].fMean << " +- " << sqrt(fEfficiency[iDetector].GetVariance());
+        out << endl;
+        out << "    inefficient bursts:";
+        for(map<int, UInt_t>::const_iterator it=fFlags.begin(); it!=fFlags.end(); ++it){
+            if(it->second & kInefficientFlag[iDetector]) out << " " << it->first;
+        }
+        out << endl << "    bursts with dead/hot channels:";
+        for(map<int, UInt_t>::const_iterator it=fFlags.begin(); it!=fFlags.end(); ++it){
+            if(it->second & kChannelsFlag[iDetector]) out << " " << it->first;
+        }
+        out << endl;
+    }
+}
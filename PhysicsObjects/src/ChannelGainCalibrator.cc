@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <TH1D.h>
+#include <TSystem.h>
+#include "ChannelGainCalibrator.hh"
+
+using namespace std;
+
+ChannelGainCalibrator::ChannelGainCalibrator(TString name, int nBins, double min, double max, double threshold, double window) :
+    fName(name),
+    fThreshold(threshold),
+    fPeakFinder(window, 100.)
+{
+    /// \MemberDescr
+    /// \param name : prefix of the histograms
+    /// \param nBins : number of bins of the charge spectrum of each channel
+    /// \param min : lower edge of the spectra
+    /// \param max : upper edge of the spectra
+    /// \param threshold : the MIP peak is searched above this charge (pedestal and noise below)
+    /// \param window : half width of the window of the peak estimate
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        int nChannels = MUVChannelMap::GetNChannels(iDetector);
+        fBlocks.push_back(ChannelHistogramBlock<UShort_t>(nChannels, nBins, min, max));
+        ChannelPeak empty = {NAN, 0., 0.};
+        fPeaks[iDetector].assign(nChannels, empty);
+        fReference[iDetector] = NAN;
+        fPeakHistos[iDetector] = 0;
+        fGainHistos[iDetector] = 0;
+    }
+}
+
+void ChannelGainCalibrator::BookHistos(vector<TH1D*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book
+    ///
+    /// <name>_<detector>_ChannelMIP: MIP peak of each channel index\n
+    /// <name>_<detector>_ChannelGain: gain constant of each channel index
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        TString detector = MUVChannelMap::GetDetectorName(iDetector);
+        int nChannels = fBlocks[iDetector].GetNChannels();
+        fPeakHistos[iDetector] = new TH1D(fName + "_" + detector + "_ChannelMIP", fName + " " + detector + " MIP peak;Channel index;Charge", nChannels, 0, nChannels);
+        fGainHistos[iDetector] = new TH1D(fName + "_" + detector + "_ChannelGain", fName + " " + detector + " gain constant;Channel index;Gain", nChannels, 0, nChannels);
+        histos.push_back(fPeakHistos[iDetector]);
+        histos.push_back(fGainHistos[iDetector]);
+    }
+}
+
+void ChannelGainCalibrator::Fit(int nThreads){
+    /// \MemberDescr
+    /// \param nThreads : threads used to fit the channels of each detector (<=0: number of cores)
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        fBlocks[iDetector].FindPeaks(fPeakFinder, fPeaks[iDetector], nThreads, fThreshold);
+
+        vector<double> peaks;
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            if(!std::isnan(fPeaks[iDetector][iChannel].fPeak)) peaks.push_back(fPeaks[iDetector][iChannel].fPeak);
+        }
+        fReference[iDetector] = NAN;
+        if(!peaks.empty()){
+            nth_element(peaks.begin(), peaks.begin()+peaks.size()/2, peaks.end());
+            fReference[iDetector] = peaks[peaks.size()/2];
+        }
+
+        if(!fPeakHistos[iDetector] || !fGainHistos[iDetector]) continue;
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            const ChannelPeak& peak = fPeaks[iDetector][iChannel];
+            if(std::isnan(peak.fPeak)) continue;
+            fPeakHistos[iDetector]->SetBinContent(iChannel+1, peak.fPeak);
+            fPeakHistos[iDetector]->SetBinError(iChannel+1, peak.fRMS/sqrt(peak.fEntries));
+            fGainHistos[iDetector]->SetBinContent(iChannel+1, GetGain(iDetector, iChannel));
+        }
+    }
+}
+
+double ChannelGainCalibrator::GetGain(int detector, int channel) const{
+    /// \MemberDescr
+    /// \param detector : MUVChannelMap::kMUV1 or kMUV2
+    /// \param channel : MUVChannelMap channel index
+    /// \return gain constant, NaN if the channel could not be fitted
+    /// \EndMemberDescr
+    return fReference[detector]/fPeaks[detector][channel].fPeak;
+}
+
+bool ChannelGainCalibrator::Write(TString path) const{
+    /// \MemberDescr
+    /// \param path : text file receiving the table (replaced)
+    /// \return false if the file cannot be written
+    ///
+    /// One line per fitted channel: detector, channel ID, gain constant, MIP peak, rms
+    /// and number of entries of the peak. Channels without enough entries are not written
+    /// (gain 1 in the reconstruction).
+    /// \EndMemberDescr
+    //Written next to the final file and renamed: a job reading the table never sees a partial file
+    TString tmpFile = Form("%s.%d", path.Data(), gSystem->GetPid());
+    ofstream out(tmpFile.Data());
+    if(!out.is_open()){
+        cerr << "ChannelGainCalibrator: unable to write " << path << endl;
+        return false;
+    }
+    out << "# " << fName << " channel gain: charge x gain has the same MIP peak in all the channels of a detector" << endl;
+    out << "# Detector ChannelID Gain MIPPeak RMS Entries" << endl;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            const ChannelPeak& peak = fPeaks[iDetector][iChannel];
+            if(std::isnan(peak.fPeak)) continue;
+            out << MUVChannelMap::GetDetectorName(iDetector) << " " << MUVChannelMap::GetChannelID(iDetector, iChannel) << " " << GetGain(iDetector, iChannel)
+                << " " << peak.fPeak << " " << peak.fRMS << " " << peak.fEntries << endl;
+        }
+    }
+    out.close();
+    return gSystem->Rename(tmpFile, path)==0;
+}
+
+void ChannelGainCalibrator::Print(ostream& out) const{
+    out << endl << "Channel gains " << fName << ":" << endl;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        int nFitted = 0;
+        double minGain = 0., maxGain = 0.;
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            double gain = GetGain(iDetector, iChannel);
+            if(std::isnan(gain)) continue;
+            if(nFitted==0 || gain<minGain) minGain = gain;
+            if(nFitted==0 || gain>maxGain) maxGain = gain;
+            nFitted++;
+        }
+        out << "  " << MUVChannelMap::GetDetectorName(iDetector) << ": " << nFitted << "/" << fPeaks[iDetector].size() << " channels fitted";
+        if(nFitted>0) out << ", median MIP peak " << fReference[iDetector] << ", gains from " << minGain << " to " << maxGain;
+        out << endl;
+    }
+}
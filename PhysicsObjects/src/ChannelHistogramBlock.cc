@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "ChannelHistogramBlock.hh"
+
+using namespace std;
+
+template <typename T>
+ChannelHistogramBlock<T>::ChannelHistogramBlock(int nChannels, int nBins, double min, double max) :
+    fNChannels(nChannels),
+    fNBins(nBins),
+    fMin(min),
+    fMax(max),
+    fInvBinWidth(nBins/(max-min)),
+    fCounts(nChannels*nBins, 0)
+{
+    /// \MemberDescr
+    /// \param nChannels : number of channels (dense indices 0 to nChannels-1)
+    /// \param nBins : number of bins of each channel
+    /// \param min : lower edge of the distributions
+    /// \param max : upper edge of the distributions
+    /// \EndMemberDescr
+}
+
+template <typename T>
+void ChannelHistogramBlock<T>::Reset(){
+    fill(fCounts.begin(), fCounts.end(), 0);
+}
+
+template <typename T>
+void ChannelHistogramBlock<T>::Add(const ChannelHistogramBlock<T>& other){
+    /// \MemberDescr
+    /// \param other : block with the same channels and binning, added bin by bin (saturating)
+    /// \EndMemberDescr
+    if(other.fCounts.size()!=fCounts.size()) return;
+    for(size_t iBin=0; iBin<fCounts.size(); iBin++){
+        double sum = (double)fCounts[iBin] + other.fCounts[iBin];
+        fCounts[iBin] = sum<numeric_limits<T>::max() ? (T)sum : numeric_limits<T>::max();
+    }
+}
+
+template <typename T>
+double ChannelHistogramBlock<T>::GetEntries(int channel) const{
+    double entries = 0.;
+    const T* counts = GetCounts(channel);
+    for(int iBin=0; iBin<fNBins; iBin++) entries += counts[iBin];
+    return entries;
+}
+
+template <typename T>
+void ChannelHistogramBlock<T>::FindPeaks(const PeakFinder& finder, vector<ChannelPeak>& peaks, int nThreads, double threshold) const{
+    /// \MemberDescr
+    /// \param finder : peak estimator, shared by the threads (const)
+    /// \param peaks : receives the peak of each channel
+    /// \param nThreads : number of threads (<=0: number of cores)
+    /// \param threshold : only the bins above threshold are considered
+    ///
+    /// Each thread handles a contiguous range of channels, i.e. of the count block.
+    /// \EndMemberDescr
+    peaks.resize(fNChannels);
+    int firstBin = max(0, (int)ceil((threshold-fMin)*fInvBinWidth));
+    firstBin = min(firstBin, fNBins);
+    if(nThreads<=0) nThreads = thread::hardware_concurrency();
+    //A thread is not worth it for less than a few channels
+    nThreads = max(1, min(nThreads, fNChannels/8));
+
+    vector<thread> threads;
+    int first = 0;
+    for(int iThread=0; iThread<nThreads; iThread++){
+        int last = first + (fNChannels-first)/(nThreads-iThread);
+        if(iThread==nThreads-1) FindPeaks(finder, peaks, firstBin, first, last);
+        else threads.push_back(thread([this, &finder, &peaks, firstBin, first, last](){ FindPeaks(finder, peaks, firstBin, first, last); }));
+        first = last;
+    }
+    for(size_t iThread=0; iThread<threads.size(); iThread++) threads[iThread].join();
+}
+
+template <typename T>
+void ChannelHistogramBlock<T>::FindPeaks(const PeakFinder& finder, vector<ChannelPeak>& peaks, int firstBin, int firstChannel, int lastChannel) const{
+    double xFirst = fMin + firstBin/fInvBinWidth;
+    for(int iChannel=firstChannel; iChannel<lastChannel; iChannel++){
+        ChannelPeak& peak = peaks[iChannel];
+        peak.fRMS = 0.;
+        peak.fEntries = 0.;
+        peak.fPeak = finder.Find(GetCounts(iChannel)+firstBin, fNBins-firstBin, xFirst, fMax, &peak.fRMS, &peak.fEntries);
+    }
+}
+
+template class ChannelHistogramBlock<UShort_t>;
+template class ChannelHistogramBlock<UInt_t>;
@@ -0,0 +1,105 @@
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <TH1D.h>
+#include <TSystem.h>
+#include "ChannelT0Calibrator.hh"
+
+using namespace std;
+
+ChannelT0Calibrator::ChannelT0Calibrator(TString name, int nBins, double min, double max, double window) :
+    fName(name),
+    fPeakFinder(window)
+{
+    /// \MemberDescr
+    /// \param name : prefix of the histograms
+    /// \param nBins : number of bins of the time difference of each channel
+    /// \param min : lower edge of the time differences [ns]
+    /// \param max : upper edge of the time differences [ns]
+    /// \param window : half width of the window of the peak estimate [ns]
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<MUVChannelMap::kNDetectors; iDetector++){
+        int nChannels = MUVChannelMap::GetNChannels(iDetector);
+        fBlocks.push_back(ChannelHistogramBlock<UInt_t>(nChannels, nBins, min, max));
+        ChannelPeak empty = {NAN, 0., 0.};
+        fPeaks[iDetector].assign(nChannels, empty);
+        fT0Histos[iDetector] = 0;
+    }
+}
+
+void ChannelT0Calibrator::BookHistos(vector<TH1D*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book
+    ///
+    /// <name>_<detector>_ChannelT0: T0 of each channel index, error: rms/sqrt(entries) of the peak
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<MUVChannelMap::kNDetectors; iDetector++){
+        int nChannels = fBlocks[iDetector].GetNChannels();
+        fT0Histos[iDetector] = new TH1D(fName + "_" + MUVChannelMap::GetDetectorName(iDetector) + "_ChannelT0",
+                                        fName + " " + MUVChannelMap::GetDetectorName(iDetector) + " channel T0;Channel index;T0 [ns]", nChannels, 0, nChannels);
+        histos.push_back(fT0Histos[iDetector]);
+    }
+}
+
+void ChannelT0Calibrator::EndBurst(int nThreads){
+    /// \MemberDescr
+    /// \param nThreads : threads used to fit the channels of each detector (<=0: number of cores)
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<MUVChannelMap::kNDetectors; iDetector++){
+        fBlocks[iDetector].FindPeaks(fPeakFinder, fPeaks[iDetector], nThreads);
+        if(!fT0Histos[iDetector]) continue;
+        fT0Histos[iDetector]->Reset();
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            const ChannelPeak& peak = fPeaks[iDetector][iChannel];
+            if(std::isnan(peak.fPeak)) continue;
+            fT0Histos[iDetector]->SetBinContent(iChannel+1, -peak.fPeak);
+            fT0Histos[iDetector]->SetBinError(iChannel+1, peak.fRMS/sqrt(peak.fEntries));
+        }
+    }
+}
+
+bool ChannelT0Calibrator::Write(TString path) const{
+    /// \MemberDescr
+    /// \param path : text file receiving the table (replaced)
+    /// \return false if the file cannot be written
+    ///
+    /// One line per calibrated channel: detector, channel ID (tile ID for MUV3), T0, rms
+    /// and number of entries of the peak. Channels without enough entries are not written.
+    /// \EndMemberDescr
+    //Written next to the final file and renamed: a job reading the table never sees a partial file
+    TString tmpFile = Form("%s.%d", path.Data(), gSystem->GetPid());
+    ofstream out(tmpFile.Data());
+    if(!out.is_open()){
+        cerr << "ChannelT0Calibrator: unable to write " << path << endl;
+        return false;
+    }
+    out << "# " << fName << " channel T0 [ns]: CHOD - hit + detector offset + T0 peaks at 0" << endl;
+    out << "# Detector ChannelID T0 RMS Entries" << endl;
+    for(int iDetector=0; iDetector<MUVChannelMap::kNDetectors; iDetector++){
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            const ChannelPeak& peak = fPeaks[iDetector][iChannel];
+            if(std::isnan(peak.fPeak)) continue;
+            out << MUVChannelMap::GetDetectorName(iDetector) << " " << MUVChannelMap::GetChannelID(iDetector, iChannel) << " " << -peak.fPeak << " " << peak.fRMS << " " << peak.fEntries << endl;
+        }
+    }
+    out.close();
+    return gSystem->Rename(tmpFile, path)==0;
+}
+
+void ChannelT0Calibrator::Print(ostream& out) const{
+    out << endl << "Channel T0 " << fName << ":" << endl;
+    for(int iDetector=0; iDetector<MUVChannelMap::kNDetectors; iDetector++){
+        int nCalibrated = 0;
+        double minT0 = 0., maxT0 = 0.;
+        for(size_t iChannel=0; iChannel<fPeaks[iDetector].size(); iChannel++){
+            double t0 = -fPeaks[iDetector][iChannel].fPeak;
+            if(std::isnan(t0)) continue;
+            if(nCalibrated==0 || t0<minT0) minT0 = t0;
+            if(nCalibrated==0 || t0>maxT0) maxT0 = t0;
+            nCalibrated++;
+        }
+        out << "  " << MUVChannelMap::GetDetectorName(iDetector) << ": " << nCalibrated << "/" << fPeaks[iDetector].size() << " channels calibrated";
+        if(nCalibrated>0) out << ", T0 from " << minT0 << " to " << maxT0 << " ns";
+        out << endl;
+    }
+}
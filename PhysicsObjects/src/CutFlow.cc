@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <iomanip>
+#include <TH1D.h>
+#include "CutFlow.hh"
+
+using namespace std;
+
+CutFlow::CutFlow(TString name) :
+    fName(name),
+    fGroupLast(-1),
+    fNEvents(0),
+    fRejected(false),
+    fLast(0),
+    fFlowHisto(0),
+    fTimeHisto(0)
+{
+    /// \MemberDescr
+    /// \param name : name of the selection, used as prefix of the histograms
+    /// \EndMemberDescr
+}
+
+CutFlow::CutFlow(TString name, const CutFlow& stages) :
+    fName(name),
+    fStages(stages.fStages),
+    fOrder(stages.fOrder),
+    fInGroup(stages.fInGroup),
+    fGroupLast(stages.fGroupLast),
+    fNEvents(0),
+    fRejected(false),
+    fLast(0),
+    fFlowHisto(0),
+    fTimeHisto(0)
+{
+    /// \MemberDescr
+    /// \param name : name of the selection, used as prefix of the histograms
+    /// \param stages : cut flow declaring the same stages (e.g. the nominal configuration of the selection)
+    /// \EndMemberDescr
+    for(size_t iStage=0; iStage<fStages.size(); iStage++){
+        fStages[iStage].fNEvaluated = 0;
+        fStages[iStage].fNRejected = 0;
+        fStages[iStage].fTicks = 0;
+    }
+}
+
+void CutFlow::AddCut(int cut, TString name){
+    /// \MemberDescr
+    /// \param cut : index of the stage (usually an enum value of the analyzer, starting at 0)
+    /// \param name : name of the stage, used in the histogram labels and in the table
+    /// \EndMemberDescr
+    if(cut>=(int)fStages.size()){
+        Stage empty = {"", 0, 0, 0};
+        for(int iStage=fStages.size(); iStage<=cut; iStage++) fOrder.push_back(iStage);
+        fStages.resize(cut+1, empty);
+        fInGroup.resize(cut+1, 0);
+    }
+    fStages[cut].fName = name;
+}
+
+void CutFlow::SetGroup(const vector<int>& order){
+    /// \MemberDescr
+    /// \param order : cuts of the group in the order of evaluation (CutScheduler::GetOrder())
+    ///
+    /// The cuts of the group take the places of the group in the histograms and in the table,
+    /// in the given order. Their Survivors are not cumulative: an event rejected by one of
+    /// them is subtracted after the last cut of the group only. Call before Fill() and Print().
+    /// \EndMemberDescr
+    vector<size_t> places;
+    for(size_t iOrder=0; iOrder<fOrder.size(); iOrder++){
+        if(find(order.begin(), order.end(), fOrder[iOrder])!=order.end()) places.push_back(iOrder);
+    }
+    fill(fInGroup.begin(), fInGroup.end(), 0);
+    for(size_t iPlace=0; iPlace<places.size(); iPlace++){
+        fOrder[places[iPlace]] = order[iPlace];
+        fInGroup[order[iPlace]] = 1;
+    }
+    fGroupLast = places.empty() ? -1 : order[places.size()-1];
+}
+
+Long64_t CutFlow::Survivors(int cut, Long64_t& survivors, Long64_t& groupRejected) const{
+    /// \MemberDescr
+    /// \param cut : stage, in the order of fOrder
+    /// \param survivors : events surviving the previous stage, updated
+    /// \param groupRejected : events rejected by the cuts of the group seen so far, updated
+    /// \return events surviving the stage, -1 inside the group
+    /// \EndMemberDescr
+    if(!fInGroup[cut]){
+        survivors -= fStages[cut].fNRejected;
+        return survivors;
+    }
+    groupRejected += fStages[cut].fNRejected;
+    if(cut!=fGroupLast) return -1;
+    survivors -= groupRejected;
+    return survivors;
+}
+
+void CutFlow::BookHistos(vector<TH1D*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book (call after all AddCut())
+    ///
+    /// <name>_CutFlow: number of events surviving each stage (first bin: all events)\n
+    /// <name>_CutTime: total time spent in each stage [ms]
+    /// \EndMemberDescr
+    int nStages = fStages.size();
+    fFlowHisto = new TH1D(fName + "_CutFlow", fName + " cut flow;;Events", nStages+1, 0, nStages+1);
+    fTimeHisto = new TH1D(fName + "_CutTime", fName + " time per cut;;Time [ms]", nStages, 0, nStages);
+    fFlowHisto->GetXaxis()->SetBinLabel(1, "All");
+    for(int iStage=0; iStage<nStages; iStage++){
+        fFlowHisto->GetXaxis()->SetBinLabel(iStage+2, fStages[fOrder[iStage]].fName);
+        fTimeHisto->GetXaxis()->SetBinLabel(iStage+1, fStages[fOrder[iStage]].fName);
+    }
+    histos.push_back(fFlowHisto);
+    histos.push_back(fTimeHisto);
+}
+
+void CutFlow::Fill() const{
+    /// \MemberDescr
+    /// Sets the content of the histograms from the counters. The stages are sequential
+    /// (each rejection ends the event), so the survivors of a stage are all the events
+    /// minus the ones rejected by this stage or an earlier one. The bins of the cuts of
+    /// the group (SetGroup()) before the last one keep the survivors before the group.
+    /// \EndMemberDescr
+    if(!fFlowHisto || !fTimeHisto) return;
+    Long64_t survivors = fNEvents;
+    Long64_t groupRejected = 0;
+    fFlowHisto->SetBinContent(1, survivors);
+    for(size_t iStage=0; iStage<fOrder.size(); iStage++){
+        int cut = fOrder[iStage];
+        Long64_t stageSurvivors = Survivors(cut, survivors, groupRejected);
+        fFlowHisto->GetXaxis()->SetBinLabel(iStage+2, fStages[cut].fName);
+        fFlowHisto->SetBinContent(iStage+2, stageSurvivors>=0 ? stageSurvivors : survivors);
+        fTimeHisto->GetXaxis()->SetBinLabel(iStage+1, fStages[cut].fName);
+        fTimeHisto->SetBinContent(iStage+1, CycleClock::ToNs(fStages[cut].fTicks)*1e-6);
+    }
+}
+
+void CutFlow::Print(ostream& out) const{
+    CycleClock::Ticks totalTicks = 0;
+    for(size_t iStage=0; iStage<fStages.size(); iStage++) totalTicks += fStages[iStage].fTicks;
+
+    out << endl << "Cut flow " << fName << ": " << fNEvents << " events, "
+        << fixed << setprecision(1) << CycleClock::ToNs(totalTicks)*1e-6 << " ms in the cuts" << endl;
+    out << setw(28) << left << "Cut" << right << setw(12) << "Evaluated" << setw(12) << "Rejected"
+        << setw(12) << "Survivors" << setw(10) << "Eff[%]" << setw(12) << "ns/eval" << setw(10) << "Time[%]" << endl;
+    Long64_t survivors = fNEvents;
+    Long64_t groupRejected = 0;
+    for(size_t iStage=0; iStage<fOrder.size(); iStage++){
+        const Stage& stage = fStages[fOrder[iStage]];
+        Long64_t stageSurvivors = Survivors(fOrder[iStage], survivors, groupRejected);
+        double efficiency = stage.fNEvaluated>0 ? 100.*(stage.fNEvaluated-stage.fNRejected)/stage.fNEvaluated : 0.;
+        double nsPerEval = stage.fNEvaluated>0 ? CycleClock::ToNs(stage.fTicks)/stage.fNEvaluated : 0.;
+        double share = totalTicks>0 ? 100.*stage.fTicks/totalTicks : 0.;
+        out << setw(28) << left << (fInGroup[fOrder[iStage]] ? "*" + stage.fName : stage.fName) << right
+            << setw(12) << stage.fNEvaluated << setw(12) << stage.fNRejected;
+        if(stageSurvivors>=0) out << setw(12) << stageSurvivors;
+        else out << setw(12) << "-";
+        out << setw(10) << setprecision(2) << efficiency << setw(12) << setprecision(1) << nsPerEval
+            << setw(10) << share << endl;
+    }
+    if(fGroupLast>=0) out << "* scheduled group, survivors counted after its last cut" << endl;
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <TH1D.h>
+#include "CutScan.hh"
+
+using namespace std;
+
+CutScan::CutScan(TString name) :
+    fName(name),
+    fEnabled(false),
+    fEvaluated(0),
+    fFailed(0)
+{
+    /// \MemberDescr
+    /// \param name : name of the selection, used as prefix of the histograms
+    /// \EndMemberDescr
+}
+
+void CutScan::AddCut(int cut, TString name, int nBins, double min, double max, bool rejectAbove){
+    /// \MemberDescr
+    /// \param cut : index of the scanned cut (0 to 63)
+    /// \param name : name of the cut variable
+    /// \param nBins, min, max : binning of the N-1 histogram, i.e. of the scanned cut values
+    /// \param rejectAbove : true if the cut rejects the values above the threshold (cda > 40),
+    /// false if it rejects the values below
+    /// \EndMemberDescr
+    if(cut<0 || cut>=64){
+        cerr << "CutScan: cut index " << cut << " out of range, " << name << " not scanned" << endl;
+        return;
+    }
+    if(cut>=(int)fCuts.size()){
+        Cut empty = {"", 0, 0., 0., true, 0, 0};
+        fCuts.resize(cut+1, empty);
+        fValues.resize(cut+1, 0.);
+    }
+    Cut& scanned = fCuts[cut];
+    scanned.fName = name;
+    scanned.fNBins = nBins;
+    scanned.fMin = min;
+    scanned.fMax = max;
+    scanned.fRejectAbove = rejectAbove;
+}
+
+void CutScan::BookHistos(vector<TH1D*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book (call after all AddCut())
+    ///
+    /// <name>_<cut>_NMinus1: variable of the cut for the events passing all the other cuts\n
+    /// <name>_<cut>_Eff: fraction of these events kept as a function of the cut value
+    /// \EndMemberDescr
+    for(size_t iCut=0; iCut<fCuts.size(); iCut++){
+        Cut& cut = fCuts[iCut];
+        if(cut.fNBins<=0) continue;
+        TString prefix = fName + "_" + cut.fName;
+        cut.fNMinus1 = new TH1D(prefix + "_NMinus1", fName + " " + cut.fName + " (all other cuts applied);" + cut.fName, cut.fNBins, cut.fMin, cut.fMax);
+        cut.fEfficiency = new TH1D(prefix + "_Eff", fName + " fraction of events kept vs " + cut.fName + " cut;" + cut.fName + " cut;Efficiency", cut.fNBins, cut.fMin, cut.fMax);
+        histos.push_back(cut.fNMinus1);
+        histos.push_back(cut.fEfficiency);
+    }
+}
+
+bool CutScan::Commit(){
+    /// \MemberDescr
+    /// \return true if the event passes the scanned cuts (always true when disabled)
+    ///
+    /// To be called where the event has passed all the non scanned cuts.
+    /// \EndMemberDescr
+    if(!fEnabled) return true;
+    for(size_t iCut=0; iCut<fCuts.size(); iCut++){
+        unsigned long long bit = 1ULL<<iCut;
+        //Fill only if all the other scanned cuts pass
+        if(!(fEvaluated & bit) || (fFailed & ~bit) || !fCuts[iCut].fNMinus1) continue;
+        fCuts[iCut].fNMinus1->Fill(fValues[iCut]);
+    }
+    return fFailed==0;
+}
+
+void CutScan::Fill() const{
+    /// \MemberDescr
+    /// Computes the efficiency curves from the N-1 histograms. Bin i of <name>_Eff is the
+    /// fraction kept by a cut placed at the upper edge of the bin (lower edge for the cuts
+    /// rejecting low values). Under/overflows count in the total.
+    /// \EndMemberDescr
+    for(size_t iCut=0; iCut<fCuts.size(); iCut++){
+        const Cut& cut = fCuts[iCut];
+        if(!cut.fNMinus1 || !cut.fEfficiency) continue;
+        double total = cut.fNMinus1->Integral(0, cut.fNBins+1);
+        if(total<=0) continue;
+        double kept = 0;
+        if(cut.fRejectAbove){
+            kept = cut.fNMinus1->GetBinContent(0);
+            for(int iBin=1; iBin<=cut.fNBins; iBin++){
+                kept += cut.fNMinus1->GetBinContent(iBin);
+                cut.fEfficiency->SetBinContent(iBin, kept/total);
+            }
+        }
+        else{
+            kept = cut.fNMinus1->GetBinContent(cut.fNBins+1);
+            for(int iBin=cut.fNBins; iBin>=1; iBin--){
+                kept += cut.fNMinus1->GetBinContent(iBin);
+                cut.fEfficiency->SetBinContent(iBin, kept/total);
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <iomanip>
+#include <limits>
+#include "CutScheduler.hh"
+
+using namespace std;
+
+CutScheduler::CutScheduler(TString name, int nWarmUp) :
+    fName(name),
+    fNEvents(0),
+    fNWarmUp(nWarmUp),
+    fReordered(false)
+{
+    /// \MemberDescr
+    /// \param name : name of the group, used in the printout
+    /// \param nWarmUp : number of events processed in the declaration order before reordering
+    /// \EndMemberDescr
+}
+
+void CutScheduler::AddProducer(int producer, TString name){
+    /// \MemberDescr
+    /// \param producer : ID of the producer (usually an enum value of the analyzer, starting at 0)
+    /// \param name : name used in the printout
+    /// \EndMemberDescr
+    if(producer>=(int)fProducers.size()){
+        Producer empty = {"", 0, 0};
+        fProducers.resize(producer+1, empty);
+        fDone.resize(producer+1, 0);
+    }
+    fProducers[producer].fName = name;
+}
+
+void CutScheduler::AddCut(int cut, TString name, const vector<int>& producers, const vector<int>& after){
+    /// \MemberDescr
+    /// \param cut : ID of the cut (usually the CutFlow stage of the cut)
+    /// \param name : name used in the printout
+    /// \param producers : producers to run before the cut
+    /// \param after : cuts of the group which must be evaluated (and passed) before this one
+    ///
+    /// The cuts are evaluated in the order of the AddCut() calls until the end of the warm up.
+    /// \EndMemberDescr
+    if(cut>=(int)fCuts.size()){
+        Cut empty;
+        empty.fNEvaluated = 0;
+        empty.fNRejected = 0;
+        empty.fTicks = 0;
+        fCuts.resize(cut+1, empty);
+    }
+    fCuts[cut].fName = name;
+    fCuts[cut].fProducers = producers;
+    fCuts[cut].fAfter = after;
+    fOrder.push_back(cut);
+}
+
+void CutScheduler::Reorder(){
+    vector<int> remaining = fOrder;
+    vector<int> order;
+    vector<bool> placed(fCuts.size(), false);
+    vector<bool> produced(fProducers.size(), false);
+
+    while(!remaining.empty()){
+        int best = -1;
+        double bestScore = numeric_limits<double>::infinity();
+        for(size_t iCut=0; iCut<remaining.size(); iCut++){
+            const Cut& cut = fCuts[remaining[iCut]];
+            bool ready = true;
+            for(size_t iAfter=0; iAfter<cut.fAfter.size(); iAfter++) ready = ready && placed[cut.fAfter[iAfter]];
+            if(!ready) continue;
+            if(best<0) best = iCut;
+
+            //Cost per evaluation, including the producers this cut would be the first to need
+            double cost = cut.fNEvaluated>0 ? (double)cut.fTicks/cut.fNEvaluated : 0.;
+            for(size_t iProducer=0; iProducer<cut.fProducers.size(); iProducer++){
+                const Producer& producer = fProducers[cut.fProducers[iProducer]];
+                if(!produced[cut.fProducers[iProducer]] && producer.fNRuns>0) cost += (double)producer.fTicks/producer.fNRuns;
+            }
+            double rejected = cut.fNEvaluated>0 ? (double)cut.fNRejected/cut.fNEvaluated : 0.;
+            //Cuts which never rejected stay at the end, in their declaration order
+            if(rejected<=0.) continue;
+            if(cost/rejected<bestScore){
+                bestScore = cost/rejected;
+                best = iCut;
+            }
+        }
+        //The declaration order always satisfies the prerequisites: best>=0
+        const Cut& cut = fCuts[remaining[best]];
+        for(size_t iProducer=0; iProducer<cut.fProducers.size(); iProducer++) produced[cut.fProducers[iProducer]] = true;
+        placed[remaining[best]] = true;
+        order.push_back(remaining[best]);
+        remaining.erase(remaining.begin()+best);
+    }
+
+    fOrder = order;
+    fReordered = true;
+}
+
+void CutScheduler::Print(ostream& out) const{
+    double nsPerTick = CycleClock::GetNsPerTick();
+    out << endl << "Cut order " << fName << (fReordered ? " (reordered after " : " (declaration order, warm up ")
+        << fNWarmUp << " events)" << endl;
+    out << setw(28) << left << "Cut" << right << setw(12) << "Evaluated" << setw(12) << "Rejected" << setw(12) << "ns/eval" << endl;
+    out << fixed << setprecision(1);
+    for(size_t iOrder=0; iOrder<fOrder.size(); iOrder++){
+        const Cut& cut = fCuts[fOrder[iOrder]];
+        out << setw(28) << left << cut.fName << right << setw(12) << cut.fNEvaluated << setw(12) << cut.fNRejected
+            << setw(12) << (cut.fNEvaluated>0 ? cut.fTicks*nsPerTick/cut.fNEvaluated : 0.) << endl;
+    }
+    for(size_t iProducer=0; iProducer<fProducers.size(); iProducer++){
+        const Producer& producer = fProducers[iProducer];
+        out << setw(28) << left << "[" + producer.fName + "]" << right << setw(12) << producer.fNRuns << setw(12) << "-"
+            << setw(12) << (producer.fNRuns>0 ? producer.fTicks*nsPerTick/producer.fNRuns : 0.) << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
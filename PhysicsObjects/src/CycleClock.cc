@@ -0,0 +1,26 @@
+#include <thread>
+#include "CycleClock.hh"
+
+using namespace std;
+
+static double Calibrate(){
+#if defined(__x86_64__) || defined(__i386__)
+    //Invariant TSC on all the machines we run on: one 20 ms measurement is enough for a per mille precision
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    CycleClock::Ticks startTicks = CycleClock::Now();
+    this_thread::sleep_for(chrono::milliseconds(20));
+    CycleClock::Ticks stopTicks = CycleClock::Now();
+    double ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    return stopTicks>startTicks ? ns/(stopTicks - startTicks) : 1.;
+#else
+    return 1.;
+#endif
+}
+
+double CycleClock::GetNsPerTick(){
+    /// \MemberDescr
+    /// \return duration of one tick of Now() in ns. Measured at the first call only.
+    /// \EndMemberDescr
+    static const double nsPerTick = Calibrate();
+    return nsPerTick;
+}
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <TH1D.h>
+#include <TH2D.h>
+#include "DigiPulseMonitor.hh"
+
+using namespace std;
+
+/// Sum and maximum of n samples, two per instruction with SSE2
+static inline void SumMax(const double* samples, int n, double& sum, double& max){
+    int iSample = 0;
+    sum = 0.;
+    max = -DBL_MAX;
+#if defined(__SSE2__)
+    __m128d vSum = _mm_setzero_pd();
+    __m128d vMax = _mm_set1_pd(-DBL_MAX);
+    for(; iSample+2<=n; iSample+=2){
+        __m128d v = _mm_loadu_pd(samples+iSample);
+        vSum = _mm_add_pd(vSum, v);
+        vMax = _mm_max_pd(vMax, v);
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, vSum);
+    sum = lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, vMax);
+    max = lanes[0]>lanes[1] ? lanes[0] : lanes[1];
+#endif
+    for(; iSample<n; iSample++){
+        sum += samples[iSample];
+        if(samples[iSample]>max) max = samples[iSample];
+    }
+}
+
+/// Index of the first sample equal to value, n if none
+static inline int FindFirst(const double* samples, int n, double value){
+    int iSample = 0;
+#if defined(__SSE2__)
+    __m128d vValue = _mm_set1_pd(value);
+    for(; iSample+2<=n; iSample+=2){
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(samples+iSample), vValue));
+        if(mask) return iSample + ((mask&1) ? 0 : 1);
+    }
+#endif
+    for(; iSample<n; iSample++){
+        if(samples[iSample]==value) return iSample;
+    }
+    return n;
+}
+
+DigiPulseMonitor::DigiPulseMonitor(TString name, int nPedestalSamples, double samplePeriod, double saturation) :
+    fName(name),
+    fNPedestalSamples(nPedestalSamples),
+    fSamplePeriod(samplePeriod),
+    fSaturation(saturation)
+{
+    /// \MemberDescr
+    /// \param name : prefix of the histograms
+    /// \param nPedestalSamples : number of samples at the beginning of the digi used for the pedestal
+    /// \param samplePeriod : time between two samples [ns]
+    /// \param saturation : ADC value of a saturated sample
+    /// \EndMemberDescr
+    ChannelSummary empty = {0, 0, 0, 0., 0., 0., 0.};
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        int nChannels = MUVChannelMap::GetNChannels(iDetector);
+        fSummaries[iDetector].assign(nChannels, empty);
+        fShapes[iDetector].assign(nChannels*kMaxSamples, 0.);
+        fAmplitudeHistos[iDetector] = 0;
+        fPeakTimeHistos[iDetector] = 0;
+        fIntegralHistos[iDetector] = 0;
+        fSaturatedHistos[iDetector] = 0;
+        fBadQualityHistos[iDetector] = 0;
+        fShapeHistos[iDetector] = 0;
+    }
+}
+
+FADCPulse DigiPulseMonitor::Analyze(const double* samples, int nSamples) const{
+    /// \MemberDescr
+    /// \param samples : ADC samples of the digi
+    /// \param nSamples : number of samples (at least 1)
+    /// \return pedestal, amplitude, peak time and integral of the pulse
+    /// \EndMemberDescr
+    FADCPulse pulse;
+    double sum, maxSample, pedestalSum, pedestalMax;
+    SumMax(samples, nSamples, sum, maxSample);
+    int nPedestal = min(fNPedestalSamples, nSamples);
+    SumMax(samples, nPedestal, pedestalSum, pedestalMax);
+    pulse.fPedestal = nPedestal>0 ? pedestalSum/nPedestal : 0.;
+    pulse.fAmplitude = maxSample - pulse.fPedestal;
+    pulse.fIntegral = sum - nSamples*pulse.fPedestal;
+    pulse.fSaturated = maxSample>=fSaturation;
+    pulse.fPeakSample = FindFirst(samples, nSamples, maxSample);
+
+    //Parabola through the maximum and its neighbours
+    double peak = pulse.fPeakSample;
+    if(pulse.fPeakSample>0 && pulse.fPeakSample<nSamples-1){
+        double before = samples[pulse.fPeakSample-1];
+        double after = samples[pulse.fPeakSample+1];
+        double curvature = before - 2.*maxSample + after;
+        if(curvature<0.) peak += 0.5*(before - after)/curvature;
+    }
+    pulse.fPeakTime = peak*fSamplePeriod;
+    return pulse;
+}
+
+void DigiPulseMonitor::Fill(int detector, int channel, const double* samples, int nSamples, int quality){
+    /// \MemberDescr
+    /// \param detector : MUVChannelMap::kMUV1 or kMUV2
+    /// \param channel : MUVChannelMap channel index (digis with a negative index are ignored)
+    /// \param samples, nSamples : ADC samples of the digi
+    /// \param quality : quality of the digi, only counted if not 0
+    /// \EndMemberDescr
+    if(channel<0 || nSamples<=0) return;
+    ChannelSummary& summary = fSummaries[detector][channel];
+    if(quality!=0){
+        summary.fNBadQuality++;
+        return;
+    }
+    FADCPulse pulse = Analyze(samples, nSamples);
+    if(pulse.fSaturated){
+        summary.fNSaturated++;
+        return;
+    }
+    summary.fNPulses++;
+    summary.fSumAmplitude += pulse.fAmplitude;
+    summary.fSumAmplitude2 += pulse.fAmplitude*pulse.fAmplitude;
+    summary.fSumPeakTime += pulse.fPeakTime;
+    summary.fSumIntegral += pulse.fIntegral;
+    if(pulse.fAmplitude<=0.) return;
+    double* shape = &fShapes[detector][channel*kMaxSamples];
+    double norm = 1./pulse.fAmplitude;
+    int n = min(nSamples, (int)kMaxSamples);
+    for(int iSample=0; iSample<n; iSample++) shape[iSample] += (samples[iSample] - pulse.fPedestal)*norm;
+}
+
+void DigiPulseMonitor::BookHistos(vector<TH1*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        TString prefix = fName + "_" + MUVChannelMap::GetDetectorName(iDetector);
+        TString title = fName + " " + MUVChannelMap::GetDetectorName(iDetector);
+        int nChannels = fSummaries[iDetector].size();
+        fAmplitudeHistos[iDetector]  = new TH1D(prefix + "_PulseAmplitude", title + " mean pulse amplitude;Channel index;Amplitude [ADC]", nChannels, 0, nChannels);
+        fPeakTimeHistos[iDetector]   = new TH1D(prefix + "_PulsePeakTime", title + " mean peak time;Channel index;Peak time [ns]", nChannels, 0, nChannels);
+        fIntegralHistos[iDetector]   = new TH1D(prefix + "_PulseIntegral", title + " mean pulse integral;Channel index;Integral [ADC]", nChannels, 0, nChannels);
+        fSaturatedHistos[iDetector]  = new TH1D(prefix + "_PulseSaturated", title + " saturated pulses;Channel index", nChannels, 0, nChannels);
+        fBadQualityHistos[iDetector] = new TH1D(prefix + "_PulseBadQuality", title + " digis with quality != 0;Channel index", nChannels, 0, nChannels);
+        fShapeHistos[iDetector]      = new TH2D(prefix + "_PulseShape", title + " mean normalised pulse shape;Channel index;Sample", nChannels, 0, nChannels, kMaxSamples, 0, kMaxSamples);
+        histos.push_back(fAmplitudeHistos[iDetector]);
+        histos.push_back(fPeakTimeHistos[iDetector]);
+        histos.push_back(fIntegralHistos[iDetector]);
+        histos.push_back(fSaturatedHistos[iDetector]);
+        histos.push_back(fBadQualityHistos[iDetector]);
+        histos.push_back(fShapeHistos[iDetector]);
+    }
+}
+
+void DigiPulseMonitor::FillHistos() const{
+    /// \MemberDescr
+    /// Sets the content of the booked histograms from the channel summaries
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        if(!fAmplitudeHistos[iDetector]) continue;
+        for(size_t iChannel=0; iChannel<fSummaries[iDetector].size(); iChannel++){
+            const ChannelSummary& summary = fSummaries[iDetector][iChannel];
+            fSaturatedHistos[iDetector]->SetBinContent(iChannel+1, summary.fNSaturated);
+            fBadQualityHistos[iDetector]->SetBinContent(iChannel+1, summary.fNBadQuality);
+            if(summary.fNPulses==0) continue;
+            double mean = summary.fSumAmplitude/summary.fNPulses;
+            double variance = max(0., summary.fSumAmplitude2/summary.fNPulses - mean*mean);
+            fAmplitudeHistos[iDetector]->SetBinContent(iChannel+1, mean);
+            fAmplitudeHistos[iDetector]->SetBinError(iChannel+1, sqrt(variance/summary.fNPulses));
+            fPeakTimeHistos[iDetector]->SetBinContent(iChannel+1, summary.fSumPeakTime/summary.fNPulses);
+            fIntegralHistos[iDetector]->SetBinContent(iChannel+1, summary.fSumIntegral/summary.fNPulses);
+            for(int iSample=0; iSample<kMaxSamples; iSample++){
+                fShapeHistos[iDetector]->SetBinContent(iChannel+1, iSample+1, fShapes[iDetector][iChannel*kMaxSamples+iSample]/summary.fNPulses);
+            }
+        }
+    }
+}
+
+void DigiPulseMonitor::Print(ostream& out) const{
+    out << endl << "Digi pulses " << fName << ":" << endl;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        Long64_t nPulses = 0, nSaturated = 0, nBadQuality = 0;
+        for(size_t iChannel=0; iChannel<fSummaries[iDetector].size(); iChannel++){
+            nPulses += fSummaries[iDetector][iChannel].fNPulses;
+            nSaturated += fSummaries[iDetector][iChannel].fNSaturated;
+            nBadQuality += fSummaries[iDetector][iChannel].fNBadQuality;
+        }
+        out << "  " << MUVChannelMap::GetDetectorName(iDetector) << ": " << nPulses << " pulses, " << nSaturated << " saturated, "
+            << nBadQuality << " with quality != 0" << endl;
+    }
+}
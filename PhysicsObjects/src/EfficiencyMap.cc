@@ -0,0 +1,175 @@
+#include <iomanip>
+#include <iostream>
+#include <TEfficiency.h>
+#include <TGraphAsymmErrors.h>
+#include <TH2D.h>
+#include "EfficiencyMap.hh"
+
+using namespace std;
+
+EfficiencyMap::EfficiencyMap(TString name, TString title, int nX, double xMin, double xMax, int nY, double yMin, double yMax, double level) :
+    fName(name),
+    fTitle(title),
+    fNX(nX),
+    fXMin(xMin),
+    fXMax(xMax),
+    fInvWidthX(nX/(xMax-xMin)),
+    fNY(nY),
+    fYMin(yMin),
+    fYMax(yMax),
+    fInvWidthY(nY/(yMax-yMin)),
+    fLevel(level),
+    fBurstNum(nX*nY, 0),
+    fBurstDen(nX*nY, 0),
+    fNum(nX*nY, 0),
+    fDen(nX*nY, 0),
+    fNumHisto(0),
+    fDenHisto(0),
+    fEffHisto(0),
+    fLowHisto(0),
+    fUpHisto(0),
+    fBurstGraph(0)
+{
+    /// \MemberDescr
+    /// \param name : prefix of the histograms
+    /// \param title : title of the histograms, with the axis titles (";x;y")
+    /// \param nX, xMin, xMax : binning in x
+    /// \param nY, yMin, yMax : binning in y
+    /// \param level : confidence level of the Clopper-Pearson intervals (default: 1 sigma)
+    /// \EndMemberDescr
+}
+
+void EfficiencyMap::EndBurst(int burstID){
+    /// \MemberDescr
+    /// \param burstID : burst of the probes filled since the previous call
+    ///
+    /// Bursts without any probe are not recorded.
+    /// \EndMemberDescr
+    BurstCounts counts = {0, 0};
+    for(size_t iBin=0; iBin<fBurstDen.size(); iBin++){
+        counts.fNum += fBurstNum[iBin];
+        counts.fDen += fBurstDen[iBin];
+        fNum[iBin] += fBurstNum[iBin];
+        fDen[iBin] += fBurstDen[iBin];
+        fBurstNum[iBin] = 0;
+        fBurstDen[iBin] = 0;
+    }
+    if(counts.fDen==0) return;
+    BurstCounts& burst = fBursts[burstID];
+    burst.fNum += counts.fNum;
+    burst.fDen += counts.fDen;
+}
+
+void EfficiencyMap::Add(const EfficiencyMap& other){
+    /// \MemberDescr
+    /// \param other : map with the same binning, e.g. filled by another thread or job
+    ///
+    /// The ended bursts and the current burst counters of other are added to this map.
+    /// \EndMemberDescr
+    if(other.fDen.size()!=fDen.size()){
+        cerr << "EfficiencyMap " << fName << ": cannot add " << other.fName << " (different binning)" << endl;
+        return;
+    }
+    for(size_t iBin=0; iBin<fDen.size(); iBin++){
+        fNum[iBin] += other.fNum[iBin];
+        fDen[iBin] += other.fDen[iBin];
+        fBurstNum[iBin] += other.fBurstNum[iBin];
+        fBurstDen[iBin] += other.fBurstDen[iBin];
+    }
+    for(map<int, BurstCounts>::const_iterator it=other.fBursts.begin(); it!=other.fBursts.end(); ++it){
+        BurstCounts& burst = fBursts[it->first];
+        burst.fNum += it->second.fNum;
+        burst.fDen += it->second.fDen;
+    }
+}
+
+void EfficiencyMap::BookHistos(vector<TH1*>& histos, vector<TGraphAsymmErrors*>& graphs){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book
+    /// \param graphs : receives the per burst efficiency graph to book
+    /// \EndMemberDescr
+    fNumHisto = new TH2D(fName + "_Num", fTitle + " (numerator)" , fNX, fXMin, fXMax, fNY, fYMin, fYMax);
+    fDenHisto = new TH2D(fName + "_Den", fTitle + " (denominator)", fNX, fXMin, fXMax, fNY, fYMin, fYMax);
+    fEffHisto = new TH2D(fName + "_Eff", fTitle + " (efficiency)" , fNX, fXMin, fXMax, fNY, fYMin, fYMax);
+    fLowHisto = new TH2D(fName + "_EffLow", fTitle + " (efficiency, lower limit)", fNX, fXMin, fXMax, fNY, fYMin, fYMax);
+    fUpHisto  = new TH2D(fName + "_EffUp", fTitle + " (efficiency, upper limit)" , fNX, fXMin, fXMax, fNY, fYMin, fYMax);
+    histos.push_back(fNumHisto);
+    histos.push_back(fDenHisto);
+    histos.push_back(fEffHisto);
+    histos.push_back(fLowHisto);
+    histos.push_back(fUpHisto);
+
+    fBurstGraph = new TGraphAsymmErrors();
+    fBurstGraph->SetName(fName + "_Burst");
+    fBurstGraph->SetTitle(fTitle + " per burst;BurstID;Efficiency");
+    graphs.push_back(fBurstGraph);
+}
+
+void EfficiencyMap::Fill() const{
+    /// \MemberDescr
+    /// Sets the content of the booked histograms and graph from the counters (ended bursts only)
+    /// \EndMemberDescr
+    if(!fNumHisto) return;
+    for(int iY=0; iY<fNY; iY++){
+        for(int iX=0; iX<fNX; iX++){
+            fNumHisto->SetBinContent(iX+1, iY+1, fNum[iY*fNX+iX]);
+            fDenHisto->SetBinContent(iX+1, iY+1, fDen[iY*fNX+iX]);
+        }
+    }
+    FillEfficiency(fNumHisto, fDenHisto, fEffHisto, fLowHisto, fUpHisto, fLevel);
+
+    fBurstGraph->Set(0);
+    for(map<int, BurstCounts>::const_iterator it=fBursts.begin(); it!=fBursts.end(); ++it){
+        double efficiency = (double)it->second.fNum/it->second.fDen;
+        double low = TEfficiency::ClopperPearson(it->second.fDen, it->second.fNum, fLevel, false);
+        double up  = TEfficiency::ClopperPearson(it->second.fDen, it->second.fNum, fLevel, true);
+        int iPoint = fBurstGraph->GetN();
+        fBurstGraph->SetPoint(iPoint, it->first, efficiency);
+        fBurstGraph->SetPointError(iPoint, 0., 0., efficiency-low, up-efficiency);
+    }
+}
+
+void EfficiencyMap::FillEfficiency(const TH1* num, const TH1* den, TH1* eff, TH1* low, TH1* up, double level){
+    /// \MemberDescr
+    /// \param num, den : numerator and denominator, e.g. _Num and _Den merged from several jobs
+    /// \param eff : receives the efficiency of each bin (bins without probe are left empty)
+    /// \param low, up : receive the limits of the Clopper-Pearson interval (can be null)
+    /// \param level : confidence level of the interval
+    /// \EndMemberDescr
+    int nBins = num->GetNbinsX()+2;
+    if(num->GetDimension()>1) nBins *= num->GetNbinsY()+2;
+    if(num->GetDimension()>2) nBins *= num->GetNbinsZ()+2;
+    for(int iBin=0; iBin<nBins; iBin++){
+        double total = den->GetBinContent(iBin);
+        if(total<=0.) continue;
+        double passed = num->GetBinContent(iBin);
+        eff->SetBinContent(iBin, passed/total);
+        if(low) low->SetBinContent(iBin, TEfficiency::ClopperPearson(total, passed, level, false));
+        if(up)  up->SetBinContent(iBin, TEfficiency::ClopperPearson(total, passed, level, true));
+    }
+}
+
+Long64_t EfficiencyMap::GetNumerator() const{
+    Long64_t total = 0;
+    for(size_t iBin=0; iBin<fNum.size(); iBin++) total += fNum[iBin];
+    return total;
+}
+
+Long64_t EfficiencyMap::GetDenominator() const{
+    Long64_t total = 0;
+    for(size_t iBin=0; iBin<fDen.size(); iBin++) total += fDen[iBin];
+    return total;
+}
+
+void EfficiencyMap::Print(ostream& out) const{
+    Long64_t num = GetNumerator();
+    Long64_t den = GetDenominator();
+    out << fName << ": " << num << "/" << den;
+    if(den>0){
+        double efficiency = (double)num/den;
+        double low = TEfficiency::ClopperPearson(den, num, fLevel, false);
+        double up  = TEfficiency::ClopperPearson(den, num, fLevel, true);
+        out << " = " << setprecision(6) << efficiency << " -" << efficiency-low << " +" << up-efficiency;
+    }
+    out << " (" << fBursts.size() << " bursts)" << endl;
+}
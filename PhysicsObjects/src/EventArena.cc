@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <new>
+#include "EventArena.hh"
+
+using namespace std;
+
+EventArena::EventArena(size_t blockSize) :
+    fUsedBefore(0),
+    fHighWater(0),
+    fNBlockAllocations(0)
+{
+    /// \MemberDescr
+    /// \param blockSize : size of the first block [bytes]
+    /// \EndMemberDescr
+    AddBlock(blockSize);
+}
+
+EventArena::~EventArena(){
+    for(size_t iBlock=0; iBlock<fBlocks.size(); iBlock++) free(fBlocks[iBlock].first);
+}
+
+void EventArena::AddBlock(size_t size){
+    char* block = (char*)malloc(size);
+    if(!block) throw bad_alloc();
+    fBlocks.push_back(make_pair(block, size));
+    fCurrent = block;
+    fEnd = block + size;
+    fNBlockAllocations++;
+}
+
+void* EventArena::Grow(size_t size, size_t alignment){
+    /// \MemberDescr
+    /// Continues the event in a new block, at least twice as large as the current one
+    /// \EndMemberDescr
+    fUsedBefore += fCurrent - fBlocks.back().first;
+    size_t blockSize = 2*fBlocks.back().second;
+    if(blockSize < size + alignment) blockSize = size + alignment;
+    AddBlock(blockSize);
+    return Allocate(size, alignment);
+}
+
+void EventArena::Reset(){
+    /// \MemberDescr
+    /// Makes the memory of the event available for the next one. The containers allocated in
+    /// the arena must not be used any more.
+    /// \EndMemberDescr
+    size_t used = GetUsed();
+    if(used > fHighWater) fHighWater = used;
+    if(fBlocks.size() > 1){
+        //The event overflowed the first block: one block for the whole capacity
+        size_t capacity = GetCapacity();
+        for(size_t iBlock=0; iBlock<fBlocks.size(); iBlock++) free(fBlocks[iBlock].first);
+        fBlocks.clear();
+        AddBlock(capacity);
+    }
+    fCurrent = fBlocks.back().first;
+    fUsedBefore = 0;
+}
+
+size_t EventArena::GetCapacity() const{
+    size_t capacity = 0;
+    for(size_t iBlock=0; iBlock<fBlocks.size(); iBlock++) capacity += fBlocks[iBlock].second;
+    return capacity;
+}
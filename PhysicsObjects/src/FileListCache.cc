@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TSystem.h>
+#include <TTree.h>
+#include "FileListCache.hh"
+
+using namespace std;
+
+static const char* kCacheHeader = "# MUVDataQualityControl file list cache v1";
+
+FileListCache::FileListCache(TString listFile, TString cacheFile) :
+    fListFile(listFile),
+    fCacheFile(cacheFile),
+    fNOpened(0)
+{
+    /// \MemberDescr
+    /// \param listFile : text file with one input ROOT file per line
+    /// \param cacheFile : path of the cache (default: listFile + ".cache")
+    /// \EndMemberDescr
+    if(fCacheFile.Length()==0) fCacheFile = fListFile + ".cache";
+}
+
+bool FileListCache::Build(int maxFiles){
+    /// \MemberDescr
+    /// \param maxFiles : only the first maxFiles files of the list are considered (<=0: all)
+    /// \return false if the list cannot be read or one of the files cannot be opened
+    ///
+    /// Fills the entries from the cache, opening only the files that are missing from
+    /// it or that changed since, and updates the cache if needed. Files which cannot be
+    /// opened are not cached: their entry count is unknown and the event arithmetic of
+    /// FindFile() would be wrong, so they are retried at the next start.
+    /// \EndMemberDescr
+    ifstream list(fListFile.Data());
+    if(!list.is_open()){
+        cerr << "FileListCache: unable to read " << fListFile << endl;
+        return false;
+    }
+
+    vector<Entry> cachedEntries;
+    ReadCache(cachedEntries);
+    map<TString, const Entry*> cached;
+    for(size_t iEntry=0; iEntry<cachedEntries.size(); iEntry++) cached[cachedEntries[iEntry].fPath] = &cachedEntries[iEntry];
+
+    fEntries.clear();
+    fNOpened = 0;
+    string line;
+    Long64_t firstEvent = 0;
+    int nFailed = 0;
+    while(getline(list, line)){
+        if(maxFiles>0 && (int)fEntries.size()>=maxFiles) break;
+        TString path = TString(line.c_str()).Strip(TString::kBoth);
+        if(path.Length()==0 || path.BeginsWith("#")) continue;
+
+        Entry entry;
+        entry.fPath = path;
+        entry.fSize = -1;
+        entry.fMTime = -1;
+        entry.fNEntries = 0;
+        entry.fBurstID = -1;
+        entry.fTrees = 0;
+
+        FileStat_t stat;
+        if(gSystem->GetPathInfo(path, stat)==0){
+            entry.fSize = stat.fSize;
+            entry.fMTime = stat.fMtime;
+        }
+
+        map<TString, const Entry*>::iterator it = cached.find(path);
+        if(it!=cached.end() && entry.fSize>=0 && it->second->fSize==entry.fSize && it->second->fMTime==entry.fMTime){
+            entry.fNEntries = it->second->fNEntries;
+            entry.fBurstID = it->second->fBurstID;
+            entry.fTrees = it->second->fTrees;
+        }
+        else{
+            fNOpened++;
+            if(!Inspect(entry)){
+                cerr << "FileListCache: unable to open " << path << endl;
+                entry.fSize = -1;
+                nFailed++;
+            }
+        }
+
+        entry.fFirstEvent = firstEvent;
+        firstEvent += entry.fNEntries;
+        fEntries.push_back(entry);
+    }
+
+    if(fNOpened>nFailed) WriteCache();
+    return nFailed==0;
+}
+
+Long64_t FileListCache::GetNEvents() const{
+    if(fEntries.empty()) return 0;
+    return fEntries.back().fFirstEvent + fEntries.back().fNEntries;
+}
+
+int FileListCache::FindFile(Long64_t event) const{
+    /// \MemberDescr
+    /// \param event : index of the event in the whole list
+    /// \return index of the file containing this event, -1 if beyond the last file
+    /// \EndMemberDescr
+    if(event<0 || event>=GetNEvents()) return -1;
+    int first = 0, last = fEntries.size()-1;
+    while(first<last){
+        int middle = (first+last+1)/2;
+        if(fEntries[middle].fFirstEvent<=event) first = middle;
+        else last = middle-1;
+    }
+    return first;
+}
+
+bool FileListCache::WriteList(TString path, int firstFile, int nFiles) const{
+    /// \MemberDescr
+    /// \param path : output list
+    /// \param firstFile : index of the first file to write
+    /// \param nFiles : number of files to write (<=0: up to the end)
+    ///
+    /// Writes a sub list, used to start directly at the file containing the first event.
+    /// \EndMemberDescr
+    ofstream out(path.Data());
+    if(!out.is_open()) return false;
+    int lastFile = nFiles>0 ? min((int)fEntries.size(), firstFile+nFiles) : fEntries.size();
+    for(int iFile=firstFile; iFile<lastFile; iFile++) out << fEntries[iFile].fPath << endl;
+    return true;
+}
+
+bool FileListCache::ReadCache(vector<Entry>& cached) const{
+    ifstream in(fCacheFile.Data());
+    if(!in.is_open()) return false;
+    string line;
+    if(!getline(in, line) || line!=kCacheHeader) return false;
+    while(getline(in, line)){
+        //Path last: it is the only field that may contain spaces
+        istringstream fields(line);
+        Entry entry;
+        if(!(fields >> entry.fSize >> entry.fMTime >> entry.fNEntries >> entry.fBurstID >> entry.fTrees)) continue;
+        string path;
+        getline(fields >> ws, path);
+        entry.fPath = path.c_str();
+        entry.fFirstEvent = 0;
+        cached.push_back(entry);
+    }
+    return true;
+}
+
+bool FileListCache::WriteCache() const{
+    //Written next to the final file and renamed: concurrent jobs never read a partial cache
+    TString tmpFile = Form("%s.%d", fCacheFile.Data(), gSystem->GetPid());
+    ofstream out(tmpFile.Data());
+    if(!out.is_open()){
+        cerr << "FileListCache: unable to write " << fCacheFile << endl;
+        return false;
+    }
+    out << kCacheHeader << endl;
+    for(size_t iEntry=0; iEntry<fEntries.size(); iEntry++){
+        const Entry& entry = fEntries[iEntry];
+        if(entry.fSize<0) continue;
+        out << entry.fSize << " " << entry.fMTime << " " << entry.fNEntries << " " << entry.fBurstID << " " << entry.fTrees << " " << entry.fPath << endl;
+    }
+    out.close();
+    return gSystem->Rename(tmpFile, fCacheFile)==0;
+}
+
+bool FileListCache::Inspect(Entry& entry){
+    TFile* file = TFile::Open(entry.fPath);
+    if(!file || file->IsZombie()){
+        delete file;
+        return false;
+    }
+
+    const char* treeNames[] = {"Reco", "Digis", "MC"};
+    const UInt_t treeBits[] = {kReco, kDigis, kMC};
+    TTree* mainTree = 0;
+    for(int iTree=0; iTree<3; iTree++){
+        TTree* tree = (TTree*)file->Get(treeNames[iTree]);
+        if(!tree) continue;
+        entry.fTrees |= treeBits[iTree];
+        if(!mainTree) mainTree = tree;
+    }
+
+    if(mainTree){
+        entry.fNEntries = mainTree->GetEntries();
+        //All the detector events of one file carry the same burst ID: read it from the first one found
+        TLeaf* leaf = mainTree->GetLeaf("fBurstID");
+        if(leaf && entry.fNEntries>0){
+            leaf->GetBranch()->GetEntry(0);
+            entry.fBurstID = (Int_t)leaf->GetValue();
+        }
+    }
+
+    file->Close();
+    delete file;
+    return true;
+}
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <limits.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sstream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <TSystem.h>
+#include "FileStager.hh"
+
+using namespace std;
+
+FileStager::FileStager(TString stageDir, double maxSizeGB, int nAhead) :
+    fStageDir(stageDir),
+    fMaxSize((Long64_t)(maxSizeGB*1024*1024*1024)),
+    fNAhead(nAhead>0 ? nAhead : 1),
+    fStop(false),
+    fNStaged(0),
+    fNShared(0)
+{
+    /// \MemberDescr
+    /// \param stageDir : local scratch directory, shared with the other jobs of the node
+    /// \param maxSizeGB : maximum total size of the staged files [GB]
+    /// \param nAhead : number of files staged in advance
+    /// \EndMemberDescr
+    fJobDir = Form("%s/jobs/%d", fStageDir.Data(), getpid());
+    fJobList = fJobDir + "/list";
+}
+
+FileStager::~FileStager(){
+    Stop();
+}
+
+bool FileStager::Start(TString listFile, int maxFiles){
+    /// \MemberDescr
+    /// \param listFile : original list of input files
+    /// \param maxFiles : only the first maxFiles files are used (<=0: all)
+    /// \return false if the staging area cannot be used. The original list should then be used.
+    ///
+    /// Creates the job list (GetList()) and starts the staging thread.
+    /// \EndMemberDescr
+    ifstream list(listFile.Data());
+    if(!list.is_open()) return false;
+    string line;
+    while(getline(list, line)){
+        if(maxFiles>0 && (int)fSources.size()>=maxFiles) break;
+        TString path = TString(line.c_str()).Strip(TString::kBoth);
+        if(path.Length()==0 || path.BeginsWith("#")) continue;
+        fSources.push_back(path);
+    }
+    fState.assign(fSources.size(), 0);
+
+    //TSystem::mkdir fails on existing directories: the files directory is usually already there
+    TString filesDir = fStageDir + "/files";
+    if((gSystem->AccessPathName(filesDir) && gSystem->mkdir(filesDir, kTRUE)!=0) || gSystem->mkdir(fJobDir, kTRUE)!=0){
+        cerr << "FileStager: unable to use " << fStageDir << ", reading the files directly" << endl;
+        return false;
+    }
+    CleanDeadJobs();
+
+    ofstream jobList(fJobList.Data());
+    if(!jobList.is_open()) return false;
+    char resolved[PATH_MAX];
+    for(size_t iFile=0; iFile<fSources.size(); iFile++){
+        //The links live in another directory: they must point to absolute paths
+        if(fSources[iFile].Contains("://") || !realpath(fSources[iFile].Data(), resolved)){
+            //URL or missing file: no link possible, the framework reads the original path
+            fState[iFile] = 2;
+            jobList << fSources[iFile] << endl;
+            continue;
+        }
+        fSources[iFile] = resolved;
+        if(!Relink(iFile, fSources[iFile])) return false;
+        jobList << LinkPath(iFile) << endl;
+    }
+    jobList.close();
+
+    fThread = thread(&FileStager::Run, this);
+    return true;
+}
+
+void FileStager::Stop(){
+    /// \MemberDescr
+    /// Stops the staging thread and removes the job directory. The staged files stay
+    /// available for the next jobs.
+    /// \EndMemberDescr
+    {
+        lock_guard<mutex> lock(fMutex);
+        fStop = true;
+    }
+    fCondition.notify_one();
+    if(!fThread.joinable()) return;
+    fThread.join();
+
+    for(size_t iFile=0; iFile<fSources.size(); iFile++) unlink(LinkPath(iFile).Data());
+    unlink(fJobList.Data());
+    rmdir(fJobDir.Data());
+    cout << "FileStager: " << fNStaged << " files staged, " << fNShared << " already staged by other jobs" << endl;
+}
+
+void FileStager::Run(){
+    while(true){
+        int current = FindCurrentFile();
+        for(int iFile=0; iFile<current && iFile<(int)fSources.size(); iFile++)
+            if(fState[iFile]!=2) Release(iFile);
+
+        int first = max(current, 0);
+        for(int iFile=first; iFile<first+fNAhead && iFile<(int)fSources.size(); iFile++){
+            if(fState[iFile]!=0) continue;
+            fState[iFile] = Stage(iFile) ? 1 : -1;
+            {
+                lock_guard<mutex> lock(fMutex);
+                if(fStop) return;
+            }
+        }
+
+        unique_lock<mutex> lock(fMutex);
+        if(fCondition.wait_for(lock, chrono::milliseconds(500), [this]{ return fStop; })) return;
+    }
+}
+
+int FileStager::FindCurrentFile() const{
+    /// \MemberDescr
+    /// \return index of the last file of the list currently opened by the process, -1 if none
+    /// \EndMemberDescr
+    DIR* fdDir = opendir("/proc/self/fd");
+    if(!fdDir) return -1;
+    int current = -1;
+    char target[4096];
+    struct dirent* fd;
+    while((fd = readdir(fdDir))){
+        TString fdPath = Form("/proc/self/fd/%s", fd->d_name);
+        ssize_t length = readlink(fdPath.Data(), target, sizeof(target)-1);
+        if(length<=0) continue;
+        target[length] = 0;
+        TString opened(target);
+        for(int iFile=fSources.size()-1; iFile>current; iFile--){
+            if(opened==fSources[iFile] || opened==fStageDir+"/files/"+CachedName(iFile)){
+                current = iFile;
+                break;
+            }
+        }
+    }
+    closedir(fdDir);
+    return current;
+}
+
+bool FileStager::Stage(int iFile){
+    TString name = CachedName(iFile);
+    TString cached = fStageDir + "/files/" + name;
+
+    struct stat info;
+    if(stat(fSources[iFile].Data(), &info)!=0 || info.st_size>fMaxSize) return false;
+    Long64_t size = info.st_size;
+
+    //Reserve the space (or find the file already staged by another job)
+    int lockFd = Lock();
+    if(lockFd<0) return false;
+    vector<IndexEntry> index;
+    ReadIndex(index);
+    for(size_t iEntry=0; iEntry<index.size(); iEntry++){
+        if(index[iEntry].fName!=name) continue;
+        if(index[iEntry].fOwner!=0){
+            //Another job is copying it: read the original, do not copy twice
+            Unlock(lockFd);
+            return false;
+        }
+        index[iEntry].fLastUse = time(0);
+        WriteIndex(index);
+        bool linked = Relink(iFile, cached);
+        Unlock(lockFd);
+        if(linked) fNShared++;
+        return linked;
+    }
+    if(!MakeRoom(index, size)){
+        Unlock(lockFd);
+        return false;
+    }
+    IndexEntry entry;
+    entry.fName = name;
+    entry.fSize = size;
+    entry.fLastUse = time(0);
+    entry.fOwner = getpid();
+    index.push_back(entry);
+    WriteIndex(index);
+    Unlock(lockFd);
+
+    //Copy outside of the lock
+    TString partial = Form("%s.part.%d", cached.Data(), getpid());
+    bool copied = CopyFile(fSources[iFile], partial) && rename(partial.Data(), cached.Data())==0;
+    if(!copied) unlink(partial.Data());
+
+    lockFd = Lock();
+    index.clear();
+    ReadIndex(index);
+    for(size_t iEntry=0; iEntry<index.size(); iEntry++){
+        if(index[iEntry].fName!=name) continue;
+        if(copied) index[iEntry].fOwner = 0;
+        else index.erase(index.begin()+iEntry);
+        break;
+    }
+    WriteIndex(index);
+    bool linked = copied && Relink(iFile, cached);
+    Unlock(lockFd);
+    if(linked) fNStaged++;
+    return linked;
+}
+
+void FileStager::Release(int iFile){
+    //The framework already has the file open (or is done with it): the link is not needed anymore
+    unlink(LinkPath(iFile).Data());
+    fState[iFile] = 2;
+}
+
+bool FileStager::CopyFile(TString source, TString destination) const{
+    //Plain POSIX copy: no ROOT I/O on the staging thread
+    int in = open(source.Data(), O_RDONLY);
+    if(in<0) return false;
+    int out = open(destination.Data(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if(out<0){
+        close(in);
+        return false;
+    }
+    vector<char> buffer(8*1024*1024);
+    bool ok = true;
+    ssize_t nRead;
+    while(ok && (nRead = read(in, &buffer[0], buffer.size()))>0){
+        ssize_t nWritten = 0;
+        while(nWritten<nRead){
+            ssize_t n = write(out, &buffer[nWritten], nRead-nWritten);
+            if(n<0){
+                ok = false;
+                break;
+            }
+            nWritten += n;
+        }
+    }
+    if(nRead<0) ok = false;
+    close(in);
+    if(close(out)!=0) ok = false;
+    return ok;
+}
+
+int FileStager::Lock() const{
+    int fd = open((fStageDir + "/lock").Data(), O_RDWR|O_CREAT, 0666);
+    if(fd<0) return -1;
+    while(flock(fd, LOCK_EX)!=0){
+        if(errno!=EINTR){
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+void FileStager::Unlock(int fd) const{
+    if(fd<0) return;
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+void FileStager::ReadIndex(vector<IndexEntry>& index) const{
+    ifstream in((fStageDir + "/index").Data());
+    string line;
+    while(getline(in, line)){
+        istringstream fields(line);
+        IndexEntry entry;
+        string name;
+        if(!(fields >> name >> entry.fSize >> entry.fLastUse >> entry.fOwner)) continue;
+        entry.fName = name.c_str();
+        //Copies left behind by a job which died while staging: the partial file goes with the entry
+        if(entry.fOwner!=0 && kill(entry.fOwner, 0)!=0 && errno==ESRCH){
+            unlink(Form("%s/files/%s.part.%d", fStageDir.Data(), name.c_str(), entry.fOwner));
+            continue;
+        }
+        index.push_back(entry);
+    }
+}
+
+void FileStager::WriteIndex(const vector<IndexEntry>& index) const{
+    TString tmpIndex = Form("%s/index.%d", fStageDir.Data(), getpid());
+    ofstream out(tmpIndex.Data());
+    for(size_t iEntry=0; iEntry<index.size(); iEntry++)
+        out << index[iEntry].fName << " " << index[iEntry].fSize << " " << index[iEntry].fLastUse << " " << index[iEntry].fOwner << endl;
+    out.close();
+    rename(tmpIndex.Data(), (fStageDir + "/index").Data());
+}
+
+bool FileStager::MakeRoom(vector<IndexEntry>& index, Long64_t size) const{
+    /// \MemberDescr
+    /// \param index : current index, updated with the evicted files removed
+    /// \param size : size needed
+    /// \return false if the space cannot be freed
+    ///
+    /// Must be called with the lock held. Removes the least recently used complete files
+    /// which are not linked from the directory of a running job.
+    /// \EndMemberDescr
+    Long64_t used = 0;
+    for(size_t iEntry=0; iEntry<index.size(); iEntry++) used += index[iEntry].fSize;
+    if(used+size<=fMaxSize) return true;
+
+    vector<TString> pinned;
+    CollectPinned(pinned);
+
+    vector<size_t> order;
+    for(size_t iEntry=0; iEntry<index.size(); iEntry++) order.push_back(iEntry);
+    sort(order.begin(), order.end(), [&index](size_t a, size_t b){ return index[a].fLastUse<index[b].fLastUse; });
+
+    vector<bool> evicted(index.size(), false);
+    for(size_t iOrder=0; iOrder<order.size() && used+size>fMaxSize; iOrder++){
+        const IndexEntry& entry = index[order[iOrder]];
+        if(entry.fOwner!=0) continue;
+        if(find(pinned.begin(), pinned.end(), entry.fName)!=pinned.end()) continue;
+        //A job which already opened the file keeps reading it: unlink only removes the name
+        unlink((fStageDir + "/files/" + entry.fName).Data());
+        evicted[order[iOrder]] = true;
+        used -= entry.fSize;
+    }
+
+    vector<IndexEntry> kept;
+    for(size_t iEntry=0; iEntry<index.size(); iEntry++) if(!evicted[iEntry]) kept.push_back(index[iEntry]);
+    index.swap(kept);
+    return used+size<=fMaxSize;
+}
+
+void FileStager::CollectPinned(vector<TString>& pinned) const{
+    //Files still linked from the directory of a job will be read by this job
+    TString jobsDir = fStageDir + "/jobs";
+    DIR* jobs = opendir(jobsDir.Data());
+    if(!jobs) return;
+    struct dirent* job;
+    char target[4096];
+    while((job = readdir(jobs))){
+        if(job->d_name[0]=='.') continue;
+        TString jobDir = jobsDir + "/" + job->d_name;
+        DIR* links = opendir(jobDir.Data());
+        if(!links) continue;
+        struct dirent* link;
+        while((link = readdir(links))){
+            ssize_t length = readlink((jobDir + "/" + link->d_name).Data(), target, sizeof(target)-1);
+            if(length<=0) continue;
+            target[length] = 0;
+            pinned.push_back(gSystem->BaseName(target));
+        }
+        closedir(links);
+    }
+    closedir(jobs);
+}
+
+void FileStager::CleanDeadJobs() const{
+    TString jobsDir = fStageDir + "/jobs";
+    DIR* jobs = opendir(jobsDir.Data());
+    if(!jobs) return;
+    struct dirent* job;
+    while((job = readdir(jobs))){
+        if(job->d_name[0]=='.') continue;
+        int pid = atoi(job->d_name);
+        if(pid<=0 || kill(pid, 0)==0 || errno!=ESRCH) continue;
+        TString jobDir = jobsDir + "/" + job->d_name;
+        DIR* links = opendir(jobDir.Data());
+        if(links){
+            struct dirent* link;
+            while((link = readdir(links))) if(link->d_name[0]!='.') unlink((jobDir + "/" + link->d_name).Data());
+            closedir(links);
+        }
+        rmdir(jobDir.Data());
+    }
+    closedir(jobs);
+}
+
+TString FileStager::CachedName(int iFile) const{
+    //Different directories may contain files with the same name
+    return Form("%08x_%s", fSources[iFile].Hash(), gSystem->BaseName(fSources[iFile].Data()));
+}
+
+TString FileStager::LinkPath(int iFile) const{
+    return Form("%s/%05d_%s", fJobDir.Data(), iFile, gSystem->BaseName(fSources[iFile].Data()));
+}
+
+bool FileStager::Relink(int iFile, TString target) const{
+    //New link under a temporary name then rename: the framework never sees a missing file
+    TString link = LinkPath(iFile);
+    TString tmpLink = link + ".tmp";
+    unlink(tmpLink.Data());
+    if(symlink(target.Data(), tmpLink.Data())!=0) return false;
+    return rename(tmpLink.Data(), link.Data())==0;
+}
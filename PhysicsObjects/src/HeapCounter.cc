@@ -0,0 +1,73 @@
+#include <TH1D.h>
+#include "HeapCounter.hh"
+
+using namespace std;
+
+//Allocations of the thread, incremented by the operator new of HeapCounterHooks.cc (HEAP_COUNTER
+//option). Plain integers, initialised without code so that they can be used by allocations made
+//before main() and during the thread start
+thread_local Long64_t gHeapNAllocations = 0;
+thread_local Long64_t gHeapNBytes = 0;
+
+HeapCounter::HeapCounter(TString name, int warmUpEvents) :
+    fName(name),
+    fWarmUpEvents(warmUpEvents),
+    fStartAllocations(0),
+    fStartBytes(0),
+    fLastAllocations(0),
+    fNEvents(0),
+    fNAllocatingEvents(0),
+    fSumAllocations(0),
+    fSumBytes(0),
+    fMaxAllocations(0),
+    fAllocationsHisto(0)
+{
+    /// \MemberDescr
+    /// \param name : prefix of the histogram
+    /// \param warmUpEvents : first events, not counted (buffers and histograms reaching their size)
+    /// \EndMemberDescr
+#ifndef HEAP_COUNTER
+    cerr << "HeapCounter: built without -DHEAP_COUNTER=ON, the allocations of " << fName << " are not counted" << endl;
+#endif
+}
+
+Long64_t HeapCounter::GetNAllocations(){
+    return gHeapNAllocations;
+}
+
+Long64_t HeapCounter::GetNBytes(){
+    return gHeapNBytes;
+}
+
+void HeapCounter::EndEvent(){
+    /// \MemberDescr
+    /// Counts the allocations since StartEvent()
+    /// \EndMemberDescr
+    fLastAllocations = GetNAllocations() - fStartAllocations;
+    if(++fNEvents <= fWarmUpEvents) return;
+    if(fLastAllocations>0) fNAllocatingEvents++;
+    if(fLastAllocations>fMaxAllocations) fMaxAllocations = fLastAllocations;
+    fSumAllocations += fLastAllocations;
+    fSumBytes += GetNBytes() - fStartBytes;
+    if(fAllocationsHisto) fAllocationsHisto->Fill(fLastAllocations);
+}
+
+void HeapCounter::BookHistos(vector<TH1*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histogram to book
+    /// \EndMemberDescr
+    fAllocationsHisto = new TH1D(fName + "_HeapAllocations", fName + " heap allocations per event after warm-up;Allocations", 200, 0, 200);
+    histos.push_back(fAllocationsHisto);
+}
+
+void HeapCounter::Print(ostream& out) const{
+    Long64_t nEvents = fNEvents - fWarmUpEvents;
+    out << endl << "Heap allocations " << fName << ":" << endl;
+    if(nEvents<=0){
+        out << "  " << fNEvents << " events, all in the warm-up" << endl;
+        return;
+    }
+    out << "  " << nEvents << " events after " << fWarmUpEvents << " warm-up events, " << fNAllocatingEvents << " allocating" << endl;
+    out << "  " << (double)fSumAllocations/nEvents << " allocations and " << (double)fSumBytes/nEvents
+        << " bytes per event, at most " << fMaxAllocations << " allocations" << endl;
+}
@@ -0,0 +1,39 @@
+//Replacement of the global operator new and delete counting the allocations of each thread for
+//HeapCounter. Every allocation of the process goes through it: only linked with -DHEAP_COUNTER=ON
+#include <cstdlib>
+#include <new>
+#include <TString.h>
+
+using namespace std;
+
+//Defined in HeapCounter.cc
+extern thread_local Long64_t gHeapNAllocations;
+extern thread_local Long64_t gHeapNBytes;
+
+static inline void* CountedAllocate(size_t size){
+    gHeapNAllocations++;
+    gHeapNBytes += size;
+    if(size==0) size = 1;
+    for(;;){
+        void* pointer = malloc(size);
+        if(pointer) return pointer;
+        new_handler handler = get_new_handler();
+        if(!handler) throw bad_alloc();
+        handler();
+    }
+}
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try{ return CountedAllocate(size); }
+    catch(...){ return 0; }
+}
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    try{ return CountedAllocate(size); }
+    catch(...){ return 0; }
+}
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete[](void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, const nothrow_t&) noexcept { free(pointer); }
+void operator delete[](void* pointer, const nothrow_t&) noexcept { free(pointer); }
@@ -0,0 +1,164 @@
+#include <cmath>
+#include <iomanip>
+#include <set>
+#include <TClass.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TKey.h>
+#include <TPRegexp.h>
+#include "HistoComparator.hh"
+
+using namespace std;
+
+HistoComparator::HistoComparator() :
+    fRelative(0.),
+    fAbsolute(0.),
+    fNCompared(0),
+    fNExcluded(0),
+    fMaxDeviation(0.)
+{
+}
+
+void HistoComparator::SetTolerance(double relative, double absolute){
+    /// \MemberDescr
+    /// \param relative : allowed difference relative to the larger value, 0 for the exact mode
+    /// \param absolute : allowed absolute difference, 0 for the exact mode
+    /// \EndMemberDescr
+    fRelative = relative;
+    fAbsolute = absolute;
+}
+
+bool HistoComparator::IsExcluded(TString path) const{
+    for(size_t iExclude=0; iExclude<fExcludes.size(); iExclude++){
+        TPRegexp regexp(fExcludes[iExclude]);
+        if(path.Contains(regexp)) return true;
+    }
+    return false;
+}
+
+bool HistoComparator::Agree(double golden, double output){
+    if(golden==output) return true;
+    double difference = fabs(golden - output);
+    double scale = max(fabs(golden), fabs(output));
+    if(difference > fAbsolute + fRelative*scale) return false;
+    if(scale>0. && difference/scale>fMaxDeviation){
+        fMaxDeviation = difference/scale;
+        fMaxDeviationPath = fCurrentPath;
+    }
+    return true;
+}
+
+bool HistoComparator::CompareHistos(const TH1* golden, const TH1* output, TString& reason){
+    /// \MemberDescr
+    /// \param reason : receives the first difference found
+    /// \return true if the histograms agree
+    /// \EndMemberDescr
+    if(golden->GetDimension()!=output->GetDimension() || golden->GetNcells()!=output->GetNcells()){
+        reason = TString::Format("binning %dD/%d cells instead of %dD/%d cells", output->GetDimension(), output->GetNcells(),
+                                 golden->GetDimension(), golden->GetNcells());
+        return false;
+    }
+    const TAxis* goldenAxes[3] = {golden->GetXaxis(), golden->GetYaxis(), golden->GetZaxis()};
+    const TAxis* outputAxes[3] = {output->GetXaxis(), output->GetYaxis(), output->GetZaxis()};
+    for(int iAxis=0; iAxis<golden->GetDimension(); iAxis++){
+        if(goldenAxes[iAxis]->GetXmin()!=outputAxes[iAxis]->GetXmin() || goldenAxes[iAxis]->GetXmax()!=outputAxes[iAxis]->GetXmax()){
+            reason = TString::Format("axis %d range [%g,%g] instead of [%g,%g]", iAxis, outputAxes[iAxis]->GetXmin(), outputAxes[iAxis]->GetXmax(),
+                                     goldenAxes[iAxis]->GetXmin(), goldenAxes[iAxis]->GetXmax());
+            return false;
+        }
+    }
+    if(!Agree(golden->GetEntries(), output->GetEntries())){
+        reason = TString::Format("%.0f entries instead of %.0f", output->GetEntries(), golden->GetEntries());
+        return false;
+    }
+    for(int iCell=0; iCell<golden->GetNcells(); iCell++){
+        if(!Agree(golden->GetBinContent(iCell), output->GetBinContent(iCell))){
+            reason = TString::Format("cell %d content %.10g instead of %.10g", iCell, output->GetBinContent(iCell), golden->GetBinContent(iCell));
+            return false;
+        }
+        if(!Agree(golden->GetBinError(iCell), output->GetBinError(iCell))){
+            reason = TString::Format("cell %d error %.10g instead of %.10g", iCell, output->GetBinError(iCell), golden->GetBinError(iCell));
+            return false;
+        }
+    }
+    return true;
+}
+
+void HistoComparator::CompareDirectories(TDirectory* golden, TDirectory* output, TString path){
+    //Only the highest cycle of each key
+    set<TString> names;
+    TIter nextGolden(golden->GetListOfKeys());
+    while(TKey* key = (TKey*)nextGolden()){
+        TString name = key->GetName();
+        if(names.count(name)) continue;
+        names.insert(name);
+        TString fullPath = path + name;
+        TClass* keyClass = TClass::GetClass(key->GetClassName());
+        if(!keyClass) continue;
+        if(keyClass->InheritsFrom(TDirectory::Class())){
+            TDirectory* outputDirectory = output->GetDirectory(name);
+            if(!outputDirectory){
+                Failure failure = {fullPath + "/", "directory missing in the output"};
+                fFailures.push_back(failure);
+                continue;
+            }
+            CompareDirectories(golden->GetDirectory(name), outputDirectory, fullPath + "/");
+            continue;
+        }
+        if(!keyClass->InheritsFrom(TH1::Class())) continue;
+        if(IsExcluded(fullPath)){
+            fNExcluded++;
+            continue;
+        }
+        fNCompared++;
+        TH1* goldenHisto = (TH1*)key->ReadObj();
+        TH1* outputHisto = 0;
+        output->GetObject(name, outputHisto);
+        Failure failure = {fullPath, ""};
+        fCurrentPath = fullPath;
+        if(!outputHisto) failure.fReason = "missing in the output";
+        if(!failure.fReason.IsNull() || !CompareHistos(goldenHisto, outputHisto, failure.fReason)) fFailures.push_back(failure);
+        delete goldenHisto;
+        delete outputHisto;
+    }
+
+    TIter nextOutput(output->GetListOfKeys());
+    while(TKey* key = (TKey*)nextOutput()){
+        TString name = key->GetName();
+        if(names.count(name)) continue;
+        names.insert(name);
+        TClass* keyClass = TClass::GetClass(key->GetClassName());
+        if(keyClass && keyClass->InheritsFrom(TH1::Class()) && !IsExcluded(path + name)) fExtra.push_back(path + name);
+    }
+}
+
+int HistoComparator::Compare(TDirectory* golden, TDirectory* output){
+    /// \MemberDescr
+    /// \param golden : reference file or directory
+    /// \param output : file or directory to check
+    /// \return number of histograms which do not agree or are missing in the output
+    /// \EndMemberDescr
+    fNCompared = 0;
+    fNExcluded = 0;
+    fMaxDeviation = 0.;
+    fMaxDeviationPath = "";
+    fFailures.clear();
+    fExtra.clear();
+    CompareDirectories(golden, output, "");
+    return fFailures.size();
+}
+
+void HistoComparator::Print(ostream& out, int maxFailures) const{
+    out << endl << "Histogram comparison (" << (fRelative==0. && fAbsolute==0. ? "exact" : "tolerance") << " mode";
+    if(fRelative!=0. || fAbsolute!=0.) out << ", relative " << fRelative << ", absolute " << fAbsolute;
+    out << "): " << fNCompared << " compared, " << fNExcluded << " excluded, "
+        << fFailures.size() << " different, " << fExtra.size() << " only in the output" << endl;
+    for(size_t iFailure=0; iFailure<fFailures.size() && (int)iFailure<maxFailures; iFailure++){
+        out << "  DIFFERENT " << setw(48) << left << fFailures[iFailure].fPath << right << " " << fFailures[iFailure].fReason << endl;
+    }
+    if((int)fFailures.size()>maxFailures) out << "  ... " << fFailures.size()-maxFailures << " more" << endl;
+    for(size_t iExtra=0; iExtra<fExtra.size() && (int)iExtra<maxFailures; iExtra++) out << "  NEW       " << fExtra[iExtra] << endl;
+    if(fMaxDeviation>0.) out << "Largest relative deviation within tolerance: " << scientific << setprecision(2) << fMaxDeviation << " in " << fMaxDeviationPath << endl;
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include "HitTimeline.hh"
+
+using namespace std;
+
+static bool EarlierThan(const HitTimeline::Entry& a, const HitTimeline::Entry& b) { return a.fTime<b.fTime; }
+static bool EntryBefore(const HitTimeline::Entry& entry, double time) { return entry.fTime<time; }
+static bool TimeBefore(double time, const HitTimeline::Entry& entry) { return time<entry.fTime; }
+
+HitTimeline::HitTimeline(int nDetectors) :
+    fEntries(nDetectors)
+{
+    /// \MemberDescr
+    /// \param nDetectors : number of detector indices used with Add()
+    /// \EndMemberDescr
+}
+
+void HitTimeline::Clear(){
+    for(size_t iDetector=0; iDetector<fEntries.size(); iDetector++) fEntries[iDetector].clear();
+    fMerged.clear();
+}
+
+void HitTimeline::Sort(){
+    /// \MemberDescr
+    /// Sorts the entries of each detector (stable: equal times keep the order of Add()) and
+    /// merges the detectors
+    /// \EndMemberDescr
+    fMerged.clear();
+    for(size_t iDetector=0; iDetector<fEntries.size(); iDetector++){
+        vector<Entry>& entries = fEntries[iDetector];
+        //Few entries per detector and often already in time order: insertion sort
+        for(size_t iEntry=1; iEntry<entries.size(); iEntry++){
+            Entry entry = entries[iEntry];
+            size_t jEntry = iEntry;
+            for(; jEntry>0 && entry.fTime<entries[jEntry-1].fTime; jEntry--) entries[jEntry] = entries[jEntry-1];
+            entries[jEntry] = entry;
+        }
+        if(entries.empty()) continue;
+        fBuffer.resize(fMerged.size() + entries.size());
+        merge(fMerged.begin(), fMerged.end(), entries.begin(), entries.end(), fBuffer.begin(), EarlierThan);
+        fMerged.swap(fBuffer);
+    }
+}
+
+HitTimeline::Range HitTimeline::MakeRange(const vector<Entry>& entries){
+    if(entries.empty()) return Range((const Entry*)0, (const Entry*)0);
+    return Range(&entries[0], &entries[0] + entries.size());
+}
+
+HitTimeline::Range HitTimeline::Find(const vector<Entry>& entries, double min, double max){
+    /// \MemberDescr
+    /// \param entries : entries sorted by time
+    /// \param min, max : time window (inclusive)
+    /// \return entries with min <= time <= max
+    /// \EndMemberDescr
+    Range all = MakeRange(entries);
+    const Entry* first = lower_bound(all.first, all.second, min, EntryBefore);
+    const Entry* last = upper_bound(first, all.second, max, TimeBefore);
+    return Range(first, last);
+}
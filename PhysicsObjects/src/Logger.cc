@@ -0,0 +1,135 @@
+#include <cstring>
+#include <iostream>
+#include "Logger.hh"
+
+using namespace std;
+
+Logger::Site::Site(int level, const char* file, int line) :
+    fLevel(level),
+    fFile(file),
+    fLine(line),
+    fWindowStart(CycleClock::Now()),
+    fWindowTicks(1e9/CycleClock::GetNsPerTick()),
+    fNInWindow(0),
+    fNSuppressed(0)
+{
+    /// \MemberDescr
+    /// \param level : Logger::Level of the messages of the site
+    /// \param file, line : location of the call site (__FILE__, __LINE__)
+    ///
+    /// Created at the first message of the site (function static).
+    /// \EndMemberDescr
+    Logger::Instance();
+}
+
+Logger::Site::~Site(){
+    //The logger is constructed before the first site, hence destroyed after the last one
+    if(fNSuppressed>0) Logger::Instance().Push(fLevel, fFile, fLine, fNSuppressed, "");
+}
+
+Logger& Logger::Instance(){
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() :
+    fHead(0),
+    fTail(0),
+    fRateLimit(10),
+    fNDropped(0),
+    fStop(false)
+{
+    for(size_t iSlot=0; iSlot<kNSlots; iSlot++) fSlots[iSlot].fSequence.store(iSlot, memory_order_relaxed);
+    fThread = thread(&Logger::Run, this);
+}
+
+Logger::~Logger(){
+    fStop = true;
+    fThread.join();
+    if(fNDropped>0) cerr << "Logger: " << fNDropped << " messages dropped (buffer full)" << endl;
+}
+
+bool Logger::Push(Site& site, const string& message){
+    /// \MemberDescr
+    /// \param site : call site of the message, its suppressed count is attached to the message
+    /// \param message : formatted message (truncated to the slot size)
+    /// \return false if the message was dropped because the buffer is full
+    /// \EndMemberDescr
+    UInt_t nSuppressed = site.fNSuppressed.exchange(0, memory_order_relaxed);
+    return Push(site.fLevel, site.fFile, site.fLine, nSuppressed, message);
+}
+
+bool Logger::Push(int level, const char* file, int line, UInt_t nSuppressed, const string& message){
+    //Bounded multi-producer queue: a producer claims the position whose slot sequence matches
+    size_t position = fHead.load(memory_order_relaxed);
+    Slot* slot;
+    for(;;){
+        slot = &fSlots[position & (kNSlots-1)];
+        size_t sequence = slot->fSequence.load(memory_order_acquire);
+        long difference = (long)sequence - (long)position;
+        if(difference==0){
+            if(fHead.compare_exchange_weak(position, position+1, memory_order_relaxed)) break;
+        }
+        else if(difference<0){
+            fNDropped++;
+            return false;
+        }
+        else position = fHead.load(memory_order_relaxed);
+    }
+    slot->fLevel = level;
+    slot->fFile = file;
+    slot->fLine = line;
+    slot->fNSuppressed = nSuppressed;
+    size_t length = min(message.size(), kMessageSize-1);
+    memcpy(slot->fMessage, message.data(), length);
+    slot->fMessage[length] = 0;
+    slot->fSequence.store(position+1, memory_order_release);
+    return true;
+}
+
+bool Logger::Pop(){
+    /// \MemberDescr
+    /// \return false if there is no written message to print (writer thread only)
+    /// \EndMemberDescr
+    size_t position = fTail.load(memory_order_relaxed);
+    Slot& slot = fSlots[position & (kNSlots-1)];
+    if(slot.fSequence.load(memory_order_acquire)!=position+1) return false;
+
+    const char* file = strrchr(slot.fFile, '/');
+    ostream& out = slot.fLevel<=kWarning ? cerr : cout;
+    out << "[" << GetLevelName(slot.fLevel) << "] " << (file ? file+1 : slot.fFile) << ":" << slot.fLine << ": ";
+    if(slot.fMessage[0]!=0) out << slot.fMessage;
+    if(slot.fNSuppressed>0) out << (slot.fMessage[0]!=0 ? " (" : "(") << slot.fNSuppressed << " messages suppressed)";
+    out << endl;
+
+    slot.fSequence.store(position+kNSlots, memory_order_release);
+    fTail.store(position+1, memory_order_release);
+    return true;
+}
+
+void Logger::Run(){
+    int idle = 0;
+    for(;;){
+        if(Pop()){
+            idle = 0;
+            continue;
+        }
+        if(fStop && fTail.load()==fHead.load()) return;
+        //Back off up to 10 ms: the event loop never signals the writer
+        this_thread::sleep_for(chrono::microseconds(idle<10 ? 100 : 10000));
+        idle++;
+    }
+}
+
+void Logger::Flush(){
+    /// \MemberDescr
+    /// Waits until the messages pushed before the call are written
+    /// \EndMemberDescr
+    size_t head = fHead.load();
+    while(fTail.load(memory_order_acquire)<head) this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+const char* Logger::GetLevelName(int level){
+    static const char* names[] = {"Error", "Warning", "Info", "Debug"};
+    return (level>=kError && level<=kDebug) ? names[level] : "Unknown";
+}
@@ -0,0 +1,27 @@
+#include "MUVChannelMap.hh"
+
+static const int kNChannels[MUVChannelMap::kNDetectors] = {176, 88, 152};
+static const int kNStrips[MUVChannelMap::kNDetectors] = {44, 22, 0};
+
+int MUVChannelMap::GetNChannels(int detector){
+    return (detector>=0 && detector<kNDetectors) ? kNChannels[detector] : 0;
+}
+
+int MUVChannelMap::GetChannelID(int detector, int channel){
+    /// \MemberDescr
+    /// \param detector : Detector
+    /// \param channel : channel index
+    /// \return channel ID of the MUV1/MUV2 strip end, tile ID for MUV3 (inverse of the Channel() mappings)
+    /// \EndMemberDescr
+    int nStrips = kNStrips[detector];
+    if(nStrips==0) return channel;
+    int side  = channel/(2*nStrips);
+    int plane = (channel/nStrips)%2;
+    int strip = channel%nStrips + 1;
+    return (side+1)*100 + plane*50 + strip;
+}
+
+const char* MUVChannelMap::GetDetectorName(int detector){
+    static const char* names[kNDetectors] = {"MUV1", "MUV2", "MUV3"};
+    return (detector>=0 && detector<kNDetectors) ? names[detector] : "";
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <sys/resource.h>
+#include <TArrayC.h>
+#include <TArrayF.h>
+#include <TArrayI.h>
+#include <TArrayS.h>
+#include <TGraph.h>
+#include <TH1D.h>
+#include "MemoryMonitor.hh"
+
+using namespace std;
+
+MemoryMonitor& MemoryMonitor::Instance(){
+    static MemoryMonitor monitor;
+    return monitor;
+}
+
+MemoryMonitor::MemoryMonitor() :
+    fEnabled(false),
+    fBurstStartAllocations(0),
+    fAllocationsHisto(0),
+    fHistoMemoryHisto(0),
+    fRSSGraph(0),
+    fHighWaterGraph(0),
+    fBurstAllocationsGraph(0)
+{
+}
+
+int MemoryMonitor::AddAnalyzer(TString name){
+    /// \MemberDescr
+    /// \param name : name of the analyzer in the report
+    /// \return index of the analyzer, to pass to the other methods
+    /// \EndMemberDescr
+    AnalyzerMemory analyzer = {name, 0, 0, 0, 0, 0, 0};
+    fAnalyzers.push_back(analyzer);
+    return fAnalyzers.size()-1;
+}
+
+void MemoryMonitor::AddProcess(int analyzer, Long64_t nAllocations, Long64_t nBytes){
+    AnalyzerMemory& memory = fAnalyzers[analyzer];
+    memory.fNCalls++;
+    memory.fNAllocations += nAllocations;
+    memory.fNBytes += nBytes;
+    if(nAllocations>memory.fMaxAllocations) memory.fMaxAllocations = nAllocations;
+}
+
+Long64_t MemoryMonitor::GetHistoBytes(const TH1* histo){
+    /// \MemberDescr
+    /// \param histo : booked histogram
+    /// \return size of the bin contents and of the sum of squares of the weights [bytes]
+    /// \EndMemberDescr
+    Long64_t cellBytes = sizeof(Double_t);
+    if(dynamic_cast<const TArrayF*>(histo) || dynamic_cast<const TArrayI*>(histo)) cellBytes = 4;
+    else if(dynamic_cast<const TArrayS*>(histo)) cellBytes = 2;
+    else if(dynamic_cast<const TArrayC*>(histo)) cellBytes = 1;
+    return histo->GetNcells()*cellBytes + histo->GetSumw2N()*sizeof(Double_t);
+}
+
+void MemoryMonitor::AddHisto(int analyzer, TH1* histo){
+    if(!fEnabled) return;
+    HistoMemory memory = {analyzer, histo->GetName(), GetHistoBytes(histo)};
+    fHistos.push_back(memory);
+    fAnalyzers[analyzer].fNHistos++;
+    fAnalyzers[analyzer].fHistoBytes += memory.fBytes;
+}
+
+bool MemoryMonitor::ReadRSS(Long64_t& rss, Long64_t& highWater){
+    /// \MemberDescr
+    /// \param rss : receives the resident set size [kB]
+    /// \param highWater : receives the largest resident set size of the process [kB]
+    /// \return false if /proc/self/status is not available (only highWater is set, from getrusage)
+    /// \EndMemberDescr
+    rss = highWater = 0;
+    ifstream status("/proc/self/status");
+    string key;
+    while(status >> key){
+        if(key=="VmRSS:") status >> rss;
+        else if(key=="VmHWM:") status >> highWater;
+        status.ignore(1024, '\n');
+    }
+    if(rss>0) return true;
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage)==0) highWater = usage.ru_maxrss;
+    return false;
+}
+
+void MemoryMonitor::EndBurst(int analyzer, int burstID){
+    /// \MemberDescr
+    /// \param analyzer : index of the calling analyzer, only the first one is recorded
+    /// \param burstID : burst which just ended
+    /// \EndMemberDescr
+    if(!fEnabled || analyzer!=0) return;
+    BurstMemory burst;
+    burst.fBurstID = burstID;
+    ReadRSS(burst.fRSS, burst.fHighWater);
+    Long64_t nAllocations = HeapCounter::GetNAllocations();
+    burst.fNAllocations = nAllocations - fBurstStartAllocations;
+    fBurstStartAllocations = nAllocations;
+    fBursts.push_back(burst);
+}
+
+void MemoryMonitor::BookHistos(int analyzer, vector<TH1*>& histos, vector<TGraph*>& graphs){
+    /// \MemberDescr
+    /// \param analyzer : index of the calling analyzer, only the first one receives the histograms
+    /// \param histos, graphs : receive the histograms and graphs to book
+    /// \EndMemberDescr
+    if(!fEnabled || analyzer!=0) return;
+    int nAnalyzers = fAnalyzers.size();
+    fAllocationsHisto = new TH1D("Memory_AllocationsPerCall", "Heap allocations per Process call;;Allocations", nAnalyzers, 0, nAnalyzers);
+    fHistoMemoryHisto = new TH1D("Memory_HistoMemory", "Memory of the booked histograms;;Memory [MB]", nAnalyzers, 0, nAnalyzers);
+    for(int iAnalyzer=0; iAnalyzer<nAnalyzers; iAnalyzer++){
+        fAllocationsHisto->GetXaxis()->SetBinLabel(iAnalyzer+1, fAnalyzers[iAnalyzer].fName);
+        fHistoMemoryHisto->GetXaxis()->SetBinLabel(iAnalyzer+1, fAnalyzers[iAnalyzer].fName);
+    }
+    histos.push_back(fAllocationsHisto);
+    histos.push_back(fHistoMemoryHisto);
+
+    fRSSGraph = new TGraph();
+    fRSSGraph->SetName("Memory_BurstRSS");
+    fRSSGraph->SetTitle("Resident memory at the end of the burst;Burst ID;RSS [MB]");
+    fHighWaterGraph = new TGraph();
+    fHighWaterGraph->SetName("Memory_BurstHighWater");
+    fHighWaterGraph->SetTitle("Resident memory high-water mark at the end of the burst;Burst ID;Peak RSS [MB]");
+    fBurstAllocationsGraph = new TGraph();
+    fBurstAllocationsGraph->SetName("Memory_BurstAllocations");
+    fBurstAllocationsGraph->SetTitle("Heap allocations during the burst;Burst ID;Allocations");
+    graphs.push_back(fRSSGraph);
+    graphs.push_back(fHighWaterGraph);
+    graphs.push_back(fBurstAllocationsGraph);
+}
+
+void MemoryMonitor::Fill() const{
+    if(fAllocationsHisto){
+        for(size_t iAnalyzer=0; iAnalyzer<fAnalyzers.size(); iAnalyzer++){
+            const AnalyzerMemory& memory = fAnalyzers[iAnalyzer];
+            fAllocationsHisto->SetBinContent(iAnalyzer+1, memory.fNCalls>0 ? (double)memory.fNAllocations/memory.fNCalls : 0.);
+            fHistoMemoryHisto->SetBinContent(iAnalyzer+1, memory.fHistoBytes/1048576.);
+        }
+    }
+    if(fRSSGraph){
+        fRSSGraph->Set(fBursts.size());
+        fHighWaterGraph->Set(fBursts.size());
+        fBurstAllocationsGraph->Set(fBursts.size());
+        for(size_t iBurst=0; iBurst<fBursts.size(); iBurst++){
+            const BurstMemory& burst = fBursts[iBurst];
+            fRSSGraph->SetPoint(iBurst, burst.fBurstID, burst.fRSS/1024.);
+            fHighWaterGraph->SetPoint(iBurst, burst.fBurstID, burst.fHighWater/1024.);
+            fBurstAllocationsGraph->SetPoint(iBurst, burst.fBurstID, burst.fNAllocations);
+        }
+    }
+}
+
+static bool LargerHisto(const pair<Long64_t, int>& a, const pair<Long64_t, int>& b) { return a.first>b.first; }
+
+void MemoryMonitor::Print(ostream& out) const{
+    Long64_t rss, highWater;
+    ReadRSS(rss, highWater);
+    out << endl << "Memory: RSS " << fixed << setprecision(1) << rss/1024. << " MB, high-water " << highWater/1024. << " MB" << endl;
+    out << setw(24) << left << "Analyzer" << right << setw(12) << "Calls" << setw(12) << "Alloc/call" << setw(12) << "kB/call"
+        << setw(12) << "Max alloc" << setw(10) << "Histos" << setw(12) << "Histo[MB]" << endl;
+    for(size_t iAnalyzer=0; iAnalyzer<fAnalyzers.size(); iAnalyzer++){
+        const AnalyzerMemory& memory = fAnalyzers[iAnalyzer];
+        double calls = memory.fNCalls>0 ? memory.fNCalls : 1.;
+        out << setw(24) << left << memory.fName << right << setw(12) << memory.fNCalls << setw(12) << memory.fNAllocations/calls
+            << setw(12) << memory.fNBytes/calls/1024. << setw(12) << memory.fMaxAllocations << setw(10) << memory.fNHistos
+            << setw(12) << memory.fHistoBytes/1048576. << endl;
+    }
+
+    vector<pair<Long64_t, int> > largest;
+    for(size_t iHisto=0; iHisto<fHistos.size(); iHisto++) largest.push_back(make_pair(fHistos[iHisto].fBytes, (int)iHisto));
+    size_t nLargest = min(largest.size(), (size_t)10);
+    partial_sort(largest.begin(), largest.begin()+nLargest, largest.end(), LargerHisto);
+    if(nLargest>0) out << "Largest histograms:" << endl;
+    for(size_t iHisto=0; iHisto<nLargest; iHisto++){
+        const HistoMemory& histo = fHistos[largest[iHisto].second];
+        out << "  " << setw(40) << left << histo.fName << right << setw(24) << fAnalyzers[histo.fAnalyzer].fName
+            << setw(12) << histo.fBytes/1048576. << " MB" << endl;
+    }
+
+    if(!fBursts.empty()){
+        const BurstMemory& first = fBursts.front();
+        const BurstMemory& last = fBursts.back();
+        out << fBursts.size() << " bursts: RSS " << first.fRSS/1024. << " MB after burst " << first.fBurstID << ", "
+            << last.fRSS/1024. << " MB after burst " << last.fBurstID << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+
+void MemoryMonitor::Report(int analyzer, ostream& out){
+    /// \MemberDescr
+    /// \param analyzer : index of the calling analyzer, only the first one fills and prints the report
+    /// \param out : receives the report table
+    /// \EndMemberDescr
+    if(!fEnabled || analyzer!=0) return;
+    Fill();
+    Print(out);
+}
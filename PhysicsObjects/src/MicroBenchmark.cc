@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include "MicroBenchmark.hh"
+
+using namespace std;
+
+MicroBenchmark::MicroBenchmark(int nWarmup, int nRepetitions, double minTime) :
+    fNWarmup(nWarmup),
+    fNRepetitions(nRepetitions>0 ? nRepetitions : 1),
+    fMinTime(minTime),
+    fSink(0.)
+{
+    /// \MemberDescr
+    /// \param nWarmup : repetitions run before the measurement
+    /// \param nRepetitions : measured repetitions
+    /// \param minTime : minimum duration of one repetition [ns], sets the number of calls
+    /// \EndMemberDescr
+}
+
+double MicroBenchmark::Median(vector<double> values){
+    if(values.empty()) return 0.;
+    size_t middle = values.size()/2;
+    nth_element(values.begin(), values.begin()+middle, values.end());
+    double median = values[middle];
+    if(values.size()%2==1) return median;
+    return 0.5*(median + *max_element(values.begin(), values.begin()+middle));
+}
+
+const MicroBenchmark::Result& MicroBenchmark::AddResult(TString kernel, int parameter, Long64_t calls, vector<double>& times){
+    Result result;
+    result.fKernel = kernel;
+    result.fParameter = parameter;
+    result.fCalls = calls;
+    result.fRepetitions = times.size();
+    result.fMedian = Median(times);
+    result.fMin = *min_element(times.begin(), times.end());
+    vector<double> deviations(times.size());
+    for(size_t iTime=0; iTime<times.size(); iTime++) deviations[iTime] = fabs(times[iTime] - result.fMedian);
+    result.fMAD = Median(deviations);
+    fResults.push_back(result);
+    return fResults.back();
+}
+
+void MicroBenchmark::Print(ostream& out) const{
+    out << endl << setw(32) << left << "Kernel" << right << setw(10) << "Size" << setw(14) << "Calls/rep"
+        << setw(14) << "Median[ns]" << setw(12) << "MAD[ns]" << setw(10) << "MAD[%]" << setw(12) << "Min[ns]" << endl;
+    for(size_t iResult=0; iResult<fResults.size(); iResult++){
+        const Result& result = fResults[iResult];
+        out << setw(32) << left << result.fKernel << right << setw(10) << result.fParameter << setw(14) << result.fCalls
+            << fixed << setprecision(2) << setw(14) << result.fMedian << setw(12) << result.fMAD
+            << setprecision(1) << setw(10) << (result.fMedian>0. ? 100.*result.fMAD/result.fMedian : 0.)
+            << setprecision(2) << setw(12) << result.fMin << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+
+void MicroBenchmark::WriteJSON(ostream& out, TString label) const{
+    /// \MemberDescr
+    /// \param out : receives {"label": ..., "ns_per_tick": ..., "results": [{"kernel": ..., "size": ...,
+    /// "median_ns": ..., "mad_ns": ..., "min_ns": ..., "calls": ..., "repetitions": ...}, ...]}
+    /// \param label : free text identifying the run (commit, machine, compiler flags)
+    /// \EndMemberDescr
+    label.ReplaceAll("\\", "\\\\");
+    label.ReplaceAll("\"", "\\\"");
+    out << "{" << endl;
+    out << "  \"label\": \"" << label << "\"," << endl;
+    out << "  \"ns_per_tick\": " << setprecision(9) << CycleClock::GetNsPerTick() << "," << endl;
+    out << "  \"warmup\": " << fNWarmup << "," << endl;
+    out << "  \"results\": [" << endl;
+    for(size_t iResult=0; iResult<fResults.size(); iResult++){
+        const Result& result = fResults[iResult];
+        out << "    {\"kernel\": \"" << result.fKernel << "\", \"size\": " << result.fParameter
+            << ", \"median_ns\": " << result.fMedian << ", \"mad_ns\": " << result.fMAD << ", \"min_ns\": " << result.fMin
+            << ", \"calls\": " << result.fCalls << ", \"repetitions\": " << result.fRepetitions << "}"
+            << (iResult+1<fResults.size() ? "," : "") << endl;
+    }
+    out << "  ]" << endl << "}" << endl;
+    out << setprecision(6);
+}
@@ -0,0 +1,14 @@
+#include "PeakFinder.hh"
+
+PeakFinder::PeakFinder(double window, double minEntries, int seedHalfWidth) :
+    fWindow(window),
+    fMinEntries(minEntries),
+    fSeedHalfWidth(seedHalfWidth>0 ? seedHalfWidth : 0),
+    fMaxIterations(10)
+{
+    /// \MemberDescr
+    /// \param window : half width of the truncation window around the peak (x units)
+    /// \param minEntries : minimum number of entries inside the final window
+    /// \param seedHalfWidth : half width (bins) of the sliding sum seeding the peak
+    /// \EndMemberDescr
+}
@@ -0,0 +1,263 @@
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include <TH1D.h>
+#include "PerfCounters.hh"
+
+using namespace std;
+
+PerfCounters& PerfCounters::Instance(){
+    static PerfCounters counters;
+    return counters;
+}
+
+PerfCounters::PerfCounters() :
+    fEnabled(false),
+    fLeader(-1),
+    fNOpen(0),
+    fMultiplexed(false),
+    fStarted(false),
+    fTimeHisto(0),
+    fIPCHisto(0),
+    fCyclesHisto(0),
+    fCacheMissesHisto(0),
+    fBranchMissesHisto(0)
+{
+    fFirst.fTicks = 0;
+    fLast.fTicks = 0;
+    for(int iCounter=0; iCounter<kNCounters; iCounter++){
+        fFD[iCounter] = -1;
+        fGroupIndex[iCounter] = -1;
+        fFirst.fCount[iCounter] = 0;
+        fLast.fCount[iCounter] = 0;
+    }
+}
+
+PerfCounters::~PerfCounters(){
+    Close();
+}
+
+const char* PerfCounters::GetCounterName(int counter){
+    static const char* names[kNCounters] = {"cycles", "instructions", "cache-misses", "branch-misses"};
+    return names[counter];
+}
+
+bool PerfCounters::Open(){
+    /// \MemberDescr
+    /// \return false if none of the counters can be opened, the reason is printed
+    /// \EndMemberDescr
+#ifdef __linux__
+    static const unsigned long long configs[kNCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int firstError = 0;
+    for(int iCounter=0; iCounter<kNCounters; iCounter++){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[iCounter];
+        attr.disabled = fLeader<0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = syscall(__NR_perf_event_open, &attr, 0, -1, fLeader, 0);
+        if(fd<0){
+            if(firstError==0) firstError = errno;
+            continue;
+        }
+        if(fLeader<0) fLeader = fd;
+        fFD[iCounter] = fd;
+        fGroupIndex[iCounter] = fNOpen++;
+    }
+    if(fLeader<0){
+        cerr << "PerfCounters: hardware counters not available (" << strerror(firstError) << "), only the time is reported";
+        if(firstError==EACCES || firstError==EPERM) cerr << ". Check /proc/sys/kernel/perf_event_paranoid";
+        cerr << endl;
+        return false;
+    }
+    for(int iCounter=0; iCounter<kNCounters; iCounter++){
+        if(fFD[iCounter]<0) cerr << "PerfCounters: " << GetCounterName(iCounter) << " not available" << endl;
+    }
+    ioctl(fLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    cerr << "PerfCounters: hardware counters only available on Linux, only the time is reported" << endl;
+    return false;
+#endif
+}
+
+void PerfCounters::Close(){
+    for(int iCounter=0; iCounter<kNCounters; iCounter++){
+        if(fFD[iCounter]>=0) close(fFD[iCounter]);
+        fFD[iCounter] = -1;
+        fGroupIndex[iCounter] = -1;
+    }
+    fLeader = -1;
+    fNOpen = 0;
+}
+
+bool PerfCounters::SetEnabled(bool enabled){
+    /// \MemberDescr
+    /// \param enabled : opens (closes) the counters of the calling thread, the one running Process
+    /// \return whether the monitor is enabled, also when only the time is available
+    /// \EndMemberDescr
+    if(enabled && !fEnabled){
+        Open();
+        fEnabled = true;
+    }
+    else if(!enabled && fEnabled){
+        Close();
+        fEnabled = false;
+    }
+    return fEnabled;
+}
+
+int PerfCounters::AddAnalyzer(TString name){
+    /// \MemberDescr
+    /// \param name : name of the analyzer in the report
+    /// \return index of the analyzer, to pass to the other methods
+    /// \EndMemberDescr
+    AnalyzerCounts analyzer;
+    analyzer.fName = name;
+    analyzer.fNCalls = 0;
+    analyzer.fTicks = 0;
+    for(int iCounter=0; iCounter<kNCounters; iCounter++) analyzer.fCount[iCounter] = 0;
+    fAnalyzers.push_back(analyzer);
+    return fAnalyzers.size()-1;
+}
+
+bool PerfCounters::Read(Values& values) const{
+    /// \MemberDescr
+    /// \param values : receives the time and the counts since SetEnabled(), 0 for the counters not available
+    /// \return false if the group could not be read
+    /// \EndMemberDescr
+    values.fTicks = CycleClock::Now();
+    if(fLeader<0){
+        for(int iCounter=0; iCounter<kNCounters; iCounter++) values.fCount[iCounter] = 0;
+        return true;
+    }
+    unsigned long long buffer[3+kNCounters];
+    if(read(fLeader, buffer, sizeof(buffer)) < (ssize_t)((3+fNOpen)*sizeof(unsigned long long))) return false;
+    unsigned long long timeEnabled = buffer[1];
+    unsigned long long timeRunning = buffer[2];
+    double scale = 1.;
+    if(timeRunning>0 && timeRunning<timeEnabled){
+        scale = (double)timeEnabled/timeRunning;
+        fMultiplexed = true;
+    }
+    for(int iCounter=0; iCounter<kNCounters; iCounter++){
+        values.fCount[iCounter] = fGroupIndex[iCounter]>=0 ? (Long64_t)(buffer[3+fGroupIndex[iCounter]]*scale) : 0;
+    }
+    return true;
+}
+
+void PerfCounters::AddScope(int analyzer, const Values& start){
+    Values end;
+    if(!Read(end)) return;
+    AnalyzerCounts& counts = fAnalyzers[analyzer];
+    counts.fNCalls++;
+    counts.fTicks += end.fTicks - start.fTicks;
+    for(int iCounter=0; iCounter<kNCounters; iCounter++) counts.fCount[iCounter] += end.fCount[iCounter] - start.fCount[iCounter];
+    if(!fStarted){
+        fFirst = start;
+        fStarted = true;
+    }
+    fLast = end;
+}
+
+PerfCounters::AnalyzerCounts PerfCounters::GetOutside() const{
+    /// \MemberDescr
+    /// \return counts between the first and the last scope which are not in any analyzer,
+    /// per call of the first analyzer
+    /// \EndMemberDescr
+    AnalyzerCounts outside;
+    outside.fName = "Outside analyzers";
+    outside.fNCalls = fAnalyzers.empty() ? 0 : fAnalyzers[0].fNCalls;
+    Long64_t outsideTicks = fLast.fTicks - fFirst.fTicks;
+    for(size_t iAnalyzer=0; iAnalyzer<fAnalyzers.size(); iAnalyzer++) outsideTicks -= fAnalyzers[iAnalyzer].fTicks;
+    outside.fTicks = outsideTicks>0 ? outsideTicks : 0;
+    for(int iCounter=0; iCounter<kNCounters; iCounter++){
+        outside.fCount[iCounter] = fLast.fCount[iCounter] - fFirst.fCount[iCounter];
+        for(size_t iAnalyzer=0; iAnalyzer<fAnalyzers.size(); iAnalyzer++) outside.fCount[iCounter] -= fAnalyzers[iAnalyzer].fCount[iCounter];
+        if(outside.fCount[iCounter]<0) outside.fCount[iCounter] = 0;
+    }
+    return outside;
+}
+
+void PerfCounters::BookHistos(int analyzer, vector<TH1*>& histos){
+    /// \MemberDescr
+    /// \param analyzer : index of the calling analyzer, only the first one receives the histograms
+    /// \param histos : receives the histograms to book
+    /// \EndMemberDescr
+    if(!fEnabled || analyzer!=0) return;
+    int nBins = fAnalyzers.size()+1;
+    fTimeHisto = new TH1D("Perf_TimePerEvent", "Time per event;;Time [ns]", nBins, 0, nBins);
+    fIPCHisto = new TH1D("Perf_IPC", "Instructions per cycle;;IPC", nBins, 0, nBins);
+    fCyclesHisto = new TH1D("Perf_CyclesPerEvent", "Cycles per event;;Cycles", nBins, 0, nBins);
+    fCacheMissesHisto = new TH1D("Perf_CacheMissesPerEvent", "Last level cache misses per event;;Misses", nBins, 0, nBins);
+    fBranchMissesHisto = new TH1D("Perf_BranchMissesPerEvent", "Branch mispredictions per event;;Misses", nBins, 0, nBins);
+    TH1D* perfHistos[5] = {fTimeHisto, fIPCHisto, fCyclesHisto, fCacheMissesHisto, fBranchMissesHisto};
+    for(int iHisto=0; iHisto<5; iHisto++){
+        for(size_t iAnalyzer=0; iAnalyzer<fAnalyzers.size(); iAnalyzer++) perfHistos[iHisto]->GetXaxis()->SetBinLabel(iAnalyzer+1, fAnalyzers[iAnalyzer].fName);
+        perfHistos[iHisto]->GetXaxis()->SetBinLabel(nBins, "Outside");
+        histos.push_back(perfHistos[iHisto]);
+    }
+}
+
+void PerfCounters::Fill() const{
+    if(!fTimeHisto) return;
+    for(size_t iBin=0; iBin<=fAnalyzers.size(); iBin++){
+        AnalyzerCounts counts = iBin<fAnalyzers.size() ? fAnalyzers[iBin] : GetOutside();
+        double calls = counts.fNCalls>0 ? counts.fNCalls : 1.;
+        fTimeHisto->SetBinContent(iBin+1, CycleClock::ToNs(counts.fTicks)/calls);
+        fIPCHisto->SetBinContent(iBin+1, counts.fCount[kCycles]>0 ? (double)counts.fCount[kInstructions]/counts.fCount[kCycles] : 0.);
+        fCyclesHisto->SetBinContent(iBin+1, counts.fCount[kCycles]/calls);
+        fCacheMissesHisto->SetBinContent(iBin+1, counts.fCount[kCacheMisses]/calls);
+        fBranchMissesHisto->SetBinContent(iBin+1, counts.fCount[kBranchMisses]/calls);
+    }
+}
+
+void PerfCounters::Print(ostream& out) const{
+    out << endl << "Time and hardware counters per event (user space";
+    if(fMultiplexed) out << ", multiplexed and scaled";
+    out << "):" << endl;
+    out << setw(24) << left << "Analyzer" << right << setw(12) << "Calls" << setw(12) << "ns";
+    for(int iCounter=0; iCounter<kNCounters; iCounter++) out << setw(16) << GetCounterName(iCounter);
+    out << setw(8) << "IPC" << setw(12) << "Miss/kinst" << endl;
+    for(size_t iRow=0; iRow<=fAnalyzers.size(); iRow++){
+        AnalyzerCounts counts = iRow<fAnalyzers.size() ? fAnalyzers[iRow] : GetOutside();
+        double calls = counts.fNCalls>0 ? counts.fNCalls : 1.;
+        out << setw(24) << left << counts.fName << right << setw(12) << counts.fNCalls << fixed << setprecision(0);
+        out << setw(12) << CycleClock::ToNs(counts.fTicks)/calls;
+        for(int iCounter=0; iCounter<kNCounters; iCounter++){
+            if(IsAvailable(iCounter)) out << setw(16) << counts.fCount[iCounter]/calls;
+            else out << setw(16) << "n/a";
+        }
+        out << setprecision(2);
+        if(IsAvailable(kCycles) && IsAvailable(kInstructions) && counts.fCount[kCycles]>0) out << setw(8) << (double)counts.fCount[kInstructions]/counts.fCount[kCycles];
+        else out << setw(8) << "n/a";
+        if(IsAvailable(kCacheMisses) && IsAvailable(kInstructions) && counts.fCount[kInstructions]>0) out << setw(12) << 1000.*counts.fCount[kCacheMisses]/counts.fCount[kInstructions];
+        else out << setw(12) << "n/a";
+        out << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
+
+void PerfCounters::Report(int analyzer, ostream& out){
+    /// \MemberDescr
+    /// \param analyzer : index of the calling analyzer, only the first one fills and prints the report
+    /// \param out : receives the report table
+    /// \EndMemberDescr
+    if(!fEnabled || analyzer!=0) return;
+    Fill();
+    Print(out);
+}
@@ -0,0 +1,372 @@
+#include <cmath>
+#include <TTree.h>
+#include <TVector2.h>
+#include "RecoEventGenerator.hh"
+#include "Definition.h"
+#include "Persistency.hh"
+
+using namespace std;
+using namespace NA62Constants;
+
+//Geometry and detector constants not in Definition.h [mm, MeV]
+static const double kZStraw1     = 183508.;   ///< First STRAW chamber, PositionBeforeMagnet
+static const double kZMagnet     = 197600.;   ///< Centre of the spectrometer magnet
+static const double kZStraw4     = 219546.;   ///< Last STRAW chamber, PositionAfterMagnet
+static const double kMagnetKick  = 270.;      ///< Transverse momentum kick along x
+static const double kPi0Mass     = 134.9766;
+static const double kRICHIndex   = 1.000067;  ///< Neon, as in the Kmu2 RICH mass
+static const double kRICHFocal   = 17000.;
+static const double kLKrOffset   = 115.;      ///< Nominal Kmu2 LKr - CHOD time offset [ns]
+static const double kMUVHalfSize = 1320.;
+static const double kMUV3TileSize= 220.;
+
+RecoEventGenerator::RecoEventGenerator(const Config& config, unsigned int seed) :
+    fConfig(config),
+    fRandom(seed),
+    fKpi2(false),
+    fSpectrometerEvent(new TRecoSpectrometerEvent),
+    fCHODEvent(new TRecoCHODEvent),
+    fLKrEvent(new TRecoLKrEvent),
+    fMUV1Event(new TRecoMUV1Event),
+    fMUV2Event(new TRecoMUV2Event),
+    fMUV3Event(new TRecoMUV3Event),
+    fCedarEvent(new TRecoCedarEvent),
+    fRICHEvent(new TRecoRICHEvent)
+{
+    /// \MemberDescr
+    /// \param config : composition of the events and accidental multiplicities
+    /// \param seed : seed of the random generator, the same seed gives the same events
+    /// \EndMemberDescr
+}
+
+RecoEventGenerator::~RecoEventGenerator(){
+    delete fSpectrometerEvent;
+    delete fCHODEvent;
+    delete fLKrEvent;
+    delete fMUV1Event;
+    delete fMUV2Event;
+    delete fMUV3Event;
+    delete fCedarEvent;
+    delete fRICHEvent;
+}
+
+RecoEventGenerator::Config RecoEventGenerator::GetDefaultConfig(){
+    /// \MemberDescr
+    /// \return Kmu2 dominated sample (Kpi2 fraction of the K+ branching ratios) at nominal intensity
+    /// \EndMemberDescr
+    Config config;
+    config.fKpi2Fraction = 0.25;
+    config.fAccidentals = 1.;
+    config.fCedarAccidentals = 1.;
+    config.fNoiseHits = 2.;
+    config.fTimeWindow = 50.;
+    return config;
+}
+
+void RecoEventGenerator::Branch(TTree* tree){
+    /// \MemberDescr
+    /// \param tree : receives one branch per detector, named as in the reco files
+    /// \EndMemberDescr
+    tree->Branch("Spectrometer", fSpectrometerEvent->ClassName(), &fSpectrometerEvent);
+    tree->Branch("CHOD", fCHODEvent->ClassName(), &fCHODEvent);
+    tree->Branch("LKr", fLKrEvent->ClassName(), &fLKrEvent);
+    tree->Branch("MUV1", fMUV1Event->ClassName(), &fMUV1Event);
+    tree->Branch("MUV2", fMUV2Event->ClassName(), &fMUV2Event);
+    tree->Branch("MUV3", fMUV3Event->ClassName(), &fMUV3Event);
+    tree->Branch("Cedar", fCedarEvent->ClassName(), &fCedarEvent);
+    tree->Branch("RICH", fRICHEvent->ClassName(), &fRICHEvent);
+}
+
+void RecoEventGenerator::Clear(int burstID, int eventID){
+    TRecoVEvent* events[8] = {fSpectrometerEvent, fCHODEvent, fLKrEvent, fMUV1Event, fMUV2Event, fMUV3Event, fCedarEvent, fRICHEvent};
+    for(int iEvent=0; iEvent<8; iEvent++){
+        events[iEvent]->Clear("C");
+        events[iEvent]->SetBurstID(burstID);
+        events[iEvent]->SetID(eventID);
+    }
+}
+
+void RecoEventGenerator::Generate(int burstID, int eventID){
+    /// \MemberDescr
+    /// \param burstID, eventID : set in all the detector events
+    ///
+    /// Replaces the content of the events by a new decay and its accidentals
+    /// \EndMemberDescr
+    Clear(burstID, eventID);
+    fKpi2 = fRandom.Rndm() < fConfig.fKpi2Fraction;
+    double t0 = fRandom.Gaus(0., 1.);
+    AddSignal(t0);
+
+    //Halo muons and upstream pions, out of the spectrometer acceptance or not reconstructed
+    int nAccidentals = fRandom.Poisson(fConfig.fAccidentals);
+    for(int iAccidental=0; iAccidental<nAccidentals; iAccidental++){
+        Particle particle;
+        double radius = sqrt(fRandom.Uniform(100.*100., 1100.*1100.));
+        double phi = fRandom.Uniform(0., 2.*M_PI);
+        particle.fPosition.SetXYZ(radius*cos(phi), radius*sin(phi), kZStraw4);
+        particle.fSlopes.SetXYZ(fRandom.Gaus(0., 0.003), fRandom.Gaus(0., 0.003), 1.);
+        particle.fMuon = fRandom.Rndm() < 0.7;
+        particle.fMass = particle.fMuon ? MuMass*1000. : PiPlMass*1000.;
+        particle.fMomentum = fRandom.Uniform(5000., 60000.);
+        particle.fTime = t0 + fRandom.Uniform(-fConfig.fTimeWindow, fConfig.fTimeWindow);
+        AddDownstream(particle);
+    }
+    int nCedar = fRandom.Poisson(fConfig.fCedarAccidentals);
+    for(int iKaon=0; iKaon<nCedar; iKaon++) AddCedar(t0 + fRandom.Uniform(-fConfig.fTimeWindow, fConfig.fTimeWindow));
+    AddNoise();
+}
+
+TLorentzVector RecoEventGenerator::TwoBodyDecay(const TLorentzVector& parent, double mass1, double mass2, TLorentzVector& daughter2){
+    /// \MemberDescr
+    /// \param parent : four-momentum of the decaying particle
+    /// \param mass1, mass2 : masses of the daughters
+    /// \param daughter2 : receives the four-momentum of the second daughter
+    /// \return four-momentum of the first daughter, isotropic decay in the parent rest frame
+    /// \EndMemberDescr
+    double mass = parent.M();
+    double momentum = sqrt((mass*mass - pow(mass1+mass2, 2))*(mass*mass - pow(mass1-mass2, 2)))/(2.*mass);
+    double cosTheta = fRandom.Uniform(-1., 1.);
+    double sinTheta = sqrt(1. - cosTheta*cosTheta);
+    double phi = fRandom.Uniform(0., 2.*M_PI);
+    TVector3 direction(sinTheta*cos(phi), sinTheta*sin(phi), cosTheta);
+    TLorentzVector daughter1;
+    daughter1.SetVectM(momentum*direction, mass1);
+    daughter2.SetVectM(-momentum*direction, mass2);
+    daughter1.Boost(parent.BoostVector());
+    daughter2.Boost(parent.BoostVector());
+    return daughter1;
+}
+
+bool RecoEventGenerator::AddSignal(double t0){
+    /// \MemberDescr
+    /// \param t0 : time of the charged track at the CHOD
+    /// \return false if no decay with the track in the STRAW acceptance was found (Cedar kaon only)
+    /// \EndMemberDescr
+    //Beam kaon from Trim5, as assumed by the vertex of the analyzers
+    double beamNorm = 1./sqrt(XAngle*XAngle + 1.);
+    TLorentzVector kaon;
+    kaon.SetXYZM(beamNorm*KEnergy*XAngle*1000., 0., beamNorm*KEnergy*1000., KMass*1000.);
+    TVector3 beamSlopes(XAngle, 0., 1.);
+    TVector3 trim5(0., 0., Ztrim*1000.);
+    AddCedar(t0 + fRandom.Gaus(0., 0.1));
+
+    for(int iTry=0; iTry<100; iTry++){
+        double zVertex = fRandom.Uniform(105000., 180000.);
+        TVector3 vertex = trim5 + (zVertex - trim5.Z())*beamSlopes;
+        TLorentzVector neutral;
+        TLorentzVector charged = fKpi2 ? TwoBodyDecay(kaon, PiPlMass*1000., kPi0Mass, neutral) : TwoBodyDecay(kaon, MuMass*1000., 0., neutral);
+        if(charged.Pz()<=0.) continue;
+
+        //STRAW acceptance before and after the magnet, kick in the horizontal plane
+        TVector3 slopesBefore(charged.Px()/charged.Pz(), charged.Py()/charged.Pz(), 1.);
+        TVector3 straw1 = vertex + (kZStraw1 - zVertex)*slopesBefore;
+        if(straw1.Perp()<75. || straw1.Perp()>1000.) continue;
+        TVector3 magnet = vertex + (kZMagnet - zVertex)*slopesBefore;
+        TVector3 slopesAfter((charged.Px() + kMagnetKick)/charged.Pz(), slopesBefore.Y(), 1.);
+        TVector3 straw4 = magnet + (kZStraw4 - kZMagnet)*slopesAfter;
+        if(straw4.Perp()<75. || straw4.Perp()>1000.) continue;
+
+        TRecoSpectrometerCandidate* track = (TRecoSpectrometerCandidate*)fSpectrometerEvent->AddCandidate();
+        double chi2 = 0.;
+        for(int iDof=0; iDof<5; iDof++) chi2 += pow(fRandom.Gaus(0., 1.), 2);
+        track->SetTime(t0 + fRandom.Gaus(0., 3.));
+        track->SetCharge(1);
+        track->SetMomentum(charged.P()*(1. + fRandom.Gaus(0., 0.005)));
+        track->SetMomentumBeforeFit(charged.P()*(1. + fRandom.Gaus(0., 0.02)));
+        track->SetChi2(chi2);
+        track->SetNChambers(fRandom.Rndm()<0.9 ? 4 : 3);
+        track->SetSlopeXBeforeMagnet(slopesBefore.X() + fRandom.Gaus(0., 2e-5));
+        track->SetSlopeYBeforeMagnet(slopesBefore.Y() + fRandom.Gaus(0., 2e-5));
+        track->SetPositionBeforeMagnet(straw1);
+        track->SetSlopeXAfterMagnet(slopesAfter.X() + fRandom.Gaus(0., 2e-5));
+        track->SetSlopeYAfterMagnet(slopesAfter.Y() + fRandom.Gaus(0., 2e-5));
+        track->SetPositionAfterMagnet(straw4);
+
+        Particle particle;
+        particle.fPosition = straw4;
+        particle.fSlopes = slopesAfter;
+        particle.fMomentum = charged.P();
+        particle.fMass = charged.M();
+        particle.fTime = t0;
+        particle.fMuon = !fKpi2;
+        AddDownstream(particle);
+
+        if(fKpi2){
+            //pi0 -> gamma gamma, photons reaching the LKr
+            TLorentzVector photon2;
+            TLorentzVector photon1 = TwoBodyDecay(neutral, 0., 0., photon2);
+            TLorentzVector* photons[2] = {&photon1, &photon2};
+            for(int iPhoton=0; iPhoton<2; iPhoton++){
+                const TLorentzVector& photon = *photons[iPhoton];
+                if(photon.Pz()<=0.) continue;
+                TVector3 lkr = vertex + (ZLKrStart*1000. - zVertex)/photon.Pz()*photon.Vect();
+                if(lkr.Perp()<150. || lkr.Perp()>1130.) continue;
+                AddLKr(lkr, photon.E()*0.001*fRandom.Gaus(1., 0.01), 20 + fRandom.Poisson(20.), t0 + kLKrOffset + fRandom.Gaus(0., 0.5));
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+TVector3 RecoEventGenerator::Extrapolate(const Particle& particle, double z) const{
+    return particle.fPosition + (z - particle.fPosition.Z())*particle.fSlopes;
+}
+
+void RecoEventGenerator::AddDownstream(const Particle& particle){
+    /// \MemberDescr
+    /// \param particle : charged particle after the magnet, adds the candidates and hits of the downstream detectors
+    /// \EndMemberDescr
+    TVector3 chod = Extrapolate(particle, ZCHODStart*1000.);
+    if(chod.Perp()>120. && chod.Perp()<1210.) AddCHOD(chod, particle.fTime + fRandom.Gaus(0., 0.3));
+    AddRICH(particle);
+
+    TVector3 lkr = Extrapolate(particle, ZLKrStart*1000.);
+    double lkrTime = particle.fTime + kLKrOffset + fRandom.Gaus(0., 0.5);
+    bool inLKr = lkr.Perp()>150. && lkr.Perp()<1130.;
+    if(inLKr && particle.fMuon) AddLKr(lkr, fabs(fRandom.Gaus(0.55, 0.12)), 1 + fRandom.Poisson(1.), lkrTime);
+    if(inLKr && !particle.fMuon) AddLKr(lkr, particle.fMomentum*0.001*fRandom.Uniform(0.2, 0.9), 8 + fRandom.Poisson(12.), lkrTime);
+
+    //Muons cross all the MUVs, the pion showers start in LKr or MUV1 and rarely punch through
+    TVector3 muv1 = Extrapolate(particle, ZMUV1Start*1000.);
+    TVector3 muv2 = Extrapolate(particle, ZMUV2Start*1000.);
+    TVector3 muv3 = Extrapolate(particle, ZMUV3Start*1000.);
+    bool shower = !particle.fMuon;
+    if(fabs(muv1.X())<kMUVHalfSize && fabs(muv1.Y())<kMUVHalfSize && (particle.fMuon || fRandom.Rndm()<0.8)){
+        AddMUV1(muv1, shower ? particle.fMomentum*0.001*fRandom.Uniform(0.1, 0.6) : 0.3, particle.fTime + fRandom.Gaus(0., 1.), shower);
+    }
+    if(fabs(muv2.X())<kMUVHalfSize && fabs(muv2.Y())<kMUVHalfSize && (particle.fMuon || fRandom.Rndm()<0.5)){
+        AddMUV2(muv2, shower ? particle.fMomentum*0.001*fRandom.Uniform(0.05, 0.3) : 0.25, particle.fTime + fRandom.Gaus(0., 1.), shower);
+    }
+    if(fabs(muv3.X())<kMUVHalfSize && fabs(muv3.Y())<kMUVHalfSize && muv3.Perp()>103. && (particle.fMuon || fRandom.Rndm()<0.01)){
+        AddMUV3(muv3, particle.fTime + fRandom.Gaus(0., 0.5));
+    }
+}
+
+void RecoEventGenerator::AddCHOD(const TVector3& position, double time){
+    //Slab resolution, position in cm as in the reco
+    TRecoCHODCandidate* candidate = (TRecoCHODCandidate*)fCHODEvent->AddCandidate();
+    candidate->SetHitPosition(TVector2(0.1*position.X() + fRandom.Uniform(-3.25, 3.25), 0.1*position.Y() + fRandom.Uniform(-3.25, 3.25)));
+    candidate->SetTime(time);
+}
+
+void RecoEventGenerator::AddRICH(const Particle& particle){
+    //Ring of the Cherenkov angle, centred on the focal image of the track direction
+    double beta = particle.fMomentum/sqrt(particle.fMomentum*particle.fMomentum + particle.fMass*particle.fMass);
+    double cosAngle = 1./(kRICHIndex*beta);
+    if(cosAngle>=1.) return;
+    TVector3 rich = Extrapolate(particle, ZRICHStart*1000.);
+    if(rich.Perp()<100. || rich.Perp()>1100.) return;
+    TRecoRICHCandidate* ring = fRICHEvent->AddRingCandidate();
+    ring->SetRingRadius(kRICHFocal*tan(acos(cosAngle)) + fRandom.Gaus(0., 1.5));
+    ring->SetRingCenter(TVector2(kRICHFocal*particle.fSlopes.X() + fRandom.Gaus(0., 1.5), kRICHFocal*particle.fSlopes.Y() + fRandom.Gaus(0., 1.5)));
+    ring->SetRingTime(particle.fTime + fRandom.Gaus(0., 0.2));
+}
+
+void RecoEventGenerator::AddLKr(const TVector3& position, double energy, int nCells, double time){
+    /// \MemberDescr
+    /// \param position : impact point [mm]
+    /// \param energy : cluster energy before the corrections of the analyzers [GeV]
+    /// \param nCells : number of cells of the cluster
+    /// \param time : cluster time [ns]
+    /// \EndMemberDescr
+    TRecoLKrCandidate* cluster = (TRecoLKrCandidate*)fLKrEvent->AddCandidate();
+    cluster->SetClusterX(0.1*position.X() + fRandom.Gaus(0., 0.1));
+    cluster->SetClusterY(0.1*position.Y() + fRandom.Gaus(0., 0.1));
+    cluster->SetClusterEnergy(energy);
+    cluster->SetClusterSeedEnergy(energy*(nCells>5 ? 0.3 : 0.8));
+    cluster->SetCluster77Energy(energy*0.97);
+    cluster->SetNCells(nCells);
+    cluster->SetClusterTime(time);
+    cluster->SetTime(time);
+}
+
+double RecoEventGenerator::MIPCharge(){
+    //Landau-like tail of the scintillator signal [pC]
+    return 5.*(1. + 0.2*fabs(fRandom.Gaus(0., 1.)) + 0.3*fRandom.Exp(1.));
+}
+
+/// Cluster and strip hits of MUV1 or MUV2: side*100 + plane*50 + strip, both readout ends
+template<class HitClass, class CandidateClass>
+static void AddMUVCluster(TRecoVEvent* event, TRandom3& random, int nStrips, double stripWidth, const TVector3& position,
+                          double energy, double time, bool shower, double mipCharge){
+    int vertical   = (int)((position.X() + nStrips*stripWidth/2.)/stripWidth) + 1;
+    int horizontal = (int)((position.Y() + nStrips*stripWidth/2.)/stripWidth) + 1;
+    CandidateClass* cluster = (CandidateClass*)event->AddCandidate();
+    int halfWidth = shower ? 2 : 0;
+    for(int plane=0; plane<2; plane++){
+        int centre = plane==0 ? vertical : horizontal;
+        for(int strip=centre-halfWidth; strip<=centre+halfWidth; strip++){
+            if(strip<1 || strip>nStrips) continue;
+            double charge = mipCharge*(shower ? energy*10.*exp(-fabs(strip-centre)) : 1.);
+            for(int side=1; side<=2; side++){
+                HitClass* hit = (HitClass*)event->AddHit();
+                hit->SetChannelID(side*100 + plane*50 + strip);
+                hit->SetTime(time + random.Gaus(0., 1.5));
+                hit->SetCharge(charge*random.Gaus(1., 0.1));
+                cluster->AddHit(event->GetNHits()-1);
+            }
+        }
+    }
+    cluster->SetPosition(TVector2(position.X() + random.Gaus(0., stripWidth/4.), position.Y() + random.Gaus(0., stripWidth/4.)));
+    cluster->SetTime(time);
+    cluster->SetEnergy(energy);
+    cluster->SetSeedEnergy(energy*(shower ? 0.4 : 0.9));
+    cluster->SetSeedEnergyHorizontal(energy*(shower ? 0.2 : 0.45));
+    cluster->SetSeedEnergyVertical(energy*(shower ? 0.2 : 0.45));
+    cluster->SetShowerWidth(shower ? random.Gaus(60., 15.) : fabs(random.Gaus(15., 5.)));
+    cluster->SetQuality(shower ? 2 : (random.Rndm()<0.8 ? 0 : 1));
+    cluster->SetVerticalChannel(vertical);
+    cluster->SetHorizontalChannel(horizontal);
+}
+
+void RecoEventGenerator::AddMUV1(const TVector3& position, double energy, double time, bool shower){
+    AddMUVCluster<TRecoMUV1Hit, TRecoMUV1Candidate>(fMUV1Event, fRandom, 44, 2.*kMUVHalfSize/44, position, energy, time, shower, MIPCharge());
+}
+
+void RecoEventGenerator::AddMUV2(const TVector3& position, double energy, double time, bool shower){
+    AddMUVCluster<TRecoMUV2Hit, TRecoMUV2Candidate>(fMUV2Event, fRandom, 22, 2.*kMUVHalfSize/22, position, energy, time, shower, MIPCharge());
+}
+
+void RecoEventGenerator::AddMUV3(const TVector3& position, double time){
+    //Tile of the 12x12 grid, position of its centre as in the reco
+    int column = (int)((position.X() + kMUVHalfSize)/kMUV3TileSize);
+    int row    = (int)((position.Y() + kMUVHalfSize)/kMUV3TileSize);
+    TRecoMUV3Candidate* candidate = (TRecoMUV3Candidate*)fMUV3Event->AddCandidate();
+    candidate->SetTileID(row*12 + column);
+    candidate->SetX((column + 0.5)*kMUV3TileSize - kMUVHalfSize);
+    candidate->SetY((row + 0.5)*kMUV3TileSize - kMUVHalfSize);
+    candidate->SetTime(time);
+}
+
+void RecoEventGenerator::AddCedar(double time){
+    TRecoCedarCandidate* candidate = (TRecoCedarCandidate*)fCedarEvent->AddCandidate();
+    candidate->SetNSectors(fRandom.Rndm()<0.95 ? 5 + fRandom.Integer(4) : 3 + fRandom.Integer(2));
+    candidate->SetTime(time);
+}
+
+void RecoEventGenerator::AddNoise(){
+    //Single noise hits of random MUV1/MUV2 strip ends, uniform in the accidental window
+    TRecoVEvent* events[2] = {fMUV1Event, fMUV2Event};
+    int nStrips[2] = {44, 22};
+    for(int iDetector=0; iDetector<2; iDetector++){
+        int nHits = fRandom.Poisson(fConfig.fNoiseHits);
+        for(int iHit=0; iHit<nHits; iHit++){
+            int channelID = (1 + fRandom.Integer(2))*100 + fRandom.Integer(2)*50 + 1 + fRandom.Integer(nStrips[iDetector]);
+            double time = fRandom.Uniform(-fConfig.fTimeWindow, fConfig.fTimeWindow);
+            double charge = fRandom.Exp(1.5);
+            if(iDetector==0){
+                TRecoMUV1Hit* hit = (TRecoMUV1Hit*)events[iDetector]->AddHit();
+                hit->SetChannelID(channelID);
+                hit->SetTime(time);
+                hit->SetCharge(charge);
+            }
+            else{
+                TRecoMUV2Hit* hit = (TRecoMUV2Hit*)events[iDetector]->AddHit();
+                hit->SetChannelID(channelID);
+                hit->SetTime(time);
+                hit->SetCharge(charge);
+            }
+        }
+    }
+}
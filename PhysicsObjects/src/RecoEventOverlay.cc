@@ -0,0 +1,210 @@
+#include <iostream>
+#include <vector>
+#include <TClonesArray.h>
+#include <TObjArray.h>
+#include <TObjString.h>
+#include <TTree.h>
+#include "RecoEventOverlay.hh"
+#include "Persistency.hh"
+
+using namespace std;
+
+RecoEventOverlay::RecoEventOverlay(unsigned int seed) :
+    fTimeWindow(50.),
+    fRandom(seed),
+    fDonors(0)
+{
+    /// \MemberDescr
+    /// \param seed : seed of the random generator (donor entries and time shifts)
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        fEnabled[iDetector] = iDetector!=kSpectrometer;
+        fInTarget[iDetector] = false;
+        fInDonors[iDetector] = false;
+    }
+    CreateEvents(fTarget);
+    CreateEvents(fDonor);
+}
+
+RecoEventOverlay::~RecoEventOverlay(){
+    DeleteEvents(fTarget);
+    DeleteEvents(fDonor);
+}
+
+const char* RecoEventOverlay::GetDetectorName(int detector){
+    static const char* names[kNDetectors] = {"Spectrometer", "CHOD", "LKr", "MUV1", "MUV2", "MUV3", "Cedar", "RICH"};
+    return names[detector];
+}
+
+void RecoEventOverlay::CreateEvents(Events& events){
+    events.fSpectrometer = new TRecoSpectrometerEvent;
+    events.fCHOD = new TRecoCHODEvent;
+    events.fLKr = new TRecoLKrEvent;
+    events.fMUV1 = new TRecoMUV1Event;
+    events.fMUV2 = new TRecoMUV2Event;
+    events.fMUV3 = new TRecoMUV3Event;
+    events.fCedar = new TRecoCedarEvent;
+    events.fRICH = new TRecoRICHEvent;
+}
+
+void RecoEventOverlay::DeleteEvents(Events& events){
+    delete events.fSpectrometer;
+    delete events.fCHOD;
+    delete events.fLKr;
+    delete events.fMUV1;
+    delete events.fMUV2;
+    delete events.fMUV3;
+    delete events.fCedar;
+    delete events.fRICH;
+}
+
+bool RecoEventOverlay::SetDetectors(TString detectors){
+    /// \MemberDescr
+    /// \param detectors : comma separated names of the detectors to overlay, e.g. "CHOD,LKr,MUV1"
+    /// \return false if a name is unknown, the selection is then unchanged
+    /// \EndMemberDescr
+    bool enabled[kNDetectors] = {false};
+    TObjArray* names = detectors.Tokenize(",");
+    bool valid = true;
+    for(int iName=0; iName<names->GetEntries(); iName++){
+        TString name = ((TObjString*)names->At(iName))->GetString().Strip(TString::kBoth);
+        int detector = 0;
+        while(detector<kNDetectors && name!=GetDetectorName(detector)) detector++;
+        if(detector==kNDetectors){
+            cerr << "RecoEventOverlay: unknown detector " << name << endl;
+            valid = false;
+        }
+        else enabled[detector] = true;
+    }
+    delete names;
+    if(!valid) return false;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++) fEnabled[iDetector] = enabled[iDetector];
+    return true;
+}
+
+void RecoEventOverlay::SetAddresses(TTree* tree, Events& events, bool* present){
+    TString names[kNDetectors];
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        names[iDetector] = GetDetectorName(iDetector);
+        present[iDetector] = fEnabled[iDetector] && tree->GetBranch(names[iDetector]);
+        if(fEnabled[iDetector] && !present[iDetector]) cerr << "RecoEventOverlay: no " << names[iDetector] << " branch in " << tree->GetName() << ", not overlaid" << endl;
+    }
+    if(present[kSpectrometer]) tree->SetBranchAddress(names[kSpectrometer], &events.fSpectrometer);
+    if(present[kCHOD]) tree->SetBranchAddress(names[kCHOD], &events.fCHOD);
+    if(present[kLKr]) tree->SetBranchAddress(names[kLKr], &events.fLKr);
+    if(present[kMUV1]) tree->SetBranchAddress(names[kMUV1], &events.fMUV1);
+    if(present[kMUV2]) tree->SetBranchAddress(names[kMUV2], &events.fMUV2);
+    if(present[kMUV3]) tree->SetBranchAddress(names[kMUV3], &events.fMUV3);
+    if(present[kCedar]) tree->SetBranchAddress(names[kCedar], &events.fCedar);
+    if(present[kRICH]) tree->SetBranchAddress(names[kRICH], &events.fRICH);
+}
+
+void RecoEventOverlay::SetTarget(TTree* tree){
+    /// \MemberDescr
+    /// \param tree : tree of the events receiving the overlay, call before CloneTree()
+    /// so that the clone points to the same events
+    /// \EndMemberDescr
+    SetAddresses(tree, fTarget, fInTarget);
+}
+
+void RecoEventOverlay::SetDonors(TTree* tree){
+    /// \MemberDescr
+    /// \param tree : tree or chain of the events to overlay, only the overlaid branches are read
+    /// \EndMemberDescr
+    fDonors = tree;
+    fDonors->SetBranchStatus("*", 0);
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++){
+        if(fEnabled[iDetector]) fDonors->SetBranchStatus(TString(GetDetectorName(iDetector)) + "*", 1);
+    }
+    SetAddresses(fDonors, fDonor, fInDonors);
+}
+
+int RecoEventOverlay::Overlay(int nDonors, Long64_t exclude){
+    /// \MemberDescr
+    /// \param nDonors : number of random donor entries to overlay on the current target event
+    /// \param exclude : donor entry not to use, the target entry itself when the donors are the same files
+    /// \return number of donor events overlaid
+    /// \EndMemberDescr
+    if(!fDonors) return 0;
+    Long64_t nEntries = fDonors->GetEntries();
+    if(nEntries==0 || (nEntries==1 && exclude==0)) return 0;
+    for(int iDonor=0; iDonor<nDonors; iDonor++){
+        Long64_t entry;
+        do entry = (Long64_t)(fRandom.Rndm()*nEntries);
+        while(entry==exclude || entry>=nEntries);
+        fDonors->GetEntry(entry);
+        Merge(fRandom.Uniform(-fTimeWindow, fTimeWindow));
+    }
+    return nDonors;
+}
+
+static void ShiftTime(TRecoVCandidate* candidate, double shift){
+    candidate->SetTime(candidate->GetTime() + shift);
+}
+
+static void ShiftTime(TRecoLKrCandidate* candidate, double shift){
+    candidate->SetTime(candidate->GetTime() + shift);
+    candidate->SetClusterTime(candidate->GetClusterTime() + shift);
+}
+
+static void ShiftTime(TRecoRICHCandidate* candidate, double shift){
+    candidate->SetTime(candidate->GetTime() + shift);
+    candidate->SetRingTime(candidate->GetRingTime() + shift);
+}
+
+/// Points a copied candidate to the target event and to its hits, appended after hitOffset
+static void Relink(TRecoVCandidate* candidate, TRecoVEvent* event, int hitOffset){
+    candidate->SetEvent(event);
+    int nHits = candidate->GetNHits();
+    vector<int> indexes(candidate->GetHitsIndexes(), candidate->GetHitsIndexes() + nHits);
+    candidate->SetNHits(0);
+    for(int iHit=0; iHit<nHits; iHit++) candidate->AddHit(indexes[iHit] + hitOffset);
+}
+
+/// Appends the hits of the donor and returns the number of target hits before them
+template<class HitClass>
+static int MergeHits(TRecoVEvent* target, TRecoVEvent* donor, double shift){
+    int hitOffset = target->GetNHits();
+    TClonesArray* hits = donor->GetHits();
+    for(int iHit=0; iHit<donor->GetNHits(); iHit++){
+        HitClass* hit = (HitClass*)target->AddHit();
+        *hit = *(HitClass*)hits->At(iHit);
+        hit->SetTime(hit->GetTime() + shift);
+    }
+    return hitOffset;
+}
+
+template<class CandidateClass, class HitClass>
+static void MergeEvent(TRecoVEvent* target, TRecoVEvent* donor, double shift){
+    int hitOffset = MergeHits<HitClass>(target, donor, shift);
+    int nCandidates = donor->GetNCandidates();
+    for(int iCandidate=0; iCandidate<nCandidates; iCandidate++){
+        CandidateClass* candidate = (CandidateClass*)target->AddCandidate();
+        *candidate = *(CandidateClass*)donor->GetCandidate(iCandidate);
+        ShiftTime(candidate, shift);
+        Relink(candidate, target, hitOffset);
+    }
+}
+
+void RecoEventOverlay::Merge(double shift){
+    /// \MemberDescr
+    /// \param shift : time added to all the candidates and hits of the donor event [ns]
+    /// \EndMemberDescr
+    if(fInTarget[kSpectrometer] && fInDonors[kSpectrometer]) MergeEvent<TRecoSpectrometerCandidate, TRecoSpectrometerHit>(fTarget.fSpectrometer, fDonor.fSpectrometer, shift);
+    if(fInTarget[kCHOD] && fInDonors[kCHOD]) MergeEvent<TRecoCHODCandidate, TRecoCHODHit>(fTarget.fCHOD, fDonor.fCHOD, shift);
+    if(fInTarget[kLKr] && fInDonors[kLKr]) MergeEvent<TRecoLKrCandidate, TRecoLKrHit>(fTarget.fLKr, fDonor.fLKr, shift);
+    if(fInTarget[kMUV1] && fInDonors[kMUV1]) MergeEvent<TRecoMUV1Candidate, TRecoMUV1Hit>(fTarget.fMUV1, fDonor.fMUV1, shift);
+    if(fInTarget[kMUV2] && fInDonors[kMUV2]) MergeEvent<TRecoMUV2Candidate, TRecoMUV2Hit>(fTarget.fMUV2, fDonor.fMUV2, shift);
+    if(fInTarget[kMUV3] && fInDonors[kMUV3]) MergeEvent<TRecoMUV3Candidate, TRecoMUV3Hit>(fTarget.fMUV3, fDonor.fMUV3, shift);
+    if(fInTarget[kCedar] && fInDonors[kCedar]) MergeEvent<TRecoCedarCandidate, TRecoCedarHit>(fTarget.fCedar, fDonor.fCedar, shift);
+    if(fInTarget[kRICH] && fInDonors[kRICH]){
+        //Ring candidates have their own accessors in the RICH event
+        int hitOffset = MergeHits<TRecoRICHHit>(fTarget.fRICH, fDonor.fRICH, shift);
+        for(int iRing=0; iRing<fDonor.fRICH->GetNRingCandidates(); iRing++){
+            TRecoRICHCandidate* ring = fTarget.fRICH->AddRingCandidate();
+            *ring = *fDonor.fRICH->GetRingCandidate(iRing);
+            ShiftTime(ring, shift);
+            Relink(ring, fTarget.fRICH, hitOffset);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include <iomanip>
+#include <iostream>
+#include "SelectionMask.hh"
+
+using namespace std;
+
+SelectionMask::SelectionMask(TString name) :
+    fName(name),
+    fBits(0),
+    fPassed(0)
+{
+    /// \MemberDescr
+    /// \param name : name of the set of selections, used in the printout
+    /// \EndMemberDescr
+}
+
+void SelectionMask::AddBit(int bit, TString name){
+    /// \MemberDescr
+    /// \param bit : index of the bit (usually an enum value of the analyzer, 0 to 63)
+    /// \param name : name of the bit, used in the printout of the selections
+    /// \EndMemberDescr
+    if(bit<0 || bit>=64){
+        cerr << "SelectionMask " << fName << ": bit " << bit << " (" << name << ") out of range" << endl;
+        return;
+    }
+    if(bit>=(int)fBitNames.size()) fBitNames.resize(bit+1);
+    fBitNames[bit] = name;
+}
+
+void SelectionMask::AddSelection(int selection, TString name, Mask required, Mask vetoed){
+    /// \MemberDescr
+    /// \param selection : index of the selection (usually an enum value of the analyzer, 0 to 63)
+    /// \param name : name of the selection
+    /// \param required : bits which must all be set, e.g. Bit(kBitMUV2) | Bit(kBitMUV3)
+    /// \param vetoed : bits which must all be cleared
+    /// \EndMemberDescr
+    if(selection<0 || selection>=64){
+        cerr << "SelectionMask " << fName << ": selection " << selection << " (" << name << ") out of range" << endl;
+        return;
+    }
+    if(selection>=(int)fSelections.size()){
+        //Gaps in the indices never pass
+        Selection empty = {"", 0, ~0ULL};
+        fSelections.resize(selection+1, empty);
+        fCounts.resize(selection+1, 0);
+    }
+    fSelections[selection].fName = name;
+    fSelections[selection].fRequired = required;
+    fSelections[selection].fVetoed = vetoed;
+}
+
+void SelectionMask::Print(ostream& out) const{
+    out << endl << "Selections " << fName << ":" << endl;
+    out << setw(20) << left << "Selection" << right << setw(12) << "Events" << "  Definition" << endl;
+    for(size_t iSel=0; iSel<fSelections.size(); iSel++){
+        const Selection& selection = fSelections[iSel];
+        if(selection.fName.Length()==0) continue;
+        TString definition;
+        for(size_t iBit=0; iBit<fBitNames.size(); iBit++){
+            if(selection.fRequired & Bit(iBit)) definition += " " + fBitNames[iBit];
+            if(selection.fVetoed & Bit(iBit)) definition += " !" + fBitNames[iBit];
+        }
+        out << setw(20) << left << selection.fName << right << setw(12) << fCounts[iSel] << " " << definition << endl;
+    }
+}
@@ -0,0 +1,98 @@
+#include <iomanip>
+#include "SharedEvent.hh"
+#include "AnalysisKernels.hh"
+#include "Persistency.hh"
+
+using namespace std;
+
+SharedEvent& SharedEvent::Instance(){
+    static SharedEvent shared;
+    return shared;
+}
+
+SharedEvent::SharedEvent() :
+    fLKrCorrected(false),
+    fNEvents(0),
+    fNLookups(0),
+    fNShared(0)
+{
+}
+
+int SharedEvent::AddAnalyzer(TString name){
+    /// \MemberDescr
+    /// \param name : name of the analyzer in the report
+    /// \return index of the analyzer, to pass to BeginEvent() and Report()
+    /// \EndMemberDescr
+    fAnalyzers.push_back(name);
+    fSeen.push_back(0);
+    return fAnalyzers.size()-1;
+}
+
+void SharedEvent::BeginEvent(int analyzer){
+    /// \MemberDescr
+    /// \param analyzer : index returned by AddAnalyzer()
+    ///
+    /// Forgets the results of the previous event if this analyzer has already started it
+    /// \EndMemberDescr
+    if(fSeen[analyzer] || fNEvents==0){
+        fSeen.assign(fSeen.size(), 0);
+        fAssociations.clear();
+        fLKrCorrected = false;
+        fNEvents++;
+    }
+    fSeen[analyzer] = 1;
+}
+
+int SharedEvent::FindClosestCluster(TRecoVEvent* event, const TVector3& extrapolation, int detector, double& minimum){
+    /// \MemberDescr
+    /// \param event : reco event of the detector
+    /// \param extrapolation : track at the detector plane [mm]
+    /// \param detector : AnalysisKernels::Detector of the event
+    /// \param minimum : receives the distance to the closest candidate [mm], unchanged if there is none
+    /// \return index of the closest candidate, -1 if there is none (see AnalysisKernels::FindClosestCluster())
+    /// \EndMemberDescr
+    fNLookups++;
+    for(size_t iAssociation=0; iAssociation<fAssociations.size(); iAssociation++){
+        const Association& association = fAssociations[iAssociation];
+        if(association.fEvent!=event || association.fDetector!=detector ||
+           association.fX!=extrapolation.X() || association.fY!=extrapolation.Y()) continue;
+        fNShared++;
+        if(association.fPosition>=0) minimum = association.fMinimum;
+        return association.fPosition;
+    }
+    Association association = {event, detector, extrapolation.X(), extrapolation.Y(), -1, 0.};
+    association.fPosition = AnalysisKernels::FindClosestCluster(event, extrapolation, detector, association.fMinimum);
+    fAssociations.push_back(association);
+    if(association.fPosition>=0) minimum = association.fMinimum;
+    return association.fPosition;
+}
+
+void SharedEvent::CorrectLKrEnergies(TRecoLKrEvent* event){
+    /// \MemberDescr
+    /// \param event : LKr reco event, the energies of its candidates are corrected in place
+    ///
+    /// ZS non-linearity and energy scale (AnalysisKernels::LKrCorrectedEnergy()), once per event
+    /// \EndMemberDescr
+    if(fLKrCorrected) return;
+    fLKrCorrected = true;
+    for(int iLKrCand=0; iLKrCand<event->GetNCandidates(); iLKrCand++){
+        TRecoLKrCandidate* LKrCluster = ((TRecoLKrCandidate*)event->GetCandidate(iLKrCand));
+        LKrCluster->SetClusterEnergy(AnalysisKernels::LKrCorrectedEnergy(LKrCluster->GetClusterEnergy(), LKrCluster->GetNCells()));
+    }
+}
+
+void SharedEvent::Report(int analyzer, ostream& out) const{
+    /// \MemberDescr
+    /// \param analyzer : index returned by AddAnalyzer(), only the first analyzer prints
+    /// \param out : receives the report, nothing if a single analyzer is registered
+    /// \EndMemberDescr
+    if(analyzer!=0 || fAnalyzers.size()<2) return;
+    out << endl << "Shared per event results (";
+    for(size_t iAnalyzer=0; iAnalyzer<fAnalyzers.size(); iAnalyzer++) out << (iAnalyzer ? ", " : "") << fAnalyzers[iAnalyzer];
+    out << "): " << fNEvents << " events" << endl;
+    out << "  cluster associations: " << fNLookups << " lookups, " << fNShared << " shared";
+    if(fNLookups>0) out << " (" << fixed << setprecision(1) << 100.*fNShared/fNLookups << "%)";
+    out << endl;
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
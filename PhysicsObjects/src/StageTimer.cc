@@ -0,0 +1,168 @@
+#include <cmath>
+#include <iomanip>
+#include <TH1D.h>
+#include "StageTimer.hh"
+
+using namespace std;
+
+StageTimer::StageTimer(TString name) :
+    fName(name),
+    fEnabled(false),
+    fEventStart(0),
+    fP50Histo(0),
+    fP99Histo(0),
+    fShareHisto(0)
+{
+    /// \MemberDescr
+    /// \param name : name of the analyzer, used as prefix of the histograms
+    /// \EndMemberDescr
+    fTotal.fName = "Total";
+    fTotal.fParent = -1;
+    fTotal.fNEvents = 0;
+    fTotal.fTicks = 0;
+    fTotal.fEventTicks = 0;
+    fTotal.fReached = false;
+    fTotal.fBins.assign(kNBins, 0);
+    fTotal.fHisto = 0;
+}
+
+void StageTimer::AddStage(int stage, TString name, int parent){
+    /// \MemberDescr
+    /// \param stage : index of the stage (usually an enum value of the analyzer, starting at 0)
+    /// \param name : name of the stage, used in the histogram names and in the table
+    /// \param parent : stage including this one, -1 if none
+    /// \EndMemberDescr
+    if(stage>=(int)fStages.size()){
+        Stage empty = {"", -1, 0, 0, 0, false, vector<Long64_t>(kNBins, 0), 0};
+        fStages.resize(stage+1, empty);
+    }
+    fStages[stage].fName = name;
+    fStages[stage].fParent = parent;
+}
+
+void StageTimer::BookHistos(vector<TH1D*>& histos){
+    /// \MemberDescr
+    /// \param histos : receives the histograms to book (call after all AddStage())
+    ///
+    /// <name>_StageTime_<stage>: time of the stage per event reaching it, log10(t/ns)\n
+    /// <name>_StageP50, <name>_StageP99: median and 99th percentile of each stage [us]\n
+    /// <name>_StageShare: time of each stage over the total time of the events [%]
+    /// \EndMemberDescr
+    int nStages = fStages.size();
+    for(int iStage=0; iStage<nStages; iStage++){
+        Stage& stage = fStages[iStage];
+        stage.fHisto = new TH1D(fName + "_StageTime_" + stage.fName, fName + " " + stage.fName + " time per event;log_{10}(t/ns);Events",
+                                kNBins, 0, (double)kNBins/kBinsPerDecade);
+        histos.push_back(stage.fHisto);
+    }
+    fTotal.fHisto = new TH1D(fName + "_StageTime_Total", fName + " Process time per event;log_{10}(t/ns);Events", kNBins, 0, (double)kNBins/kBinsPerDecade);
+    histos.push_back(fTotal.fHisto);
+
+    fP50Histo = new TH1D(fName + "_StageP50", fName + " median time per stage;;Time [#mus]", nStages+1, 0, nStages+1);
+    fP99Histo = new TH1D(fName + "_StageP99", fName + " 99th percentile of the time per stage;;Time [#mus]", nStages+1, 0, nStages+1);
+    fShareHisto = new TH1D(fName + "_StageShare", fName + " share of the Process time per stage;;Time [%]", nStages, 0, nStages);
+    for(int iStage=0; iStage<nStages; iStage++){
+        fP50Histo->GetXaxis()->SetBinLabel(iStage+1, fStages[iStage].fName);
+        fP99Histo->GetXaxis()->SetBinLabel(iStage+1, fStages[iStage].fName);
+        fShareHisto->GetXaxis()->SetBinLabel(iStage+1, fStages[iStage].fName);
+    }
+    fP50Histo->GetXaxis()->SetBinLabel(nStages+1, fTotal.fName);
+    fP99Histo->GetXaxis()->SetBinLabel(nStages+1, fTotal.fName);
+    histos.push_back(fP50Histo);
+    histos.push_back(fP99Histo);
+    histos.push_back(fShareHisto);
+}
+
+void StageTimer::AddTime(Stage& stage, CycleClock::Ticks ticks){
+    double ns = CycleClock::ToNs(ticks);
+    int bin = ns>1. ? (int)(log10(ns)*kBinsPerDecade) : 0;
+    if(bin>=kNBins) bin = kNBins-1;
+    stage.fBins[bin]++;
+    stage.fTicks += ticks;
+    stage.fNEvents++;
+}
+
+void StageTimer::AddEvent(CycleClock::Ticks now){
+    /// \MemberDescr
+    /// Adds the time of the stages reached since StartEvent() to their distributions
+    /// \EndMemberDescr
+    for(size_t iStage=0; iStage<fStages.size(); iStage++){
+        Stage& stage = fStages[iStage];
+        if(!stage.fReached) continue;
+        AddTime(stage, stage.fEventTicks);
+        stage.fEventTicks = 0;
+        stage.fReached = false;
+    }
+    AddTime(fTotal, now - fEventStart);
+    fEventStart = 0;
+}
+
+double StageTimer::Percentile(const Stage& stage, double fraction){
+    /// \MemberDescr
+    /// \param stage : stage or total
+    /// \param fraction : fraction of the events below the returned time (0.5 for the median)
+    /// \return time [ns], interpolated in the log10 bin containing the percentile
+    /// \EndMemberDescr
+    if(stage.fNEvents==0) return 0.;
+    double target = fraction*stage.fNEvents;
+    double below = 0.;
+    for(int iBin=0; iBin<kNBins; iBin++){
+        if(stage.fBins[iBin]==0 || below + stage.fBins[iBin] < target){
+            below += stage.fBins[iBin];
+            continue;
+        }
+        double position = (iBin + (target - below)/stage.fBins[iBin])/kBinsPerDecade;
+        return pow(10., position);
+    }
+    return pow(10., (double)kNBins/kBinsPerDecade);
+}
+
+double StageTimer::GetPercentile(int stage, double fraction) const{
+    return Percentile(fStages[stage], fraction);
+}
+
+double StageTimer::GetShare(int stage) const{
+    /// \MemberDescr
+    /// \return time of the stage over the total time of the events [%]
+    /// \EndMemberDescr
+    return fTotal.fTicks>0 ? 100.*fStages[stage].fTicks/fTotal.fTicks : 0.;
+}
+
+int StageTimer::GetDepth(int stage) const{
+    int depth = 0;
+    for(int parent=fStages[stage].fParent; parent>=0 && depth<(int)fStages.size(); parent=fStages[parent].fParent) depth++;
+    return depth;
+}
+
+void StageTimer::Fill() const{
+    /// \MemberDescr
+    /// Sets the content of the histograms from the counters
+    /// \EndMemberDescr
+    if(!fP50Histo || !fP99Histo || !fShareHisto) return;
+    int nStages = fStages.size();
+    for(int iStage=0; iStage<=nStages; iStage++){
+        const Stage& stage = iStage<nStages ? fStages[iStage] : fTotal;
+        for(int iBin=0; iBin<kNBins; iBin++) stage.fHisto->SetBinContent(iBin+1, stage.fBins[iBin]);
+        fP50Histo->SetBinContent(iStage+1, Percentile(stage, 0.5)*1e-3);
+        fP99Histo->SetBinContent(iStage+1, Percentile(stage, 0.99)*1e-3);
+        if(iStage<nStages) fShareHisto->SetBinContent(iStage+1, GetShare(iStage));
+    }
+}
+
+void StageTimer::Print(ostream& out) const{
+    out << endl << "Stage timing " << fName << ": " << fTotal.fNEvents << " events, "
+        << fixed << setprecision(1) << CycleClock::ToNs(fTotal.fTicks)*1e-6 << " ms in Process" << endl;
+    out << setw(28) << left << "Stage" << right << setw(12) << "Events" << setw(12) << "ns/event"
+        << setw(12) << "p50[ns]" << setw(12) << "p99[ns]" << setw(10) << "Time[%]" << endl;
+    int nStages = fStages.size();
+    for(int iStage=0; iStage<=nStages; iStage++){
+        const Stage& stage = iStage<nStages ? fStages[iStage] : fTotal;
+        TString name = iStage<nStages ? TString(' ', 2*GetDepth(iStage)) + stage.fName : stage.fName;
+        double nsPerEvent = stage.fNEvents>0 ? CycleClock::ToNs(stage.fTicks)/stage.fNEvents : 0.;
+        double share = fTotal.fTicks>0 ? 100.*stage.fTicks/fTotal.fTicks : 0.;
+        out << setw(28) << left << name << right << setw(12) << stage.fNEvents << setw(12) << nsPerEvent
+            << setw(12) << Percentile(stage, 0.5) << setw(12) << Percentile(stage, 0.99) << setw(10) << share << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
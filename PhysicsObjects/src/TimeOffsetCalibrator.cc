@@ -0,0 +1,73 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include "TimeOffsetCalibrator.hh"
+
+using namespace std;
+
+TimeOffsetCalibrator::TimeOffsetCalibrator(int nBins, double min, double max, double window) :
+    fNBins(nBins),
+    fMin(min),
+    fMax(max),
+    fInvBinWidth(nBins/(max-min)),
+    fPeakFinder(window),
+    fCounts(TimeOffsetTable::kNDetectors*nBins, 0),
+    fRunCounts(TimeOffsetTable::kNDetectors*nBins, 0)
+{
+    /// \MemberDescr
+    /// \param nBins : number of bins of each time difference distribution
+    /// \param min : lower edge of the distributions [ns], must contain the largest raw offset
+    /// \param max : upper edge of the distributions [ns]
+    /// \param window : half width of the window of the peak estimate [ns]
+    /// \EndMemberDescr
+    for(int iDetector=0; iDetector<TimeOffsetTable::kNDetectors; iDetector++) fRun.fOffset[iDetector] = numeric_limits<float>::quiet_NaN();
+}
+
+void TimeOffsetCalibrator::EndBurst(int burstID){
+    /// \MemberDescr
+    /// \param burstID : burst of the counts accumulated since the previous call
+    ///
+    /// Bursts without any entry (end of burst called twice) are ignored.
+    /// \EndMemberDescr
+    bool empty = true;
+    for(size_t iBin=0; iBin<fCounts.size() && empty; iBin++) empty = fCounts[iBin]==0;
+    if(empty) return;
+
+    FitPeaks(fCounts, fBursts[burstID]);
+    for(size_t iBin=0; iBin<fCounts.size(); iBin++){
+        fRunCounts[iBin] += fCounts[iBin];
+        fCounts[iBin] = 0;
+    }
+}
+
+bool TimeOffsetCalibrator::Write(TString path){
+    /// \MemberDescr
+    /// \param path : TimeOffsetTable to write
+    /// \return false if the table cannot be written
+    /// \EndMemberDescr
+    FitPeaks(fRunCounts, fRun);
+    return TimeOffsetTable::Write(path, fBursts, fRun);
+}
+
+void TimeOffsetCalibrator::Print(ostream& out) const{
+    out << endl << "Time offsets (" << fBursts.size() << " bursts, nan: not enough entries)" << endl;
+    out << setw(8) << "Burst";
+    for(int iDetector=0; iDetector<TimeOffsetTable::kNDetectors; iDetector++) out << setw(10) << TimeOffsetTable::GetDetectorName(iDetector);
+    out << endl << setw(8) << "Run" << fixed << setprecision(2);
+    for(int iDetector=0; iDetector<TimeOffsetTable::kNDetectors; iDetector++) out << setw(10) << fRun.fOffset[iDetector];
+    out << endl;
+    for(map<int, TimeOffsetTable::Row>::const_iterator it=fBursts.begin(); it!=fBursts.end(); ++it){
+        out << setw(8) << it->first;
+        for(int iDetector=0; iDetector<TimeOffsetTable::kNDetectors; iDetector++) out << setw(10) << it->second.fOffset[iDetector];
+        out << endl;
+    }
+    out.unsetf(ios::fixed);
+}
+
+void TimeOffsetCalibrator::FitPeaks(const vector<UInt_t>& counts, TimeOffsetTable::Row& offsets) const{
+    for(int iDetector=0; iDetector<TimeOffsetTable::kNDetectors; iDetector++){
+        double peak = fPeakFinder.Find(&counts[iDetector*fNBins], fNBins, fMin, fMax);
+        offsets.fOffset[iDetector] = std::isnan(peak) ? numeric_limits<float>::quiet_NaN() : -peak;
+    }
+}
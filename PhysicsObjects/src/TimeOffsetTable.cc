@@ -0,0 +1,126 @@
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <TSystem.h>
+#include "TimeOffsetTable.hh"
+
+using namespace std;
+
+static const char kTableMagic[8] = {'N','A','6','2','T','O','F','F'};
+static const UInt_t kTableVersion = 1;
+
+TimeOffsetTable::TimeOffsetTable() :
+    fMap(0),
+    fMapSize(0),
+    fHeader(0),
+    fRun(0),
+    fBursts(0)
+{
+}
+
+TimeOffsetTable::~TimeOffsetTable(){
+    Close();
+}
+
+bool TimeOffsetTable::Open(TString path){
+    /// \MemberDescr
+    /// \param path : table written by Write()
+    /// \return false if the file cannot be mapped or is not a valid table
+    /// \EndMemberDescr
+    Close();
+    int fd = open(path.Data(), O_RDONLY);
+    if(fd<0){
+        cerr << "TimeOffsetTable: unable to open " << path << endl;
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info)!=0 || info.st_size<(off_t)(sizeof(Header)+sizeof(Row))){
+        cerr << "TimeOffsetTable: " << path << " is not a time offset table" << endl;
+        close(fd);
+        return false;
+    }
+    void* map = mmap(0, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map==MAP_FAILED){
+        cerr << "TimeOffsetTable: unable to map " << path << endl;
+        return false;
+    }
+
+    const Header* header = (const Header*)map;
+    size_t expectedSize = sizeof(Header) + (header->fNBursts+1)*sizeof(Row);
+    if(memcmp(header->fMagic, kTableMagic, sizeof(kTableMagic))!=0 || header->fVersion!=kTableVersion ||
+       header->fNDetectors!=kNDetectors || header->fNBursts<0 || (size_t)info.st_size!=expectedSize){
+        cerr << "TimeOffsetTable: " << path << " is not a time offset table (or was written by another version)" << endl;
+        munmap(map, info.st_size);
+        return false;
+    }
+
+    fMap = map;
+    fMapSize = info.st_size;
+    fHeader = header;
+    fRun = (const Row*)((const char*)map + sizeof(Header));
+    fBursts = fRun + 1;
+    return true;
+}
+
+void TimeOffsetTable::Close(){
+    if(fMap) munmap(fMap, fMapSize);
+    fMap = 0;
+    fMapSize = 0;
+    fHeader = 0;
+    fRun = 0;
+    fBursts = 0;
+}
+
+bool TimeOffsetTable::Write(TString path, const map<int, Row>& bursts, const Row& run){
+    /// \MemberDescr
+    /// \param path : output file, replaced atomically
+    /// \param bursts : offsets of each calibrated burst, by burst ID
+    /// \param run : offsets of the whole run, used for the bursts missing from the table
+    /// \return false if the file cannot be written
+    /// \EndMemberDescr
+    Header header;
+    memcpy(header.fMagic, kTableMagic, sizeof(kTableMagic));
+    header.fVersion = kTableVersion;
+    header.fNDetectors = kNDetectors;
+    header.fFirstBurst = bursts.empty() ? 0 : bursts.begin()->first;
+    header.fNBursts = bursts.empty() ? 0 : bursts.rbegin()->first - header.fFirstBurst + 1;
+
+    Row missing;
+    for(int iDetector=0; iDetector<kNDetectors; iDetector++) missing.fOffset[iDetector] = numeric_limits<float>::quiet_NaN();
+
+    //Written next to the final file and renamed: a job mapping the table never sees a partial file
+    TString tmpFile = Form("%s.%d", path.Data(), gSystem->GetPid());
+    ofstream out(tmpFile.Data(), ios::binary);
+    if(!out.is_open()){
+        cerr << "TimeOffsetTable: unable to write " << path << endl;
+        return false;
+    }
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)&run, sizeof(run));
+    map<int, Row>::const_iterator it = bursts.begin();
+    for(int burstID=header.fFirstBurst; burstID<header.fFirstBurst+header.fNBursts; burstID++){
+        if(it!=bursts.end() && it->first==burstID){
+            out.write((const char*)&it->second, sizeof(Row));
+            ++it;
+        }
+        else out.write((const char*)&missing, sizeof(Row));
+    }
+    out.close();
+    if(out.fail() || gSystem->Rename(tmpFile, path)!=0){
+        cerr << "TimeOffsetTable: unable to write " << path << endl;
+        gSystem->Unlink(tmpFile);
+        return false;
+    }
+    return true;
+}
+
+const char* TimeOffsetTable::GetDetectorName(int detector){
+    static const char* names[kNDetectors] = {"LKr", "MUV1", "MUV2", "MUV3", "Cedar"};
+    return (detector>=0 && detector<kNDetectors) ? names[detector] : "";
+}
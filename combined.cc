@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <iostream>
+#include <signal.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <TString.h>
+#include <TObjArray.h>
+#include <TObjString.h>
+#include <TApplication.h>
+
+#include "BaseAnalysis.hh"
+
+#include "JobSetup.hh"
+#include "OneTrackSelection.hh"
+#include "OneTrack.hh"
+#include "Kmu2.hh"
+
+
+NA62Analysis::Core::BaseAnalysis *ban = 0;
+TApplication *theApp = 0;
+using namespace std;
+
+/// Analyzers which can be run together, in the default order
+template <class T> NA62Analysis::Analyzer* CreateAnalyzer(NA62Analysis::Core::BaseAnalysis* ba){ return new T(ba); }
+struct AnalyzerEntry {
+	const char* fName;
+	NA62Analysis::Analyzer* (*fCreate)(NA62Analysis::Core::BaseAnalysis*);
+};
+static const AnalyzerEntry kAnalyzers[] = {
+	{"OneTrackSelection",	CreateAnalyzer<OneTrackSelection>},
+	{"OneTrack",			CreateAnalyzer<OneTrack>},
+	{"Kmu2",				CreateAnalyzer<Kmu2>}
+};
+static const int kNAnalyzers = sizeof(kAnalyzers)/sizeof(AnalyzerEntry);
+
+void usage(char* name)
+{
+	cout << endl;
+	cout << "Usage: \t"<< name << " (-i path | -l/--list path) [options]" << endl << endl;
+	cout << "Runs several analyzers in the same event loop: the input is read once, the per event" << endl
+		 << "results shared by the analyzers (SharedEvent) are computed once, and the histograms of" << endl
+		 << "each analyzer are written to its own directory of the output file. The --memory-report and" << endl
+		 << "--perf-counters summaries cover all the analyzers and are written to AllAnalyzers/ in the" << endl
+		 << "directory of the first one." << endl << endl;
+	cout << "Allowed options:" << endl;
+	cout << "  -h/--help\t\t: Display this help" << endl;
+	cout << "  -a/--analyzers list\t: Comma separated analyzers to run, in this order. (Default: all)" << endl
+		 << "\t\t\t  Available:";
+	for(int iAnalyzer=0; iAnalyzer<kNAnalyzers; iAnalyzer++) cout << " " << kAnalyzers[iAnalyzer].fName;
+	cout << endl;
+	JobSetup::PrintOptions(cout);
+}
+
+void sighandler(int sig)
+{
+	cerr << endl << "********************************************************************************" << endl;
+	cerr << "Killed with Signal " << sig << endl;
+	cerr << endl << "********************************************************************************" << endl;
+	cerr << "Bye!" << endl;
+
+	delete ban;
+
+	if(theApp) theApp->Terminate();
+
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv){
+	signal(SIGXCPU, sighandler);
+	signal(SIGTERM, sighandler);
+	signal(SIGINT, sighandler);
+	signal(SIGABRT, sighandler);
+
+	TString analyzerList;
+	vector<struct option> longopts = {
+			{ "analyzers",	required_argument,	NULL,					'a'}
+	};
+	JobSetup job;
+	bool parsed = job.ParseOptions(argc, argv, "a:", longopts, [&](int opt, const char* arg){
+		if(opt!='a') return false;
+		//Analyzers to run, long_option: analyzers
+		analyzerList = TString(arg);
+		return true;
+	});
+	if(!parsed){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	vector<int> selected;
+	if(analyzerList.IsNull()){
+		for(int iAnalyzer=0; iAnalyzer<kNAnalyzers; iAnalyzer++) selected.push_back(iAnalyzer);
+	}
+	else{
+		TObjArray* names = analyzerList.Tokenize(", ");
+		for(int iName=0; iName<names->GetEntries(); iName++){
+			TString name = ((TObjString*)names->At(iName))->GetString();
+			int analyzer = 0;
+			while(analyzer<kNAnalyzers && name!=kAnalyzers[analyzer].fName) analyzer++;
+			if(analyzer==kNAnalyzers){
+				cerr << "Unknown analyzer " << name << " in --analyzers" << endl;
+				delete names;
+				return EXIT_FAILURE;
+			}
+			if(find(selected.begin(), selected.end(), analyzer)!=selected.end()){
+				cerr << "Analyzer " << name << " given twice in --analyzers" << endl;
+				delete names;
+				return EXIT_FAILURE;
+			}
+			selected.push_back(analyzer);
+		}
+		delete names;
+	}
+	if(selected.empty()){
+		cerr << "No analyzer to run" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if(!job.Prepare()) return EXIT_FAILURE;
+
+	if(job.IsGraphicMode()) theApp = new TApplication("NA62Analysis", &argc, argv);
+
+	ban = job.CreateAnalysis();
+	vector<NA62Analysis::Analyzer*> analyzers;
+	for(size_t iAnalyzer=0; iAnalyzer<selected.size(); iAnalyzer++){
+		analyzers.push_back(kAnalyzers[selected[iAnalyzer]].fCreate(ban));
+		ban->AddAnalyzer(analyzers.back());
+	}
+
+	bool retCode = job.Run(ban);
+
+	if(job.IsGraphicMode()) theApp->Run();
+
+	for(size_t iAnalyzer=0; iAnalyzer<analyzers.size(); iAnalyzer++) delete analyzers[iAnalyzer];
+
+	delete ban;
+
+	return retCode ? 0 : EXIT_FAILURE;
+}
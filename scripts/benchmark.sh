@@ -0,0 +1,74 @@
+#!/bin/bash
+# Throughput of the analyzers on a synthetic sample (GenerateRecoEvents)
+#   scripts/benchmark.sh [-n events] [-b files] [-a accidentals] [-A analyzers] <sample dir> [executable ...]
+# The sample is generated in <sample dir> if its files.list is missing or was generated with
+# other parameters (stored in <sample dir>/parameters next to the event count). Each executable
+# (OneTrackSelection, OneTrack, Kmu2, ... as built by the analysis builder) then processes
+# the whole list and its events/s are printed; without executable only the sample is made
+# (make benchmark-sample, used by the regression). With -A "OneTrackSelection OneTrack Kmu2"
+# each executable (CombinedAnalysis) runs once per analyzer with --analyzers <analyzer>, the run
+# being named after the analyzer. The synthetic files only contain the Reco tree, the
+# executables run with --ignore. GENERATOR overrides the path of GenerateRecoEvents.
+
+NEVT=10000
+NFILES=2
+ACCIDENTALS=1
+ANALYZERS=""
+while getopts "n:b:a:A:" opt; do
+	case $opt in
+		n) NEVT=$OPTARG;;
+		b) NFILES=$OPTARG;;
+		a) ACCIDENTALS=$OPTARG;;
+		A) ANALYZERS=$OPTARG;;
+		*) exit 1;;
+	esac
+done
+shift $((OPTIND-1))
+
+if [[ $# -lt 1 ]]; then
+	echo "Usage: $0 [-n events] [-b files] [-a accidentals] [-A analyzers] <sample dir> [executable ...]"
+	exit 1
+fi
+
+SAMPLE=$1
+shift
+GENERATOR=${GENERATOR:-$(dirname "$0")/../GenerateRecoEvents}
+
+PARAMETERS="-n $NEVT -b $NFILES -a $ACCIDENTALS"
+if [[ ! -f $SAMPLE/files.list || $(cat "$SAMPLE/parameters" 2>/dev/null) != "$PARAMETERS" ]]; then
+	echo "Generating $NFILES x $NEVT events, $ACCIDENTALS accidentals per event -> $SAMPLE"
+	# Files of a previous sample which the new list would not overwrite
+	rm -f "$SAMPLE"/Reco_*.root "$SAMPLE/files.list" "$SAMPLE/files.list.cache" "$SAMPLE/nevents" "$SAMPLE/parameters"
+	if ! $GENERATOR -o "$SAMPLE" -n "$NEVT" -b "$NFILES" --accidentals "$ACCIDENTALS"; then
+		echo "Sample generation failed"
+		exit 1
+	fi
+	echo $(( NFILES * NEVT )) > "$SAMPLE/nevents"
+	echo "$PARAMETERS" > "$SAMPLE/parameters"
+fi
+NTOTAL=$(cat "$SAMPLE/nevents")
+[[ $# == 0 ]] && exit 0
+
+STATUS=0
+printf "\n%-28s %12s %10s %12s\n" "Executable" "Events" "Time[s]" "Events/s"
+for EXEC in "$@"; do
+	for ANALYZER in ${ANALYZERS:--}; do
+		NAME=$(basename "$EXEC")
+		OPTIONS=()
+		if [[ $ANALYZER != "-" ]]; then
+			# Named after the analyzer, and the executable if there are several
+			[[ $# -gt 1 ]] && NAME=${NAME}_$ANALYZER || NAME=$ANALYZER
+			OPTIONS=(--analyzers "$ANALYZER")
+		fi
+		START=$(date +%s.%N)
+		if ! $EXEC -l "$SAMPLE/files.list" --ignore -o "$SAMPLE/$NAME.root" "${OPTIONS[@]}" > "$SAMPLE/$NAME.log" 2>&1; then
+			echo "$NAME failed, see $SAMPLE/$NAME.log"
+			STATUS=1
+			continue
+		fi
+		END=$(date +%s.%N)
+		awk -v name="$NAME" -v n="$NTOTAL" -v t0="$START" -v t1="$END" \
+			'BEGIN { t = t1-t0; printf "%-28s %12d %10.2f %12.0f\n", name, n, t, (t>0 ? n/t : 0) }'
+	done
+done
+exit $STATUS
@@ -0,0 +1,123 @@
+#!/bin/bash
+# Per event cost of the analyzers against the overlaid accidental activity (OverlayRecoEvents)
+#   scripts/pileup.sh [-k "0 1 2 4 8"] [-n events] <input list> <work dir> <executable> [executable ...] [-- executable options]
+# For each overlay factor k, <work dir>/k<k> receives the input events with the candidates and
+# hits of k random other events overlaid (made once, reused if present). Each executable
+# processes every sample with --perf-counters: the in-process time of Process per event of each
+# analyzer (and of the reading outside the analyzers) and its ratio to the first k are taken
+# from the PerfCounters table of the log, written to <work dir>/pileup.txt and plotted in
+# <work dir>/pileup.pdf (one curve per analyzer). A ratio growing faster than the multiplicity
+# points to a non-linear loop: rerun with "-- -p Kmu2:StageTiming=1" and compare the stage
+# tables in the logs <work dir>/k<k>/<executable>.log. OVERLAY overrides the path of OverlayRecoEvents.
+
+FACTORS="0 1 2 4 8"
+NEVT=-1
+while getopts "k:n:" opt; do
+	case $opt in
+		k) FACTORS=$OPTARG;;
+		n) NEVT=$OPTARG;;
+		*) exit 1;;
+	esac
+done
+shift $((OPTIND-1))
+
+if [[ $# -lt 3 ]]; then
+	echo "Usage: $0 [-k \"0 1 2 4 8\"] [-n events] <input list> <work dir> <executable> [executable ...] [-- executable options]"
+	exit 1
+fi
+
+INPUT=$1
+WORK=$2
+shift 2
+EXECS=()
+while [[ $# -gt 0 && $1 != "--" ]]; do
+	EXECS+=("$1")
+	shift
+done
+[[ $1 == "--" ]] && shift
+OVERLAY=${OVERLAY:-$(dirname "$0")/../OverlayRecoEvents}
+mkdir -p "$WORK"
+
+TABLE=$WORK/pileup.txt
+echo "# k analyzer ns/event ratio" > "$TABLE"
+declare -A REFERENCE
+STATUS=0
+printf "\n%6s %-40s %12s %10s\n" "k" "Analyzer" "ns/event" "Ratio"
+for K in $FACTORS; do
+	SAMPLE=$WORK/k$K
+	if [[ ! -f $SAMPLE/nevents ]]; then
+		if ! $OVERLAY -l "$INPUT" -o "$SAMPLE" -k "$K" -n "$NEVT" > "$SAMPLE.log" 2>&1; then
+			echo "Overlay k=$K failed, see $SAMPLE.log"
+			exit 1
+		fi
+		awk '/ events, / { n += $2 } END { print n }' "$SAMPLE.log" > "$SAMPLE/nevents"
+	fi
+	for EXEC in "${EXECS[@]}"; do
+		NAME=$(basename "$EXEC")
+		if ! $EXEC -l "$SAMPLE/files.list" --ignore -o "$SAMPLE/$NAME.root" --perf-counters "$@" > "$SAMPLE/$NAME.log" 2>&1; then
+			echo "$NAME failed for k=$K, see $SAMPLE/$NAME.log"
+			STATUS=1
+			continue
+		fi
+		# Rows of the PerfCounters table: name in the first 24 columns, then calls and ns per call
+		ROWS=$(awk '/^Time and hardware counters per event/ { table = 1; getline; next }
+			table && NF == 0 { exit }
+			table { name = substr($0, 1, 24); sub(/ +$/, "", name); gsub(/ /, "_", name); split(substr($0, 25), fields, " "); print name, fields[2] }' "$SAMPLE/$NAME.log")
+		if [[ -z $ROWS ]]; then
+			echo "$NAME printed no time per analyzer for k=$K, see $SAMPLE/$NAME.log"
+			STATUS=1
+			continue
+		fi
+		while read -r ANALYZER NS; do
+			# Executable and analyzer: the same analyzer may run in several executables
+			LABEL=$NAME/$ANALYZER
+			[[ ${#EXECS[@]} == 1 ]] && LABEL=$ANALYZER
+			[[ -z ${REFERENCE[$LABEL]} ]] && REFERENCE[$LABEL]=$NS
+			RATIO=$(awk -v ns="$NS" -v ref="${REFERENCE[$LABEL]}" 'BEGIN { printf "%.2f", (ref>0 ? ns/ref : 0) }')
+			printf "%6s %-40s %12.0f %10s\n" "$K" "$LABEL" "$NS" "$RATIO"
+			echo "$K $LABEL $NS $RATIO" >> "$TABLE"
+		done <<< "$ROWS"
+	done
+done
+
+# One graph of ns/event against k per analyzer
+cat > "$WORK/pileup_plot.C" <<'MACRO'
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+void pileup_plot(const char* table, const char* output){
+	std::map<std::string, TGraph*> graphs;
+	std::ifstream in(table);
+	std::string line;
+	while(std::getline(in, line)){
+		if(line.empty() || line[0]=='#') continue;
+		std::istringstream fields(line);
+		double k, ns, ratio;
+		std::string name;
+		fields >> k >> name >> ns >> ratio;
+		if(!graphs.count(name)) graphs[name] = new TGraph;
+		graphs[name]->SetPoint(graphs[name]->GetN(), k, ns);
+	}
+	TCanvas canvas("pileup", "Per event cost against overlay factor", 800, 600);
+	TMultiGraph all("all", "Per event cost against overlay factor;Overlaid events k;Time [ns/event]");
+	TLegend legend(0.15, 0.7, 0.45, 0.88);
+	int color = 1;
+	for(std::map<std::string, TGraph*>::iterator graph=graphs.begin(); graph!=graphs.end(); ++graph, ++color){
+		graph->second->SetMarkerStyle(20);
+		graph->second->SetMarkerColor(color);
+		graph->second->SetLineColor(color);
+		all.Add(graph->second, "LP");
+		legend.AddEntry(graph->second, graph->first.c_str(), "LP");
+	}
+	all.Draw("A");
+	legend.Draw();
+	canvas.SaveAs(output);
+}
+MACRO
+if command -v root > /dev/null; then
+	root -l -b -q "$WORK/pileup_plot.C(\"$TABLE\",\"$WORK/pileup.pdf\")" > /dev/null
+	echo "Plot: $WORK/pileup.pdf"
+fi
+echo "Table: $TABLE"
+exit $STATUS
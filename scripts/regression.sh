@@ -0,0 +1,123 @@
+#!/bin/bash
+# Golden output regression: physics output and throughput of an executable on a fixed sample
+#   scripts/regression.sh [-r relative] [-a absolute] [-s slowdown%] [-n repetitions] [-t time dir] [-A analyzers] [-u] <input list> <golden dir> <executable> [-- executable options]
+# The executable processes the input list (best wall time of the repetitions). Every histogram
+# of its output is compared bin by bin (CompareHistos) with <golden dir>/<executable>.root,
+# exactly by default or within the -r/-a tolerances, and the time with the one recorded in
+# <time dir>/<executable>.time (Default: the current directory). The time depends on the
+# machine: it is kept out of the golden directory and recorded by the first run without one.
+# The regression fails (exit code 1) on any histogram difference, a missing golden file, or if
+# the executable is more than <slowdown>% slower than the recorded run (Default: 10).
+# With -A "OneTrackSelection OneTrack Kmu2" the executable (CombinedAnalysis) runs once per
+# analyzer with --analyzers <analyzer>, each run being checked as above under the name of the
+# analyzer (<golden dir>/<analyzer>.root); the regression fails if any of them fails.
+# -u records the current output and time as the new golden.
+# COMPARE overrides the path of CompareHistos.
+
+RELATIVE=0
+ABSOLUTE=0
+SLOWDOWN=10
+REPEAT=3
+TIMES=.
+UPDATE=0
+ANALYZERS=""
+while getopts "r:a:s:n:t:A:u" opt; do
+	case $opt in
+		r) RELATIVE=$OPTARG;;
+		a) ABSOLUTE=$OPTARG;;
+		s) SLOWDOWN=$OPTARG;;
+		n) REPEAT=$OPTARG;;
+		t) TIMES=$OPTARG;;
+		A) ANALYZERS=$OPTARG;;
+		u) UPDATE=1;;
+		*) exit 1;;
+	esac
+done
+shift $((OPTIND-1))
+
+if [[ $# -lt 3 ]]; then
+	echo "Usage: $0 [-r relative] [-a absolute] [-s slowdown%] [-n repetitions] [-t time dir] [-A analyzers] [-u] <input list> <golden dir> <executable> [-- executable options]"
+	exit 1
+fi
+
+INPUT=$1
+GOLDEN=$2
+EXEC=$3
+shift 3
+[[ $1 == "--" ]] && shift
+COMPARE=${COMPARE:-$(dirname "$0")/../CompareHistos}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Events of the sample, if known (benchmark and pileup samples), for the events/s
+NEVENTS=0
+[[ -f $(dirname "$INPUT")/nevents ]] && NEVENTS=$(cat "$(dirname "$INPUT")/nevents")
+
+rate() {
+	awk -v n="$NEVENTS" -v t="$1" 'BEGIN { if(n>0 && t>0) printf "%.0f events/s", n/t; else printf "%.2f s", t }'
+}
+
+# Runs, checks or records (-u) one configuration: regress <name> [executable options]
+regress() {
+	local NAME=$1
+	shift
+	local OPTIONS=("$@")
+	local BEST="" START END STATUS REFERENCE_TIME CHANGE I
+	for ((I=0; I<REPEAT; I++)); do
+		START=$(date +%s.%N)
+		if ! $EXEC -l "$INPUT" --ignore -o "$WORK/$NAME.root" "${OPTIONS[@]}" > "$WORK/$NAME.log" 2>&1; then
+			cat "$WORK/$NAME.log"
+			echo "REGRESSION FAILED: $NAME did not run"
+			return 1
+		fi
+		END=$(date +%s.%N)
+		BEST=$(awk -v t="$(awk -v t0="$START" -v t1="$END" 'BEGIN { print t1-t0 }')" -v best="$BEST" 'BEGIN { print (best=="" || t<best) ? t : best }')
+	done
+
+	if [[ $UPDATE == 1 ]]; then
+		mkdir -p "$GOLDEN" "$TIMES"
+		cp "$WORK/$NAME.root" "$GOLDEN/$NAME.root"
+		echo "$BEST" > "$TIMES/$NAME.time"
+		echo "Golden output of $NAME recorded in $GOLDEN, time in $TIMES ($(rate "$BEST"))"
+		return 0
+	fi
+	if [[ ! -f $GOLDEN/$NAME.root ]]; then
+		echo "REGRESSION FAILED: no golden output $GOLDEN/$NAME.root, record it with -u (make regression-update, see data/golden/README)"
+		return 1
+	fi
+
+	STATUS=0
+	if ! $COMPARE -r "$RELATIVE" -a "$ABSOLUTE" "$GOLDEN/$NAME.root" "$WORK/$NAME.root"; then
+		echo "REGRESSION FAILED: the output of $NAME differs from the golden file"
+		STATUS=1
+	fi
+
+	if [[ ! -f $TIMES/$NAME.time ]]; then
+		mkdir -p "$TIMES"
+		echo "$BEST" > "$TIMES/$NAME.time"
+		echo
+		echo "Throughput $NAME: $(rate "$BEST"), recorded in $TIMES as the reference of the next runs"
+	else
+		REFERENCE_TIME=$(cat "$TIMES/$NAME.time")
+		CHANGE=$(awk -v t="$BEST" -v ref="$REFERENCE_TIME" 'BEGIN { printf "%.1f", 100*(t/ref-1) }')
+		echo
+		echo "Throughput $NAME: $(rate "$BEST"), reference $(rate "$REFERENCE_TIME"), time change $CHANGE% (limit +$SLOWDOWN%)"
+		if awk -v change="$CHANGE" -v limit="$SLOWDOWN" 'BEGIN { exit !(change>limit) }'; then
+			echo "REGRESSION FAILED: $NAME is $CHANGE% slower than the reference run"
+			STATUS=1
+		fi
+	fi
+	return $STATUS
+}
+
+STATUS=0
+if [[ -z $ANALYZERS ]]; then
+	regress "$(basename "$EXEC")" "$@" || STATUS=1
+else
+	for ANALYZER in $ANALYZERS; do
+		echo "== $ANALYZER"
+		regress "$ANALYZER" --analyzers "$ANALYZER" "$@" || STATUS=1
+	done
+fi
+[[ $STATUS == 0 && $UPDATE == 0 ]] && echo "Regression passed"
+exit $STATUS
@@ -0,0 +1,81 @@
+#!/bin/bash
+# Test of the input file staging (--stage-dir) with a local directory standing in for the remote store
+#   scripts/staging.sh <input list> <work dir> <executable> [-- executable options]
+# The files of the input list are copied to <work dir>/remote, listed with relative paths.
+# The executable reads them once directly (reference) and twice concurrently through the
+# same staging directory, limited to 1.5 times the largest file so that copies are evicted.
+# A partial copy of a dead job is planted in the staging directory beforehand. The test fails
+# (exit code 1) if an output differs from the reference, if nothing was staged, or if partial
+# copies, job directories or more than the size limit are left behind.
+# COMPARE overrides the path of CompareHistos.
+
+if [[ $# -lt 3 ]]; then
+	echo "Usage: $0 <input list> <work dir> <executable> [-- executable options]"
+	exit 1
+fi
+
+# Absolute paths: the executables run in the remote store
+INPUT=$1
+mkdir -p "$2" || exit 1
+WORK=$(readlink -f "$2")
+EXEC=$3
+[[ -e $EXEC ]] && EXEC=$(readlink -f "$EXEC")
+shift 3
+[[ $1 == "--" ]] && shift
+COMPARE=$(readlink -f "${COMPARE:-$(dirname "$0")/../CompareHistos}")
+NAME=$(basename "$EXEC")
+REMOTE=$WORK/remote
+STAGE=$WORK/stage
+
+rm -rf "$REMOTE" "$STAGE"
+mkdir -p "$REMOTE" "$STAGE/files"
+while read -r FILE; do
+	[[ -z $FILE || $FILE == \#* ]] && continue
+	cp "$FILE" "$REMOTE/" || exit 1
+	basename "$FILE" >> "$REMOTE/files.list"
+done < "$INPUT"
+MAXSIZE=$(stat -c %s "$REMOTE"/*.root | sort -n | tail -1)
+LIMIT=$(awk -v s="$MAXSIZE" 'BEGIN { printf "%.9f", 1.5*s/1024/1024/1024 }')
+
+# Job which died while copying: its partial copy must be removed
+sleep 0 &
+DEAD=$!
+wait $DEAD
+echo "dead.root 1000 0 $DEAD" > "$STAGE/index"
+echo "partial" > "$STAGE/files/dead.root.part.$DEAD"
+
+# Relative paths in the list
+cd "$REMOTE" || exit 1
+run() {
+	if ! $EXEC -l files.list --ignore -o "$WORK/$1.root" "${@:2}" > "$WORK/$1.log" 2>&1; then
+		cat "$WORK/$1.log"
+		echo "STAGING TEST FAILED: $NAME did not run ($1)"
+		exit 1
+	fi
+}
+run reference "$@"
+run staged1 --stage-dir "$STAGE" --stage-size "$LIMIT" --stage-ahead 1 "$@" &
+JOB1=$!
+run staged2 --stage-dir "$STAGE" --stage-size "$LIMIT" --stage-ahead 1 "$@" &
+JOB2=$!
+wait $JOB1 || exit 1
+wait $JOB2 || exit 1
+
+STATUS=0
+fail() {
+	echo "STAGING TEST FAILED: $1"
+	STATUS=1
+}
+for OUT in staged1 staged2; do
+	$COMPARE "$WORK/reference.root" "$WORK/$OUT.root" > "$WORK/$OUT.compare" 2>&1 || fail "the output of $OUT differs from the direct reading (see $WORK/$OUT.compare)"
+done
+NCOPIES=$(awk '/^FileStager: / { n += $2 + $5 } END { print n+0 }' "$WORK/staged1.log" "$WORK/staged2.log")
+[[ $NCOPIES -gt 0 ]] || fail "no file was staged"
+[[ -z $(find "$STAGE/files" -name '*.part.*') ]] || fail "partial copies left in $STAGE/files"
+[[ -z $(ls -A "$STAGE/jobs") ]] || fail "job directories left in $STAGE/jobs"
+USED=$(awk '{ used += $2 } END { print used+0 }' "$STAGE/index")
+awk -v used="$USED" -v max="$MAXSIZE" 'BEGIN { exit !(used<=1.5*max) }' || fail "$USED bytes staged, above the limit"
+
+echo "$NCOPIES files staged or shared, $USED bytes left in $STAGE"
+[[ $STATUS == 0 ]] && echo "Staging test passed"
+exit $STATUS
@@ -0,0 +1,50 @@
+#!/bin/bash
+# Two pass processing with per burst time offsets (Kmu2 TimeOffsets/TimeCalibration parameters)
+#   scripts/timecalib.sh <executable> <table> [executable options]
+# The calibration prepass fits the offsets of each burst of the input and writes <table>.
+# It only runs if <table> is missing or older than the input file/list (-i, -l). The main
+# pass then runs with the same options and reads the offsets from <table>.
+
+if [[ $# -lt 2 ]]; then
+	echo "Usage: $0 <executable> <table> [executable options]"
+	exit 1
+fi
+
+EXEC=$1
+TABLE=$2
+shift 2
+
+ARGS=()
+PARAMS=""
+OUTPUT="outFile.root"
+INPUT=""
+while [[ $# -gt 0 ]]; do
+	case $1 in
+		-p|--params) PARAMS=$2; shift 2;;
+		-o|--output) OUTPUT=$2; shift 2;;
+		-i|-l|--list) INPUT=$2; ARGS+=("$1" "$2"); shift 2;;
+		*) ARGS+=("$1"); shift;;
+	esac
+done
+
+# Adds "param=val" to the Kmu2 section of a -p string
+kmu2_params() {
+	if [[ $PARAMS == *Kmu2:* ]]; then
+		echo "${PARAMS/Kmu2:/Kmu2:$1;}"
+	elif [[ -n $PARAMS ]]; then
+		echo "$PARAMS&Kmu2:$1"
+	else
+		echo "Kmu2:$1"
+	fi
+}
+
+if [[ ! -f $TABLE || ( -n $INPUT && $INPUT -nt $TABLE ) ]]; then
+	echo "Time offset calibration prepass -> $TABLE"
+	if ! $EXEC "${ARGS[@]}" -o "$TABLE.prepass.root" -p "$(kmu2_params "TimeCalibration=1;TimeOffsets=$TABLE")"; then
+		echo "Calibration prepass failed"
+		exit 1
+	fi
+	rm -f "$TABLE.prepass.root"
+fi
+
+exec $EXEC "${ARGS[@]}" -o "$OUTPUT" -p "$(kmu2_params "TimeOffsets=$TABLE")"
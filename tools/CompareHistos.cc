@@ -0,0 +1,96 @@
+#include <getopt.h>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <TFile.h>
+#include <TString.h>
+
+#include "HistoComparator.hh"
+
+using namespace std;
+
+void usage(char* name)
+{
+	cout << endl;
+	cout << "Usage: \t"<< name << " [options] <golden file> <output file>" << endl << endl;
+	cout << "Compares bin by bin all the histograms of the output with the golden file." << endl
+		 << "Exit code 0 if they agree, 1 if a histogram differs or is missing in the output." << endl << endl;
+	cout << "Allowed options:" << endl;
+	cout << "  -h/--help\t\t: Display this help" << endl;
+	cout << "  -r/--relative float\t: Relative tolerance. (Default: 0, exact)" << endl;
+	cout << "  -a/--absolute float\t: Absolute tolerance. (Default: 0, exact)" << endl;
+	cout << "  -x/--exclude regexp\t: Skip the histograms whose path matches. Can be repeated." << endl
+		 << "\t\t\t  (Default: the timing, memory and hardware counter histograms)" << endl;
+	cout << "  --all\t\t\t: Do not skip the default exclusions." << endl;
+	cout << "  --max-print int\t: Maximum number of differences printed. (Default: 20)" << endl;
+	cout << endl << endl;
+}
+
+int main(int argc, char** argv){
+	double relative = 0.;
+	double absolute = 0.;
+	int maxPrint = 20;
+	int flAll = 0;
+	vector<TString> excludes;
+
+	int opt;
+	struct option longopts[] = {
+			{ "help",		no_argument,		NULL,	'h'},
+			{ "relative",	required_argument,	NULL,	'r'},
+			{ "absolute",	required_argument,	NULL,	'a'},
+			{ "exclude",	required_argument,	NULL,	'x'},
+			{ "all",		no_argument,		&flAll,	1},
+			{ "max-print",	required_argument,	NULL,	'0'},
+			{0,0,0,0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "hr:a:x:0:", longopts, NULL)) != -1) {
+		switch (opt) {
+		case 0:
+			break;
+		case 'r': /* long_option: relative */
+			relative = TString(optarg).Atof();
+			break;
+		case 'a': /* long_option: absolute */
+			absolute = TString(optarg).Atof();
+			break;
+		case 'x': /* long_option: exclude */
+			excludes.push_back(TString(optarg));
+			break;
+		case '0': /* long_option: max-print */
+			maxPrint = TString(optarg).Atoi();
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(argc-optind!=2){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	TFile* golden = TFile::Open(argv[optind]);
+	TFile* output = TFile::Open(argv[optind+1]);
+	if(!golden || golden->IsZombie() || !output || output->IsZombie()){
+		cerr << "CompareHistos: cannot open " << (!golden || golden->IsZombie() ? argv[optind] : argv[optind+1]) << endl;
+		return EXIT_FAILURE;
+	}
+
+	HistoComparator comparator;
+	comparator.SetTolerance(relative, absolute);
+	//Run dependent: StageTimer, CutFlow timing, HeapCounter, MemoryMonitor, PerfCounters
+	if(!flAll){
+		comparator.AddExclude("_StageTime_|_StageP50$|_StageP99$|_StageShare$");
+		comparator.AddExclude("_CutTime$|_HeapAllocations$");
+		comparator.AddExclude("(^|/)Memory_|(^|/)Perf_");
+	}
+	for(size_t iExclude=0; iExclude<excludes.size(); iExclude++) comparator.AddExclude(excludes[iExclude]);
+	int nFailures = comparator.Compare(golden, output);
+	comparator.Print(cout, maxPrint);
+	golden->Close();
+	output->Close();
+	return nFailures==0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+#include <getopt.h>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+
+#include <TFile.h>
+#include <TString.h>
+#include <TSystem.h>
+#include <TTree.h>
+
+#include "RecoEventGenerator.hh"
+
+using namespace std;
+
+void usage(char* name)
+{
+	cout << endl;
+	cout << "Usage: \t"<< name << " -o dir [options]" << endl << endl;
+	cout << "Writes synthetic reco files (Kmu2/Kpi2 single track and accidentals) for the benchmarks:" << endl
+		 << "dir/Reco_<burst>.root with a Reco tree (one branch per detector) and the list dir/files.list." << endl << endl;
+	cout << "Allowed options:" << endl;
+	cout << "  -h/--help\t\t: Display this help" << endl;
+	cout << "  -o/--output path\t: Output directory, created if missing." << endl;
+	cout << "  -n/--nevt int\t\t: Number of events per file. (Default: 10000)" << endl;
+	cout << "  -b/--nfiles int\t: Number of files (bursts). (Default: 1)" << endl;
+	cout << "  --seed int\t\t: Seed of the first file, the next files use seed+burst. (Default: 1)" << endl;
+	cout << "  --kpi2 float\t\t: Fraction of Kpi2 events. (Default: 0.25)" << endl;
+	cout << "  --accidentals float\t: Mean number of accidental halo muons and pions per event. (Default: 1)" << endl;
+	cout << "  --cedar float\t\t: Mean number of accidental Cedar kaons per event. (Default: 1)" << endl;
+	cout << "  --noise float\t\t: Mean number of noise hits per event in MUV1 and in MUV2. (Default: 2)" << endl;
+	cout << "  --window float\t: Half width of the accidental time window in ns. (Default: 50)" << endl;
+	cout << endl << endl;
+}
+
+int main(int argc, char** argv){
+	TString outDir;
+	int nEvents = 10000;
+	int nFiles = 1;
+	unsigned int seed = 1;
+	RecoEventGenerator::Config config = RecoEventGenerator::GetDefaultConfig();
+
+	int opt;
+	struct option longopts[] = {
+			{ "help",		no_argument,		NULL,	'h'},
+			{ "output",		required_argument,	NULL,	'o'},
+			{ "nevt",		required_argument,	NULL,	'n'},
+			{ "nfiles",		required_argument,	NULL,	'b'},
+			{ "seed",		required_argument,	NULL,	'0'},
+			{ "kpi2",		required_argument,	NULL,	'1'},
+			{ "accidentals",required_argument,	NULL,	'2'},
+			{ "cedar",		required_argument,	NULL,	'3'},
+			{ "noise",		required_argument,	NULL,	'4'},
+			{ "window",		required_argument,	NULL,	'5'},
+			{0,0,0,0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "ho:n:b:0:1:2:3:4:5:", longopts, NULL)) != -1) {
+		switch (opt) {
+		case 'o': /* Output directory, long_option: output */
+			outDir = TString(optarg);
+			break;
+		case 'n': /* Events per file, long_option: nevt */
+			nEvents = TString(optarg).Atoi();
+			break;
+		case 'b': /* Number of files, long_option: nfiles */
+			nFiles = TString(optarg).Atoi();
+			break;
+		case '0': /* long_option: seed */
+			seed = TString(optarg).Atoi();
+			break;
+		case '1': /* long_option: kpi2 */
+			config.fKpi2Fraction = TString(optarg).Atof();
+			break;
+		case '2': /* long_option: accidentals */
+			config.fAccidentals = TString(optarg).Atof();
+			break;
+		case '3': /* long_option: cedar */
+			config.fCedarAccidentals = TString(optarg).Atof();
+			break;
+		case '4': /* long_option: noise */
+			config.fNoiseHits = TString(optarg).Atof();
+			break;
+		case '5': /* long_option: window */
+			config.fTimeWindow = TString(optarg).Atof();
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(outDir.IsNull() || nEvents<=0 || nFiles<=0){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	gSystem->mkdir(outDir, kTRUE);
+
+	ofstream list(outDir + "/files.list");
+	for(int burst=0; burst<nFiles; burst++){
+		TString fileName = TString::Format("%s/Reco_%04d.root", outDir.Data(), burst);
+		TFile file(fileName, "RECREATE");
+		if(file.IsZombie()){
+			cerr << "GenerateRecoEvents: cannot create " << fileName << endl;
+			return EXIT_FAILURE;
+		}
+		TTree* tree = new TTree("Reco", "Synthetic reconstructed events");
+		RecoEventGenerator generator(config, seed+burst);
+		generator.Branch(tree);
+		int nKpi2 = 0;
+		for(int iEvent=0; iEvent<nEvents; iEvent++){
+			generator.Generate(burst, iEvent);
+			if(generator.IsKpi2()) nKpi2++;
+			tree->Fill();
+		}
+		tree->Write();
+		file.Close();
+		list << fileName << endl;
+		cout << fileName << ": " << nEvents << " events, " << nKpi2 << " Kpi2" << endl;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,256 @@
+#include <getopt.h>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <TH1D.h>
+#include <TPRegexp.h>
+#include <TRandom3.h>
+#include <TString.h>
+#include <TVector2.h>
+#include <TVector3.h>
+
+#include "HistoHandler.hh"
+#include "Persistency.hh"
+#include "AnalysisKernels.hh"
+#include "MicroBenchmark.hh"
+
+using namespace std;
+
+static const int kNInputs = 1024;     ///< Inputs cycled through by the kernels, power of 2
+static const int kSizes[] = {1, 2, 5, 10, 20, 50, 100, 200};
+
+void usage(char* name)
+{
+	cout << endl;
+	cout << "Usage: \t"<< name << " [options]" << endl << endl;
+	cout << "Times the hot kernels of the analyzers (AnalysisKernels, FillHisto)." << endl << endl;
+	cout << "Allowed options:" << endl;
+	cout << "  -h/--help\t\t: Display this help" << endl;
+	cout << "  -r/--repetitions int\t: Measured repetitions of each kernel. (Default: 15)" << endl;
+	cout << "  -w/--warmup int\t: Discarded repetitions before the measurement. (Default: 3)" << endl;
+	cout << "  -t/--min-time float\t: Minimum duration of one repetition in ms. (Default: 2)" << endl;
+	cout << "  -f/--filter regexp\t: Only the kernels whose name matches." << endl;
+	cout << "  -o/--output path\t: Write the results in JSON to this file." << endl;
+	cout << "  --label string\t: Label of the run in the JSON output (commit, machine, ...)." << endl;
+	cout << endl << endl;
+}
+
+/// Candidates of a downstream detector at random positions, in the units of the reco
+static void FillCandidates(TRecoVEvent* event, int detector, int nCandidates, TRandom3& random){
+	event->Clear("C");
+	for(int iCand=0; iCand<nCandidates; iCand++){
+		double x = random.Uniform(-1000., 1000.);
+		double y = random.Uniform(-1000., 1000.);
+		switch(detector){
+		case AnalysisKernels::kCHOD:
+			((TRecoCHODCandidate*)event->AddCandidate())->SetHitPosition(TVector2(0.1*x, 0.1*y));
+			break;
+		case AnalysisKernels::kLKr:{
+			TRecoLKrCandidate* cluster = (TRecoLKrCandidate*)event->AddCandidate();
+			cluster->SetClusterX(0.1*x);
+			cluster->SetClusterY(0.1*y);
+			break;
+		}
+		case AnalysisKernels::kMUV1:
+			((TRecoMUV1Candidate*)event->AddCandidate())->SetPosition(TVector2(x, y));
+			break;
+		case AnalysisKernels::kMUV2:
+			((TRecoMUV2Candidate*)event->AddCandidate())->SetPosition(TVector2(x, y));
+			break;
+		case AnalysisKernels::kMUV3:{
+			TRecoMUV3Candidate* tile = (TRecoMUV3Candidate*)event->AddCandidate();
+			tile->SetX(x);
+			tile->SetY(y);
+			break;
+		}
+		}
+	}
+}
+
+int main(int argc, char** argv){
+	int nRepetitions = 15;
+	int nWarmup = 3;
+	double minTime = 2.;
+	TString filter;
+	TString outFileName;
+	TString label;
+
+	int opt;
+	struct option longopts[] = {
+			{ "help",		no_argument,		NULL,	'h'},
+			{ "repetitions",required_argument,	NULL,	'r'},
+			{ "warmup",		required_argument,	NULL,	'w'},
+			{ "min-time",	required_argument,	NULL,	't'},
+			{ "filter",		required_argument,	NULL,	'f'},
+			{ "output",		required_argument,	NULL,	'o'},
+			{ "label",		required_argument,	NULL,	'0'},
+			{0,0,0,0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "hr:w:t:f:o:0:", longopts, NULL)) != -1) {
+		switch (opt) {
+		case 'r': /* long_option: repetitions */
+			nRepetitions = TString(optarg).Atoi();
+			break;
+		case 'w': /* long_option: warmup */
+			nWarmup = TString(optarg).Atoi();
+			break;
+		case 't': /* Minimum time per repetition, long_option: min-time */
+			minTime = TString(optarg).Atof();
+			break;
+		case 'f': /* Kernel name regexp, long_option: filter */
+			filter = TString(optarg);
+			break;
+		case 'o': /* JSON output, long_option: output */
+			outFileName = TString(optarg);
+			break;
+		case '0': /* long_option: label */
+			label = TString(optarg);
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	MicroBenchmark benchmark(nWarmup, nRepetitions, minTime*1e6);
+	TPRegexp filterRegexp(filter.IsNull() ? "." : filter.Data());
+	TRandom3 random(1);
+	int iInput = 0;
+
+	//FindClosestCluster: one event per detector and number of candidates, random extrapolations
+	vector<TVector3> extrapolations(kNInputs);
+	for(int iPoint=0; iPoint<kNInputs; iPoint++) extrapolations[iPoint].SetXYZ(random.Uniform(-1000., 1000.), random.Uniform(-1000., 1000.), 0.);
+	TRecoVEvent* events[AnalysisKernels::kNDetectors] = {new TRecoCHODEvent, new TRecoLKrEvent, new TRecoMUV1Event, new TRecoMUV2Event, new TRecoMUV3Event};
+	for(int detector=0; detector<AnalysisKernels::kNDetectors; detector++){
+		TString kernel = TString("FindClosestCluster_") + AnalysisKernels::GetDetectorName(detector);
+		if(!kernel.Contains(filterRegexp)) continue;
+		for(size_t iSize=0; iSize<sizeof(kSizes)/sizeof(int); iSize++){
+			FillCandidates(events[detector], detector, kSizes[iSize], random);
+			TRecoVEvent* event = events[detector];
+			benchmark.Run(kernel, kSizes[iSize], [&](){
+				double minimum = 0.;
+				int position = AnalysisKernels::FindClosestCluster(event, extrapolations[iInput++ & (kNInputs-1)], detector, minimum);
+				return minimum + position;
+			});
+		}
+	}
+
+	//VertexCDA: track after the STRAW and beam kaon from Trim5
+	TString kernel = "VertexCDA";
+	if(kernel.Contains(filterRegexp)){
+		vector<TVector3> positions(kNInputs), momenta(kNInputs);
+		for(int iTrack=0; iTrack<kNInputs; iTrack++){
+			positions[iTrack].SetXYZ(random.Uniform(-500., 500.), random.Uniform(-500., 500.), 183508.);
+			momenta[iTrack].SetXYZ(random.Gaus(0., 400.), random.Gaus(0., 400.), random.Uniform(10000., 60000.));
+		}
+		TVector3 beamPosition(0., 0., 101800.);
+		TVector3 beamMomentum(90., 0., 75000.);
+		benchmark.Run(kernel, 0, [&](){
+			double cda = 0.;
+			int iTrack = iInput++ & (kNInputs-1);
+			TVector3 vertex = AnalysisKernels::VertexCDA(positions[iTrack], momenta[iTrack], beamPosition, beamMomentum, cda);
+			return cda + vertex.Z();
+		});
+	}
+
+	//LKr non-linearity: MIP to electromagnetic cluster energies and sizes
+	kernel = "LKrCorrectedEnergy";
+	if(kernel.Contains(filterRegexp)){
+		vector<double> energies(kNInputs);
+		vector<int> nCells(kNInputs);
+		for(int iCluster=0; iCluster<kNInputs; iCluster++){
+			energies[iCluster] = random.Uniform(0.1, 80.);
+			nCells[iCluster] = 1 + random.Integer(40);
+		}
+		benchmark.Run(kernel, 0, [&](){
+			int iCluster = iInput++ & (kNInputs-1);
+			return AnalysisKernels::LKrCorrectedEnergy(energies[iCluster], nCells[iCluster]);
+		});
+	}
+
+	//MUV1 strip matching: random strips and times of the hits, track strip and CHOD time varied
+	kernel = "MUVStripMatching";
+	if(kernel.Contains(filterRegexp)){
+		TRecoMUV1Event muv1Event;
+		for(size_t iSize=0; iSize<sizeof(kSizes)/sizeof(int); iSize++){
+			muv1Event.Clear("C");
+			for(int iHit=0; iHit<kSizes[iSize]; iHit++){
+				TRecoMUV1Hit* hit = (TRecoMUV1Hit*)muv1Event.AddHit();
+				hit->SetChannelID((1 + random.Integer(2))*100 + random.Integer(2)*50 + 1 + random.Integer(44));
+				hit->SetTime(random.Uniform(-50., 50.));
+			}
+			benchmark.Run(kernel, kSizes[iSize], [&](){
+				int iTrack = iInput++;
+				int nVertical, nHorizontal;
+				return AnalysisKernels::MatchStrips(&muv1Event, 1 + iTrack%44, 1 + (iTrack/44)%44, (iTrack%21) - 10., nVertical, nHorizontal);
+			});
+		}
+	}
+
+	//RICH ring mass: ring radius of muons and pions at 15-35 GeV/c
+	kernel = "RICHMass";
+	if(kernel.Contains(filterRegexp)){
+		vector<double> momenta(kNInputs), radii(kNInputs);
+		for(int iRing=0; iRing<kNInputs; iRing++){
+			momenta[iRing] = random.Uniform(15000., 35000.);
+			radii[iRing] = random.Uniform(150., 190.);
+		}
+		benchmark.Run(kernel, 0, [&](){
+			int iRing = iInput++ & (kNInputs-1);
+			return AnalysisKernels::RICHMass(momenta[iRing], radii[iRing]);
+		});
+	}
+
+	//FillHisto: framework lookup by name (with the variant suffix, as in Kmu2) against a stored pointer
+	TString nameKernel = "FillHistoByName";
+	TString handleKernel = "FillHistoByHandle";
+	if(nameKernel.Contains(filterRegexp) || handleKernel.Contains(filterRegexp)){
+		NA62Analysis::Core::HistoHandler histoHandler;
+		vector<TString> names;
+		vector<TH1*> handles;
+		for(int iHisto=0; iHisto<400; iHisto++){
+			TString name = TString::Format("Kmu2Histo_%03d", iHisto);
+			TH1* histo = new TH1D(name, name, 100, 0., 1.);
+			histo->SetDirectory(0);
+			histoHandler.BookHisto(name, histo);
+			names.push_back(name);
+			handles.push_back(histo);
+		}
+		TString suffix = "";
+		for(size_t iSize=0; iSize<sizeof(kSizes)/sizeof(int); iSize++){
+			//Number of distinct histograms filled in turn
+			int nFilled = kSizes[iSize];
+			if(nameKernel.Contains(filterRegexp)){
+				benchmark.Run(nameKernel, nFilled, [&](){
+					int iHisto = (iInput++)%nFilled;
+					histoHandler.FillHisto(names[iHisto*7%400] + suffix, 0.5);
+					return 0.;
+				});
+			}
+			if(handleKernel.Contains(filterRegexp)){
+				benchmark.Run(handleKernel, nFilled, [&](){
+					int iHisto = (iInput++)%nFilled;
+					handles[iHisto*7%400]->Fill(0.5);
+					return 0.;
+				});
+			}
+		}
+	}
+
+	benchmark.Print(cout);
+	if(!outFileName.IsNull()){
+		ofstream out(outFileName.Data());
+		if(!out){
+			cerr << "MicroBenchmarks: cannot write " << outFileName << endl;
+			return EXIT_FAILURE;
+		}
+		benchmark.WriteJSON(out, label);
+		cout << "Results written to " << outFileName << endl;
+	}
+	for(int detector=0; detector<AnalysisKernels::kNDetectors; detector++) delete events[detector];
+	return EXIT_SUCCESS;
+}
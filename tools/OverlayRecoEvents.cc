@@ -0,0 +1,166 @@
+#include <getopt.h>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdlib.h>
+#include <vector>
+
+#include <TChain.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TString.h>
+#include <TSystem.h>
+#include <TTree.h>
+
+#include "RecoEventOverlay.hh"
+
+using namespace std;
+
+void usage(char* name)
+{
+	cout << endl;
+	cout << "Usage: \t"<< name << " (-i path | -l/--list path) -o dir -k int [options]" << endl << endl;
+	cout << "Overlays on each event the candidates and hits of k random other events of the input, time shifted." << endl
+		 << "Writes dir/<input file name> for each input file (the other trees are copied unchanged) and dir/files.list." << endl << endl;
+	cout << "Allowed options:" << endl;
+	cout << "  -h/--help\t\t: Display this help" << endl;
+	cout << "  -i path\t\t: Path to an input ROOT file." << endl;
+	cout << "  -l/--list path\t: Path to a text file containing a list of paths to input ROOT files." << endl;
+	cout << "  -o/--output path\t: Output directory, created if missing." << endl;
+	cout << "  -k/--overlay int\t: Number of events overlaid on each event. (Default: 1)" << endl;
+	cout << "  -n/--nevt int\t\t: Maximum number of events per file. (Default: All)" << endl;
+	cout << "  --window float\t: Half width of the window of the time shifts in ns. (Default: 50)" << endl;
+	cout << "  --detectors string\t: Comma separated detectors to overlay. (Default: CHOD,LKr,MUV1,MUV2,MUV3,Cedar,RICH)" << endl;
+	cout << "  --seed int\t\t: Seed of the random generator. (Default: 1)" << endl;
+	cout << endl << endl;
+}
+
+int main(int argc, char** argv){
+	TString inFileName;
+	bool fromList = false;
+	TString outDir;
+	TString detectors;
+	int nOverlay = 1;
+	Long64_t maxEvents = -1;
+	double window = 50.;
+	unsigned int seed = 1;
+
+	int opt;
+	struct option longopts[] = {
+			{ "help",		no_argument,		NULL,	'h'},
+			{ "list",		required_argument,	NULL,	'l'},
+			{ "output",		required_argument,	NULL,	'o'},
+			{ "overlay",	required_argument,	NULL,	'k'},
+			{ "nevt",		required_argument,	NULL,	'n'},
+			{ "window",		required_argument,	NULL,	'0'},
+			{ "detectors",	required_argument,	NULL,	'1'},
+			{ "seed",		required_argument,	NULL,	'2'},
+			{0,0,0,0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "hi:l:o:k:n:0:1:2:", longopts, NULL)) != -1) {
+		switch (opt) {
+		case 'i': /* Input file */
+			inFileName = TString(optarg);
+			fromList = false;
+			break;
+		case 'l': /* Input files list, long_option: list */
+			inFileName = TString(optarg);
+			fromList = true;
+			break;
+		case 'o': /* Output directory, long_option: output */
+			outDir = TString(optarg);
+			break;
+		case 'k': /* Overlay factor, long_option: overlay */
+			nOverlay = TString(optarg).Atoi();
+			break;
+		case 'n': /* Maximum number of events per file, long_option: nevt */
+			maxEvents = TString(optarg).Atoll();
+			break;
+		case '0': /* long_option: window */
+			window = TString(optarg).Atof();
+			break;
+		case '1': /* long_option: detectors */
+			detectors = TString(optarg);
+			break;
+		case '2': /* long_option: seed */
+			seed = TString(optarg).Atoi();
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(inFileName.IsNull() || outDir.IsNull() || nOverlay<0){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	vector<TString> inputs;
+	if(fromList){
+		ifstream list(inFileName.Data());
+		string line;
+		while(getline(list, line)){
+			TString path = TString(line.c_str()).Strip(TString::kBoth);
+			if(!path.IsNull()) inputs.push_back(path);
+		}
+	}
+	else inputs.push_back(inFileName);
+	if(inputs.empty()){
+		cerr << "OverlayRecoEvents: no input file in " << inFileName << endl;
+		return EXIT_FAILURE;
+	}
+
+	//Donors: all the input files
+	TChain donors("Reco");
+	for(size_t iFile=0; iFile<inputs.size(); iFile++) donors.Add(inputs[iFile]);
+	gSystem->mkdir(outDir, kTRUE);
+
+	RecoEventOverlay overlay(seed);
+	overlay.SetTimeWindow(window);
+	if(!detectors.IsNull() && !overlay.SetDetectors(detectors)) return EXIT_FAILURE;
+	overlay.SetDonors(&donors);
+
+	ofstream outList(outDir + "/files.list");
+	Long64_t firstEntry = 0;
+	for(size_t iFile=0; iFile<inputs.size(); iFile++){
+		TFile* inFile = TFile::Open(inputs[iFile]);
+		TTree* inTree = inFile ? (TTree*)inFile->Get("Reco") : 0;
+		if(!inTree){
+			cerr << "OverlayRecoEvents: no Reco tree in " << inputs[iFile] << endl;
+			return EXIT_FAILURE;
+		}
+		TString outFileName = outDir + "/" + gSystem->BaseName(inputs[iFile]);
+		TFile outFile(outFileName, "RECREATE");
+		overlay.SetTarget(inTree);
+		TTree* outTree = inTree->CloneTree(0);
+		Long64_t nEntries = inTree->GetEntries();
+		Long64_t nEvents = maxEvents>=0 && maxEvents<nEntries ? maxEvents : nEntries;
+		for(Long64_t iEntry=0; iEntry<nEvents; iEntry++){
+			inTree->GetEntry(iEntry);
+			overlay.Overlay(nOverlay, firstEntry + iEntry);
+			outTree->Fill();
+		}
+		outTree->Write();
+
+		//Other trees (Digis, MC, ...) copied unchanged
+		set<TString> copied;
+		TIter next(inFile->GetListOfKeys());
+		while(TKey* key = (TKey*)next()){
+			TString name = key->GetName();
+			if(name=="Reco" || copied.count(name) || !TString(key->GetClassName()).BeginsWith("TTree")) continue;
+			copied.insert(name);
+			TTree* tree = (TTree*)inFile->Get(name);
+			outFile.cd();
+			tree->CloneTree(-1, "fast")->Write();
+		}
+		outFile.Close();
+		inFile->Close();
+		delete inFile;
+		firstEntry += nEntries;
+		outList << outFileName << endl;
+		cout << outFileName << ": " << nEvents << " events, " << nOverlay << " overlaid per event" << endl;
+	}
+	return EXIT_SUCCESS;
+}